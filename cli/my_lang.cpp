@@ -1,4 +1,18 @@
+#include "ml/analysis/lint.h"
+#include "ml/analysis/search.h"
+#include "ml/analysis/semantic_tokens.h"
+#include "ml/analysis/symbol_index.h"
+#include "ml/ast/image.h"
+#include "ml/basic/hash.h"
+#include "ml/compiler/build.h"
 #include "ml/compiler/compiler.h"
+#include "ml/compiler/snapshot.h"
+#include "ml/format/formatter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <iomanip>
 
 ml::compiler::Configuration parseArgs(int argc, char **argv) {
   ml::compiler::Configuration config;
@@ -7,18 +21,632 @@ ml::compiler::Configuration parseArgs(int argc, char **argv) {
     std::string arg = argv[i];
     if (arg == "--debug" || arg == "-g") {
       config.debug = true;
+    } else if (arg == "--optimize" || arg == "-O") {
+      config.optimize = true;
     }
   }
 
   return config;
 }
 
+/**
+ * @brief Reads the value following an option, such as --db build.db.
+ * @param i The index of the option; moved to its value.
+ * @param value Set to the value.
+ * @return False, after reporting it, if the value is missing.
+ */
+bool valueOption(int argc, char **argv, int &i, std::string &value) {
+  if (i + 1 >= argc) {
+    std::cerr << "Missing value for " << argv[i] << std::endl;
+    return false;
+  }
+  value = argv[++i];
+  return true;
+}
+
+/**
+ * @brief Reads the number following an option, such as --jobs 4.
+ * @param i The index of the option; moved to its value.
+ * @param value Set to the number.
+ * @return False, after reporting it, if the value is missing or is not a
+ * non-negative number.
+ */
+bool numericOption(int argc, char **argv, int &i, unsigned &value) {
+  std::string option = argv[i];
+  std::string text;
+  if (!valueOption(argc, argv, i, text)) {
+    return false;
+  }
+  unsigned long number = 0;
+  bool valid = !text.empty() && text.size() <= 10;
+  for (char c : text) {
+    valid = valid && c >= '0' && c <= '9';
+  }
+  if (valid) {
+    number = std::stoul(text);
+    valid = number <= UINT_MAX;
+  }
+  if (!valid) {
+    std::cerr << "Invalid value for " << option << ": '" << text
+              << "' (expected a non-negative integer)" << std::endl;
+    return false;
+  }
+  value = static_cast<unsigned>(number);
+  return true;
+}
+
+/**
+ * @brief Reads a source file.
+ * @param path The path of the file.
+ * @param source Set to the content of the file.
+ * @return False, after reporting it, if the file cannot be read.
+ */
+bool readSource(const std::string &path, std::string &source) {
+  try {
+    source = ml::compiler::Compiler::readFile(path);
+  } catch (const std::exception &error) {
+    std::cerr << error.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int runBuild(int argc, char **argv) {
+  ml::compiler::BuildOptions options;
+  std::vector<std::string> paths;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--jobs" || arg == "-j") {
+      if (!numericOption(argc, argv, i, options.jobs)) {
+        return 1;
+      }
+    } else if (arg == "--db") {
+      if (!valueOption(argc, argv, i, options.database)) {
+        return 1;
+      }
+    } else {
+      paths.push_back(arg);
+    }
+  }
+
+  if (paths.empty()) {
+    std::cerr << "Usage: my_lang build [--jobs N] [--db <file>] <paths...>"
+              << std::endl;
+    return 1;
+  }
+
+  auto sources = ml::compiler::Builder::collectSources(paths);
+  ml::compiler::Builder builder(options);
+  auto summary = builder.build(sources);
+
+  std::cout << "Built " << summary.total << " files: " << summary.cached
+            << " up to date, " << summary.rebuilt << " rebuilt, "
+            << summary.failed << " failed (cache hit rate " << std::fixed
+            << std::setprecision(1) << summary.hitRate() * 100.0 << "%)"
+            << std::endl;
+  for (const auto &path : summary.failures) {
+    std::cerr << "Could not build " << path << std::endl;
+  }
+  if (!summary.saved) {
+    std::cerr << "Failed to write " << options.database << std::endl;
+    return 1;
+  }
+
+  return summary.failed == 0 ? 0 : 1;
+}
+
+int runIndex(int argc, char **argv) {
+  std::string index_path = ".ml_build/symbols.idx";
+  unsigned jobs = 0;
+  std::vector<std::string> paths;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--jobs" || arg == "-j") {
+      if (!numericOption(argc, argv, i, jobs)) {
+        return 1;
+      }
+    } else if (arg == "--index") {
+      if (!valueOption(argc, argv, i, index_path)) {
+        return 1;
+      }
+    } else {
+      paths.push_back(arg);
+    }
+  }
+
+  if (paths.empty()) {
+    std::cerr << "Usage: my_lang index [--jobs N] [--index <file>] <paths...>"
+              << std::endl;
+    return 1;
+  }
+
+  auto sources = ml::compiler::Builder::collectSources(paths);
+  auto summary = ml::analysis::updateSymbolIndex(index_path, sources, jobs);
+  if (!summary.written) {
+    std::cerr << "Failed to write " << index_path << std::endl;
+    return 1;
+  }
+
+  std::cout << "Indexed " << summary.files << " files (" << summary.reused
+            << " unchanged): " << summary.symbols << " symbols, "
+            << summary.occurrences << " occurrences" << std::endl;
+  return 0;
+}
+
+int runQuery(int argc, char **argv) {
+  std::string index_path = ".ml_build/symbols.idx";
+  std::string name;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--index") {
+      if (!valueOption(argc, argv, i, index_path)) {
+        return 1;
+      }
+    } else {
+      name = arg;
+    }
+  }
+
+  if (name.empty()) {
+    std::cerr << "Usage: my_lang query [--index <file>] <name>" << std::endl;
+    return 1;
+  }
+
+  ml::analysis::SymbolIndex index;
+  if (!index.open(index_path)) {
+    std::cerr << "No valid symbol index at " << index_path
+              << " (run 'my_lang index' first)" << std::endl;
+    return 1;
+  }
+
+  auto locations = index.lookup(name);
+  for (const auto &location : locations) {
+    std::cout << location.path << ":" << location.line << ":"
+              << location.column << ": ";
+    if (location.definition) {
+      std::cout << "definition " << ml::analysis::symbolKindName(location.kind);
+    } else {
+      std::cout << "reference";
+    }
+    std::cout << std::endl;
+  }
+  return locations.empty() ? 1 : 0;
+}
+
+int runImage(int argc, char **argv) {
+  std::string output;
+  std::string file_path;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--output" || arg == "-o") {
+      if (!valueOption(argc, argv, i, output)) {
+        return 1;
+      }
+    } else {
+      file_path = arg;
+    }
+  }
+
+  if (file_path.empty()) {
+    std::cerr << "Usage: my_lang image [--output <file>] <file>" << std::endl;
+    return 1;
+  }
+  if (output.empty()) {
+    output = file_path + "i";
+  }
+
+  std::string source;
+  if (!readSource(file_path, source)) {
+    return 1;
+  }
+  ml::parser::Parser parser;
+  parser.setFile(file_path);
+  auto program = parser.parse(source);
+  if (!program || parser.errors() > 0) {
+    std::cerr << "Compilation failed." << std::endl;
+    return 1;
+  }
+  if (!ml::ast::writeImage(output, *program, ml::basic::fnv1a(source))) {
+    std::cerr << "Failed to write " << output << std::endl;
+    return 1;
+  }
+  std::cout << "Wrote " << output << std::endl;
+  return 0;
+}
+
+int runSnapshot(int argc, char **argv) {
+  std::string output;
+  std::string file_path;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--output" || arg == "-o") {
+      if (!valueOption(argc, argv, i, output)) {
+        return 1;
+      }
+    } else {
+      file_path = arg;
+    }
+  }
+
+  if (file_path.empty()) {
+    std::cerr << "Usage: my_lang snapshot [--output <file>] <file>"
+              << std::endl;
+    return 1;
+  }
+  if (output.empty()) {
+    output = file_path + ".snap";
+  }
+
+  std::string source;
+  if (!readSource(file_path, source)) {
+    return 1;
+  }
+  uint64_t hash = ml::basic::fnv1a(source);
+  ml::compiler::StartupSnapshot snapshot;
+  if (snapshot.open(output, hash)) {
+    std::cout << "Restored " << snapshot.globalCount() << " globals and "
+              << snapshot.typeCount() << " types from " << output
+              << std::endl;
+    return 0;
+  }
+
+  ml::parser::Parser parser;
+  parser.setFile(file_path);
+  auto program = parser.parse(source);
+  if (!program || parser.errors() > 0) {
+    std::cerr << "Compilation failed." << std::endl;
+    return 1;
+  }
+  auto state = ml::compiler::initialize(*program);
+  if (!ml::compiler::writeSnapshot(output, state, hash)) {
+    std::cerr << "Failed to write " << output << std::endl;
+    return 1;
+  }
+  std::cout << "Wrote " << output << ": " << state.globals.size()
+            << " globals (" << state.deferred() << " deferred), "
+            << state.types.size() << " types" << std::endl;
+  return 0;
+}
+
+int runFmt(int argc, char **argv) {
+  ml::format::FormatOptions options;
+  unsigned jobs = 0;
+  bool check = false;
+  std::vector<std::string> paths;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--jobs" || arg == "-j") {
+      if (!numericOption(argc, argv, i, jobs)) {
+        return 1;
+      }
+    } else if (arg == "--width") {
+      if (!numericOption(argc, argv, i, options.width)) {
+        return 1;
+      }
+    } else if (arg == "--check") {
+      check = true;
+    } else {
+      paths.push_back(arg);
+    }
+  }
+
+  if (paths.empty()) {
+    std::cerr << "Usage: my_lang fmt [--check] [--jobs N] [--width N] "
+                 "<paths...>"
+              << std::endl;
+    return 1;
+  }
+
+  auto sources = ml::compiler::Builder::collectSources(paths);
+  auto summary = ml::format::formatFiles(sources, options, !check, jobs);
+  for (const auto &path : summary.changes) {
+    std::cout << (check ? "Not formatted: " : "Formatted: ") << path
+              << std::endl;
+  }
+  for (const auto &path : summary.errors) {
+    std::cerr << "Could not format " << path << std::endl;
+  }
+  std::cout << "Checked " << summary.files << " files: " << summary.changed
+            << (check ? " need formatting, " : " reformatted, ")
+            << summary.failed << " failed" << std::endl;
+
+  return summary.failed == 0 && (!check || summary.changed == 0) ? 0 : 1;
+}
+
+int runMinify(int argc, char **argv) {
+  ml::format::MinifyOptions options;
+  unsigned jobs = 0;
+  std::string output;
+  std::vector<std::string> paths;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--jobs" || arg == "-j") {
+      if (!numericOption(argc, argv, i, jobs)) {
+        return 1;
+      }
+    } else if (arg == "--output" || arg == "-o") {
+      if (!valueOption(argc, argv, i, output)) {
+        return 1;
+      }
+    } else if (arg == "--rename") {
+      options.rename = true;
+    } else {
+      paths.push_back(arg);
+    }
+  }
+
+  if (paths.empty()) {
+    std::cerr << "Usage: my_lang minify [--rename] [--jobs N] "
+                 "[--output <dir>] <paths...>"
+              << std::endl;
+    return 1;
+  }
+
+  auto sources = ml::compiler::Builder::collectSources(paths);
+  if (output.empty()) {
+    // Without a directory, print the minified sources.
+    int status = 0;
+    for (const auto &path : sources) {
+      std::string source;
+      if (!readSource(path, source)) {
+        status = 1;
+        continue;
+      }
+      std::string minified;
+      if (!ml::format::minifySource(source, minified, options)) {
+        std::cerr << "Could not minify " << path << std::endl;
+        status = 1;
+        continue;
+      }
+      std::cout << minified << std::endl;
+    }
+    return status;
+  }
+
+  auto summary = ml::format::minifyFiles(sources, options, output, jobs);
+  for (const auto &path : summary.errors) {
+    std::cerr << "Could not minify " << path << std::endl;
+  }
+  std::cout << "Minified " << summary.files - summary.failed << " of "
+            << summary.files << " files into " << output << ": "
+            << summary.input_bytes << " to " << summary.output_bytes
+            << " bytes" << std::endl;
+
+  return summary.failed == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Lists the lint rules on standard error.
+ */
+void printLintRules() {
+  std::cerr << "Rules:";
+  for (const auto &rule : ml::analysis::lintRules()) {
+    std::cerr << " " << rule;
+  }
+  std::cerr << std::endl;
+}
+
+int runLint(int argc, char **argv) {
+  ml::analysis::LintOptions options;
+  unsigned jobs = 0;
+  std::vector<std::string> paths;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--jobs" || arg == "-j") {
+      if (!numericOption(argc, argv, i, jobs)) {
+        return 1;
+      }
+    } else if (arg == "--rule") {
+      std::string rule;
+      if (!valueOption(argc, argv, i, rule)) {
+        return 1;
+      }
+      const auto &rules = ml::analysis::lintRules();
+      if (std::find(rules.begin(), rules.end(), rule) == rules.end()) {
+        std::cerr << "Unknown lint rule: " << rule << std::endl;
+        printLintRules();
+        return 1;
+      }
+      options.rules.push_back(rule);
+    } else if (arg == "--time") {
+      options.timed = true;
+    } else {
+      paths.push_back(arg);
+    }
+  }
+
+  if (paths.empty()) {
+    std::cerr << "Usage: my_lang lint [--jobs N] [--rule <name>] [--time] "
+                 "<paths...>"
+              << std::endl;
+    printLintRules();
+    return 1;
+  }
+
+  auto sources = ml::compiler::Builder::collectSources(paths);
+  auto summary = ml::analysis::lintFiles(sources, options, jobs);
+  bool errors = false;
+  for (const auto &file : summary.results) {
+    for (const auto &diagnostic : file.diagnostics) {
+      bool error = diagnostic.level >= ml::basic::ErrorLevel::Error;
+      errors = errors || error;
+      std::cout << file.path << ":" << diagnostic.start.line << ":"
+                << diagnostic.start.column << ": "
+                << (error ? "error: " : "warning: ") << diagnostic.desc
+                << " [" << diagnostic.rule << "]" << std::endl;
+    }
+  }
+  for (const auto &path : summary.errors) {
+    std::cerr << "Could not lint " << path << std::endl;
+  }
+  std::cout << "Linted " << summary.files << " files: "
+            << summary.diagnostics << " findings, " << summary.failed
+            << " failed" << std::endl;
+  for (const auto &timing : summary.timings) {
+    std::cout << "  " << std::left << std::setw(20) << timing.rule
+              << std::right << std::fixed << std::setprecision(3)
+              << std::chrono::duration<double, std::milli>(timing.time).count()
+              << " ms" << std::endl;
+  }
+
+  return summary.failed == 0 && !errors ? 0 : 1;
+}
+
+int runGrep(int argc, char **argv) {
+  unsigned jobs = 0;
+  bool stats = false;
+  std::string inside_text;
+  std::vector<std::string> args;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--jobs" || arg == "-j") {
+      if (!numericOption(argc, argv, i, jobs)) {
+        return 2;
+      }
+    } else if (arg == "--inside") {
+      if (!valueOption(argc, argv, i, inside_text)) {
+        return 2;
+      }
+    } else if (arg == "--stats") {
+      stats = true;
+    } else {
+      args.push_back(arg);
+    }
+  }
+
+  if (args.size() < 2) {
+    std::cerr << "Usage: my_lang grep [--inside <pattern>] [--jobs N] "
+                 "[--stats] <pattern> <paths...>"
+              << std::endl;
+    return 2;
+  }
+
+  ml::analysis::StructuralPattern pattern;
+  ml::analysis::StructuralPattern inside;
+  if (!pattern.parse(args[0])) {
+    std::cerr << "Invalid pattern: " << pattern.error() << std::endl;
+    return 2;
+  }
+  if (!inside_text.empty() && !inside.parse(inside_text)) {
+    std::cerr << "Invalid --inside pattern: " << inside.error() << std::endl;
+    return 2;
+  }
+
+  auto sources = ml::compiler::Builder::collectSources(
+      std::vector<std::string>(args.begin() + 1, args.end()));
+  auto summary = ml::analysis::searchFiles(
+      sources, pattern, inside_text.empty() ? nullptr : &inside, jobs);
+  for (const auto &match : summary.matches) {
+    std::cout << match.path << ":" << match.start.line << ":"
+              << match.start.column << ": " << match.line << std::endl;
+  }
+  for (const auto &path : summary.errors) {
+    std::cerr << "Could not search " << path << std::endl;
+  }
+  if (stats) {
+    std::cout << "Searched " << summary.files << " files: "
+              << summary.matches.size() << " matches, " << summary.skipped
+              << " skipped by the prefilter, " << summary.cached
+              << " read from images, " << summary.parsed << " parsed, "
+              << summary.failed << " failed" << std::endl;
+  }
+
+  return summary.matches.empty() ? 1 : 0;
+}
+
+int runTokens(int argc, char **argv) {
+  if (argc != 3) {
+    std::cerr << "Usage: my_lang tokens <file>" << std::endl;
+    return 1;
+  }
+
+  std::string source;
+  if (!readSource(argv[2], source)) {
+    return 1;
+  }
+  ml::analysis::SemanticDocument document(std::move(source));
+  const auto &types = ml::analysis::semanticTokenTypes();
+  const auto &modifiers = ml::analysis::semanticTokenModifiers();
+  for (const auto &token : document.tokens()) {
+    std::cout << token.line + 1 << ":" << token.column + 1 << " "
+              << token.length << " " << types[static_cast<size_t>(token.type)];
+    for (size_t i = 0; i < modifiers.size(); i++) {
+      if (token.modifiers & (1u << i)) {
+        std::cout << " " << modifiers[i];
+      }
+    }
+    std::cout << std::endl;
+  }
+  return 0;
+}
+
 int main(int argc, char **argv) {
+  if (argc >= 2 && std::string(argv[1]) == "build") {
+    return runBuild(argc, argv);
+  }
+  if (argc >= 2 && std::string(argv[1]) == "index") {
+    return runIndex(argc, argv);
+  }
+  if (argc >= 2 && std::string(argv[1]) == "query") {
+    return runQuery(argc, argv);
+  }
+  if (argc >= 2 && std::string(argv[1]) == "image") {
+    return runImage(argc, argv);
+  }
+  if (argc >= 2 && std::string(argv[1]) == "snapshot") {
+    return runSnapshot(argc, argv);
+  }
+  if (argc >= 2 && std::string(argv[1]) == "fmt") {
+    return runFmt(argc, argv);
+  }
+  if (argc >= 2 && std::string(argv[1]) == "minify") {
+    return runMinify(argc, argv);
+  }
+  if (argc >= 2 && std::string(argv[1]) == "lint") {
+    return runLint(argc, argv);
+  }
+  if (argc >= 2 && std::string(argv[1]) == "grep") {
+    return runGrep(argc, argv);
+  }
+  if (argc >= 2 && std::string(argv[1]) == "tokens") {
+    return runTokens(argc, argv);
+  }
+
   ml::compiler::Configuration config = parseArgs(argc, argv);
   ml::compiler::Compiler compiler;
 
   if (argc < 2) {
-    std::cerr << "Usage: my_lang <file>" << std::endl;
+    std::cerr << "Usage: my_lang <file> [--debug] [--optimize]" << std::endl;
+    std::cerr << "       my_lang build [--jobs N] [--db <file>] <paths...>"
+              << std::endl;
+    std::cerr << "       my_lang index [--jobs N] [--index <file>] <paths...>"
+              << std::endl;
+    std::cerr << "       my_lang query [--index <file>] <name>" << std::endl;
+    std::cerr << "       my_lang image [--output <file>] <file>" << std::endl;
+    std::cerr << "       my_lang snapshot [--output <file>] <file>"
+              << std::endl;
+    std::cerr << "       my_lang fmt [--check] [--jobs N] [--width N] "
+                 "<paths...>"
+              << std::endl;
+    std::cerr << "       my_lang minify [--rename] [--jobs N] "
+                 "[--output <dir>] <paths...>"
+              << std::endl;
+    std::cerr << "       my_lang lint [--jobs N] [--rule <name>] [--time] "
+                 "<paths...>"
+              << std::endl;
+    std::cerr << "       my_lang grep [--inside <pattern>] [--jobs N] "
+                 "[--stats] <pattern> <paths...>"
+              << std::endl;
+    std::cerr << "       my_lang tokens <file>" << std::endl;
     std::cout << "Press Enter to exit..." << std::endl;
     std::cin.get();
     return 1;
@@ -29,6 +657,24 @@ int main(int argc, char **argv) {
 
   if (program) {
     std::cout << "Compilation successful!" << std::endl;
+    if (config.optimize) {
+      const auto &dce = compiler.statistics().dce;
+      std::cout << "DCE: " << dce.unreachable
+                << " unreachable statements, " << dce.branches
+                << " dead branches, " << dce.functions << " functions and "
+                << dce.members << " members removed" << std::endl;
+      const auto &tail = compiler.statistics().tail_calls;
+      std::cout << "TCO: " << tail.calls << " tail calls in "
+                << tail.functions << " functions" << std::endl;
+      const auto &loops = compiler.statistics().loops;
+      std::cout << "Loops: " << loops.hoisted << " invariants hoisted, "
+                << loops.reduced << " multiplications reduced in "
+                << loops.loops << " loops" << std::endl;
+      const auto &cse = compiler.statistics().cse;
+      std::cout << "CSE: " << cse.eliminated << " evaluations eliminated, "
+                << cse.temporaries << " temporaries in " << cse.statements
+                << " statements" << std::endl;
+    }
   } else {
     std::cerr << "Compilation failed." << std::endl;
   }
@@ -39,4 +685,4 @@ int main(int argc, char **argv) {
   }
 
   return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,115 @@
+/**
+ * @file lint.h
+ * @brief Lint engine definitions for My Language.
+ * @details Defines lint rules as fused passes: every rule subscribes to the
+ * node types it checks, and all enabled rules run together in one traversal
+ * per file, sharing a single scope resolver. Files are linted in parallel on
+ * the shared pool, and the time spent in each rule is reported so a slow
+ * rule stands out.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "ml/ast/ast.h"
+#include "ml/basic/error.h"
+#include "ml/basic/locus.h"
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ml::analysis {
+
+/**
+ * @struct LintDiagnostic lint.h
+ * @brief A finding of a lint rule.
+ */
+struct LintDiagnostic {
+  std::string rule;        // Name of the rule that reported it
+  basic::ErrorLevel level; // Severity of the finding
+  std::string desc;        // What was found
+  std::string help;        // What to do about it
+  basic::Locus start;      // Start of the code concerned
+  basic::Locus end;        // End of the code concerned
+};
+
+/**
+ * @struct LintOptions lint.h
+ * @brief The settings of a lint run.
+ */
+struct LintOptions {
+  std::vector<std::string> rules; // Rules to run; empty runs every rule
+  bool timed = false;             // Whether to time the rules
+};
+
+/**
+ * @struct RuleTiming lint.h
+ * @brief The time spent in one rule.
+ * @details The shared scope resolver is reported as the rule "scopes".
+ */
+struct RuleTiming {
+  std::string rule;                              // Name of the rule
+  std::chrono::steady_clock::duration time = {}; // Time, summed over files
+};
+
+/**
+ * @brief Gets the names of the lint rules.
+ * @return The rule names, in the order the rules run.
+ * @details The rules are:
+ * - unused-variable: a local variable that is never referenced.
+ * - shadowing: a variable or parameter that hides another one in scope.
+ * - missing-return: a function with a return type that can reach the end of
+ *   its body.
+ * - const-reassignment: an assignment to, or increment of, a const variable.
+ * - empty-block: a block without statements, other than a function body.
+ */
+const std::vector<std::string> &lintRules();
+
+/**
+ * @brief Lints a program.
+ * @param program The program, which must have parsed without errors.
+ * @param options The rules to run.
+ * @param timings Receives the time of every rule if options.timed is set;
+ * may be null.
+ * @return The findings, sorted by location.
+ * @details Unknown rule names are ignored.
+ */
+std::vector<LintDiagnostic> lint(const ast::Program &program,
+                                 const LintOptions &options = LintOptions(),
+                                 std::vector<RuleTiming> *timings = nullptr);
+
+/**
+ * @struct LintedFile lint.h
+ * @brief The findings in one source file.
+ */
+struct LintedFile {
+  std::string path;                        // Path of the source file
+  std::vector<LintDiagnostic> diagnostics; // Findings, sorted by location
+};
+
+/**
+ * @struct LintSummary lint.h
+ * @brief Statistics of a lint run.
+ */
+struct LintSummary {
+  size_t files = 0;                // Number of files considered
+  size_t diagnostics = 0;          // Number of findings
+  size_t failed = 0;               // Number of unreadable or invalid files
+  std::vector<LintedFile> results; // The files with findings, in order
+  std::vector<std::string> errors; // The unreadable or invalid files
+  std::vector<RuleTiming> timings; // Time of every rule if options.timed
+};
+
+/**
+ * @brief Lints files.
+ * @param sources The source files.
+ * @param options The rules to run.
+ * @param jobs The number of threads to lint with, 0 for automatic.
+ * @return The statistics of the run, with file lists in source order.
+ */
+LintSummary lintFiles(const std::vector<std::string> &sources,
+                      const LintOptions &options = LintOptions(),
+                      unsigned jobs = 0);
+
+} // namespace ml::analysis
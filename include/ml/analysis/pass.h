@@ -0,0 +1,222 @@
+/**
+ * @file pass.h
+ * @brief Fused analysis pass definitions for My Language.
+ * @details Defines lightweight analysis passes that register per-node
+ * callbacks, and a PassManager that runs every registered pass in a single
+ * traversal of the AST. The time spent in each pass can be measured, so a
+ * slow pass stands out without profiling the whole run.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "ml/ast/ast.h"
+#include <array>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ml::analysis {
+
+class PassManager;
+
+/**
+ * @class Pass pass.h
+ * @brief Base class for analyses that run inside a fused traversal.
+ * @details A pass does not walk the tree itself. It registers callbacks for
+ * the node types it cares about in attach(), and the PassManager calls them
+ * while it walks the tree once for all passes.
+ */
+class Pass {
+public:
+  /**
+   * @brief Gets the name of the pass.
+   * @return A short identifier, such as "unused-variable".
+   */
+  virtual std::string name() const = 0;
+
+  /**
+   * @brief Registers the callbacks of the pass.
+   * @param manager The manager the pass is added to.
+   */
+  virtual void attach(PassManager &manager) = 0;
+
+  /**
+   * @brief Called once after the traversal has finished.
+   */
+  virtual void finish() {}
+
+  virtual ~Pass() = default;
+};
+
+/**
+ * @class PassManager pass.h
+ * @brief Runs many passes in one traversal.
+ * @details Callbacks are stored in a table indexed by NodeTag, so each node
+ * is dispatched with one table lookup, and only to the passes that
+ * registered for its type; there is no dynamic_cast per node and pass.
+ * Leave callbacks run in the reverse order of enter callbacks, so a pass
+ * added first, such as one tracking scopes, brackets the passes after it.
+ */
+class PassManager {
+public:
+  using Callback = std::function<void(const ast::Node &)>;
+  using Duration = std::chrono::steady_clock::duration;
+
+private:
+  /**
+   * @struct Entry pass.h
+   * @brief A callback and the pass that registered it.
+   */
+  struct Entry {
+    Callback callback; // The callback
+    size_t pass;       // Index of the pass, or NO_PASS
+  };
+
+  using Table = std::array<std::vector<Entry>, ast::NODE_TAG_COUNT>;
+
+  static constexpr size_t NO_PASS = static_cast<size_t>(-1);
+
+  std::vector<std::unique_ptr<Pass>> passes_; // Owned passes
+  Table enter_;                               // Pre-order callbacks by tag
+  Table leave_;                               // Post-order callbacks by tag
+  std::vector<const ast::Node *> ancestors_;  // Path to the current node
+  size_t visited_ = 0;                        // Nodes visited by run()
+  size_t attaching_ = NO_PASS;                // Pass registering callbacks
+  bool timed_ = false;                        // Whether to time passes
+  std::vector<Duration> times_;               // Time spent in each pass
+
+  /**
+   * @brief Adds a callback for nodes of type T, or for every node if T is
+   * ast::Node.
+   */
+  template <typename T, typename F> void registerIn(Table &table, F &&f) {
+    Entry entry{[f = std::forward<F>(f)](const ast::Node &node) {
+                  f(static_cast<const T &>(node));
+                },
+                this->attaching_};
+    if constexpr (std::is_same_v<T, ast::Node>) {
+      for (auto &entries : table) {
+        entries.push_back(entry);
+      }
+    } else {
+      table[static_cast<size_t>(T::TAG)].push_back(std::move(entry));
+    }
+  }
+
+  /**
+   * @brief Calls a callback, timing it if timing is enabled.
+   */
+  void call(const Entry &entry, const ast::Node &node) {
+    if (!this->timed_ || entry.pass == NO_PASS) {
+      entry.callback(node);
+      return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    entry.callback(node);
+    this->times_[entry.pass] += std::chrono::steady_clock::now() - start;
+  }
+
+  /**
+   * @brief Visits a subtree without recursion.
+   * @param root The root of the subtree.
+   */
+  void visit(const ast::Node &root);
+
+public:
+  /**
+   * @brief Adds a pass and lets it register its callbacks.
+   * @param pass The pass to add.
+   * @return A reference to the added pass.
+   */
+  Pass &add(std::unique_ptr<Pass> pass);
+
+  /**
+   * @brief Constructs and adds a pass.
+   * @tparam P The pass type.
+   * @param args The arguments of the pass constructor.
+   * @return A reference to the added pass.
+   */
+  template <typename P, typename... Args> P &emplace(Args &&...args) {
+    return static_cast<P &>(
+        this->add(std::make_unique<P>(std::forward<Args>(args)...)));
+  }
+
+  /**
+   * @brief Registers a callback called before the children of a node.
+   * @tparam T The node type; ast::Node matches every node.
+   * @param f The callback, taking a const T &.
+   * @details Callbacks run in registration order.
+   */
+  template <typename T, typename F> void onEnter(F &&f) {
+    this->registerIn<T>(this->enter_, std::forward<F>(f));
+  }
+
+  /**
+   * @brief Registers a callback called after the children of a node.
+   * @tparam T The node type; ast::Node matches every node.
+   * @param f The callback, taking a const T &.
+   * @details Callbacks run in reverse registration order.
+   */
+  template <typename T, typename F> void onLeave(F &&f) {
+    this->registerIn<T>(this->leave_, std::forward<F>(f));
+  }
+
+  /**
+   * @brief Runs every pass over a tree, then calls their finish().
+   * @param root The root of the tree, usually a Program.
+   */
+  void run(const ast::Node &root);
+
+  /**
+   * @brief Gets the ancestors of the node being visited.
+   * @return The nodes from the root to the parent of the current node.
+   */
+  const std::vector<const ast::Node *> &ancestors() const {
+    return this->ancestors_;
+  }
+
+  /**
+   * @brief Gets the parent of the node being visited.
+   * @return The parent, or nullptr at the root.
+   */
+  const ast::Node *parent() const {
+    return this->ancestors_.empty() ? nullptr : this->ancestors_.back();
+  }
+
+  /**
+   * @brief Enables or disables timing of the passes.
+   * @param timed True to measure every callback of every pass.
+   * @details Timing reads the clock twice per callback, so it is off by
+   * default. Callbacks registered outside of a pass are not timed.
+   */
+  void setTimed(bool timed) { this->timed_ = timed; }
+
+  /**
+   * @brief Gets the time a pass took in the last timed run.
+   * @param pass The index of the pass, in the order the passes were added.
+   * @return The time spent in its callbacks and in its finish().
+   */
+  Duration time(size_t pass) const {
+    return pass < this->times_.size() ? this->times_[pass] : Duration::zero();
+  }
+
+  /**
+   * @brief Gets the number of nodes visited by the last run.
+   * @return The node count.
+   */
+  size_t visited() const { return this->visited_; }
+
+  /**
+   * @brief Gets the added passes.
+   * @return The passes in the order they were added.
+   */
+  const std::vector<std::unique_ptr<Pass>> &passes() const {
+    return this->passes_;
+  }
+};
+
+} // namespace ml::analysis
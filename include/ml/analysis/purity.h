@@ -0,0 +1,64 @@
+/**
+ * @file purity.h
+ * @brief Purity analysis definitions for My Language.
+ * @details Defines an analysis that finds the functions and expressions whose
+ * evaluation cannot change program state, so optimizations may evaluate them
+ * fewer times or in a different order.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "ml/ast/ast.h"
+#include <string>
+#include <unordered_set>
+
+namespace ml::analysis {
+
+/**
+ * @class PurityAnalysis purity.h
+ * @brief Finds side-effect-free functions and expressions of a program.
+ * @details A top-level function is pure when its body only assigns to its
+ * own parameters and locals and only calls pure functions. Purity is
+ * computed optimistically and refined to a fixed point, so mutually
+ * recursive pure functions are recognized. Functions the program does not
+ * define, such as built-in output functions, are impure.
+ */
+class PurityAnalysis {
+private:
+  std::unordered_set<std::string> pure_functions_; // Names of pure functions
+
+public:
+  PurityAnalysis() = default;
+
+  /**
+   * @brief Analyzes every top-level function of a program.
+   * @param program The program to analyze.
+   */
+  explicit PurityAnalysis(const ast::Program &program);
+
+  /**
+   * @brief Checks whether a function is pure.
+   * @param name The name of a top-level function.
+   * @return True if calling the function cannot change program state.
+   */
+  bool isPureFunction(const std::string &name) const {
+    return this->pure_functions_.count(name) != 0;
+  }
+
+  /**
+   * @brief Checks whether evaluating an expression cannot change state.
+   * @param expression The root of the expression.
+   * @return True if the expression has no assignment, increment, decrement,
+   * method call or call to an impure function.
+   */
+  bool isPure(const ast::Node &expression) const;
+
+  /**
+   * @brief Gets the number of pure functions found.
+   * @return The pure function count.
+   */
+  size_t pureFunctionCount() const { return this->pure_functions_.size(); }
+};
+
+} // namespace ml::analysis
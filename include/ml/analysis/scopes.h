@@ -0,0 +1,151 @@
+/**
+ * @file scopes.h
+ * @brief Scope resolver definitions for My Language.
+ * @details Defines a pass that tracks the variables in scope during a fused
+ * traversal, so other passes can resolve the names they visit. It can also
+ * record what every reference resolved to, for tools that need the whole
+ * resolution after the traversal.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "ml/analysis/pass.h"
+#include "ml/ast/ast.h"
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ml::analysis {
+
+/**
+ * @brief Where a variable is declared.
+ */
+enum class BindingKind { Global, Parameter, Local, Field };
+
+/**
+ * @struct Binding scopes.h
+ * @brief A variable or parameter in scope.
+ */
+struct Binding {
+  const ast::VariableDeclaration *declaration; // The declaration
+  BindingKind kind;                            // Where it was declared
+  size_t scope;                                // Depth of its scope
+  size_t uses;                                 // References seen so far
+};
+
+/**
+ * @brief Finds the name an attribute expression selects.
+ * @param member The attribute of an AttributeExpression.
+ * @return The identifier naming the field, or null if there is none.
+ * @details Members are parsed as whole expressions, so in "a.b + c" the
+ * member is "b + c" and only its leftmost operand names a field.
+ */
+const ast::IdentifierExpression *memberName(const ast::Expression *member);
+
+/**
+ * @class Scopes scopes.h
+ * @brief Resolves variable references during a fused traversal.
+ * @details Add it before the passes that use it, so its enter callbacks run
+ * before theirs and its leave callbacks after theirs: a pass leaving a scope
+ * still sees the bindings of that scope. A variable is bound once its
+ * declaration has been left, so its initializer does not see it. Fields are
+ * never bound; they are reached through attribute expressions.
+ */
+class Scopes : public Pass {
+private:
+  PassManager *manager_ = nullptr;              // The running manager
+  std::vector<std::vector<Binding>> scopes_;    // Bindings, innermost last
+  std::unordered_set<const ast::Node *> names_; // Non-reference names
+  bool record_ = false;                         // Whether to keep results
+  std::unordered_map<const ast::IdentifierExpression *,
+                     const ast::VariableDeclaration *>
+      references_; // Resolved references, if recording
+  std::unordered_map<const ast::VariableDeclaration *, BindingKind>
+      kinds_; // Kinds of all variable declarations, if recording
+
+  void push() { this->scopes_.emplace_back(); }
+
+  void pop() {
+    if (!this->scopes_.empty()) {
+      this->scopes_.pop_back();
+    }
+  }
+
+  void ignore(const ast::Node *node) {
+    if (node) {
+      this->names_.insert(node);
+    }
+  }
+
+  Binding *find(const std::string &name);
+
+public:
+  /**
+   * @brief Creates a resolver.
+   * @param record True to keep what every reference resolved to.
+   */
+  explicit Scopes(bool record = false) : record_(record) {}
+
+  std::string name() const override { return "scopes"; }
+
+  void attach(PassManager &manager) override;
+
+  /**
+   * @brief Finds the binding a name refers to at the current node.
+   * @param name The name.
+   * @return The innermost binding with that name, or null.
+   */
+  const Binding *lookup(const std::string &name) const {
+    return const_cast<Scopes *>(this)->find(name);
+  }
+
+  /**
+   * @brief Gets the bindings of the innermost scope.
+   */
+  const std::vector<Binding> &innermost() const {
+    return this->scopes_.back();
+  }
+
+  /**
+   * @brief Gets the depth of the innermost scope.
+   */
+  size_t depth() const { return this->scopes_.size() - 1; }
+
+  /**
+   * @brief Checks whether an identifier refers to a variable, rather than
+   * naming a declaration, a type or a field.
+   */
+  bool isReference(const ast::IdentifierExpression &identifier) const {
+    return this->names_.count(&identifier) == 0;
+  }
+
+  /**
+   * @brief Classifies the variable declaration being visited by its parent.
+   */
+  BindingKind kindOf() const;
+
+  /**
+   * @brief Gets the references that resolved to a variable.
+   * @return The declaration of every resolved reference; empty unless
+   * recording. Unresolved references, such as function names, are absent.
+   */
+  const std::unordered_map<const ast::IdentifierExpression *,
+                           const ast::VariableDeclaration *> &
+  references() const {
+    return this->references_;
+  }
+
+  /**
+   * @brief Gets the kind of every variable declaration visited.
+   * @return The kinds, fields included; empty unless recording.
+   */
+  const std::unordered_map<const ast::VariableDeclaration *, BindingKind> &
+  kinds() const {
+    return this->kinds_;
+  }
+};
+
+} // namespace ml::analysis
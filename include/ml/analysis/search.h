@@ -0,0 +1,151 @@
+/**
+ * @file search.h
+ * @brief Structural code search definitions for My Language.
+ * @details Defines patterns written in ml syntax with metavariables, which
+ * match subtrees of parsed programs, and a search over many files. Files are
+ * searched in parallel; a file whose text or cached AST image lacks a name or
+ * node kind the pattern needs is rejected before it is parsed or matched.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "ml/ast/ast.h"
+#include "ml/basic/locus.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ml::analysis {
+
+/**
+ * @struct PatternBinding search.h
+ * @brief The code a metavariable matched.
+ */
+struct PatternBinding {
+  std::string name;       // Name of the metavariable, without '$'
+  const ast::Node *first; // First matched node, null for an empty list
+  const ast::Node *last;  // Last matched node, null for an empty list
+};
+
+/**
+ * @class StructuralPattern search.h
+ * @brief A code pattern matched against ASTs.
+ * @details A pattern is one ml statement or expression, such as
+ * "outputln($...)" or "while ($cond) { $...body }". In it:
+ * - $name matches any single node. A name used twice must match
+ *   structurally equal code both times.
+ * - $...name matches any number of arguments, elements, parameters or
+ *   statements; the name is optional.
+ * - $_ matches any single node without binding it.
+ * Every other node matches a node with the same kind, name, operator or
+ * value, and matching children. A declaration without a type or modifiers
+ * matches declarations with any type or modifiers.
+ */
+class StructuralPattern {
+private:
+  std::unique_ptr<ast::Program> program_; // The parsed pattern
+  const ast::Node *root_ = nullptr;       // The node to match
+  uint64_t tags_ = 0;                     // NodeTags every match contains
+  std::vector<std::string> words_;        // Words every match contains
+  std::string error_;                     // Why parsing failed
+
+public:
+  StructuralPattern() = default;
+
+  /**
+   * @brief Parses a pattern.
+   * @param text The pattern, in ml syntax with metavariables.
+   * @return True if the text is a single valid statement or expression.
+   */
+  bool parse(const std::string &text);
+
+  /**
+   * @brief Gets why the last parse() failed.
+   * @return The message, empty after a successful parse.
+   */
+  const std::string &error() const { return this->error_; }
+
+  /**
+   * @brief Matches the pattern against a node.
+   * @param node The node.
+   * @param bindings Receives the metavariables bound by the match; may be
+   * null.
+   * @return True if the pattern matches the node itself.
+   */
+  bool match(const ast::Node &node,
+             std::vector<PatternBinding> *bindings = nullptr) const;
+
+  /**
+   * @brief Checks whether a match is possible from the kinds of the nodes.
+   * @param tags A mask with bit 1 << NodeTag of every node kind present.
+   * @return False if a kind the pattern needs is missing.
+   */
+  bool mayMatchTags(uint64_t tags) const {
+    return (this->tags_ & ~tags) == 0;
+  }
+
+  /**
+   * @brief Checks whether a match is possible from the text of a source.
+   * @param source The source.
+   * @return False if a name or keyword the pattern needs is missing.
+   */
+  bool mayMatchText(std::string_view source) const;
+
+  /**
+   * @brief Gets the kind of the nodes the pattern matches.
+   * @return The NodeTag of the pattern root, or NodeTag::Node if the root
+   * is a metavariable that matches any node.
+   */
+  ast::NodeTag rootTag() const;
+};
+
+/**
+ * @struct SearchMatch search.h
+ * @brief One match in a source file.
+ */
+struct SearchMatch {
+  std::string path;   // Path of the source file
+  basic::Locus start; // Start of the matched code
+  basic::Locus end;   // End of the matched code
+  std::string line;   // Source line the match starts on
+  std::vector<std::pair<std::string, std::string>> bindings; // Name and code
+};
+
+/**
+ * @struct SearchSummary search.h
+ * @brief Statistics of a search.
+ */
+struct SearchSummary {
+  size_t files = 0;                 // Number of files considered
+  size_t skipped = 0;               // Files rejected by the prefilter
+  size_t cached = 0;                // Files read from an AST image
+  size_t parsed = 0;                // Files parsed from source
+  size_t failed = 0;                // Unreadable or invalid files
+  std::vector<SearchMatch> matches; // Matches, by file then pre-order
+  std::vector<std::string> errors;  // The unreadable or invalid files
+};
+
+/**
+ * @brief Searches files for a pattern.
+ * @param sources The source files.
+ * @param pattern The pattern to find.
+ * @param inside If not null, only matches inside a node matching this
+ * pattern are reported; a node counts as inside itself.
+ * @param jobs The number of threads to search with, 0 for automatic.
+ * @return The statistics of the search, with matches in source order.
+ * @details A file is skipped when it lacks a word of the pattern. Otherwise
+ * its AST is taken from the image "<source>i" written by my_lang image if
+ * that image is up to date, and is only materialized if the image holds
+ * every node kind the pattern needs; files without a usable image are
+ * parsed.
+ */
+SearchSummary searchFiles(const std::vector<std::string> &sources,
+                          const StructuralPattern &pattern,
+                          const StructuralPattern *inside = nullptr,
+                          unsigned jobs = 0);
+
+} // namespace ml::analysis
@@ -0,0 +1,225 @@
+/**
+ * @file semantic_tokens.h
+ * @brief Semantic token definitions for My Language.
+ * @details Defines the classification of source tokens for editor
+ * highlighting, in the form of LSP semantic tokens: keywords, literals and
+ * comments come from the lexer, and names are told apart by resolving them.
+ * A SemanticDocument keeps the tokens of an open file up to date as it is
+ * edited, re-lexing and re-parsing only the top-level statements an edit
+ * touches.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ml::analysis {
+
+/**
+ * @brief The kinds of semantic tokens, in the order of the LSP legend.
+ */
+enum class SemanticTokenType : uint8_t {
+  Keyword,   // Keywords, including true, false and null
+  Function,  // Functions and methods
+  Type,      // Records, classes and type names
+  Property,  // Fields of records and classes
+  Parameter, // Function parameters
+  Variable,  // Global and local variables
+  String,    // String and character literals
+  Number,    // Integer and float literals
+  Operator,  // Operators
+  Comment,   // Line and block comments
+};
+
+/**
+ * @brief The modifiers of semantic tokens, in the order of the LSP legend.
+ * @details Bit i of SemanticToken::modifiers is set for modifier i.
+ */
+enum class SemanticTokenModifier : uint8_t {
+  Declaration, // The name being declared
+  Readonly,    // A const variable or field
+};
+
+/**
+ * @struct SemanticToken semantic_tokens.h
+ * @brief A classified token, positioned as in LSP.
+ * @details Tokens never span lines; a multi-line string or comment is one
+ * token per line.
+ */
+struct SemanticToken {
+  uint32_t line;          // Line, from 0
+  uint32_t column;        // Column in UTF-16 code units, from 0
+  uint32_t length;        // Length in UTF-16 code units
+  SemanticTokenType type; // The kind of token
+  uint32_t modifiers;     // Bit set of SemanticTokenModifier
+
+  bool operator==(const SemanticToken &other) const {
+    return this->line == other.line && this->column == other.column &&
+           this->length == other.length && this->type == other.type &&
+           this->modifiers == other.modifiers;
+  }
+};
+
+/**
+ * @brief Gets the LSP names of the token types.
+ * @return The names, indexed by SemanticTokenType.
+ */
+const std::vector<std::string> &semanticTokenTypes();
+
+/**
+ * @brief Gets the LSP names of the token modifiers.
+ * @return The names, indexed by SemanticTokenModifier.
+ */
+const std::vector<std::string> &semanticTokenModifiers();
+
+/**
+ * @brief Encodes tokens the way LSP transmits them.
+ * @param tokens The tokens, in source order.
+ * @return Five integers per token: the line relative to the previous token,
+ * the column relative to the previous token if on the same line, the
+ * length, the type and the modifiers.
+ */
+std::vector<uint32_t> encodeSemanticTokens(
+    const std::vector<SemanticToken> &tokens);
+
+/**
+ * @struct SemanticTokensEdit semantic_tokens.h
+ * @brief A change to encoded tokens, as in an LSP delta response.
+ */
+struct SemanticTokensEdit {
+  uint32_t start = 0;         // Index of the first integer replaced
+  uint32_t delete_count = 0;  // Number of integers replaced
+  std::vector<uint32_t> data; // The integers replacing them
+};
+
+/**
+ * @brief Finds the smallest single edit between two encodings.
+ * @param previous The tokens the editor has, encoded.
+ * @param current The new tokens, encoded.
+ * @return An edit replacing whole tokens, which is empty if nothing
+ * changed.
+ */
+SemanticTokensEdit diffSemanticTokens(const std::vector<uint32_t> &previous,
+                                      const std::vector<uint32_t> &current);
+
+/**
+ * @struct SemanticUpdate semantic_tokens.h
+ * @brief The work done to bring a document's tokens up to date.
+ */
+struct SemanticUpdate {
+  size_t parsed = 0;       // Statements lexed and parsed again
+  size_t bytes = 0;        // Bytes lexed and parsed again
+  size_t reclassified = 0; // Other statements whose names were resolved
+                           // again, because a global name changed
+};
+
+/**
+ * @class SemanticDocument semantic_tokens.h
+ * @brief The semantic tokens of a source being edited.
+ * @details The source is split into top-level statements, each parsed on
+ * its own and cached with its tokens; a split point is the end of a
+ * statement, after a semicolon or brace outside any brackets. An edit
+ * re-parses the statements it overlaps, and the one before them, growing
+ * that range until it ends at a split point again. Names are resolved
+ * within a statement first, then against the functions, types and
+ * variables declared by every statement, so when an edit changes those
+ * declarations, the statements using the changed names are classified
+ * again without being parsed. A statement that does not parse is
+ * classified from its tokens alone.
+ */
+class SemanticDocument {
+private:
+  /**
+   * @struct Symbol semantic_tokens.h
+   * @brief How a name is highlighted.
+   */
+  struct Symbol {
+    SemanticTokenType type; // The kind of token
+    uint32_t modifiers;     // Bit set of SemanticTokenModifier
+
+    bool operator==(const Symbol &other) const {
+      return this->type == other.type && this->modifiers == other.modifiers;
+    }
+  };
+
+  struct Chunk;
+  class Classifier;
+
+  std::string source_;                         // The current source
+  std::vector<std::unique_ptr<Chunk>> chunks_; // Statements, in order
+  std::unordered_map<std::string, Symbol> globals_; // Top-level names
+
+  std::vector<std::unique_ptr<Chunk>> split(size_t offset, size_t length,
+                                            bool &complete) const;
+  size_t chunkAt(size_t offset) const;
+  void parse(Chunk &chunk) const;
+  void classify(Chunk &chunk) const;
+  void collectGlobals();
+
+public:
+  /**
+   * @brief Opens a source.
+   * @param source The source.
+   */
+  explicit SemanticDocument(std::string source = std::string());
+  ~SemanticDocument();
+
+  SemanticDocument(SemanticDocument &&) noexcept;
+  SemanticDocument &operator=(SemanticDocument &&) noexcept;
+
+  /**
+   * @brief Replaces the whole source.
+   * @param source The new source.
+   * @return The work done, which covers every statement.
+   */
+  SemanticUpdate open(std::string source);
+
+  /**
+   * @brief Replaces a range of the source.
+   * @param offset The byte offset of the range; clamped to the source.
+   * @param length The byte length of the range; clamped to the source.
+   * @param text The text to put in its place.
+   * @return The work done.
+   */
+  SemanticUpdate edit(size_t offset, size_t length, std::string_view text);
+
+  /**
+   * @brief Converts an LSP position to a byte offset.
+   * @param line The line, from 0.
+   * @param column The column in UTF-16 code units, from 0.
+   * @return The offset, clamped to the end of the line or the source.
+   */
+  size_t offsetAt(uint32_t line, uint32_t column) const;
+
+  /**
+   * @brief Gets the current source.
+   */
+  const std::string &source() const { return this->source_; }
+
+  /**
+   * @brief Gets the number of top-level statements the source is split in.
+   */
+  size_t chunks() const { return this->chunks_.size(); }
+
+  /**
+   * @brief Gets the tokens of the current source.
+   * @return The tokens, in source order.
+   */
+  std::vector<SemanticToken> tokens() const;
+
+  /**
+   * @brief Gets the tokens of the current source, encoded for LSP.
+   */
+  std::vector<uint32_t> encode() const {
+    return encodeSemanticTokens(this->tokens());
+  }
+};
+
+} // namespace ml::analysis
@@ -0,0 +1,189 @@
+/**
+ * @file symbol_index.h
+ * @brief Project-wide symbol index definitions for My Language.
+ * @details Defines symbol extraction from ASTs and an on-disk,
+ * memory-mappable index mapping symbol names to their definitions and
+ * references.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "ml/ast/ast.h"
+#include "ml/basic/locus.h"
+#include "ml/basic/mapped_file.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ml::analysis {
+
+/**
+ * @enum SymbolKind symbol_index.h
+ * @brief Enumeration of indexed symbol kinds.
+ * @details References are not resolved, so their kind is Unknown.
+ */
+enum class SymbolKind : uint8_t {
+  Unknown,
+  Function,
+  Method,
+  Record,
+  Class,
+  Field,
+  Variable
+};
+
+/**
+ * @brief Converts a SymbolKind to its string representation.
+ * @param kind The SymbolKind to convert.
+ * @return The lowercase name of the kind.
+ */
+inline std::string symbolKindName(const SymbolKind kind) {
+  switch (kind) {
+  case SymbolKind::Function:
+    return "function";
+  case SymbolKind::Method:
+    return "method";
+  case SymbolKind::Record:
+    return "record";
+  case SymbolKind::Class:
+    return "class";
+  case SymbolKind::Field:
+    return "field";
+  case SymbolKind::Variable:
+    return "variable";
+  default:
+    return "unknown";
+  }
+}
+
+/**
+ * @struct SymbolOccurrence symbol_index.h
+ * @brief A definition or reference of a symbol in one source file.
+ */
+struct SymbolOccurrence {
+  std::string name;                      // Name of the symbol
+  SymbolKind kind = SymbolKind::Unknown; // Kind of a definition
+  bool definition = false;               // Definition or reference
+  basic::Locus start;                    // Location of the name
+};
+
+/**
+ * @struct IndexedFile symbol_index.h
+ * @brief The symbols of one source file.
+ */
+struct IndexedFile {
+  std::string path;                          // Path of the source file
+  uint64_t hash = 0;                         // Hash of the source content
+  std::vector<SymbolOccurrence> occurrences; // Symbols of the file
+};
+
+/**
+ * @struct SymbolLocation symbol_index.h
+ * @brief A lookup result, pointing into the mapped index.
+ */
+struct SymbolLocation {
+  std::string_view path; // Path of the source file
+  SymbolKind kind;       // Kind of a definition
+  bool definition;       // Definition or reference
+  uint32_t line;         // Line of the name (1-based)
+  uint32_t column;       // Column of the name (1-based)
+  uint32_t index;        // Byte offset of the name (0-based)
+};
+
+/**
+ * @brief Extracts the symbol definitions and references of a program.
+ * @param program The program to scan.
+ * @return The occurrences in source order.
+ * @details Functions, methods, records, classes, fields and global variables
+ * are definitions (from Declaration::identifier); every other identifier,
+ * including type names and attribute names, is a reference. Locals and
+ * parameters are not definitions.
+ */
+std::vector<SymbolOccurrence> extractSymbols(const ast::Program &program);
+
+/**
+ * @brief Writes a symbol index file.
+ * @param file_path The path of the index file.
+ * @param files The symbols of every indexed file.
+ * @return True if the file was written, false otherwise.
+ * @details The file is written next to the target and renamed over it, so
+ * readers never observe a partially written index.
+ */
+bool writeSymbolIndex(const std::string &file_path,
+                      const std::vector<IndexedFile> &files);
+
+/**
+ * @class SymbolIndex symbol_index.h
+ * @brief Read-only view of a memory-mapped symbol index.
+ * @details Symbols are sorted by name, so a lookup is a binary search over
+ * the mapped file and does not deserialize anything.
+ */
+class SymbolIndex {
+private:
+  basic::MappedFile file_; // The mapped index file
+
+public:
+  /**
+   * @brief Maps an index file.
+   * @param file_path The path of the index file.
+   * @return True if the file is a valid index, false otherwise.
+   * @details Every section, name and occurrence is checked against the file,
+   * so a damaged index is rejected here rather than read out of bounds.
+   */
+  bool open(const std::string &file_path);
+
+  /**
+   * @brief Gets the number of indexed files.
+   * @return The file count, or 0 if no index is open.
+   */
+  size_t fileCount() const;
+
+  /**
+   * @brief Gets the number of distinct symbol names.
+   * @return The symbol count, or 0 if no index is open.
+   */
+  size_t symbolCount() const;
+
+  /**
+   * @brief Finds every definition and reference of a name.
+   * @param name The symbol name.
+   * @return The locations, definitions first.
+   */
+  std::vector<SymbolLocation> lookup(std::string_view name) const;
+
+  /**
+   * @brief Reconstructs the symbols of every indexed file.
+   * @return The indexed files, used to update the index incrementally.
+   */
+  std::vector<IndexedFile> files() const;
+};
+
+/**
+ * @struct IndexSummary symbol_index.h
+ * @brief Statistics of an index update.
+ */
+struct IndexSummary {
+  size_t files = 0;       // Number of indexed files
+  size_t reused = 0;      // Number of files taken from the previous index
+  size_t symbols = 0;     // Number of distinct symbol names
+  size_t occurrences = 0; // Number of definitions and references
+  bool written = false;   // Whether the index file was written
+};
+
+/**
+ * @brief Builds or updates a symbol index.
+ * @param file_path The path of the index file.
+ * @param sources The source files to index.
+ * @param jobs The number of threads to parse with, 0 for automatic.
+ * @return The statistics of the update; written is false if the index file
+ * could not be written.
+ * @details Files whose content hash matches the previous index are reused
+ * without being parsed; the others are parsed in parallel.
+ */
+IndexSummary updateSymbolIndex(const std::string &file_path,
+                               const std::vector<std::string> &sources,
+                               unsigned jobs = 0);
+
+} // namespace ml::analysis
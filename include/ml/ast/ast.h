@@ -10,6 +10,10 @@
 #include "ml/ast/cond.h"
 #include "ml/ast/decl.h"
 #include "ml/ast/expr.h"
+#include "ml/ast/image.h"
 #include "ml/ast/node.h"
+#include "ml/ast/node_index.h"
 #include "ml/ast/node_printer.h"
 #include "ml/ast/stmt.h"
+#include "ml/ast/structural.h"
+#include "ml/ast/walk.h"
@@ -44,6 +44,8 @@ struct Conditional : public Statement, public basic::Visitable<Conditional> {
 
   ENABLE_VISITORS(Conditional)
 
+  ENABLE_NODE_TAG(Conditional)
+
   virtual ~Conditional() = default;
 };
 
@@ -78,6 +80,8 @@ struct IfConditional : public Conditional,
         else_branch(std::move(else_branch)) {}
 
   ENABLE_VISITORS(IfConditional)
+
+  ENABLE_NODE_TAG(IfConditional)
 };
 
 /**
@@ -109,6 +113,8 @@ struct SwitchConditional : public Conditional,
         case_branches(std::move(case_branches)) {}
 
   ENABLE_VISITORS(SwitchConditional)
+
+  ENABLE_NODE_TAG(SwitchConditional)
 };
 
 /**
@@ -126,6 +132,8 @@ struct WhileConditional : public Conditional,
       : Conditional(start, end, std::move(condition), std::move(then_branch)) {}
 
   ENABLE_VISITORS(WhileConditional)
+
+  ENABLE_NODE_TAG(WhileConditional)
 };
 
 /**
@@ -158,6 +166,8 @@ struct ForConditional : public Conditional,
         initializer(std::move(initializer)), increment(std::move(increment)) {}
 
   ENABLE_VISITORS(ForConditional)
+
+  ENABLE_NODE_TAG(ForConditional)
 };
 
 } // namespace ml::ast
\ No newline at end of file
@@ -52,6 +52,8 @@ struct Declaration : public Statement, public basic::Visitable<Declaration> {
         type(std::move(type)), modifier(std::move(modifier)) {}
 
   ENABLE_VISITORS(Declaration)
+
+  ENABLE_NODE_TAG(Declaration)
 };
 
 /**
@@ -79,6 +81,8 @@ struct VariableDeclaration : public Declaration,
         initializer(std::move(initializer)) {}
 
   ENABLE_VISITORS(VariableDeclaration)
+
+  ENABLE_NODE_TAG(VariableDeclaration)
 };
 
 /**
@@ -112,6 +116,8 @@ struct FunctionDeclaration : public Declaration,
         parameters(std::move(parameters)), body(std::move(body)) {}
 
   ENABLE_VISITORS(FunctionDeclaration)
+
+  ENABLE_NODE_TAG(FunctionDeclaration)
 };
 
 /**
@@ -145,6 +151,8 @@ struct ClassDeclaration : public Declaration,
         fields(std::move(fields)), methods(std::move(methods)) {}
 
   ENABLE_VISITORS(ClassDeclaration)
+
+  ENABLE_NODE_TAG(ClassDeclaration)
 };
 
 /**
@@ -171,6 +179,8 @@ struct RecordDeclaration : public Declaration,
         fields(std::move(fields)) {}
 
   ENABLE_VISITORS(RecordDeclaration)
+
+  ENABLE_NODE_TAG(RecordDeclaration)
 };
 
 } // namespace ml::ast
\ No newline at end of file
@@ -9,6 +9,7 @@
 
 #include "ml/basic/accessor.h"
 #include "ml/basic/modifier.h"
+#include "ml/basic/number.h"
 #include "node.h"
 #include <memory>
 #include <vector>
@@ -27,6 +28,8 @@ struct Expression : public Node, public basic::Visitable<Expression> {
 
   ENABLE_VISITORS(Expression)
 
+  ENABLE_NODE_TAG(Expression)
+
   virtual ~Expression() = default;
 };
 
@@ -63,6 +66,8 @@ struct BinaryExpression : public Expression,
         right(std::move(right)) {}
 
   ENABLE_VISITORS(BinaryExpression)
+
+  ENABLE_NODE_TAG(BinaryExpression)
 };
 
 /**
@@ -90,6 +95,8 @@ struct UnaryExpression : public Expression,
       : Expression(start, end), op(op), operand(std::move(operand)) {}
 
   ENABLE_VISITORS(UnaryExpression)
+
+  ENABLE_NODE_TAG(UnaryExpression)
 };
 
 /**
@@ -106,11 +113,25 @@ struct LiteralExpression : public Expression,
    */
   std::string value;
 
+  /**
+   * @var number
+   * @brief The value of a numeric literal; its kind is None otherwise.
+   */
+  basic::Number number;
+
   LiteralExpression(const basic::Locus start, const basic::Locus end,
                     std::string value)
-      : Expression(start, end), value(value) {}
+      : Expression(start, end), value(value) {
+    basic::parseNumber(this->value, this->number);
+  }
+
+  LiteralExpression(const basic::Locus start, const basic::Locus end,
+                    std::string value, const basic::Number &number)
+      : Expression(start, end), value(value), number(number) {}
 
   ENABLE_VISITORS(LiteralExpression)
+
+  ENABLE_NODE_TAG(LiteralExpression)
 };
 
 /**
@@ -132,6 +153,8 @@ struct IdentifierExpression : public Expression,
       : Expression(start, end), name(name) {}
 
   ENABLE_VISITORS(IdentifierExpression)
+
+  ENABLE_NODE_TAG(IdentifierExpression)
 };
 
 /**
@@ -155,6 +178,8 @@ struct ArrayIdentifierExpression
       : IdentifierExpression(start, end, name), size(std::move(size)) {}
 
   ENABLE_VISITORS(ArrayIdentifierExpression)
+
+  ENABLE_NODE_TAG(ArrayIdentifierExpression)
 };
 
 /**
@@ -184,6 +209,8 @@ struct IndexExpression : public Expression,
         index(std::move(index)) {}
 
   ENABLE_VISITORS(IndexExpression)
+
+  ENABLE_NODE_TAG(IndexExpression)
 };
 
 /**
@@ -214,6 +241,8 @@ struct CallExpression : public Expression,
         arguments(std::move(arguments)) {}
 
   ENABLE_VISITORS(CallExpression)
+
+  ENABLE_NODE_TAG(CallExpression)
 };
 
 /**
@@ -244,6 +273,8 @@ struct AttributeExpression : public Expression,
         attribute(std::move(attribute)) {}
 
   ENABLE_VISITORS(AttributeExpression)
+
+  ENABLE_NODE_TAG(AttributeExpression)
 };
 
 /**
@@ -265,6 +296,57 @@ struct ArrayExpression : public Expression,
       : Expression(start, end), elements(std::move(elements)) {}
 
   ENABLE_VISITORS(ArrayExpression)
+
+  ENABLE_NODE_TAG(ArrayExpression)
+};
+
+/**
+ * @struct SpawnExpression expr.h
+ * @brief Represents the start of a lightweight task in the AST.
+ * @details Inherits from Expression and contains the call the task runs. The
+ * expression evaluates to a handle of the task, which await consumes.
+ */
+struct SpawnExpression : public Expression,
+                         public basic::Visitable<SpawnExpression> {
+
+  /**
+   * @var call
+   * @brief The call the task runs, a CallExpression.
+   */
+  std::unique_ptr<Expression> call;
+
+  SpawnExpression(const basic::Locus start, const basic::Locus end,
+                  std::unique_ptr<Expression> call)
+      : Expression(start, end), call(std::move(call)) {}
+
+  ENABLE_VISITORS(SpawnExpression)
+
+  ENABLE_NODE_TAG(SpawnExpression)
+};
+
+/**
+ * @struct AwaitExpression expr.h
+ * @brief Represents waiting for a task in the AST.
+ * @details Inherits from Expression and contains the task expression. The
+ * expression suspends the current task until the awaited one finishes and
+ * evaluates to its result.
+ */
+struct AwaitExpression : public Expression,
+                         public basic::Visitable<AwaitExpression> {
+
+  /**
+   * @var task
+   * @brief The expression giving the task to wait for.
+   */
+  std::unique_ptr<Expression> task;
+
+  AwaitExpression(const basic::Locus start, const basic::Locus end,
+                  std::unique_ptr<Expression> task)
+      : Expression(start, end), task(std::move(task)) {}
+
+  ENABLE_VISITORS(AwaitExpression)
+
+  ENABLE_NODE_TAG(AwaitExpression)
 };
 
 } // namespace ml::ast
\ No newline at end of file
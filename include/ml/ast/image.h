@@ -0,0 +1,184 @@
+/**
+ * @file image.h
+ * @brief Flat, memory-mappable images of Abstract Syntax Trees (AST).
+ * @details Defines a versioned, position-independent file format holding a
+ * parsed program: a node table in pre-order, the child slots of every node,
+ * an interned string table for names, operators and literal constants, a
+ * function table and the source location of every node. An image is read
+ * straight from a memory mapping; nodes are visited in place, and a pointer
+ * tree is only built when a pass asks for one.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "ml/basic/mapped_file.h"
+#include "stmt.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ml::ast {
+
+/**
+ * @brief Version of the image format, bumped whenever its layout changes.
+ */
+constexpr uint32_t IMAGE_VERSION = 2;
+
+/**
+ * @brief Marks an absent node or string.
+ */
+constexpr uint32_t IMAGE_NONE = UINT32_MAX;
+
+/**
+ * @brief Marks a slot holding the length of the list that follows it.
+ */
+constexpr uint32_t IMAGE_LIST = 0x80000000u;
+
+/**
+ * @struct ImageNode image.h
+ * @brief One node of an image, as stored in the file.
+ * @details Nodes are numbered in pre-order, so the children of a node always
+ * have larger numbers than the node itself. The slots of a node follow a
+ * fixed layout per tag, the same order forEachChild() uses: a slot holds a
+ * node number or IMAGE_NONE, and a list is a slot of IMAGE_LIST | length
+ * followed by its elements.
+ */
+struct ImageNode {
+  uint16_t tag;          // The NodeTag of the node
+  uint8_t accessor;      // The accessor of a ModifierStatement
+  uint8_t modifier;      // The modifier flags of a ModifierStatement
+  uint32_t text;         // Name, operator or literal value, or IMAGE_NONE
+  uint32_t first_slot;   // First child slot
+  uint32_t slot_count;   // Number of child slots
+  uint32_t start_line;   // Line of the first character
+  uint32_t start_column; // Column of the first character
+  uint32_t start_index;  // Byte offset of the first character
+  uint32_t end_line;     // Line of the last character
+  uint32_t end_column;   // Column of the last character
+  uint32_t end_index;    // Byte offset of the last character
+
+  NodeTag nodeTag() const { return static_cast<NodeTag>(this->tag); }
+  basic::Locus start() const {
+    return basic::Locus(this->start_line, this->start_column,
+                        this->start_index);
+  }
+  basic::Locus end() const {
+    return basic::Locus(this->end_line, this->end_column, this->end_index);
+  }
+};
+
+static_assert(sizeof(ImageNode) == 40, "ImageNode must stay packed");
+
+/**
+ * @brief Serializes a program into an image.
+ * @param program The program.
+ * @param source_hash The hash of the source the program was parsed from.
+ * @return The bytes of the image.
+ */
+std::string buildImage(const Program &program, uint64_t source_hash);
+
+/**
+ * @brief Writes the image of a program to a file.
+ * @param file_path The path of the image; missing directories are created.
+ * @param program The program.
+ * @param source_hash The hash of the source the program was parsed from.
+ * @return True if the image was written, false otherwise.
+ * @details The image is written to a temporary file that is then renamed,
+ * so readers never map a half-written image.
+ */
+bool writeImage(const std::string &file_path, const Program &program,
+                uint64_t source_hash);
+
+/**
+ * @class AstImage image.h
+ * @brief Read-only view of a memory-mapped image.
+ * @details Opening an image checks its header and that every reference in
+ * it stays inside the file, without copying anything. Node numbers are
+ * pre-order positions; node 0 is the Program.
+ */
+class AstImage {
+private:
+  basic::MappedFile file_;              // The mapped image
+  const ImageNode *nodes_ = nullptr;    // The node table
+  const uint32_t *slots_ = nullptr;     // The child slots
+  const uint32_t *strings_ = nullptr;   // Offset and length of each string
+  const uint32_t *functions_ = nullptr; // Name and node of each function
+  const char *blob_ = nullptr;          // The characters of the strings
+  uint64_t source_hash_ = 0;            // Hash of the source
+  uint32_t node_count_ = 0;             // Number of nodes
+  uint32_t function_count_ = 0;         // Number of top-level functions
+
+  /**
+   * @brief Checks the image and caches its section pointers.
+   * @return True if the image is well formed.
+   */
+  bool validate();
+
+public:
+  /**
+   * @brief Maps an image.
+   * @param file_path The path of the image.
+   * @return True if the file is a well-formed image of this version.
+   */
+  bool open(const std::string &file_path);
+
+  /**
+   * @brief Gets the hash of the source the image was built from.
+   * @return The hash; an image is stale when it differs from the source's.
+   */
+  uint64_t sourceHash() const { return this->source_hash_; }
+
+  /**
+   * @brief Gets the number of nodes.
+   * @return The node count, 0 if no image is open.
+   */
+  size_t nodeCount() const { return this->node_count_; }
+
+  /**
+   * @brief Gets a node.
+   * @param id The node number, below nodeCount().
+   * @return The node, inside the mapping.
+   */
+  const ImageNode &node(uint32_t id) const { return this->nodes_[id]; }
+
+  /**
+   * @brief Gets the text of a node.
+   * @param id The node number.
+   * @return The name, operator or literal value, empty if it has none.
+   */
+  std::string_view text(uint32_t id) const;
+
+  /**
+   * @brief Calls a function on each child of a node, in source order.
+   * @param id The node number.
+   * @param f The function, taking the child's node number.
+   */
+  template <typename F> void forEachChild(uint32_t id, F &&f) const {
+    const ImageNode &node = this->nodes_[id];
+    for (uint32_t i = 0; i < node.slot_count; i++) {
+      uint32_t slot = this->slots_[node.first_slot + i];
+      if (slot != IMAGE_NONE && (slot & IMAGE_LIST) == 0) {
+        f(slot);
+      }
+    }
+  }
+
+  /**
+   * @brief Finds the top-level functions with a name.
+   * @param name The function name.
+   * @return The node numbers of its overloads, in source order.
+   */
+  std::vector<uint32_t> functions(std::string_view name) const;
+
+  /**
+   * @brief Rebuilds the pointer tree of the image.
+   * @return The program, or nullptr if the slots do not match the layout of
+   * their tags.
+   */
+  std::unique_ptr<Program> materialize() const;
+};
+
+} // namespace ml::ast
@@ -9,12 +9,14 @@
 
 #include "ml/basic/locus.h"
 #include "ml/basic/visitor.h"
+#include <cstddef>
 #include <iostream>
 #include <string>
 
 namespace ml::ast {
 
 enum class NodeKind;
+enum class NodeTag;
 struct Node;
 
 enum class NodeKind {
@@ -25,6 +27,137 @@ enum class NodeKind {
   Conditional,
 };
 
+/**
+ * @enum NodeTag node.h
+ * @brief Enumeration of the concrete AST node types.
+ * @details Unlike NodeKind, which only groups nodes into categories, the tag
+ * identifies the exact node struct, so code can dispatch with a switch and a
+ * static_cast instead of a chain of dynamic_casts.
+ */
+enum class NodeTag {
+  Node,
+  Program,
+  Expression,
+  BinaryExpression,
+  UnaryExpression,
+  LiteralExpression,
+  IdentifierExpression,
+  ArrayIdentifierExpression,
+  IndexExpression,
+  ArrayExpression,
+  CallExpression,
+  AttributeExpression,
+  SpawnExpression,
+  AwaitExpression,
+  Statement,
+  ReturnStatement,
+  BreakStatement,
+  ContinueStatement,
+  ExpressionStatement,
+  BlockStatement,
+  ModifierStatement,
+  Declaration,
+  VariableDeclaration,
+  FunctionDeclaration,
+  RecordDeclaration,
+  ClassDeclaration,
+  Conditional,
+  IfConditional,
+  SwitchConditional,
+  WhileConditional,
+  ForConditional,
+};
+
+/**
+ * @brief The number of values in NodeTag.
+ */
+constexpr size_t NODE_TAG_COUNT =
+    static_cast<size_t>(NodeTag::ForConditional) + 1;
+
+/**
+ * @brief Converts a NodeTag to its string representation.
+ * @param tag The NodeTag to convert.
+ * @return The name of the node struct.
+ */
+inline std::string nodeTagName(const NodeTag tag) {
+  switch (tag) {
+  case NodeTag::Node:
+    return "Node";
+  case NodeTag::Program:
+    return "Program";
+  case NodeTag::Expression:
+    return "Expression";
+  case NodeTag::BinaryExpression:
+    return "BinaryExpression";
+  case NodeTag::UnaryExpression:
+    return "UnaryExpression";
+  case NodeTag::LiteralExpression:
+    return "LiteralExpression";
+  case NodeTag::IdentifierExpression:
+    return "IdentifierExpression";
+  case NodeTag::ArrayIdentifierExpression:
+    return "ArrayIdentifierExpression";
+  case NodeTag::IndexExpression:
+    return "IndexExpression";
+  case NodeTag::ArrayExpression:
+    return "ArrayExpression";
+  case NodeTag::CallExpression:
+    return "CallExpression";
+  case NodeTag::AttributeExpression:
+    return "AttributeExpression";
+  case NodeTag::SpawnExpression:
+    return "SpawnExpression";
+  case NodeTag::AwaitExpression:
+    return "AwaitExpression";
+  case NodeTag::Statement:
+    return "Statement";
+  case NodeTag::ReturnStatement:
+    return "ReturnStatement";
+  case NodeTag::BreakStatement:
+    return "BreakStatement";
+  case NodeTag::ContinueStatement:
+    return "ContinueStatement";
+  case NodeTag::ExpressionStatement:
+    return "ExpressionStatement";
+  case NodeTag::BlockStatement:
+    return "BlockStatement";
+  case NodeTag::ModifierStatement:
+    return "ModifierStatement";
+  case NodeTag::Declaration:
+    return "Declaration";
+  case NodeTag::VariableDeclaration:
+    return "VariableDeclaration";
+  case NodeTag::FunctionDeclaration:
+    return "FunctionDeclaration";
+  case NodeTag::RecordDeclaration:
+    return "RecordDeclaration";
+  case NodeTag::ClassDeclaration:
+    return "ClassDeclaration";
+  case NodeTag::Conditional:
+    return "Conditional";
+  case NodeTag::IfConditional:
+    return "IfConditional";
+  case NodeTag::SwitchConditional:
+    return "SwitchConditional";
+  case NodeTag::WhileConditional:
+    return "WhileConditional";
+  case NodeTag::ForConditional:
+    return "ForConditional";
+  default:
+    return "Unknown";
+  }
+}
+
+/**
+ * @brief Macro to report the NodeTag of a node struct.
+ * @param ClassName The name of the node struct, which must match a NodeTag.
+ * @details Place it next to ENABLE_VISITORS in every node struct. Besides
+ * tag(), it defines the static TAG so templates can map a type to its tag.
+ */
+#define ENABLE_NODE_TAG(ClassName)                                             \
+  static constexpr NodeTag TAG = NodeTag::ClassName;                           \
+  NodeTag tag() const override { return TAG; }
+
 /**
  * @struct Node node.h
  * @brief Base class for all AST nodes.
@@ -46,6 +179,14 @@ struct Node : public basic::Visitable<Node> {
 
   ENABLE_VISITORS(Node)
 
+  /**
+   * @brief Gets the concrete type of the node.
+   * @return The NodeTag of the most derived node struct.
+   */
+  virtual NodeTag tag() const { return TAG; }
+
+  static constexpr NodeTag TAG = NodeTag::Node;
+
   virtual ~Node() = default;
 };
 
@@ -0,0 +1,90 @@
+/**
+ * @file node_index.h
+ * @brief Offset-to-node interval index for Abstract Syntax Trees (AST).
+ * @details Defines a flat index over node spans that answers "which node is
+ * at this byte offset" without walking the tree.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "node.h"
+#include <cstdint>
+#include <vector>
+
+namespace ml::ast {
+
+/**
+ * @class NodeIndex node_index.h
+ * @brief Sorted interval index over the spans of an AST.
+ * @details Spans are the half-open byte ranges [start.index, end.index) of
+ * every node with a real location. They are stored sorted by start (outer
+ * spans first on ties) together with their containment parent and a binary
+ * lifting table, so an innermost-node query is one binary search followed by
+ * at most log(depth) ancestor jumps.
+ */
+class NodeIndex {
+private:
+  /**
+   * @struct Span node_index.h
+   * @brief One indexed node.
+   */
+  struct Span {
+    uint64_t start;   // First byte of the node
+    uint64_t end;     // One past the last byte of the node
+    const Node *node; // The indexed node
+  };
+
+  std::vector<Span> spans_;                      // Spans sorted by start
+  std::vector<std::vector<uint32_t>> ancestors_; // 2^k-th parent per level
+
+  static constexpr uint32_t NONE = UINT32_MAX; // No parent
+
+public:
+  NodeIndex() = default;
+
+  /**
+   * @brief Builds the index of a tree.
+   * @param root The root of the tree, usually a Program.
+   */
+  explicit NodeIndex(const Node &root) { this->build(root); }
+
+  /**
+   * @brief Rebuilds the index of a tree.
+   * @param root The root of the tree, usually a Program.
+   * @details Nodes without a location (line 0) and empty spans are skipped.
+   * A child span that overhangs its parent is clipped to the parent so the
+   * spans stay properly nested.
+   */
+  void build(const Node &root);
+
+  /**
+   * @brief Finds the innermost node containing a byte offset.
+   * @param offset The 0-based byte offset.
+   * @return The innermost node, or nullptr if no node contains the offset.
+   */
+  const Node *at(uint64_t offset) const;
+
+  /**
+   * @brief Finds every node containing a byte offset, innermost first.
+   * @param offset The 0-based byte offset.
+   * @return The containing nodes, innermost first.
+   */
+  std::vector<const Node *> path(uint64_t offset) const;
+
+  /**
+   * @brief Gets the number of indexed nodes.
+   * @return The span count.
+   */
+  size_t size() const { return this->spans_.size(); }
+
+private:
+  /**
+   * @brief Finds the position of the innermost span containing an offset.
+   * @param offset The 0-based byte offset.
+   * @return The span position, or NONE.
+   */
+  uint32_t innermost(uint64_t offset) const;
+};
+
+} // namespace ml::ast
@@ -29,6 +29,8 @@ struct NodePrinter : public basic::Visitor,
                      public basic::Visiting<ArrayExpression>,
                      public basic::Visiting<CallExpression>,
                      public basic::Visiting<AttributeExpression>,
+                     public basic::Visiting<SpawnExpression>,
+                     public basic::Visiting<AwaitExpression>,
                      public basic::Visiting<Statement>,
                      public basic::Visiting<ReturnStatement>,
                      public basic::Visiting<BreakStatement>,
@@ -87,6 +89,8 @@ public:
   void visit(ArrayExpression &v) override;
   void visit(CallExpression &v) override;
   void visit(AttributeExpression &v) override;
+  void visit(SpawnExpression &v) override;
+  void visit(AwaitExpression &v) override;
 
   void visit(Statement &v) override;
   void visit(ReturnStatement &v) override;
@@ -0,0 +1,37 @@
+/**
+ * @file query.h
+ * @brief Queries on Abstract Syntax Tree (AST) nodes.
+ * @details Defines small questions about nodes that analyses and optimization
+ * passes both ask, so they answer them the same way.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "expr.h"
+#include "node.h"
+#include "stmt.h"
+#include <string>
+
+namespace ml::ast {
+
+/**
+ * @brief Gets the name of a plain identifier.
+ * @param node The node, which may be null.
+ * @return The name, or nullptr if the node is not an IdentifierExpression.
+ */
+const std::string *identifierName(const Node *node);
+
+/**
+ * @brief Checks whether control never falls through a statement.
+ * @param statement The statement, which may be null.
+ * @return True for return, break and continue; for a block with such a
+ * statement; for an 'if' with an 'else' whose branches all terminate; for a
+ * 'switch' with a default whose branches all terminate without a break; and
+ * for a 'while (true)' without a break. False whenever unsure.
+ * @details Code after a terminating statement is unreachable, and a function
+ * whose body terminates cannot end without a return.
+ */
+bool terminates(const Statement *statement);
+
+} // namespace ml::ast
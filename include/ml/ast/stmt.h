@@ -26,6 +26,8 @@ struct Statement : public Node, public basic::Visitable<Statement> {
 
   ENABLE_VISITORS(Statement)
 
+  ENABLE_NODE_TAG(Statement)
+
   virtual ~Statement() = default;
 };
 
@@ -49,6 +51,8 @@ struct ReturnStatement : public Statement,
       : Statement(start, end), expression(std::move(expression)) {}
 
   ENABLE_VISITORS(ReturnStatement)
+
+  ENABLE_NODE_TAG(ReturnStatement)
 };
 
 /**
@@ -62,6 +66,8 @@ struct BreakStatement : public Statement,
       : Statement(start, end) {}
 
   ENABLE_VISITORS(BreakStatement)
+
+  ENABLE_NODE_TAG(BreakStatement)
 };
 
 /**
@@ -75,6 +81,8 @@ struct ContinueStatement : public Statement,
       : Statement(start, end) {}
 
   ENABLE_VISITORS(ContinueStatement)
+
+  ENABLE_NODE_TAG(ContinueStatement)
 };
 
 /**
@@ -96,6 +104,8 @@ struct ExpressionStatement : public Statement,
       : Statement(start, end), expression(std::move(expression)) {}
 
   ENABLE_VISITORS(ExpressionStatement)
+
+  ENABLE_NODE_TAG(ExpressionStatement)
 };
 
 /**
@@ -117,6 +127,8 @@ struct BlockStatement : public Statement,
       : Statement(start, end), statements(std::move(statements)) {}
 
   ENABLE_VISITORS(BlockStatement)
+
+  ENABLE_NODE_TAG(BlockStatement)
 };
 
 /**
@@ -149,6 +161,8 @@ struct ModifierStatement : public Statement,
       : Statement(start, end), accessor(accessor), modifier(modifier) {}
 
   ENABLE_VISITORS(ModifierStatement)
+
+  ENABLE_NODE_TAG(ModifierStatement)
 };
 
 /**
@@ -169,6 +183,8 @@ struct Program : public Node, public basic::Visitable<Program> {
       : Node(start, end), statements(std::move(statements)) {}
 
   ENABLE_VISITORS(Program)
+
+  ENABLE_NODE_TAG(Program)
 };
 
 } // namespace ml::ast
\ No newline at end of file
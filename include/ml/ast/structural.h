@@ -0,0 +1,163 @@
+/**
+ * @file structural.h
+ * @brief Structural hashing and equality of Abstract Syntax Tree (AST)
+ * subtrees.
+ * @details Defines location-independent hashes and equality for subtrees, and
+ * a hash-consing table that maps identical subtrees to one canonical node.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "node.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ml::ast {
+
+/**
+ * @brief Hashes the content of a node, ignoring its children and location.
+ * @param node The node to hash.
+ * @return A hash of the tag, the operator, literal or name, the modifiers
+ * and which child slots are filled.
+ */
+uint64_t localHash(const Node &node);
+
+/**
+ * @brief Compares the content of two nodes, ignoring children and location.
+ * @param a The first node.
+ * @param b The second node.
+ * @return True if both nodes would have the same localHash() by content.
+ */
+bool localEqual(const Node &a, const Node &b);
+
+/**
+ * @brief Compares two subtrees structurally.
+ * @param a The root of the first subtree.
+ * @param b The root of the second subtree.
+ * @return True if the subtrees only differ in source locations.
+ * @details The comparison is iterative and stops at the first difference.
+ */
+bool structurallyEqual(const Node &a, const Node &b);
+
+/**
+ * @brief Checks whether evaluating a subtree cannot change any state.
+ * @param node The root of the subtree.
+ * @return True for expressions built from literals, identifiers and
+ * operators; false if the subtree contains a call, an assignment, an
+ * increment or decrement, or a statement.
+ */
+bool isSideEffectFree(const Node &node);
+
+/**
+ * @class StructuralHashes structural.h
+ * @brief The structural hash of every node of a tree.
+ * @details Hashes are computed bottom-up in one post-order pass: a node's
+ * hash combines its localHash() with the hashes of its children, in order.
+ */
+class StructuralHashes {
+private:
+  std::unordered_map<const Node *, uint64_t> hashes_; // Hash of each node
+
+public:
+  StructuralHashes() = default;
+
+  /**
+   * @brief Hashes every node of a tree.
+   * @param root The root of the tree.
+   */
+  explicit StructuralHashes(const Node &root) { this->add(root); }
+
+  /**
+   * @brief Hashes every node of another tree.
+   * @param root The root of the tree.
+   * @return The hash of the root.
+   */
+  uint64_t add(const Node &root);
+
+  /**
+   * @brief Gets the hash of a hashed node.
+   * @param node The node, which must be part of an added tree.
+   * @return The structural hash of the node.
+   */
+  uint64_t of(const Node &node) const { return this->hashes_.at(&node); }
+
+  /**
+   * @brief Gets the number of hashed nodes.
+   * @return The node count.
+   */
+  size_t size() const { return this->hashes_.size(); }
+};
+
+/**
+ * @brief Computes the structural hash of a single subtree.
+ * @param node The root of the subtree.
+ * @return The structural hash of the root.
+ */
+uint64_t structuralHash(const Node &node);
+
+/**
+ * @class HashConsTable structural.h
+ * @brief Maps structurally identical subtrees to one canonical node.
+ * @details The AST owns its children through unique_ptr, so identical
+ * subtrees cannot share storage. Instead every interned node is mapped to
+ * the first structurally equal node seen, which callers can use as the
+ * identity of the subtree for caching, common subexpression elimination or
+ * duplicate detection. Buckets are keyed by structural hash and confirmed
+ * with structurallyEqual(), so hash collisions never merge different trees.
+ */
+class HashConsTable {
+private:
+  using Bucket = std::vector<const Node *>;
+  using CanonicalMap = std::unordered_map<const Node *, const Node *>;
+
+  bool immutable_only_;                          // Only intern pure expressions
+  StructuralHashes hashes_;                      // Hashes of the added trees
+  std::unordered_map<uint64_t, Bucket> buckets_; // Canonical nodes by hash
+  CanonicalMap canonical_;                       // Canonical node of each node
+  size_t duplicates_ = 0;                        // Nodes mapped to another node
+
+public:
+  /**
+   * @brief Creates an empty table.
+   * @param immutable_only If true, only side-effect-free expressions are
+   * interned; otherwise every subtree is, including statements.
+   */
+  explicit HashConsTable(bool immutable_only = true)
+      : immutable_only_(immutable_only) {}
+
+  /**
+   * @brief Interns every eligible subtree of a tree.
+   * @param root The root of the tree, which must outlive the table.
+   */
+  void add(const Node &root);
+
+  /**
+   * @brief Gets the canonical node of a subtree.
+   * @param node The root of the subtree.
+   * @return The first structurally equal node added, the node itself if it
+   * is the first, or nullptr if the node was not interned.
+   */
+  const Node *canonical(const Node &node) const;
+
+  /**
+   * @brief Gets the structural hashes of the added trees.
+   * @return The hash table.
+   */
+  const StructuralHashes &hashes() const { return this->hashes_; }
+
+  /**
+   * @brief Gets the number of distinct interned subtrees.
+   * @return The canonical node count.
+   */
+  size_t uniqueCount() const;
+
+  /**
+   * @brief Gets the number of interned nodes that had an earlier twin.
+   * @return The duplicate count.
+   */
+  size_t duplicateCount() const { return this->duplicates_; }
+};
+
+} // namespace ml::ast
@@ -0,0 +1,394 @@
+/**
+ * @file walk.h
+ * @brief Generic Abstract Syntax Tree (AST) traversal helpers.
+ * @details Defines tag-based child enumeration, non-recursive pre-order and
+ * post-order iterators, and a pre-order walk. None of them need a visitor per
+ * traversal.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "cond.h"
+#include "decl.h"
+#include "expr.h"
+#include "ml/basic/small_vector.h"
+#include "node.h"
+#include "stmt.h"
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+
+namespace ml::ast {
+
+/**
+ * @brief Applies the constness of From to To.
+ */
+template <typename To, typename From>
+using like_t = std::conditional_t<std::is_const_v<From>, const To, To>;
+
+/**
+ * @brief Calls a function for every child field of a node, in source order.
+ * @tparam NodeT Node or const Node.
+ * @param node The node whose fields to enumerate.
+ * @param one The function to call with each single-child field, a
+ * std::unique_ptr of the field's declared type, even when it is null.
+ * @param many The function to call with each list of children, a
+ * std::vector of such pointers.
+ * @details This is the one table of which fields hold children. Everything
+ * that enumerates children, from forEachChild to the passes that hash,
+ * match or rewrite them, derives from it, so a new field only needs adding
+ * here. Fields keep their declared types, so callers can tell expression
+ * slots from blocks or declarations.
+ */
+template <typename NodeT, typename One, typename Many>
+void forEachSlot(NodeT &node, One &&one, Many &&many) {
+  static_assert(std::is_same_v<std::remove_const_t<NodeT>, Node>,
+                "forEachSlot expects a Node");
+
+  auto declaration = [&one](auto &v) {
+    one(v.modifier);
+    one(v.identifier);
+    one(v.type);
+  };
+
+  switch (node.tag()) {
+  case NodeTag::Program:
+    many(static_cast<like_t<Program, NodeT> &>(node).statements);
+    break;
+  case NodeTag::BinaryExpression: {
+    auto &v = static_cast<like_t<BinaryExpression, NodeT> &>(node);
+    one(v.left);
+    one(v.right);
+    break;
+  }
+  case NodeTag::UnaryExpression:
+    one(static_cast<like_t<UnaryExpression, NodeT> &>(node).operand);
+    break;
+  case NodeTag::ArrayIdentifierExpression:
+    one(static_cast<like_t<ArrayIdentifierExpression, NodeT> &>(node).size);
+    break;
+  case NodeTag::IndexExpression: {
+    auto &v = static_cast<like_t<IndexExpression, NodeT> &>(node);
+    one(v.array);
+    one(v.index);
+    break;
+  }
+  case NodeTag::ArrayExpression:
+    many(static_cast<like_t<ArrayExpression, NodeT> &>(node).elements);
+    break;
+  case NodeTag::CallExpression: {
+    auto &v = static_cast<like_t<CallExpression, NodeT> &>(node);
+    one(v.callee);
+    many(v.arguments);
+    break;
+  }
+  case NodeTag::AttributeExpression: {
+    auto &v = static_cast<like_t<AttributeExpression, NodeT> &>(node);
+    one(v.object);
+    one(v.attribute);
+    break;
+  }
+  case NodeTag::SpawnExpression:
+    one(static_cast<like_t<SpawnExpression, NodeT> &>(node).call);
+    break;
+  case NodeTag::AwaitExpression:
+    one(static_cast<like_t<AwaitExpression, NodeT> &>(node).task);
+    break;
+  case NodeTag::ReturnStatement:
+    one(static_cast<like_t<ReturnStatement, NodeT> &>(node).expression);
+    break;
+  case NodeTag::ExpressionStatement:
+    one(static_cast<like_t<ExpressionStatement, NodeT> &>(node).expression);
+    break;
+  case NodeTag::BlockStatement:
+    many(static_cast<like_t<BlockStatement, NodeT> &>(node).statements);
+    break;
+  case NodeTag::Declaration:
+    declaration(static_cast<like_t<Declaration, NodeT> &>(node));
+    break;
+  case NodeTag::VariableDeclaration: {
+    auto &v = static_cast<like_t<VariableDeclaration, NodeT> &>(node);
+    declaration(v);
+    one(v.initializer);
+    break;
+  }
+  case NodeTag::FunctionDeclaration: {
+    auto &v = static_cast<like_t<FunctionDeclaration, NodeT> &>(node);
+    one(v.modifier);
+    one(v.identifier);
+    many(v.parameters);
+    one(v.type);
+    one(v.body);
+    break;
+  }
+  case NodeTag::RecordDeclaration: {
+    auto &v = static_cast<like_t<RecordDeclaration, NodeT> &>(node);
+    declaration(v);
+    many(v.fields);
+    break;
+  }
+  case NodeTag::ClassDeclaration: {
+    auto &v = static_cast<like_t<ClassDeclaration, NodeT> &>(node);
+    declaration(v);
+    many(v.fields);
+    many(v.methods);
+    break;
+  }
+  case NodeTag::Conditional:
+  case NodeTag::WhileConditional: {
+    auto &v = static_cast<like_t<Conditional, NodeT> &>(node);
+    one(v.condition);
+    one(v.then_branch);
+    break;
+  }
+  case NodeTag::IfConditional: {
+    auto &v = static_cast<like_t<IfConditional, NodeT> &>(node);
+    one(v.condition);
+    one(v.then_branch);
+    many(v.elif_branches);
+    one(v.else_branch);
+    break;
+  }
+  case NodeTag::SwitchConditional: {
+    auto &v = static_cast<like_t<SwitchConditional, NodeT> &>(node);
+    one(v.switch_expression);
+    many(v.case_branches);
+    break;
+  }
+  case NodeTag::ForConditional: {
+    auto &v = static_cast<like_t<ForConditional, NodeT> &>(node);
+    one(v.initializer);
+    one(v.condition);
+    one(v.increment);
+    one(v.then_branch);
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief Calls a function for every direct child of a node, in source order.
+ * @tparam NodeT Node or const Node.
+ * @param node The node whose children to enumerate.
+ * @param f The function to call with each child (as NodeT &).
+ * @details Missing optional children are skipped.
+ */
+template <typename NodeT, typename F> void forEachChild(NodeT &node, F &&f) {
+  auto visit = [&f](auto &child) {
+    if (child) {
+      f(static_cast<like_t<Node, NodeT> &>(*child));
+    }
+  };
+  forEachSlot(node, visit, [&visit](auto &children) {
+    for (auto &child : children) {
+      visit(child);
+    }
+  });
+}
+
+/**
+ * @brief Number of pending nodes an iterator holds before allocating.
+ * @details Advancing from a node pushes all of its children, so this bounds
+ * how wide the tree is rather than how deep: any block or program with more
+ * statements than this allocates.
+ */
+constexpr size_t ITERATOR_INLINE_DEPTH = 32;
+
+/**
+ * @class PreOrderIterator walk.h
+ * @brief Visits a node before its children, children in source order.
+ * @tparam NodeT Node or const Node.
+ * @details The stack holds the nodes still to visit; the top is the current
+ * node. Its children are only pushed when the iterator advances, which is
+ * what makes skipChildren() free.
+ */
+template <typename NodeT> class PreOrderIterator {
+private:
+  basic::SmallVector<NodeT *, ITERATOR_INLINE_DEPTH> stack_; // Pending nodes
+  bool skip_ = false; // Whether to skip the children of the current node
+
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = NodeT;
+  using difference_type = std::ptrdiff_t;
+  using pointer = NodeT *;
+  using reference = NodeT &;
+
+  PreOrderIterator() = default;
+
+  explicit PreOrderIterator(NodeT &root) { this->stack_.push_back(&root); }
+
+  reference operator*() const { return *this->stack_.back(); }
+  pointer operator->() const { return this->stack_.back(); }
+
+  PreOrderIterator &operator++() {
+    NodeT *current = this->stack_.back();
+    this->stack_.pop_back();
+    if (this->skip_) {
+      this->skip_ = false;
+      return *this;
+    }
+
+    // Push the children, then reverse them so the first child is on top.
+    size_t first = this->stack_.size();
+    forEachChild(*current,
+                 [this](NodeT &child) { this->stack_.push_back(&child); });
+    std::reverse(this->stack_.begin() + first, this->stack_.end());
+    return *this;
+  }
+
+  /**
+   * @brief Makes the next increment skip the children of the current node.
+   */
+  void skipChildren() { this->skip_ = true; }
+
+  /**
+   * @brief Gets the number of pending nodes, a bound on the memory used.
+   * @return The stack size.
+   */
+  size_t pending() const { return this->stack_.size(); }
+
+  bool operator==(const PreOrderIterator &other) const {
+    return this->stack_.empty() ? other.stack_.empty()
+                                : !other.stack_.empty() &&
+                                      this->stack_.back() ==
+                                          other.stack_.back();
+  }
+  bool operator!=(const PreOrderIterator &other) const {
+    return !(*this == other);
+  }
+};
+
+/**
+ * @class PostOrderIterator walk.h
+ * @brief Visits a node after all of its children, children in source order.
+ * @tparam NodeT Node or const Node.
+ * @details Each stack entry records whether its children were already
+ * pushed. Descending stops at the first entry without children, which is
+ * the current node.
+ */
+template <typename NodeT> class PostOrderIterator {
+private:
+  /**
+   * @struct Frame walk.h
+   * @brief One pending node.
+   */
+  struct Frame {
+    NodeT *node;   // The pending node
+    bool expanded; // Whether its children were pushed
+  };
+
+  basic::SmallVector<Frame, ITERATOR_INLINE_DEPTH> stack_; // Pending nodes
+
+  /**
+   * @brief Expands the top of the stack until it is a node whose children
+   * were all visited.
+   */
+  void descend() {
+    while (!this->stack_.empty() && !this->stack_.back().expanded) {
+      this->stack_.back().expanded = true;
+      NodeT *node = this->stack_.back().node;
+      size_t first = this->stack_.size();
+      forEachChild(*node, [this](NodeT &child) {
+        this->stack_.push_back({&child, false});
+      });
+      std::reverse(this->stack_.begin() + first, this->stack_.end());
+    }
+  }
+
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = NodeT;
+  using difference_type = std::ptrdiff_t;
+  using pointer = NodeT *;
+  using reference = NodeT &;
+
+  PostOrderIterator() = default;
+
+  explicit PostOrderIterator(NodeT &root) {
+    this->stack_.push_back({&root, false});
+    this->descend();
+  }
+
+  reference operator*() const { return *this->stack_.back().node; }
+  pointer operator->() const { return this->stack_.back().node; }
+
+  PostOrderIterator &operator++() {
+    this->stack_.pop_back();
+    this->descend();
+    return *this;
+  }
+
+  /**
+   * @brief Gets the number of pending nodes, a bound on the memory used.
+   * @return The stack size.
+   */
+  size_t pending() const { return this->stack_.size(); }
+
+  bool operator==(const PostOrderIterator &other) const {
+    return this->stack_.empty() ? other.stack_.empty()
+                                : !other.stack_.empty() &&
+                                      this->stack_.back().node ==
+                                          other.stack_.back().node;
+  }
+  bool operator!=(const PostOrderIterator &other) const {
+    return !(*this == other);
+  }
+};
+
+/**
+ * @class TraversalRange walk.h
+ * @brief A subtree viewed as a range for range-for loops.
+ * @tparam Iterator PreOrderIterator or PostOrderIterator.
+ */
+template <typename Iterator> class TraversalRange {
+private:
+  typename Iterator::pointer root_; // The root of the subtree
+
+public:
+  explicit TraversalRange(typename Iterator::reference root) : root_(&root) {}
+
+  Iterator begin() const { return Iterator(*this->root_); }
+  Iterator end() const { return Iterator(); }
+};
+
+/**
+ * @brief Iterates a subtree in pre-order.
+ * @param root The root of the subtree.
+ * @return A range over the nodes.
+ */
+template <typename NodeT> auto preOrder(NodeT &root) {
+  return TraversalRange<PreOrderIterator<like_t<Node, NodeT>>>(root);
+}
+
+/**
+ * @brief Iterates a subtree in post-order.
+ * @param root The root of the subtree.
+ * @return A range over the nodes.
+ */
+template <typename NodeT> auto postOrder(NodeT &root) {
+  return TraversalRange<PostOrderIterator<like_t<Node, NodeT>>>(root);
+}
+
+/**
+ * @brief Walks a subtree in pre-order.
+ * @tparam NodeT Node or const Node.
+ * @param node The root of the subtree.
+ * @param enter The function to call with each node (as NodeT &). It returns
+ * false to skip the children of that node.
+ * @details The walk is not recursive, so deep trees cannot overflow the
+ * stack.
+ */
+template <typename NodeT, typename F> void walk(NodeT &node, F &&enter) {
+  auto range = preOrder(node);
+  for (auto it = range.begin(), end = range.end(); it != end; ++it) {
+    if (!enter(*it)) {
+      it.skipChildren();
+    }
+  }
+}
+
+} // namespace ml::ast
@@ -0,0 +1,54 @@
+/**
+ * @file hash.h
+ * @brief Hashing utilities for My Language.
+ * @details Defines small, stable, non-cryptographic hash functions.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace ml::basic {
+
+/**
+ * @brief Offset basis of the 64-bit FNV-1a hash.
+ */
+constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+
+/**
+ * @brief Prime of the 64-bit FNV-1a hash.
+ */
+constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+/**
+ * @brief Hashes a sequence of bytes with 64-bit FNV-1a.
+ * @param data The bytes to hash.
+ * @param seed The initial hash value, used to chain several inputs.
+ * @return The 64-bit hash of the bytes.
+ * @note The result is stable across runs and platforms, so it may be
+ * persisted to disk.
+ */
+inline uint64_t fnv1a(std::string_view data, uint64_t seed = FNV_OFFSET) {
+  uint64_t hash = seed;
+  for (const char c : data) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+/**
+ * @brief Mixes a value into an existing hash.
+ * @param seed The hash to mix into.
+ * @param value The value to mix.
+ * @return The combined hash.
+ */
+inline uint64_t hashCombine(uint64_t seed, uint64_t value) {
+  value *= 0x9e3779b97f4a7c15ULL;
+  value ^= value >> 32;
+  return (seed ^ value) * FNV_PRIME;
+}
+
+} // namespace ml::basic
@@ -0,0 +1,72 @@
+/**
+ * @file mapped_file.h
+ * @brief Memory-mapped file definitions for My Language.
+ * @details Defines a read-only memory mapping of a whole file.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace ml::basic {
+
+/**
+ * @class MappedFile mapped_file.h
+ * @brief Read-only memory mapping of a whole file.
+ * @details The mapping is released when the object is destroyed. Empty files
+ * are opened successfully with a null data pointer.
+ */
+class MappedFile {
+private:
+  const char *data_ = nullptr; // Start of the mapping
+  size_t size_ = 0;            // Size of the mapping in bytes
+#ifdef _WIN32
+  void *file_ = nullptr;    // Handle of the open file
+  void *mapping_ = nullptr; // Handle of the file mapping
+#endif
+
+  /**
+   * @brief Releases the mapping, if any.
+   */
+  void close() noexcept;
+
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+  ~MappedFile() { this->close(); }
+
+  /**
+   * @brief Maps a file into memory, replacing any previous mapping.
+   * @param file_path The path of the file to map.
+   * @return True if the file was mapped, false otherwise.
+   */
+  bool open(const std::string &file_path);
+
+  /**
+   * @brief Gets the start of the mapping.
+   * @return A pointer to the first byte of the file.
+   */
+  const char *data() const { return this->data_; }
+
+  /**
+   * @brief Gets the size of the mapping.
+   * @return The size of the file in bytes.
+   */
+  size_t size() const { return this->size_; }
+
+  /**
+   * @brief Gets the content of the mapping.
+   * @return A view over the whole file.
+   */
+  std::string_view view() const {
+    return std::string_view(this->data_, this->size_);
+  }
+};
+
+} // namespace ml::basic
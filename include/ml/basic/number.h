@@ -0,0 +1,96 @@
+/**
+ * @file number.h
+ * @brief Numeric literal definitions for My Language.
+ * @details Defines the value of a numeric literal and the functions that
+ * scan and convert one. Literals may be decimal, hexadecimal (0x) or binary
+ * (0b), may separate digits with underscores, may carry a fraction and an
+ * exponent, and may end in a type suffix such as i64 or f32. Conversion
+ * uses std::from_chars, so each literal is converted exactly once, without
+ * locales or allocation.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace ml::basic {
+
+/**
+ * @enum NumberKind number.h
+ * @brief The kinds of numeric literals.
+ */
+enum class NumberKind : uint8_t {
+  None,    // Not a well-formed numeric literal
+  Integer, // An integer
+  Float,   // A floating-point number
+};
+
+/**
+ * @enum NumberSuffix number.h
+ * @brief The type suffix of a numeric literal.
+ */
+enum class NumberSuffix : uint8_t {
+  None,
+  I8,
+  I16,
+  I32,
+  I64,
+  U8,
+  U16,
+  U32,
+  U64,
+  F32,
+  F64,
+};
+
+/**
+ * @struct Number number.h
+ * @brief The value of a numeric literal.
+ */
+struct Number {
+  NumberKind kind = NumberKind::None;       // Integer or float
+  NumberSuffix suffix = NumberSuffix::None; // The type suffix, if any
+  uint64_t integer = 0;                     // Value of an integer
+  double real = 0.0;                        // Value of a float
+
+  bool operator==(const Number &other) const {
+    return this->kind == other.kind && this->suffix == other.suffix &&
+           this->integer == other.integer && this->real == other.real;
+  }
+  bool operator!=(const Number &other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Gets the spelling of a suffix.
+ * @param suffix The suffix.
+ * @return The spelling, such as "i64", or "" for None.
+ */
+std::string_view suffixName(NumberSuffix suffix);
+
+/**
+ * @brief Finds the end of the numeric literal starting at an offset.
+ * @param text The text.
+ * @param index The offset to start at.
+ * @return The offset just past the literal, or index itself if no literal
+ * starts there.
+ * @details A fraction needs a digit after the dot, so ranges such as 0..10
+ * stay intact, and only known suffixes are taken into the literal.
+ */
+size_t scanNumber(std::string_view text, size_t index);
+
+/**
+ * @brief Converts a numeric literal.
+ * @param literal The literal, as found by scanNumber().
+ * @param number Receives the value. Its kind is set whenever the literal
+ * is well formed, even if the value is out of range.
+ * @return True if the literal is well formed and its value fits its type:
+ * 64 bits without a suffix, and the suffix type otherwise. Signed types
+ * accept a magnitude one past their maximum, so the minimum value can be
+ * written by negating the literal.
+ */
+bool parseNumber(std::string_view literal, Number &number);
+
+} // namespace ml::basic
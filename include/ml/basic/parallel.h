@@ -0,0 +1,72 @@
+/**
+ * @file parallel.h
+ * @brief Parallel execution helpers for My Language.
+ * @details Defines helpers to spread independent work items over the shared
+ * thread pool.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <thread>
+
+namespace ml::basic {
+
+/**
+ * @brief Returns the default number of worker threads.
+ * @return The hardware concurrency, or 1 if it is unknown.
+ */
+inline unsigned defaultJobs() {
+  unsigned jobs = std::thread::hardware_concurrency();
+  return jobs == 0 ? 1 : jobs;
+}
+
+/**
+ * @brief Runs a function for every index in [0, count) on several threads.
+ * @param count The number of work items.
+ * @param jobs The maximum number of threads to use.
+ * @param body The function to run for each index.
+ * @details Work items are claimed dynamically, so uneven items balance out.
+ * The calling thread works alongside jobs - 1 tasks forked onto the shared
+ * pool, so no threads are started per call. With a single job the items run
+ * on the calling thread. An exception thrown by the body stops the loop and
+ * is rethrown here.
+ */
+inline void parallelFor(size_t count, unsigned jobs,
+                        const std::function<void(size_t)> &body) {
+  size_t workers = std::min<size_t>(std::max(jobs, 1u), count);
+  if (workers <= 1) {
+    for (size_t i = 0; i < count; i++) {
+      body(i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next{0};
+  TaskGroup group;
+  auto worker = [&]() {
+    for (size_t i = next++; i < count && !group.cancelled(); i = next++) {
+      body(i);
+    }
+  };
+
+  for (size_t i = 1; i < workers; i++) {
+    group.run(worker);
+  }
+  try {
+    worker();
+  } catch (...) {
+    // The group's destructor joins the forked tasks before this unwinds.
+    group.cancel();
+    throw;
+  }
+  group.wait();
+}
+
+} // namespace ml::basic
@@ -0,0 +1,110 @@
+/**
+ * @file small_vector.h
+ * @brief Small-buffer vector for My Language.
+ * @details Defines a vector that stores its first elements inline and only
+ * allocates once it outgrows them.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace ml::basic {
+
+/**
+ * @class SmallVector small_vector.h
+ * @brief A vector of trivially copyable values with N inline slots.
+ * @tparam T The element type, which must be trivially copyable.
+ * @tparam N The number of elements stored without allocating.
+ * @details Meant for short-lived work lists such as traversal stacks, where
+ * the common case fits inline and larger cases must still work.
+ */
+template <typename T, size_t N> class SmallVector {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "SmallVector only holds trivially copyable values");
+  static_assert(N > 0, "SmallVector needs at least one inline slot");
+
+private:
+  T inline_[N];               // Inline storage
+  std::unique_ptr<T[]> heap_; // Heap storage once the inline slots are full
+  T *data_ = inline_;         // Active storage
+  size_t size_ = 0;           // Number of elements
+  size_t capacity_ = N;       // Number of slots in the active storage
+
+  /**
+   * @brief Moves the elements to a larger heap buffer.
+   * @param capacity The new capacity, larger than the current one.
+   */
+  void grow(size_t capacity) {
+    auto heap = std::make_unique<T[]>(capacity);
+    std::memcpy(heap.get(), this->data_, this->size_ * sizeof(T));
+    this->heap_ = std::move(heap);
+    this->data_ = this->heap_.get();
+    this->capacity_ = capacity;
+  }
+
+public:
+  SmallVector() = default;
+
+  SmallVector(const SmallVector &other) { *this = other; }
+
+  SmallVector &operator=(const SmallVector &other) {
+    if (this != &other) {
+      this->size_ = 0;
+      if (other.size_ > this->capacity_) {
+        this->grow(other.size_);
+      }
+      std::memcpy(this->data_, other.data_, other.size_ * sizeof(T));
+      this->size_ = other.size_;
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Appends an element.
+   * @param value The element to append.
+   */
+  void push_back(const T &value) {
+    if (this->size_ == this->capacity_) {
+      this->grow(this->capacity_ * 2);
+    }
+    this->data_[this->size_++] = value;
+  }
+
+  /**
+   * @brief Removes the last element.
+   * @note The vector must not be empty.
+   */
+  void pop_back() { this->size_--; }
+
+  /**
+   * @brief Removes every element, keeping the storage.
+   */
+  void clear() { this->size_ = 0; }
+
+  T &back() { return this->data_[this->size_ - 1]; }
+  const T &back() const { return this->data_[this->size_ - 1]; }
+
+  T &operator[](size_t index) { return this->data_[index]; }
+  const T &operator[](size_t index) const { return this->data_[index]; }
+
+  T *begin() { return this->data_; }
+  T *end() { return this->data_ + this->size_; }
+  const T *begin() const { return this->data_; }
+  const T *end() const { return this->data_ + this->size_; }
+
+  size_t size() const { return this->size_; }
+  bool empty() const { return this->size_ == 0; }
+
+  /**
+   * @brief Checks whether the elements still live in the inline slots.
+   * @return True if the vector has never allocated.
+   */
+  bool isInline() const { return this->heap_ == nullptr; }
+};
+
+} // namespace ml::basic
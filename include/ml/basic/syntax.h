@@ -101,6 +101,12 @@ inline bool isKwy(const std::string str) {
     if (str == "false") {
       return true;
     }
+    if (str == "spawn") {
+      return true;
+    }
+    if (str == "await") {
+      return true;
+    }
     return false;
   case 6:
     if (str == "return") {
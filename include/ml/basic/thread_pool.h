@@ -0,0 +1,375 @@
+/**
+ * @file thread_pool.h
+ * @brief Work-stealing thread pool for My Language.
+ * @details Defines a Chase-Lev work-stealing deque, a pool of workers that
+ * each own one and steal from the others when they run dry, and task groups
+ * that fork work onto the pool, join it and cancel it. Every subsystem
+ * shares the pool returned by ThreadPool::global() instead of starting its
+ * own threads.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ml::basic {
+
+/**
+ * @class WorkStealingDeque thread_pool.h
+ * @brief A lock-free Chase-Lev deque.
+ * @tparam T The element type, which must be trivially copyable.
+ * @details The owning thread pushes and pops at the bottom, so its newest
+ * work stays hot in its cache; any other thread may steal the oldest
+ * element from the top. The buffer grows on demand, and retired buffers are
+ * kept until the deque is destroyed, since a thief may still be reading
+ * one.
+ */
+template <typename T> class WorkStealingDeque {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "WorkStealingDeque only holds trivially copyable values");
+
+private:
+  /**
+   * @struct Buffer thread_pool.h
+   * @brief A circular buffer with a power-of-two capacity.
+   */
+  struct Buffer {
+    int64_t capacity;                        // Number of slots
+    std::unique_ptr<std::atomic<T>[]> slots; // The slots
+
+    explicit Buffer(int64_t capacity)
+        : capacity(capacity),
+          slots(std::make_unique<std::atomic<T>[]>(capacity)) {}
+
+    T get(int64_t index) const {
+      return this->slots[index & (this->capacity - 1)].load(
+          std::memory_order_relaxed);
+    }
+    void put(int64_t index, T value) {
+      this->slots[index & (this->capacity - 1)].store(
+          value, std::memory_order_relaxed);
+    }
+  };
+
+  std::atomic<int64_t> top_{0};                // Next element to steal
+  std::atomic<int64_t> bottom_{0};             // Next free slot
+  std::atomic<Buffer *> buffer_;               // The active buffer
+  std::vector<std::unique_ptr<Buffer>> owned_; // Every buffer ever used
+
+  /**
+   * @brief Doubles the buffer, copying the live elements.
+   * @return The new buffer.
+   */
+  Buffer *grow(Buffer *old, int64_t top, int64_t bottom) {
+    auto buffer = std::make_unique<Buffer>(old->capacity * 2);
+    for (int64_t i = top; i < bottom; i++) {
+      buffer->put(i, old->get(i));
+    }
+    Buffer *raw = buffer.get();
+    this->owned_.push_back(std::move(buffer));
+    this->buffer_.store(raw, std::memory_order_release);
+    return raw;
+  }
+
+public:
+  /**
+   * @brief Creates an empty deque.
+   * @param capacity The initial capacity, rounded up to a power of two.
+   */
+  explicit WorkStealingDeque(int64_t capacity = 64) {
+    int64_t rounded = 1;
+    while (rounded < capacity) {
+      rounded *= 2;
+    }
+    this->owned_.push_back(std::make_unique<Buffer>(rounded));
+    this->buffer_.store(this->owned_.back().get(), std::memory_order_relaxed);
+  }
+
+  WorkStealingDeque(const WorkStealingDeque &) = delete;
+  WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+  /**
+   * @brief Pushes an element at the bottom. Owner only.
+   */
+  void push(T value) {
+    int64_t bottom = this->bottom_.load(std::memory_order_relaxed);
+    int64_t top = this->top_.load(std::memory_order_acquire);
+    Buffer *buffer = this->buffer_.load(std::memory_order_relaxed);
+    if (bottom - top > buffer->capacity - 1) {
+      buffer = this->grow(buffer, top, bottom);
+    }
+    buffer->put(bottom, value);
+    std::atomic_thread_fence(std::memory_order_release);
+    this->bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Pops the newest element from the bottom. Owner only.
+   * @param value Receives the element.
+   * @return True if an element was popped, false if the deque was empty or
+   * a thief took the last element first.
+   */
+  bool pop(T &value) {
+    int64_t bottom = this->bottom_.load(std::memory_order_relaxed) - 1;
+    Buffer *buffer = this->buffer_.load(std::memory_order_relaxed);
+    this->bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = this->top_.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+      this->bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return false;
+    }
+    value = buffer->get(bottom);
+    if (top == bottom) {
+      // The last element: race the thieves for it.
+      bool won = this->top_.compare_exchange_strong(
+          top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      this->bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Steals the oldest element from the top. Any thread.
+   * @param value Receives the element.
+   * @return True if an element was stolen, false if the deque was empty or
+   * another thread won the race for it.
+   */
+  bool steal(T &value) {
+    int64_t top = this->top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = this->bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return false;
+    }
+    Buffer *buffer = this->buffer_.load(std::memory_order_acquire);
+    T stolen = buffer->get(top);
+    if (!this->top_.compare_exchange_strong(top, top + 1,
+                                            std::memory_order_seq_cst,
+                                            std::memory_order_relaxed)) {
+      return false;
+    }
+    value = stolen;
+    return true;
+  }
+
+  /**
+   * @brief Gets the number of elements; only a hint while others run.
+   */
+  size_t size() const {
+    int64_t bottom = this->bottom_.load(std::memory_order_relaxed);
+    int64_t top = this->top_.load(std::memory_order_relaxed);
+    return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+  }
+
+  bool empty() const { return this->size() == 0; }
+};
+
+class TaskGroup;
+
+/**
+ * @struct PoolStats thread_pool.h
+ * @brief Counters of a thread pool, for benchmarks and tuning.
+ */
+struct PoolStats {
+  uint64_t executed = 0; // Tasks run
+  uint64_t stolen = 0;   // Tasks taken from another worker's deque
+  uint64_t injected = 0; // Tasks submitted from outside the pool
+};
+
+/**
+ * @class ThreadPool thread_pool.h
+ * @brief A fixed set of workers that balance tasks by stealing.
+ * @details A task forked by a worker goes to the bottom of that worker's
+ * deque; a task forked by any other thread goes to a shared injection
+ * queue. An idle worker pops its own deque, then steals from the others,
+ * then drains the injection queue, and only sleeps once all are empty.
+ * Threads waiting on a task group run pending tasks while they wait, so
+ * nested fork-join never runs out of workers, and block once there is
+ * nothing left to run.
+ */
+class ThreadPool {
+  friend class TaskGroup;
+
+private:
+  /**
+   * @struct Task thread_pool.h
+   * @brief A queued unit of work.
+   */
+  struct Task {
+    std::function<void()> function; // The work
+    TaskGroup *group;               // The group to report to
+  };
+
+  /**
+   * @struct Worker thread_pool.h
+   * @brief The state of one worker thread.
+   */
+  struct Worker {
+    WorkStealingDeque<Task *> deque; // Tasks forked by this worker
+    uint64_t seed;                   // Random state for picking victims
+  };
+
+  std::vector<std::unique_ptr<Worker>> workers_; // One per thread
+  std::vector<std::thread> threads_;             // The worker threads
+  std::mutex mutex_;                             // Guards injected_, sleeps
+  std::condition_variable wake_;                 // Signals work or shutdown
+  std::deque<Task *> injected_;                  // Tasks from outside
+  std::atomic<size_t> queued_{0};                // Tasks not yet taken
+  std::atomic<size_t> sleeping_{0};              // Workers blocked on wake_
+  std::condition_variable joined_;               // Signals joiners to recheck
+  std::atomic<size_t> joining_{0};               // Threads blocked on joined_
+  std::atomic<bool> stopping_{false};            // Set on shutdown
+  std::atomic<uint64_t> executed_{0};            // Tasks run
+  std::atomic<uint64_t> stolen_{0};              // Tasks stolen
+  std::atomic<uint64_t> inject_count_{0};        // Tasks injected
+
+  /**
+   * @brief Queues a task, on the calling worker's deque if there is one.
+   */
+  void submit(Task *task);
+
+  /**
+   * @brief Takes a task: own deque first, then stealing, then injection.
+   * @return The task, or nullptr if nothing is queued.
+   */
+  Task *take();
+
+  /**
+   * @brief Runs a task and reports it to its group.
+   */
+  void execute(Task *task);
+
+  /**
+   * @brief The loop of a worker thread.
+   */
+  void work(size_t index);
+
+  /**
+   * @brief Wakes the threads blocked in TaskGroup::join, after a group
+   * finished or a task was queued.
+   */
+  void signalJoiners();
+
+public:
+  /**
+   * @brief Starts a pool.
+   * @param threads The number of workers, or 0 for defaultJobs().
+   */
+  explicit ThreadPool(unsigned threads = 0);
+
+  /**
+   * @brief Stops the pool after the queued tasks have run.
+   */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /**
+   * @brief Gets the pool shared by every subsystem.
+   * @return The pool, started with defaultJobs() workers on first use.
+   */
+  static ThreadPool &global();
+
+  /**
+   * @brief Gets the number of workers.
+   */
+  size_t size() const { return this->workers_.size(); }
+
+  /**
+   * @brief Runs one queued task on the calling thread, if there is one.
+   * @return True if a task ran.
+   */
+  bool runPending();
+
+  /**
+   * @brief Gets the counters of the pool.
+   */
+  PoolStats stats() const;
+};
+
+/**
+ * @class TaskGroup thread_pool.h
+ * @brief A set of tasks forked onto a pool and joined together.
+ * @details Tasks may fork more tasks into the same group. Cancelling a
+ * group skips its tasks that have not started yet; running tasks can poll
+ * cancelled() to stop early. The first exception a task throws cancels the
+ * group and is rethrown by wait().
+ */
+class TaskGroup {
+  friend class ThreadPool;
+
+private:
+  ThreadPool &pool_;                   // The pool tasks run on
+  std::atomic<size_t> pending_{0};     // Tasks forked and not yet finished
+  std::atomic<bool> cancelled_{false}; // Whether the group was cancelled
+  std::mutex error_mutex_;             // Guards error_
+  std::exception_ptr error_;           // The first exception thrown
+
+  /**
+   * @brief Records an exception and cancels the group.
+   */
+  void fail(std::exception_ptr error);
+
+  /**
+   * @brief Waits for every task without rethrowing.
+   */
+  void join();
+
+public:
+  /**
+   * @brief Creates an empty group.
+   * @param pool The pool to run on.
+   */
+  explicit TaskGroup(ThreadPool &pool = ThreadPool::global());
+
+  /**
+   * @brief Waits for the remaining tasks; exceptions are dropped.
+   */
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup &operator=(const TaskGroup &) = delete;
+
+  /**
+   * @brief Forks a task.
+   * @param function The work.
+   */
+  void run(std::function<void()> function);
+
+  /**
+   * @brief Waits for every task, running queued tasks meanwhile and sleeping
+   * while there are none.
+   * @details Rethrows the first exception a task threw, if any.
+   */
+  void wait();
+
+  /**
+   * @brief Cancels the tasks that have not started yet.
+   */
+  void cancel() { this->cancelled_.store(true, std::memory_order_relaxed); }
+
+  /**
+   * @brief Gets whether the group was cancelled.
+   */
+  bool cancelled() const {
+    return this->cancelled_.load(std::memory_order_relaxed);
+  }
+};
+
+} // namespace ml::basic
@@ -0,0 +1,62 @@
+/**
+ * @file unicode.h
+ * @brief UTF-8 and Unicode identifier helpers for My Language.
+ * @details Defines UTF-8 validation and decoding, and the XID_Start and
+ * XID_Continue properties that Unicode identifiers are built from. ASCII
+ * input takes fast paths throughout; the Unicode tables are only consulted
+ * for code points above U+007F.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace ml::basic {
+
+/**
+ * @brief Decodes one UTF-8 sequence.
+ * @param text The text.
+ * @param index The offset of the sequence's first byte, inside the text.
+ * @param code_point Receives the code point.
+ * @return The length of the sequence in bytes, or 0 if it is malformed:
+ * truncated, overlong, a surrogate or above U+10FFFF.
+ */
+size_t decodeUtf8(std::string_view text, size_t index, char32_t &code_point);
+
+/**
+ * @brief Checks that a text is well-formed UTF-8.
+ * @param text The text.
+ * @param error_offset Receives the offset of the first malformed sequence;
+ * may be nullptr.
+ * @return True if the whole text is well formed.
+ * @details Runs of ASCII are skipped eight bytes at a time, so a pure ASCII
+ * source is validated at close to memory speed.
+ */
+bool validateUtf8(std::string_view text, size_t *error_offset = nullptr);
+
+/**
+ * @brief Checks whether a code point may start an identifier.
+ * @param code_point The code point.
+ * @return True for XID_Start and the underscore.
+ */
+bool isXidStart(char32_t code_point);
+
+/**
+ * @brief Checks whether a code point may continue an identifier.
+ * @param code_point The code point.
+ * @return True for XID_Continue.
+ */
+bool isXidContinue(char32_t code_point);
+
+/**
+ * @brief Finds the end of the identifier starting at an offset.
+ * @param text The text.
+ * @param index The offset to start at.
+ * @return The offset just past the identifier, or index itself if no
+ * identifier starts there.
+ */
+size_t scanIdentifier(std::string_view text, size_t index);
+
+} // namespace ml::basic
@@ -0,0 +1,109 @@
+/**
+ * @file regalloc.h
+ * @brief Register allocation for the code generators of My Language.
+ * @details Defines live intervals over a linear instruction order and two
+ * allocators that map virtual registers onto machine registers and stack
+ * slots: a linear-scan allocator and a naive one that keeps every value on
+ * the stack, as a baseline. Nothing here depends on a target; a backend
+ * numbers its instructions, computes the intervals of its SSA values and
+ * reads the locations back.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ml::codegen {
+
+/**
+ * @struct LiveInterval regalloc.h
+ * @brief The positions at which a virtual register holds a live value.
+ * @details In SSA form each value has a single definition, at start, and is
+ * live until its last use, at end. At one position uses are read before
+ * the definition is written, so an interval ending at p and one starting
+ * at p may share a register.
+ */
+struct LiveInterval {
+  uint32_t vreg;              // The virtual register
+  uint32_t start;             // Position of the definition
+  uint32_t end;               // Position of the last use
+  std::vector<uint32_t> uses; // Positions reading or writing the value
+};
+
+/**
+ * @struct Move regalloc.h
+ * @brief A copy between two virtual registers, such as a phi operand.
+ * @details The allocator tries to give both ends the same register, which
+ * makes the copy unnecessary.
+ */
+struct Move {
+  uint32_t from; // The source virtual register
+  uint32_t to;   // The destination virtual register
+};
+
+/**
+ * @struct Location regalloc.h
+ * @brief Where a virtual register lives.
+ */
+struct Location {
+  enum class Kind : uint8_t {
+    None,     // The register has no interval
+    Register, // A machine register
+    Stack,    // A stack slot
+  };
+
+  Kind kind = Kind::None; // The kind of location
+  uint32_t index = 0;     // The register or slot number
+};
+
+/**
+ * @struct Allocation regalloc.h
+ * @brief The result of register allocation.
+ */
+struct Allocation {
+  std::vector<Location> locations; // Location of each virtual register
+  size_t spilled = 0;              // Intervals placed on the stack
+  size_t stack_slots = 0;          // Stack slots used
+  size_t coalesced = 0;            // Moves whose ends share a register
+  size_t memory_accesses = 0;      // Uses of values on the stack
+
+  /**
+   * @brief Gets the location of a virtual register.
+   * @param vreg The virtual register.
+   * @return Its location, of kind None if it has no interval.
+   */
+  Location at(uint32_t vreg) const {
+    return vreg < this->locations.size() ? this->locations[vreg] : Location();
+  }
+};
+
+/**
+ * @brief Allocates registers with linear scan.
+ * @param intervals The live intervals, one per virtual register, in any
+ * order.
+ * @param moves The copies between virtual registers.
+ * @param registers The number of machine registers available.
+ * @return The allocation.
+ * @details Intervals are visited by start position, as in Poletto and
+ * Sarkar's algorithm. An interval first tries the register of a move
+ * partner that has already expired, which coalesces the copy, then any
+ * free register. When none is free, the interval with the lowest spill
+ * weight, its number of uses per position covered, goes to the stack,
+ * preferring the one that ends last on ties. Spilled intervals share stack
+ * slots whenever they do not overlap.
+ */
+Allocation allocateLinearScan(const std::vector<LiveInterval> &intervals,
+                              const std::vector<Move> &moves,
+                              uint32_t registers);
+
+/**
+ * @brief Places every virtual register in its own stack slot.
+ * @param intervals The live intervals.
+ * @return The allocation, the baseline linear scan is measured against.
+ */
+Allocation allocateStackSlots(const std::vector<LiveInterval> &intervals);
+
+} // namespace ml::codegen
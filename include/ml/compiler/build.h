@@ -0,0 +1,164 @@
+/**
+ * @file build.h
+ * @brief Incremental build definitions for My Language.
+ * @details Defines the build database and the Builder class used to compile
+ * many source files while skipping the ones that are up to date.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ml::compiler {
+
+/**
+ * @struct BuildEntry build.h
+ * @brief The recorded state of one source file in the build database.
+ */
+struct BuildEntry {
+  /**
+   * @var path
+   * @brief The path of the source file.
+   */
+  std::string path;
+
+  /**
+   * @var hash
+   * @brief The hash of the source file content at the last build.
+   */
+  uint64_t hash = 0;
+
+  /**
+   * @var ok
+   * @brief Whether the last build of the file succeeded.
+   */
+  bool ok = false;
+
+  /**
+   * @var output
+   * @brief The path of the artifact produced for the file, if any.
+   */
+  std::string output;
+
+  /**
+   * @var imports
+   * @brief The paths of the source files this file depends on.
+   */
+  std::vector<std::string> imports;
+};
+
+/**
+ * @class BuildDatabase build.h
+ * @brief Persistent record of previous builds.
+ * @details Stores source hashes, per-file outputs and import edges in a
+ * line-based text file.
+ */
+class BuildDatabase {
+private:
+  std::unordered_map<std::string, BuildEntry> entries_; // Entries by path
+
+public:
+  /**
+   * @brief Loads the database from a file.
+   * @param file_path The path of the database file.
+   * @return True if the file was read, false if it is missing or invalid.
+   * @note An invalid or missing database leaves the database empty, which
+   * simply makes every file dirty.
+   */
+  bool load(const std::string &file_path);
+
+  /**
+   * @brief Saves the database to a file, creating parent directories.
+   * @param file_path The path of the database file.
+   * @return True if the file was written, false otherwise.
+   */
+  bool save(const std::string &file_path) const;
+
+  /**
+   * @brief Finds the entry of a source file.
+   * @param path The path of the source file.
+   * @return A pointer to the entry, or nullptr if the file is unknown.
+   */
+  const BuildEntry *find(const std::string &path) const;
+
+  /**
+   * @brief Inserts or replaces the entry of a source file.
+   * @param entry The entry to store.
+   */
+  void update(BuildEntry entry);
+
+  /**
+   * @brief Gets the number of entries in the database.
+   * @return The entry count.
+   */
+  size_t size() const { return this->entries_.size(); }
+};
+
+/**
+ * @struct BuildOptions build.h
+ * @brief Options for an incremental build.
+ */
+struct BuildOptions {
+  unsigned jobs = 0;                      // Worker threads, 0 for automatic
+  std::string database = ".ml_build/db"; // Path of the build database
+};
+
+/**
+ * @struct BuildSummary build.h
+ * @brief Statistics of an incremental build.
+ */
+struct BuildSummary {
+  size_t total = 0;                  // Number of source files considered
+  size_t cached = 0;                 // Number of files skipped as up to date
+  size_t rebuilt = 0;                // Number of files compiled
+  size_t failed = 0;                 // Number of compiled files that failed
+  std::vector<std::string> failures; // Paths of the failed files, in order
+  bool saved = false;                // Whether the build database was written
+
+  /**
+   * @brief Computes the share of files served from the build database.
+   * @return The cache hit rate between 0 and 1.
+   */
+  double hitRate() const {
+    return this->total == 0 ? 1.0
+                            : static_cast<double>(this->cached) /
+                                  static_cast<double>(this->total);
+  }
+};
+
+/**
+ * @class Builder build.h
+ * @brief Incremental compiler for many source files.
+ * @details A file is rebuilt when its content hash changed, when its last
+ * build failed, or when one of its imports is rebuilt. Dirty files are
+ * compiled in parallel.
+ */
+class Builder {
+private:
+  BuildOptions options_; // The options of the build
+
+public:
+  explicit Builder(BuildOptions options) : options_(std::move(options)) {}
+
+  /**
+   * @brief Collects the source files of the given paths.
+   * @param paths Files and directories; directories are searched recursively
+   * for `.ml` files.
+   * @return The sorted list of source files.
+   */
+  static std::vector<std::string>
+  collectSources(const std::vector<std::string> &paths);
+
+  /**
+   * @brief Builds the given source files.
+   * @param sources The source files to build.
+   * @return The statistics of the build.
+   */
+  BuildSummary build(const std::vector<std::string> &sources);
+};
+
+} // namespace ml::compiler
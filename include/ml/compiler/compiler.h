@@ -9,6 +9,7 @@
 #pragma once
 
 #include "ml/ast/ast.h"
+#include "ml/opt/optimizer.h"
 #include "ml/parser/parser.h"
 
 #include <filesystem>
@@ -23,7 +24,8 @@ namespace ml::compiler {
  * @brief Compiler configuration options.
  */
 struct Configuration {
-  bool debug = false; // Enable debug information
+  bool debug = false;    // Enable debug information
+  bool optimize = false; // Run the optimization passes
 };
 
 /**
@@ -33,19 +35,28 @@ struct Configuration {
  */
 class Compiler {
 private:
-  parser::Parser parser_; // The parser instance for parsing source code
+  parser::Parser parser_;               // The parser for the source code
+  opt::OptimizerStatistics statistics_; // Statistics of the last optimization
 
+public:
+  /**
+   * @brief Reads the whole content of a source file.
+   * @param file_path The path to the source file.
+   * @return The content of the file.
+   * @throws std::runtime_error If the file cannot be opened.
+   */
   static std::string readFile(const std::string &file_path);
 
-public:
   /**
    * @brief Compiles the given source code.
    * @param source The source code to compile.
+   * @param file_path The name diagnostics give the source.
    * @return A unique pointer to the AST root node.
    */
   std::unique_ptr<ast::Program>
   compileSource(const std::string &source,
-                const Configuration &config = Configuration());
+                const Configuration &config = Configuration(),
+                const std::string &file_path = "<input>");
 
   /**
    * @brief Compiles the source code from the given file.
@@ -55,6 +66,21 @@ public:
   std::unique_ptr<ast::Program>
   compileFile(const std::string &file_path,
               const Configuration &config = Configuration());
+
+  /**
+   * @brief Gets the number of errors reported by the last compilation.
+   * @return The error count.
+   */
+  uint64_t errors() const { return this->parser_.errors(); }
+
+  /**
+   * @brief Gets the statistics of the last optimization.
+   * @return The statistics, all zero if the last compilation did not
+   * optimize.
+   */
+  const opt::OptimizerStatistics &statistics() const {
+    return this->statistics_;
+  }
 };
 
 } // namespace ml::compiler
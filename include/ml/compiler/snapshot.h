@@ -0,0 +1,172 @@
+/**
+ * @file snapshot.h
+ * @brief Startup snapshot definitions for My Language.
+ * @details Defines the state a program reaches after its top-level
+ * initialization, the compile-time evaluator that computes it and a
+ * memory-mappable snapshot file that stores it, so later runs of an
+ * unchanged program restore the state instead of recomputing it.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "ml/ast/ast.h"
+#include "ml/basic/mapped_file.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ml::compiler {
+
+/**
+ * @enum ValueKind snapshot.h
+ * @brief The kinds of values a snapshot holds.
+ */
+enum class ValueKind : uint8_t {
+  Deferred, // Only known at run time; the initializer must still run
+  Integer,  // A 64-bit signed integer
+  Float,    // A double-precision float
+  Boolean,  // true or false
+  String,   // A string, without its quotes
+};
+
+/**
+ * @struct Value snapshot.h
+ * @brief The value of a global after initialization.
+ */
+struct Value {
+  ValueKind kind = ValueKind::Deferred; // The kind of value
+  int64_t integer = 0;                  // Integer value, or 1/0 for booleans
+  double real = 0.0;                    // Float value
+  std::string text;                     // String value
+};
+
+/**
+ * @struct Global snapshot.h
+ * @brief One global variable.
+ */
+struct Global {
+  std::string name; // The variable name
+  Value value;      // Its value after initialization
+};
+
+/**
+ * @struct Member snapshot.h
+ * @brief One field or method of a type.
+ */
+struct Member {
+  std::string name; // The member name
+  std::string type; // The field type, empty for methods
+};
+
+/**
+ * @struct TypeLayout snapshot.h
+ * @brief The metadata of a class or record.
+ * @details Fields are laid out in declaration order; the position of a
+ * field in the list is its slot in an instance.
+ */
+struct TypeLayout {
+  std::string name;            // The type name
+  bool record = false;         // Whether the type is a record
+  std::vector<Member> fields;  // The fields, in slot order
+  std::vector<Member> methods; // The methods, in declaration order
+};
+
+/**
+ * @struct StartupState snapshot.h
+ * @brief The state of a program after its top-level initialization.
+ */
+struct StartupState {
+  std::vector<Global> globals;   // Global variables, in source order
+  std::vector<TypeLayout> types; // Classes and records, in source order
+
+  /**
+   * @brief Gets the number of globals whose initializer must still run.
+   * @return The deferred count.
+   */
+  size_t deferred() const;
+};
+
+/**
+ * @brief Runs the top-level initialization of a program at compile time.
+ * @param program The program.
+ * @return The resulting state.
+ * @details Initializers built from literals, arithmetic, comparisons, logic
+ * and earlier globals are evaluated. Anything else, such as a call, a
+ * division by zero or an integer overflow, leaves the global deferred. Once
+ * a top-level statement with side effects runs, the globals after it are
+ * deferred too, since it may observe or change them, and so are the earlier
+ * globals that any statement or function assigns.
+ */
+StartupState initialize(const ast::Program &program);
+
+/**
+ * @brief Writes a startup snapshot.
+ * @param file_path The path of the snapshot; missing directories are
+ * created.
+ * @param state The state to store.
+ * @param source_hash The hash of the source the state was computed from.
+ * @return True if the snapshot was written, false otherwise.
+ */
+bool writeSnapshot(const std::string &file_path, const StartupState &state,
+                   uint64_t source_hash);
+
+/**
+ * @class StartupSnapshot snapshot.h
+ * @brief Read-only view of a memory-mapped startup snapshot.
+ * @details Lookups binary-search the mapped tables in place; only restore()
+ * copies the whole state out.
+ */
+class StartupSnapshot {
+private:
+  basic::MappedFile file_; // The mapped snapshot
+
+public:
+  /**
+   * @brief Maps a snapshot.
+   * @param file_path The path of the snapshot.
+   * @param source_hash The hash of the current source.
+   * @return True if the file is a well-formed snapshot of this version taken
+   * from the same source, false if it is missing, damaged or stale.
+   */
+  bool open(const std::string &file_path, uint64_t source_hash);
+
+  /**
+   * @brief Gets the number of globals.
+   * @return The global count, 0 if no snapshot is open.
+   */
+  size_t globalCount() const;
+
+  /**
+   * @brief Gets the number of types.
+   * @return The type count, 0 if no snapshot is open.
+   */
+  size_t typeCount() const;
+
+  /**
+   * @brief Looks up the value of a global.
+   * @param name The variable name.
+   * @param value Receives the value.
+   * @return True if the global exists. If it is declared more than once,
+   * the last declaration wins.
+   */
+  bool find(std::string_view name, Value &value) const;
+
+  /**
+   * @brief Looks up the slot of a field.
+   * @param type The type name.
+   * @param field The field name.
+   * @return The slot, or -1 if the type or field does not exist.
+   */
+  int64_t fieldSlot(std::string_view type, std::string_view field) const;
+
+  /**
+   * @brief Copies the whole state out of the snapshot.
+   * @return The state, with globals and types sorted by name.
+   */
+  StartupState restore() const;
+};
+
+} // namespace ml::compiler
@@ -0,0 +1,179 @@
+/**
+ * @file doc.h
+ * @brief Pretty-printing documents for My Language.
+ * @details Defines a Wadler-style document: text, line breaks that turn
+ * into spaces when their group fits on the line, groups and indentation.
+ * The document is stored as a flat stream of items over one text buffer,
+ * and laid out in two linear passes: a backward pass measures every group,
+ * and a forward pass decides each group with a single comparison and writes
+ * the result into one output string.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ml::format {
+
+/**
+ * @enum DocOp doc.h
+ * @brief The kinds of document items.
+ */
+enum class DocOp : uint8_t {
+  Text,     // Text without newlines
+  Line,     // A space, or a newline if the group breaks
+  SoftLine, // Nothing, or a newline if the group breaks
+  HardLine, // Always a newline; breaks every enclosing group
+  RawLine,  // A newline without indentation, inside verbatim text
+  Begin,    // Opens a group
+  End,      // Closes a group
+  Indent,   // Indents the lines that follow
+  Dedent,   // Undoes one Indent
+};
+
+/**
+ * @class Doc doc.h
+ * @brief A document to lay out within a line width.
+ * @details Groups are laid out flat when they fit in the rest of the line,
+ * counting the text after them up to the next possible break, and broken
+ * otherwise. Breaking a group does not break the groups inside it.
+ */
+class Doc {
+private:
+  /**
+   * @struct Item doc.h
+   * @brief One document item.
+   */
+  struct Item {
+    DocOp op;        // The kind of item
+    uint32_t offset; // Offset of the text in text_
+    uint32_t length; // Length of the text in bytes
+    uint32_t width;  // Width of the text in columns
+  };
+
+  std::vector<Item> items_; // The items, in order
+  std::string text_;        // The text of every Text item
+
+  void push(DocOp op) { this->items_.push_back({op, 0, 0, 0}); }
+
+public:
+  Doc() = default;
+
+  /**
+   * @brief Appends text.
+   * @param text The text; newlines in it are kept verbatim.
+   * @return This document.
+   */
+  Doc &text(std::string_view text);
+
+  /**
+   * @brief Appends a break that is a space when its group is flat.
+   * @return This document.
+   */
+  Doc &line() {
+    this->push(DocOp::Line);
+    return *this;
+  }
+
+  /**
+   * @brief Appends a break that is empty when its group is flat.
+   * @return This document.
+   */
+  Doc &softLine() {
+    this->push(DocOp::SoftLine);
+    return *this;
+  }
+
+  /**
+   * @brief Appends a newline that is always taken.
+   * @return This document.
+   */
+  Doc &hardLine() {
+    this->push(DocOp::HardLine);
+    return *this;
+  }
+
+  /**
+   * @brief Opens a group.
+   * @return This document.
+   */
+  Doc &begin() {
+    this->push(DocOp::Begin);
+    return *this;
+  }
+
+  /**
+   * @brief Closes the innermost open group.
+   * @return This document.
+   */
+  Doc &end() {
+    this->push(DocOp::End);
+    return *this;
+  }
+
+  /**
+   * @brief Indents the lines after the following breaks by one level.
+   * @return This document.
+   */
+  Doc &indent() {
+    this->push(DocOp::Indent);
+    return *this;
+  }
+
+  /**
+   * @brief Undoes the last indent().
+   * @return This document.
+   */
+  Doc &dedent() {
+    this->push(DocOp::Dedent);
+    return *this;
+  }
+
+  /**
+   * @brief Removes every item, keeping the allocated memory.
+   */
+  void clear() {
+    this->items_.clear();
+    this->text_.clear();
+  }
+
+  /**
+   * @brief Gets the number of items.
+   * @return The item count.
+   */
+  size_t size() const { return this->items_.size(); }
+
+  /**
+   * @brief Lays the document out.
+   * @param out The string to append the result to.
+   * @param width The line width to fit groups in.
+   * @param indent The number of spaces per indentation level.
+   * @details Runs in time linear in the size of the document. Lines never
+   * end in whitespace.
+   */
+  void render(std::string &out, unsigned width, unsigned indent) const;
+
+  /**
+   * @brief Writes the document with as little whitespace as possible.
+   * @param out The string to append the result to.
+   * @details Breaks, groups and indentation are dropped, and so are spaces at
+   * either end of a text, except next to a verbatim newline. One space is
+   * kept between two texts only where they would otherwise lex as one
+   * token: between two word characters, or two operator characters.
+   */
+  void compact(std::string &out) const;
+};
+
+/**
+ * @brief Measures the width of a text in columns.
+ * @param text UTF-8 text without newlines.
+ * @return The number of code points.
+ */
+size_t displayWidth(std::string_view text);
+
+} // namespace ml::format
@@ -0,0 +1,121 @@
+/**
+ * @file formatter.h
+ * @brief Source formatter for My Language.
+ * @details Defines a formatter that prints a program from its AST through a
+ * Doc, so the layout only depends on the program and the line width.
+ * Comments and blank lines are taken from the lexer's trivia table and kept
+ * between statements. Files are formatted in parallel on the shared pool.
+ * The same printer also emits minified sources for shipping, with comments
+ * and layout dropped and, optionally, local variables renamed.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ml::format {
+
+/**
+ * @struct FormatOptions formatter.h
+ * @brief The layout settings of the formatter.
+ */
+struct FormatOptions {
+  unsigned width = 80; // The line width to fit code in
+  unsigned indent = 4; // The number of spaces per indentation level
+};
+
+/**
+ * @brief Formats a source.
+ * @param source The source.
+ * @param out Receives the formatted source; left alone on failure.
+ * @param options The layout settings.
+ * @return True if the source parsed without errors.
+ * @details The output parses to the same AST as the source, and formatting
+ * it again gives it back unchanged. Parentheses are printed where the
+ * grammar needs them, and the default accessor is left out. Comments inside
+ * an expression or a statement header move to the end of that statement.
+ */
+bool formatSource(const std::string &source, std::string &out,
+                  const FormatOptions &options = FormatOptions());
+
+/**
+ * @struct FormatSummary formatter.h
+ * @brief Statistics of a formatting run.
+ */
+struct FormatSummary {
+  size_t files = 0;                 // Number of files considered
+  size_t changed = 0;               // Number of files not already formatted
+  size_t failed = 0;                // Number of unreadable or invalid files
+  std::vector<std::string> changes; // The files not already formatted
+  std::vector<std::string> errors;  // The unreadable or invalid files
+};
+
+/**
+ * @brief Formats files.
+ * @param sources The source files.
+ * @param options The layout settings.
+ * @param write True to rewrite files that are not formatted, false to only
+ * report them.
+ * @param jobs The number of threads to format with, 0 for automatic.
+ * @return The statistics of the run, with file lists in source order.
+ * @details Files that are already formatted are never written, so their
+ * timestamps stay put.
+ */
+FormatSummary formatFiles(const std::vector<std::string> &sources,
+                          const FormatOptions &options, bool write,
+                          unsigned jobs = 0);
+
+/**
+ * @struct MinifyOptions formatter.h
+ * @brief The settings of the minifier.
+ */
+struct MinifyOptions {
+  bool rename = false; // Whether to give locals and parameters short names
+};
+
+/**
+ * @brief Minifies a source.
+ * @param source The source.
+ * @param out Receives the minified source; left alone on failure.
+ * @param options The minifier settings.
+ * @return True if the source parsed without errors.
+ * @details The output parses to the same AST as the source, apart from
+ * renamed variables, and minifying it again gives it back unchanged.
+ * Comments are dropped, and whitespace is only kept where two tokens would
+ * otherwise run together. Renaming only touches the parameters and local
+ * variables of functions, whose references all resolve within the function;
+ * their new names never clash with any other name in the source, and the
+ * most used variables get the shortest ones.
+ */
+bool minifySource(const std::string &source, std::string &out,
+                  const MinifyOptions &options = MinifyOptions());
+
+/**
+ * @struct MinifySummary formatter.h
+ * @brief Statistics of a minifying run.
+ */
+struct MinifySummary {
+  size_t files = 0;                // Number of files considered
+  size_t failed = 0;               // Number of unreadable or invalid files
+  size_t input_bytes = 0;          // Size of the sources minified
+  size_t output_bytes = 0;         // Size of the minified sources
+  std::vector<std::string> errors; // The files that could not be minified
+};
+
+/**
+ * @brief Minifies files into a directory.
+ * @param sources The source files.
+ * @param options The minifier settings.
+ * @param output The directory to write to; each file keeps its path
+ * relative to it, with any root or leading ".." removed.
+ * @param jobs The number of threads to minify with, 0 for automatic.
+ * @return The statistics of the run, with file lists in source order.
+ */
+MinifySummary minifyFiles(const std::vector<std::string> &sources,
+                          const MinifyOptions &options,
+                          const std::string &output, unsigned jobs = 0);
+
+} // namespace ml::format
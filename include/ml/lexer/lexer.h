@@ -17,11 +17,55 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 namespace ml::lexer {
 
+/**
+ * @struct DocComment lexer.h
+ * @brief A documentation comment kept by the lexer.
+ * @details Line comments starting with exactly three slashes and block
+ * comments starting with exactly two stars are documentation comments.
+ */
+struct DocComment {
+  size_t token;       // Index of the token the comment precedes
+  basic::Locus start; // Locus of the first character
+  basic::Locus end;   // Locus just past the last character
+  std::string text;   // The comment, including its delimiters
+};
+
+/**
+ * @struct TriviaSpan lexer.h
+ * @brief The whitespace and comments in front of one token.
+ * @details Tokens and their trivia tile the source: the trivia of token i
+ * runs from the end of token i - 1 to the start of token i, and the trivia
+ * of the Eof token holds whatever trails the last real token.
+ */
+struct TriviaSpan {
+  uint32_t offset; // Byte offset of the first trivia character
+  uint32_t length; // Number of trivia bytes, 0 if the token is adjacent
+};
+
+/**
+ * @brief Finds the end of a block comment, honouring nesting.
+ * @param source The text holding the comment.
+ * @param index The offset of the opening delimiter.
+ * @return The offset just past the matching terminator, or npos if the
+ * comment is not closed.
+ */
+size_t blockCommentEnd(std::string_view source, size_t index);
+
+/**
+ * @brief Finds the end of a line or block comment, as the lexer skips it.
+ * @param source The text holding the comment.
+ * @param index The offset of the opening slash of the comment.
+ * @return The offset of the newline ending a line comment, or just past a
+ * block comment; the end of the text if the comment is not closed.
+ */
+size_t commentEnd(std::string_view source, size_t index);
+
 /**
  * @class Lexer lexer.h
  * @brief Lexer for tokenizing source code.
@@ -40,6 +84,13 @@ private:
   bool value_dirty_ = true;       // Dirty flag for cached value
   basic::Locus start_,
       current_ = basic::Locus(1, 1, 0); // Current and start loci
+  uint64_t errors_ = 0;                 // Number of errors reported
+  bool keep_docs_ = false;              // Whether to keep doc comments
+  std::vector<DocComment> docs_;        // Doc comments kept so far
+  size_t token_index_ = 0;              // Index of the token being lexed
+  bool keep_trivia_ = false;            // Whether to record trivia
+  std::vector<TriviaSpan> trivia_;      // Trivia of each token, if recorded
+  std::string file_ = "<input>";        // Source name shown in diagnostics
 
   /**
    * @brief Checks if the lexer has reached the end of the source code.
@@ -84,6 +135,19 @@ private:
    */
   void ignore();
 
+  /**
+   * @brief Moves the current locus forward to a byte offset.
+   * @param index The offset, not before the current one.
+   * @details Lines are counted in bulk over the skipped bytes instead of
+   * one advance() per character.
+   */
+  void skipTo(size_t index);
+
+  /**
+   * @brief Skips whitespace and comments before the next token.
+   */
+  void skipTrivia();
+
   /**
    * @brief Creates a token of the specified kind.
    * @param kind The kind of token to create.
@@ -103,6 +167,12 @@ private:
    */
   std::unique_ptr<Token> lexNumeric();
 
+  /**
+   * @brief Skips the escape sequence at the current position, reporting it
+   * if it is malformed.
+   */
+  void skipEscape();
+
   /**
    * @brief Lexes a character token.
    * @return A unique pointer to the lexed token, or nullptr if not applicable.
@@ -159,6 +229,57 @@ public:
    */
   const basic::Locus &current() const { return this->current_; }
 
+  /**
+   * @brief Gets the number of errors reported while lexing.
+   * @return The error count.
+   */
+  uint64_t errors() const { return this->errors_; }
+
+  /**
+   * @brief Sets the name diagnostics give the source.
+   * @param file The path of the source file; "<input>" by default.
+   */
+  void setFile(std::string file) { this->file_ = std::move(file); }
+
+  /**
+   * @brief Gets the name diagnostics give the source.
+   */
+  const std::string &file() const { return this->file_; }
+
+  /**
+   * @brief Sets whether lex() keeps documentation comments.
+   * @param keep True to keep them; off by default.
+   */
+  void keepDocComments(bool keep) { this->keep_docs_ = keep; }
+
+  /**
+   * @brief Gets the documentation comments kept by the last lex().
+   * @return The comments, in source order.
+   */
+  const std::vector<DocComment> &docComments() const { return this->docs_; }
+
+  /**
+   * @brief Sets whether lex() records the trivia of every token.
+   * @param keep True to record it; off by default, so plain lexing never
+   * touches the table.
+   */
+  void keepTrivia(bool keep) { this->keep_trivia_ = keep; }
+
+  /**
+   * @brief Gets the trivia recorded by the last lex().
+   * @return One span per token, indexed by token number.
+   */
+  const std::vector<TriviaSpan> &trivia() const { return this->trivia_; }
+
+  /**
+   * @brief Gets the trivia in front of a token.
+   * @param token The token number.
+   * @return The whitespace and comments, empty if none were recorded.
+   * @details For a source that lexes without a None token, concatenating
+   * each token's trivia and value in order reproduces the source exactly.
+   */
+  std::string_view leadingTrivia(size_t token) const;
+
   /**
    * @brief Lexes the entire source code into a vector of tokens.
    * @param source The source code to lex.
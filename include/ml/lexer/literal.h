@@ -0,0 +1,47 @@
+/**
+ * @file literal.h
+ * @brief Literal decoding for My Language.
+ * @details Defines the escape sequences of string and character literals
+ * and a single-pass decoder that turns a lexed literal into its payload.
+ * Literals without escapes are returned as views of the source, so the
+ * common case never allocates.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace ml::lexer {
+
+/**
+ * @brief Measures one escape sequence.
+ * @param text The text.
+ * @param index The offset of the backslash.
+ * @param code_point Receives the escaped code point; may be nullptr.
+ * @return The length of the escape including the backslash, or 0 if it is
+ * malformed.
+ * @details The escapes are \\n, \\t, \\r, \\0, \\\\, \\", \\', \\xHH for a
+ * code point up to U+007F and \\u{H...} with one to six hex digits for any
+ * Unicode scalar value.
+ */
+size_t escapeLength(std::string_view text, size_t index,
+                    char32_t *code_point = nullptr);
+
+/**
+ * @brief Decodes the payload of a string or character literal.
+ * @param literal The literal as lexed, including its quotes.
+ * @param storage Holds the payload when the literal has escapes.
+ * @param payload Receives the payload: a view into the literal when it has
+ * no escapes, into storage otherwise.
+ * @param error_offset Receives the offset of the first malformed escape in
+ * the literal; may be nullptr.
+ * @return True if the literal is quoted on both ends and every escape is
+ * well formed.
+ */
+bool decodeLiteral(std::string_view literal, std::string &storage,
+                   std::string_view &payload, size_t *error_offset = nullptr);
+
+} // namespace ml::lexer
@@ -8,8 +8,10 @@
 #pragma once
 
 #include "ml/basic/locus.h"
+#include "ml/basic/number.h"
 #include <ostream>
 #include <string>
+#include <utility>
 
 namespace ml::lexer {
 
@@ -95,10 +97,16 @@ struct Token {
    */
   basic::Locus end;
 
+  /**
+   * @var number
+   * @brief The value of an Integer or Float token, converted by the lexer.
+   */
+  basic::Number number;
+
   Token() : kind(TokenKind::None), value("\0"), start(1, 1), end(1, 1) {}
 
   Token(TokenKind kind, std::string value, basic::Locus start, basic::Locus end)
-      : kind(kind), value(value), start(start), end(end) {}
+      : kind(kind), value(std::move(value)), start(start), end(end) {}
 
   /**
    * @brief Converts the Token to a string representation.
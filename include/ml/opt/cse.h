@@ -0,0 +1,43 @@
+/**
+ * @file cse.h
+ * @brief Common subexpression elimination for My Language.
+ * @details Defines a pass that evaluates repeated pure subexpressions of a
+ * statement once, into a temporary declared just before the statement.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "ml/analysis/purity.h"
+#include "ml/ast/ast.h"
+
+namespace ml::opt {
+
+/**
+ * @struct CseStatistics cse.h
+ * @brief Statistics of common subexpression elimination.
+ */
+struct CseStatistics {
+  size_t statements = 0;  // Statements examined
+  size_t temporaries = 0; // Temporaries introduced
+  size_t eliminated = 0;  // Evaluations removed
+};
+
+/**
+ * @brief Eliminates common subexpressions in every statement of a program.
+ * @param program The program to rewrite.
+ * @param purity The purity of the program's functions.
+ * @return The statistics of the pass.
+ * @details A statement is rewritten when its expression, or the right-hand
+ * side of its assignment, is pure: then every evaluation order gives the
+ * same values, so a repeated subexpression can be evaluated once, first.
+ * For example 'x = a[i] * a[i] + a[i];' becomes
+ * 'let const __cse0 = a[i]; x = __cse0 * __cse0 + __cse0;'.
+ * Right operands of '&&' and '||' are never hoisted because they may not be
+ * evaluated at all, and array literals are never shared because each
+ * evaluation creates a new array. Loop conditions are left alone.
+ */
+CseStatistics eliminateCommonSubexpressions(
+    ast::Program &program, const analysis::PurityAnalysis &purity);
+
+} // namespace ml::opt
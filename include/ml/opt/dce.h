@@ -0,0 +1,48 @@
+/**
+ * @file dce.h
+ * @brief Dead code elimination for My Language.
+ * @details Defines a pass that removes code which can never run or is never
+ * used: statements after a jump, branches on constant conditions, and
+ * private declarations nothing refers to.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "ml/ast/ast.h"
+#include "ml/opt/diagnostic.h"
+
+namespace ml::opt {
+
+/**
+ * @struct DceStatistics dce.h
+ * @brief Statistics of dead code elimination.
+ */
+struct DceStatistics {
+  size_t unreachable = 0; // Statements removed after a jump
+  size_t branches = 0;    // Branches removed on constant conditions
+  size_t functions = 0;   // Unused private functions removed
+  size_t members = 0;     // Unused private fields and methods removed
+};
+
+/**
+ * @brief Eliminates dead code in a program.
+ * @param program The program to rewrite.
+ * @param diagnostics Receives a warning for every piece of code removed.
+ * @return The statistics of the pass.
+ * @details The pass runs in two steps:
+ * - Reachability: in every block, statements after a 'return', 'break' or
+ *   'continue', or after an 'if' whose branches all end in one, are
+ *   removed. Branches of 'if' and 'elif' on the literal 'true' or 'false'
+ *   are resolved, and 'while false' loops are removed.
+ * - Liveness: top-level functions and class fields and methods that are
+ *   private and whose name is never referenced are removed, until no more
+ *   become unused. 'main' and 'init' functions are always kept, and fields
+ *   whose initializer may have a side effect are kept.
+ * References are matched by name, so a name used anywhere keeps every
+ * declaration with that name alive.
+ */
+DceStatistics eliminateDeadCode(ast::Program &program,
+                                Diagnostics &diagnostics);
+
+} // namespace ml::opt
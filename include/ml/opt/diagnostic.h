@@ -0,0 +1,38 @@
+/**
+ * @file diagnostic.h
+ * @brief Diagnostics reported by the optimization passes of My Language.
+ * @details The passes only see the AST, so they record what they found and
+ * leave it to the compiler, which owns the source, to report it through
+ * basic::Error.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "ml/basic/error.h"
+#include "ml/basic/locus.h"
+
+#include <string>
+#include <vector>
+
+namespace ml::opt {
+
+/**
+ * @struct Diagnostic diagnostic.h
+ * @brief A finding of an optimization pass.
+ */
+struct Diagnostic {
+  basic::ErrorLevel level; // Severity of the finding
+  std::string desc;        // What was found
+  std::string help;        // What to do about it
+  basic::Locus start;      // Start of the code concerned
+  basic::Locus end;        // End of the code concerned
+};
+
+/**
+ * @typedef Diagnostics
+ * @brief The findings of a pass, in the order they were made.
+ */
+using Diagnostics = std::vector<Diagnostic>;
+
+} // namespace ml::opt
@@ -0,0 +1,52 @@
+/**
+ * @file loop.h
+ * @brief Loop optimizations for My Language.
+ * @details Defines a pass that moves loop-invariant expressions in front of
+ * their loop and replaces multiplications by an induction variable with
+ * additions.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "ml/analysis/purity.h"
+#include "ml/ast/ast.h"
+
+namespace ml::opt {
+
+/**
+ * @struct LoopStatistics loop.h
+ * @brief Statistics of the loop optimizations.
+ */
+struct LoopStatistics {
+  size_t loops = 0;   // Loops examined
+  size_t hoisted = 0; // Invariant expressions moved out of a loop
+  size_t reduced = 0; // Multiplications replaced with additions
+};
+
+/**
+ * @brief Optimizes every while and for loop of a program.
+ * @param program The program to rewrite.
+ * @param purity The purity of the program's functions.
+ * @return The statistics of the pass.
+ * @details Loops are processed innermost first, so an expression moved out
+ * of an inner loop can move on out of the loops around it. For each loop:
+ * - Strength reduction: an induction variable is one changed exactly once
+ *   per iteration by 'i++', 'i--', 'i = i + c' or 'i = i - c' with an
+ *   integer literal c, either in the increment of a for loop or as a
+ *   statement of a while loop's body. A product 'i * k', where both are
+ *   integers and k is invariant, becomes a variable declared before the
+ *   loop and advanced by 'c * k' alongside i.
+ * - Invariant code motion: the largest subexpressions that read no name the
+ *   loop changes are evaluated once, into 'let const' temporaries declared
+ *   just before the loop. Names declared in the loop count as changed, and
+ *   when the loop calls a function that is not pure, so does every name
+ *   that is not local to the enclosing function.
+ * A hoisted expression runs even if the loop body never does, so only
+ * arithmetic, comparison and logic on names and literals are moved:
+ * calls, indexing, attributes and division may fail and stay in place.
+ */
+LoopStatistics optimizeLoops(ast::Program &program,
+                             const analysis::PurityAnalysis &purity);
+
+} // namespace ml::opt
@@ -0,0 +1,54 @@
+/**
+ * @file optimizer.h
+ * @brief AST optimization pipeline for My Language.
+ * @details Defines the options and statistics of the optimization passes and
+ * the function that runs them over a program.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "ml/ast/ast.h"
+#include "ml/opt/cse.h"
+#include "ml/opt/dce.h"
+#include "ml/opt/diagnostic.h"
+#include "ml/opt/loop.h"
+#include "ml/opt/tail.h"
+
+namespace ml::opt {
+
+/**
+ * @struct OptimizerOptions optimizer.h
+ * @brief Selects the passes to run.
+ */
+struct OptimizerOptions {
+  bool dce = true;        // Dead code elimination
+  bool tail_calls = true; // Tail call elimination
+  bool loops = true;      // Loop-invariant code motion and strength reduction
+  bool cse = true;        // Common subexpression elimination
+};
+
+/**
+ * @struct OptimizerStatistics optimizer.h
+ * @brief Statistics of every pass of one optimization run.
+ */
+struct OptimizerStatistics {
+  DceStatistics dce;             // Dead code elimination
+  TailCallStatistics tail_calls; // Tail call elimination
+  LoopStatistics loops;          // Loop optimizations
+  CseStatistics cse;             // Common subexpression elimination
+  Diagnostics diagnostics;       // Findings of every pass, in order
+};
+
+/**
+ * @brief Runs the selected passes over a program.
+ * @param program The program to optimize in place.
+ * @param options The passes to run.
+ * @return The statistics of the passes.
+ * @details Dead code is removed first, so later passes do not spend time on
+ * code that never runs.
+ */
+OptimizerStatistics optimize(ast::Program &program,
+                             const OptimizerOptions &options = {});
+
+} // namespace ml::opt
@@ -0,0 +1,196 @@
+/**
+ * @file rewrite.h
+ * @brief AST rewriting helpers for the optimization passes of My Language.
+ * @details Defines helpers shared by passes that replace or insert nodes:
+ * enumeration of mutable expression slots and nested blocks, copies, fresh
+ * names and temporaries.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "ml/ast/ast.h"
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+
+namespace ml::opt {
+
+/**
+ * @brief Checks whether a field from ast::forEachSlot holds an expression.
+ * @tparam Slot The type of the field, possibly const.
+ */
+template <typename Slot>
+constexpr bool IS_EXPRESSION_SLOT =
+    std::is_same_v<std::remove_const_t<Slot>,
+                   std::unique_ptr<ast::Expression>>;
+
+/**
+ * @brief Calls a function for every non-null child slot of an expression.
+ * @param expression The expression whose slots to enumerate.
+ * @param f The function to call with each std::unique_ptr<Expression> &.
+ * @details Unlike forEachChild, the slots can be reassigned, which is how
+ * passes replace subexpressions.
+ */
+template <typename F> void forEachSlot(ast::Expression &expression, F &&f) {
+  auto visit = [&f](auto &slot) {
+    if constexpr (IS_EXPRESSION_SLOT<std::remove_reference_t<decltype(slot)>>) {
+      if (slot) {
+        f(slot);
+      }
+    }
+  };
+  ast::forEachSlot(static_cast<ast::Node &>(expression), visit,
+                   [&visit](auto &slots) {
+                     for (auto &slot : slots) {
+                       visit(slot);
+                     }
+                   });
+}
+
+/**
+ * @brief Calls a function for every expression slot held by a statement.
+ * @param statement The statement whose slots to enumerate.
+ * @param f The function to call with each std::unique_ptr<Expression> &.
+ * @details Only the statement's own expressions are visited, not those of
+ * nested statements such as the branches of a conditional. The slots of a
+ * for loop are its condition and increment; the initializer is a statement
+ * of its own. The type of a declaration names a type rather than computing
+ * a value, so it is not a slot.
+ */
+template <typename F>
+void forEachStatementSlot(ast::Statement &statement, F &&f) {
+  const std::unique_ptr<ast::Expression> *type = nullptr;
+  switch (statement.tag()) {
+  case ast::NodeTag::Declaration:
+  case ast::NodeTag::VariableDeclaration:
+  case ast::NodeTag::FunctionDeclaration:
+  case ast::NodeTag::ClassDeclaration:
+  case ast::NodeTag::RecordDeclaration:
+    type = &static_cast<ast::Declaration &>(statement).type;
+    break;
+  default:
+    break;
+  }
+  ast::forEachSlot(
+      static_cast<ast::Node &>(statement),
+      [&f, type](auto &slot) {
+        if constexpr (IS_EXPRESSION_SLOT<
+                          std::remove_reference_t<decltype(slot)>>) {
+          if (slot && &slot != type) {
+            f(slot);
+          }
+        }
+      },
+      [](auto &) {});
+}
+
+/**
+ * @brief Calls a function for every block directly nested in a statement.
+ * @param statement The statement whose blocks to enumerate.
+ * @param f The function to call with each ast::BlockStatement &.
+ * @details A block statement yields itself. Function bodies, the bodies of
+ * class methods and every branch of a conditional or loop are yielded, but
+ * not the blocks nested inside them.
+ */
+template <typename F> void forEachBlock(ast::Statement &statement, F &&f) {
+  if (statement.tag() == ast::NodeTag::BlockStatement) {
+    f(static_cast<ast::BlockStatement &>(statement));
+    return;
+  }
+  ast::forEachSlot(
+      static_cast<ast::Node &>(statement),
+      [&f](auto &slot) {
+        using Slot = std::remove_reference_t<decltype(slot)>;
+        if constexpr (std::is_same_v<Slot,
+                                     std::unique_ptr<ast::BlockStatement>>) {
+          if (slot) {
+            f(*slot);
+          }
+        }
+      },
+      [&f](auto &list) {
+        // Methods and the branches of if and switch hold their blocks one
+        // level down.
+        using Item = typename std::remove_reference_t<
+            decltype(list)>::value_type::element_type;
+        if constexpr (std::is_base_of_v<ast::Conditional, Item> ||
+                      std::is_same_v<Item, ast::FunctionDeclaration>) {
+          for (auto &item : list) {
+            if (item) {
+              forEachBlock(*item, f);
+            }
+          }
+        }
+      });
+}
+
+/**
+ * @brief Copies an expression tree.
+ * @param expression The expression to copy.
+ * @return A new tree with the same nodes and locations.
+ * @throws std::logic_error If the tree holds a node that is not a concrete
+ * expression.
+ */
+std::unique_ptr<ast::Expression>
+cloneExpression(const ast::Expression &expression);
+
+/**
+ * @class NameGenerator rewrite.h
+ * @brief Creates identifiers that do not clash with the program's names.
+ */
+class NameGenerator {
+private:
+  std::unordered_set<std::string> used_; // Names already in use
+  uint64_t counter_ = 0;                 // Suffix of the next name
+
+public:
+  /**
+   * @brief Records every identifier of a tree as used.
+   * @param root The root of the tree.
+   */
+  explicit NameGenerator(const ast::Node &root);
+
+  /**
+   * @brief Creates a new name.
+   * @param prefix The prefix of the name, such as "__cse".
+   * @return A name that is not used in the tree or by earlier calls.
+   */
+  std::string next(const std::string &prefix);
+};
+
+/**
+ * @brief Creates a local declaration, 'let const name = value;'.
+ * @param name The name of the variable.
+ * @param initializer The initial value.
+ * @param constant Whether the variable is constant.
+ * @return The declaration, located at the initializer.
+ * @details The type is left implicit, as the parser does for untyped
+ * declarations.
+ */
+std::unique_ptr<ast::VariableDeclaration>
+makeTemporary(const std::string &name,
+              std::unique_ptr<ast::Expression> initializer,
+              bool constant = true);
+
+/**
+ * @brief Creates an assignment statement, 'name = value;'.
+ * @param name The name of the variable.
+ * @param value The value to assign.
+ * @return The statement, located at the value.
+ */
+std::unique_ptr<ast::ExpressionStatement>
+makeAssignment(const std::string &name,
+               std::unique_ptr<ast::Expression> value);
+
+/**
+ * @brief Creates a reference to a variable.
+ * @param name The name of the variable.
+ * @param at The node whose location the reference takes.
+ * @return The identifier expression.
+ */
+std::unique_ptr<ast::IdentifierExpression>
+makeReference(const std::string &name, const ast::Node &at);
+
+} // namespace ml::opt
@@ -0,0 +1,42 @@
+/**
+ * @file tail.h
+ * @brief Tail call elimination for My Language.
+ * @details Defines a pass that turns self-recursive tail calls into jumps
+ * back to the start of the function, so deep recursion runs in constant
+ * stack space.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#pragma once
+
+#include "ml/ast/ast.h"
+
+namespace ml::opt {
+
+/**
+ * @struct TailCallStatistics tail.h
+ * @brief Statistics of tail call elimination.
+ */
+struct TailCallStatistics {
+  size_t functions = 0; // Functions turned into loops
+  size_t calls = 0;     // Tail calls replaced with jumps
+};
+
+/**
+ * @brief Eliminates the self-recursive tail calls of a program.
+ * @param program The program to rewrite.
+ * @return The statistics of the pass.
+ * @details A tail call is 'return f(...);' inside the top-level function f,
+ * with one argument per parameter. Its function body is wrapped in
+ * 'while true { ... }' and each such return becomes a block that assigns
+ * the arguments to the parameters and continues the loop. Arguments are
+ * evaluated into temporaries first when more than one parameter changes,
+ * since each may read the others. A body that can fall off its end gets a
+ * final 'break;'.
+ * Calls inside a loop or switch are left alone, as 'continue' would apply
+ * to that statement instead. Overloaded functions, functions with constant
+ * parameters and functions whose name is shadowed by a local are skipped.
+ */
+TailCallStatistics eliminateTailCalls(ast::Program &program);
+
+} // namespace ml::opt
@@ -26,8 +26,11 @@ class Parser {
 private:
   ml::lexer::Lexer lexer_; // The lexer instance for tokenizing source code
   std::vector<std::unique_ptr<ml::lexer::Token>> tokens_; // List of tokens
-  uint64_t index_ = 0;          // Current index in the tokens list
-  ml::lexer::Token last_token_; // The last consumed token
+  uint64_t index_ = 0;           // Current index in the tokens list
+  ml::lexer::Token last_token_;  // The last consumed token
+  uint64_t errors_ = 0;          // Number of errors reported
+  bool keep_trivia_ = false;     // Whether the lexer records trivia
+  std::string file_ = "<input>"; // Source name shown in diagnostics
 
   /**
    * @brief Peeks at the current token without consuming it.
@@ -250,7 +253,7 @@ private:
   std::unique_ptr<ml::ast::Expression> parseFactor();
 
   /**
-   * @brief Parses a unary expression.
+   * @brief Parses a unary expression, including spawn and await.
    * @return A unique pointer to the Unary Expression AST node.
    */
   std::unique_ptr<ml::ast::Expression> parseUnary();
@@ -276,6 +279,39 @@ public:
    * @return A unique pointer to the Program AST node.
    */
   std::unique_ptr<ml::ast::Program> parse(const std::string &source);
+
+  /**
+   * @brief Gets the tokens produced by the last parse.
+   * @return The list of tokens.
+   */
+  const std::vector<std::unique_ptr<ml::lexer::Token>> &tokens() const {
+    return this->tokens_;
+  }
+
+  /**
+   * @brief Gets the number of errors reported by the last parse.
+   * @return The error count, including lexer errors.
+   */
+  uint64_t errors() const { return this->errors_ + this->lexer_.errors(); }
+
+  /**
+   * @brief Sets whether later parses record the trivia of every token.
+   * @param keep True to record it, for tools that must reproduce the
+   * source; off by default.
+   */
+  void keepTrivia(bool keep) { this->keep_trivia_ = keep; }
+
+  /**
+   * @brief Sets the name diagnostics give the sources of later parses.
+   * @param file The path of the source file; "<input>" by default.
+   */
+  void setFile(std::string file) { this->file_ = std::move(file); }
+
+  /**
+   * @brief Gets the lexer of the last parse, with its trivia table.
+   * @return The lexer.
+   */
+  const ml::lexer::Lexer &lexer() const { return this->lexer_; }
 };
 
 } // namespace ml::parser
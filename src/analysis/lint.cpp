@@ -0,0 +1,300 @@
+/**
+ * @file lint.cpp
+ * @brief Lint engine source code for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/analysis/lint.h"
+#include "ml/analysis/pass.h"
+#include "ml/analysis/scopes.h"
+#include "ml/ast/query.h"
+#include "ml/basic/mapped_file.h"
+#include "ml/basic/parallel.h"
+#include "ml/parser/parser.h"
+
+#include <algorithm>
+
+namespace ml::analysis {
+
+namespace {
+
+/**
+ * @class Rule
+ * @brief Base class of the lint rules.
+ */
+class Rule : public Pass {
+private:
+  std::string name_;                 // Name of the rule
+  std::vector<LintDiagnostic> &out_; // Where findings go
+
+protected:
+  const Scopes &scopes_; // The shared scope resolver
+
+  void report(basic::ErrorLevel level, std::string desc, std::string help,
+              const ast::Node &node) {
+    this->out_.push_back({this->name_, level, std::move(desc),
+                          std::move(help), node.start, node.end});
+  }
+
+public:
+  Rule(std::string name, const Scopes &scopes,
+       std::vector<LintDiagnostic> &out)
+      : name_(std::move(name)), out_(out), scopes_(scopes) {}
+
+  std::string name() const override { return this->name_; }
+};
+
+class UnusedVariable : public Rule {
+private:
+  void check() {
+    for (const auto &binding : this->scopes_.innermost()) {
+      const auto &identifier = *binding.declaration->identifier;
+      if (binding.kind == BindingKind::Local && binding.uses == 0 &&
+          identifier.name.rfind('_', 0) != 0) {
+        this->report(basic::ErrorLevel::Warning,
+                     "Variable '" + identifier.name + "' is never used",
+                     "Remove it, or prefix its name with '_'", identifier);
+      }
+    }
+  }
+
+public:
+  using Rule::Rule;
+
+  void attach(PassManager &manager) override {
+    manager.onLeave<ast::BlockStatement>(
+        [this](const ast::BlockStatement &) { this->check(); });
+    manager.onLeave<ast::ForConditional>(
+        [this](const ast::ForConditional &) { this->check(); });
+  }
+};
+
+class Shadowing : public Rule {
+public:
+  using Rule::Rule;
+
+  void attach(PassManager &manager) override {
+    manager.onEnter<ast::VariableDeclaration>(
+        [this](const ast::VariableDeclaration &v) {
+          if (this->scopes_.kindOf() == BindingKind::Field) {
+            return;
+          }
+          const auto &identifier = *v.identifier;
+          const Binding *previous = this->scopes_.lookup(identifier.name);
+          if (!previous) {
+            return;
+          }
+          const auto &start = previous->declaration->identifier->start;
+          std::string where = " declared at " + std::to_string(start.line) +
+                              ":" + std::to_string(start.column);
+          if (previous->scope == this->scopes_.depth()) {
+            this->report(basic::ErrorLevel::Warning,
+                         "'" + identifier.name + "' redeclares the variable" +
+                             where,
+                         "Rename one of them", identifier);
+          } else {
+            this->report(basic::ErrorLevel::Warning,
+                         "'" + identifier.name + "' shadows the variable" +
+                             where,
+                         "Rename one of them", identifier);
+          }
+        });
+  }
+};
+
+class MissingReturn : public Rule {
+public:
+  using Rule::Rule;
+
+  void attach(PassManager &manager) override {
+    manager.onEnter<ast::FunctionDeclaration>(
+        [this](const ast::FunctionDeclaration &v) {
+          auto *type =
+              dynamic_cast<const ast::IdentifierExpression *>(v.type.get());
+          if (!type || type->name == "void" || !v.body ||
+              (v.modifier &&
+               basic::hasFlag(v.modifier->modifier, basic::Modifier::Init))) {
+            return;
+          }
+          if (!ast::terminates(v.body.get())) {
+            this->report(basic::ErrorLevel::Warning,
+                         "Function '" + v.identifier->name +
+                             "' can end without returning a '" + type->name +
+                             "'",
+                         "Return a value on every path", *v.identifier);
+          }
+        });
+  }
+};
+
+class ConstReassignment : public Rule {
+private:
+  void check(const ast::Expression *target, const ast::Node &node) {
+    if (!target || target->tag() != ast::NodeTag::IdentifierExpression) {
+      return;
+    }
+    auto &identifier = static_cast<const ast::IdentifierExpression &>(*target);
+    if (!this->scopes_.isReference(identifier)) {
+      return;
+    }
+    const Binding *binding = this->scopes_.lookup(identifier.name);
+    const auto *modifier =
+        binding ? binding->declaration->modifier.get() : nullptr;
+    if (modifier &&
+        basic::hasFlag(modifier->modifier, basic::Modifier::Constant)) {
+      this->report(basic::ErrorLevel::Error,
+                   "Cannot modify the const variable '" + identifier.name +
+                       "'",
+                   "Remove 'const' from its declaration, or use a new "
+                   "variable",
+                   node);
+    }
+  }
+
+public:
+  using Rule::Rule;
+
+  void attach(PassManager &manager) override {
+    manager.onEnter<ast::BinaryExpression>(
+        [this](const ast::BinaryExpression &v) {
+          if (v.op == "=") {
+            this->check(v.left.get(), v);
+          }
+        });
+    manager.onEnter<ast::UnaryExpression>(
+        [this](const ast::UnaryExpression &v) {
+          if (v.op == "++" || v.op == "--") {
+            this->check(v.operand.get(), v);
+          }
+        });
+  }
+};
+
+class EmptyBlock : public Rule {
+private:
+  PassManager *manager_ = nullptr; // The running manager
+
+public:
+  using Rule::Rule;
+
+  void attach(PassManager &manager) override {
+    this->manager_ = &manager;
+    manager.onEnter<ast::BlockStatement>([this](const ast::BlockStatement &v) {
+      const ast::Node *parent = this->manager_->parent();
+      // An empty function body is a deliberate no-op.
+      if (v.statements.empty() &&
+          !(parent && parent->tag() == ast::NodeTag::FunctionDeclaration)) {
+        this->report(basic::ErrorLevel::Warning, "Empty block",
+                     "Add the missing statements or remove the block", v);
+      }
+    });
+  }
+};
+
+using RuleFactory = std::unique_ptr<Rule> (*)(std::string, const Scopes &,
+                                              std::vector<LintDiagnostic> &);
+
+template <typename R>
+std::unique_ptr<Rule> makeRule(std::string name, const Scopes &scopes,
+                               std::vector<LintDiagnostic> &out) {
+  return std::make_unique<R>(std::move(name), scopes, out);
+}
+
+/**
+ * @brief The rules, in the order they run.
+ */
+const std::pair<const char *, RuleFactory> RULES[] = {
+    {"unused-variable", makeRule<UnusedVariable>},
+    {"shadowing", makeRule<Shadowing>},
+    {"missing-return", makeRule<MissingReturn>},
+    {"const-reassignment", makeRule<ConstReassignment>},
+    {"empty-block", makeRule<EmptyBlock>},
+};
+
+} // namespace
+
+const std::vector<std::string> &lintRules() {
+  static const std::vector<std::string> names = [] {
+    std::vector<std::string> names;
+    for (const auto &rule : RULES) {
+      names.emplace_back(rule.first);
+    }
+    return names;
+  }();
+  return names;
+}
+
+std::vector<LintDiagnostic> lint(const ast::Program &program,
+                                 const LintOptions &options,
+                                 std::vector<RuleTiming> *timings) {
+  std::vector<LintDiagnostic> diagnostics;
+  PassManager manager;
+  manager.setTimed(options.timed);
+  auto &scopes = manager.emplace<Scopes>();
+  for (const auto &[name, make] : RULES) {
+    if (options.rules.empty() ||
+        std::find(options.rules.begin(), options.rules.end(), name) !=
+            options.rules.end()) {
+      manager.add(make(name, scopes, diagnostics));
+    }
+  }
+  manager.run(program);
+
+  std::stable_sort(diagnostics.begin(), diagnostics.end(),
+                   [](const LintDiagnostic &a, const LintDiagnostic &b) {
+                     return a.start.index < b.start.index;
+                   });
+  if (timings && options.timed) {
+    timings->clear();
+    for (size_t i = 0; i < manager.passes().size(); i++) {
+      timings->push_back({manager.passes()[i]->name(), manager.time(i)});
+    }
+  }
+  return diagnostics;
+}
+
+LintSummary lintFiles(const std::vector<std::string> &sources,
+                      const LintOptions &options, unsigned jobs) {
+  std::vector<std::vector<LintDiagnostic>> diagnostics(sources.size());
+  std::vector<std::vector<RuleTiming>> timings(sources.size());
+  std::vector<uint8_t> failed(sources.size(), 0);
+  basic::parallelFor(
+      sources.size(), jobs == 0 ? basic::defaultJobs() : jobs, [&](size_t i) {
+        basic::MappedFile file;
+        if (!file.open(sources[i])) {
+          failed[i] = 1;
+          return;
+        }
+        parser::Parser parser;
+        auto program = parser.parse(std::string(file.view()));
+        if (!program || parser.errors() > 0) {
+          failed[i] = 1;
+          return;
+        }
+        diagnostics[i] = lint(*program, options, &timings[i]);
+      });
+
+  LintSummary summary;
+  summary.files = sources.size();
+  for (size_t i = 0; i < sources.size(); i++) {
+    if (failed[i]) {
+      summary.failed++;
+      summary.errors.push_back(sources[i]);
+      continue;
+    }
+    // Every file runs the same rules, so the timings line up by index.
+    for (size_t j = 0; j < timings[i].size(); j++) {
+      if (j == summary.timings.size()) {
+        summary.timings.push_back({timings[i][j].rule, {}});
+      }
+      summary.timings[j].time += timings[i][j].time;
+    }
+    if (!diagnostics[i].empty()) {
+      summary.diagnostics += diagnostics[i].size();
+      summary.results.push_back({sources[i], std::move(diagnostics[i])});
+    }
+  }
+  return summary;
+}
+
+} // namespace ml::analysis
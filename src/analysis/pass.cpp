@@ -0,0 +1,80 @@
+/**
+ * @file pass.cpp
+ * @brief Fused analysis pass source code for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/analysis/pass.h"
+#include "ml/basic/small_vector.h"
+
+#include <algorithm>
+
+namespace ml::analysis {
+
+Pass &PassManager::add(std::unique_ptr<Pass> pass) {
+  this->passes_.push_back(std::move(pass));
+  Pass &added = *this->passes_.back();
+  this->attaching_ = this->passes_.size() - 1;
+  added.attach(*this);
+  this->attaching_ = NO_PASS;
+  return added;
+}
+
+void PassManager::visit(const ast::Node &root) {
+  // Each frame is entered when first seen and left once its children, which
+  // sit above it on the stack, have all been popped.
+  struct Frame {
+    const ast::Node *node;
+    bool entered;
+  };
+  basic::SmallVector<Frame, ast::ITERATOR_INLINE_DEPTH> stack;
+  stack.push_back({&root, false});
+
+  while (!stack.empty()) {
+    Frame &frame = stack.back();
+    const ast::Node &node = *frame.node;
+    const size_t tag = static_cast<size_t>(node.tag());
+
+    if (frame.entered) {
+      stack.pop_back();
+      this->ancestors_.pop_back();
+      const auto &entries = this->leave_[tag];
+      for (auto entry = entries.rbegin(); entry != entries.rend(); ++entry) {
+        this->call(*entry, node);
+      }
+      continue;
+    }
+
+    frame.entered = true;
+    this->visited_++;
+    for (const auto &entry : this->enter_[tag]) {
+      this->call(entry, node);
+    }
+    this->ancestors_.push_back(&node);
+
+    size_t first = stack.size();
+    ast::forEachChild(node, [&stack](const ast::Node &child) {
+      stack.push_back({&child, false});
+    });
+    std::reverse(stack.begin() + first, stack.end());
+  }
+}
+
+void PassManager::run(const ast::Node &root) {
+  this->visited_ = 0;
+  this->ancestors_.clear();
+  this->times_.assign(this->passes_.size(), Duration::zero());
+  this->visit(root);
+
+  for (size_t i = 0; i < this->passes_.size(); i++) {
+    if (!this->timed_) {
+      this->passes_[i]->finish();
+      continue;
+    }
+    auto start = std::chrono::steady_clock::now();
+    this->passes_[i]->finish();
+    this->times_[i] += std::chrono::steady_clock::now() - start;
+  }
+}
+
+} // namespace ml::analysis
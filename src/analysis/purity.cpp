@@ -0,0 +1,156 @@
+/**
+ * @file purity.cpp
+ * @brief Purity analysis source code for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/analysis/purity.h"
+#include "ml/ast/query.h"
+
+#include <unordered_map>
+
+namespace ml::analysis {
+
+namespace {
+
+/**
+ * @brief Checks a subtree for side effects.
+ * @param root The subtree to check.
+ * @param pure The functions currently assumed pure.
+ * @param locals The names the subtree may assign to, or nullptr if it may
+ * not assign at all.
+ */
+bool checkPure(const ast::Node &root,
+               const std::unordered_set<std::string> &pure,
+               const std::unordered_set<std::string> *locals) {
+  auto assignable = [locals](const ast::Node *target) {
+    const std::string *name = ast::identifierName(target);
+    return locals && name && locals->count(*name) != 0;
+  };
+
+  for (const ast::Node &node : ast::preOrder(root)) {
+    switch (node.tag()) {
+    case ast::NodeTag::BinaryExpression: {
+      auto &v = static_cast<const ast::BinaryExpression &>(node);
+      if (v.op == "=" && !assignable(v.left.get())) {
+        return false;
+      }
+      break;
+    }
+    case ast::NodeTag::UnaryExpression: {
+      auto &v = static_cast<const ast::UnaryExpression &>(node);
+      if ((v.op == "++" || v.op == "--") && !assignable(v.operand.get())) {
+        return false;
+      }
+      break;
+    }
+    case ast::NodeTag::CallExpression: {
+      const std::string *callee = ast::identifierName(
+          static_cast<const ast::CallExpression &>(node).callee.get());
+      if (!callee || pure.count(*callee) == 0) {
+        return false;
+      }
+      break;
+    }
+    case ast::NodeTag::SpawnExpression:
+    case ast::NodeTag::AwaitExpression:
+      // Tasks run concurrently with their caller and resume it later.
+      return false;
+    case ast::NodeTag::AttributeExpression: {
+      // 'a.f()' parses as an attribute whose attribute is the call 'f()'.
+      // Such a method call may change 'a', whatever 'f' names globally.
+      auto &v = static_cast<const ast::AttributeExpression &>(node);
+      if (v.attribute) {
+        for (const ast::Node &child : ast::preOrder(
+                 static_cast<const ast::Node &>(*v.attribute))) {
+          if (child.tag() == ast::NodeTag::CallExpression) {
+            return false;
+          }
+        }
+      }
+      break;
+    }
+    default:
+      break;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Collects the names a function may assign to.
+ */
+std::unordered_set<std::string>
+localsOf(const ast::FunctionDeclaration &function) {
+  std::unordered_set<std::string> locals;
+  for (const auto &parameter : function.parameters) {
+    if (parameter && parameter->identifier) {
+      locals.insert(parameter->identifier->name);
+    }
+  }
+  if (function.body) {
+    for (const ast::Node &node : ast::preOrder(
+             static_cast<const ast::Node &>(*function.body))) {
+      if (node.tag() == ast::NodeTag::VariableDeclaration) {
+        auto &v = static_cast<const ast::VariableDeclaration &>(node);
+        if (v.identifier) {
+          locals.insert(v.identifier->name);
+        }
+      }
+    }
+  }
+  return locals;
+}
+
+} // namespace
+
+PurityAnalysis::PurityAnalysis(const ast::Program &program) {
+  std::unordered_map<std::string, const ast::FunctionDeclaration *> functions;
+  std::unordered_set<std::string> overloaded;
+  for (const auto &statement : program.statements) {
+    if (statement && statement->tag() == ast::NodeTag::FunctionDeclaration) {
+      auto *function =
+          static_cast<const ast::FunctionDeclaration *>(statement.get());
+      if (!function->identifier || !function->body) {
+        continue;
+      }
+      if (!functions.emplace(function->identifier->name, function).second) {
+        overloaded.insert(function->identifier->name);
+      }
+    }
+  }
+
+  // Start by assuming every function is pure, then drop the ones whose body
+  // has a side effect until nothing changes.
+  for (const auto &[name, function] : functions) {
+    if (overloaded.count(name) == 0) {
+      this->pure_functions_.insert(name);
+    }
+  }
+  std::unordered_map<std::string, std::unordered_set<std::string>> locals;
+  for (const auto &[name, function] : functions) {
+    locals[name] = localsOf(*function);
+  }
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto it = this->pure_functions_.begin();
+         it != this->pure_functions_.end();) {
+      const auto *function = functions.at(*it);
+      if (checkPure(*function->body, this->pure_functions_, &locals[*it])) {
+        ++it;
+      } else {
+        it = this->pure_functions_.erase(it);
+        changed = true;
+      }
+    }
+  }
+}
+
+bool PurityAnalysis::isPure(const ast::Node &expression) const {
+  return expression.kind == ast::NodeKind::Expression &&
+         checkPure(expression, this->pure_functions_, nullptr);
+}
+
+} // namespace ml::analysis
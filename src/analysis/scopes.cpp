@@ -0,0 +1,132 @@
+/**
+ * @file scopes.cpp
+ * @brief Scope resolver source code for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/analysis/scopes.h"
+
+namespace ml::analysis {
+
+const ast::IdentifierExpression *memberName(const ast::Expression *member) {
+  while (member) {
+    switch (member->tag()) {
+    case ast::NodeTag::IdentifierExpression:
+      return static_cast<const ast::IdentifierExpression *>(member);
+    case ast::NodeTag::BinaryExpression:
+      member = static_cast<const ast::BinaryExpression *>(member)->left.get();
+      break;
+    case ast::NodeTag::UnaryExpression:
+      member =
+          static_cast<const ast::UnaryExpression *>(member)->operand.get();
+      break;
+    case ast::NodeTag::CallExpression:
+      member = static_cast<const ast::CallExpression *>(member)->callee.get();
+      break;
+    case ast::NodeTag::IndexExpression:
+      member = static_cast<const ast::IndexExpression *>(member)->array.get();
+      break;
+    case ast::NodeTag::AttributeExpression:
+      member =
+          static_cast<const ast::AttributeExpression *>(member)->object.get();
+      break;
+    default:
+      return nullptr;
+    }
+  }
+  return nullptr;
+}
+
+Binding *Scopes::find(const std::string &name) {
+  for (auto scope = this->scopes_.rbegin(); scope != this->scopes_.rend();
+       ++scope) {
+    for (auto binding = scope->rbegin(); binding != scope->rend(); ++binding) {
+      if (binding->declaration->identifier->name == name) {
+        return &*binding;
+      }
+    }
+  }
+  return nullptr;
+}
+
+void Scopes::attach(PassManager &manager) {
+  this->manager_ = &manager;
+  manager.onEnter<ast::Program>([this](const ast::Program &) {
+    this->scopes_.clear();
+    this->names_.clear();
+    this->references_.clear();
+    this->kinds_.clear();
+    this->push();
+  });
+  manager.onEnter<ast::FunctionDeclaration>(
+      [this](const ast::FunctionDeclaration &v) {
+        this->ignore(v.identifier.get());
+        this->ignore(v.type.get());
+        this->push();
+      });
+  manager.onEnter<ast::BlockStatement>(
+      [this](const ast::BlockStatement &) { this->push(); });
+  manager.onEnter<ast::ForConditional>(
+      [this](const ast::ForConditional &) { this->push(); });
+  manager.onLeave<ast::Program>([this](const ast::Program &) { this->pop(); });
+  manager.onLeave<ast::FunctionDeclaration>(
+      [this](const ast::FunctionDeclaration &) { this->pop(); });
+  manager.onLeave<ast::BlockStatement>(
+      [this](const ast::BlockStatement &) { this->pop(); });
+  manager.onLeave<ast::ForConditional>(
+      [this](const ast::ForConditional &) { this->pop(); });
+
+  // Declared names and type names are not references.
+  auto declaration = [this](const ast::Declaration &v) {
+    this->ignore(v.identifier.get());
+    this->ignore(v.type.get());
+  };
+  manager.onEnter<ast::Declaration>(declaration);
+  manager.onEnter<ast::VariableDeclaration>(declaration);
+  manager.onEnter<ast::RecordDeclaration>(declaration);
+  manager.onEnter<ast::ClassDeclaration>(declaration);
+  manager.onEnter<ast::AttributeExpression>(
+      [this](const ast::AttributeExpression &v) {
+        this->ignore(memberName(v.attribute.get()));
+      });
+
+  manager.onLeave<ast::VariableDeclaration>(
+      [this](const ast::VariableDeclaration &v) {
+        BindingKind kind = this->kindOf();
+        if (this->record_) {
+          this->kinds_.emplace(&v, kind);
+        }
+        if (kind != BindingKind::Field && !this->scopes_.empty()) {
+          this->scopes_.back().push_back(
+              {&v, kind, this->scopes_.size() - 1, 0});
+        }
+      });
+  manager.onEnter<ast::IdentifierExpression>(
+      [this](const ast::IdentifierExpression &v) {
+        if (this->isReference(v)) {
+          if (Binding *binding = this->find(v.name)) {
+            binding->uses++;
+            if (this->record_) {
+              this->references_.emplace(&v, binding->declaration);
+            }
+          }
+        }
+      });
+}
+
+BindingKind Scopes::kindOf() const {
+  const ast::Node *parent = this->manager_->parent();
+  switch (parent ? parent->tag() : ast::NodeTag::Program) {
+  case ast::NodeTag::Program:
+    return BindingKind::Global;
+  case ast::NodeTag::FunctionDeclaration:
+    return BindingKind::Parameter;
+  case ast::NodeTag::RecordDeclaration:
+  case ast::NodeTag::ClassDeclaration:
+    return BindingKind::Field;
+  default:
+    return BindingKind::Local;
+  }
+}
+
+} // namespace ml::analysis
@@ -0,0 +1,539 @@
+/**
+ * @file search.cpp
+ * @brief Structural code search source code for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/analysis/search.h"
+#include "ml/analysis/pass.h"
+#include "ml/ast/image.h"
+#include "ml/ast/structural.h"
+#include "ml/ast/walk.h"
+#include "ml/basic/hash.h"
+#include "ml/basic/mapped_file.h"
+#include "ml/basic/parallel.h"
+#include "ml/parser/parser.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace ml::analysis {
+
+namespace {
+
+// Metavariables are not valid ml, so parse() renames them to identifiers
+// with these prefixes first.
+const std::string META = "__ml_meta_";
+const std::string SEQUENCE = "__ml_metas_";
+
+using Slots = std::vector<std::vector<const ast::Node *>>;
+
+bool isWordChar(char c) {
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_' ||
+         (static_cast<unsigned char>(c) & 0x80) != 0;
+}
+
+bool startsWith(const std::string &text, const std::string &prefix) {
+  return text.compare(0, prefix.size(), prefix) == 0;
+}
+
+/**
+ * @brief Gets the metavariable an identifier stands for.
+ * @return The name after the prefix, or nullptr if it is not one.
+ */
+const std::string *metaName(const ast::Node &node, const std::string &prefix) {
+  if (node.tag() != ast::NodeTag::IdentifierExpression) {
+    return nullptr;
+  }
+  const auto &name = static_cast<const ast::IdentifierExpression &>(node).name;
+  return startsWith(name, prefix) ? &name : nullptr;
+}
+
+/**
+ * @brief Gets the list metavariable a pattern element stands for: a bare
+ * identifier, an expression statement or a parameter without a type.
+ */
+const std::string *sequenceName(const ast::Node &node) {
+  switch (node.tag()) {
+  case ast::NodeTag::ExpressionStatement: {
+    const auto &v = static_cast<const ast::ExpressionStatement &>(node);
+    return v.expression ? metaName(*v.expression, SEQUENCE) : nullptr;
+  }
+  case ast::NodeTag::VariableDeclaration: {
+    const auto &v = static_cast<const ast::VariableDeclaration &>(node);
+    return v.identifier && !v.initializer ? metaName(*v.identifier, SEQUENCE)
+                                          : nullptr;
+  }
+  default:
+    return metaName(node, SEQUENCE);
+  }
+}
+
+/**
+ * @brief Checks whether a pattern node was left out, and so matches anything:
+ * the implicit type of a declaration, or its default modifiers.
+ */
+bool isImplicit(const ast::Node &node) {
+  if (node.tag() == ast::NodeTag::ModifierStatement) {
+    const auto &v = static_cast<const ast::ModifierStatement &>(node);
+    return v.accessor == basic::Accessor::Private &&
+           v.modifier == basic::Modifier::None;
+  }
+  return node.tag() == ast::NodeTag::IdentifierExpression &&
+         node.start.line == 0;
+}
+
+/**
+ * @brief Compares the content of two nodes, ignoring their children.
+ */
+bool samePayload(const ast::Node &pattern, const ast::Node &node) {
+  if (pattern.tag() != node.tag()) {
+    return false;
+  }
+  switch (node.tag()) {
+  case ast::NodeTag::IdentifierExpression:
+  case ast::NodeTag::ArrayIdentifierExpression:
+    return static_cast<const ast::IdentifierExpression &>(pattern).name ==
+           static_cast<const ast::IdentifierExpression &>(node).name;
+  case ast::NodeTag::LiteralExpression:
+    return static_cast<const ast::LiteralExpression &>(pattern).value ==
+           static_cast<const ast::LiteralExpression &>(node).value;
+  case ast::NodeTag::BinaryExpression:
+    return static_cast<const ast::BinaryExpression &>(pattern).op ==
+           static_cast<const ast::BinaryExpression &>(node).op;
+  case ast::NodeTag::UnaryExpression:
+    return static_cast<const ast::UnaryExpression &>(pattern).op ==
+           static_cast<const ast::UnaryExpression &>(node).op;
+  case ast::NodeTag::ModifierStatement: {
+    const auto &a = static_cast<const ast::ModifierStatement &>(pattern);
+    const auto &b = static_cast<const ast::ModifierStatement &>(node);
+    return a.accessor == b.accessor && a.modifier == b.modifier;
+  }
+  default:
+    return true;
+  }
+}
+
+/**
+ * @brief Gets the child slots of a node in forEachSlot() order; a single
+ * child is a list of at most one node, so lists and single children match
+ * the same way.
+ */
+void slotsOf(const ast::Node &node, Slots &slots) {
+  slots.clear();
+  ast::forEachSlot(
+      node,
+      [&slots](const auto &child) {
+        slots.emplace_back();
+        if (child) {
+          slots.back().push_back(child.get());
+        }
+      },
+      [&slots](const auto &children) {
+        slots.emplace_back();
+        for (const auto &child : children) {
+          slots.back().push_back(child.get());
+        }
+      });
+}
+
+/**
+ * @class Matcher
+ * @brief Matches a pattern tree against a tree, backtracking over lists.
+ */
+class Matcher {
+private:
+  std::vector<PatternBinding> &bindings_; // Metavariables bound so far
+
+  const PatternBinding *bound(const std::string &name) const {
+    for (const auto &binding : this->bindings_) {
+      if (binding.name == name) {
+        return &binding;
+      }
+    }
+    return nullptr;
+  }
+
+  bool list(const std::vector<const ast::Node *> &pattern, size_t p,
+            const std::vector<const ast::Node *> &nodes, size_t n) {
+    if (p == pattern.size()) {
+      return n == nodes.size();
+    }
+    size_t saved = this->bindings_.size();
+    if (const std::string *name = sequenceName(*pattern[p])) {
+      // Try the shortest run first, so earlier lists bind as little as
+      // possible.
+      for (size_t end = n; end <= nodes.size(); end++) {
+        if (name->size() > SEQUENCE.size()) {
+          this->bindings_.push_back({name->substr(SEQUENCE.size()),
+                                     end > n ? nodes[n] : nullptr,
+                                     end > n ? nodes[end - 1] : nullptr});
+        }
+        if (this->list(pattern, p + 1, nodes, end)) {
+          return true;
+        }
+        this->bindings_.resize(saved);
+      }
+      return false;
+    }
+    if (n < nodes.size() && this->match(*pattern[p], *nodes[n]) &&
+        this->list(pattern, p + 1, nodes, n + 1)) {
+      return true;
+    }
+    this->bindings_.resize(saved);
+    return false;
+  }
+
+public:
+  explicit Matcher(std::vector<PatternBinding> &bindings)
+      : bindings_(bindings) {}
+
+  bool match(const ast::Node &pattern, const ast::Node &node) {
+    if (const std::string *meta = metaName(pattern, META)) {
+      std::string name = meta->substr(META.size());
+      if (name.empty() || name == "_") {
+        return true;
+      }
+      if (const PatternBinding *binding = this->bound(name)) {
+        return binding->first == binding->last && binding->first &&
+               ast::structurallyEqual(*binding->first, node);
+      }
+      this->bindings_.push_back({std::move(name), &node, &node});
+      return true;
+    }
+    if (isImplicit(pattern)) {
+      return true;
+    }
+    if (!samePayload(pattern, node)) {
+      return false;
+    }
+    Slots pattern_slots;
+    Slots node_slots;
+    slotsOf(pattern, pattern_slots);
+    slotsOf(node, node_slots);
+    if (pattern_slots.size() != node_slots.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < pattern_slots.size(); i++) {
+      if (!this->list(pattern_slots[i], 0, node_slots[i], 0)) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+/**
+ * @brief Gets the keyword that a node of a tag always starts with.
+ */
+const char *keywordOf(ast::NodeTag tag) {
+  switch (tag) {
+  case ast::NodeTag::ReturnStatement:
+    return "return";
+  case ast::NodeTag::BreakStatement:
+    return "break";
+  case ast::NodeTag::ContinueStatement:
+    return "continue";
+  case ast::NodeTag::SpawnExpression:
+    return "spawn";
+  case ast::NodeTag::AwaitExpression:
+    return "await";
+  case ast::NodeTag::FunctionDeclaration:
+    return "fn";
+  case ast::NodeTag::RecordDeclaration:
+    return "rec";
+  case ast::NodeTag::ClassDeclaration:
+    return "cls";
+  case ast::NodeTag::IfConditional:
+    return "if";
+  case ast::NodeTag::SwitchConditional:
+    return "switch";
+  case ast::NodeTag::WhileConditional:
+    return "while";
+  case ast::NodeTag::ForConditional:
+    return "for";
+  default:
+    return nullptr;
+  }
+}
+
+/**
+ * @brief Renames the metavariables of a pattern to identifiers, and adds the
+ * semicolons a pattern may leave out.
+ * @return False if a '$' is not followed by a name or "...".
+ */
+bool rewrite(const std::string &text, std::string &out) {
+  out.clear();
+  for (size_t i = 0; i < text.size(); i++) {
+    char c = text[i];
+    if (c == '"' || c == '\'') {
+      // Copy literals verbatim, escapes included.
+      size_t end = i + 1;
+      while (end < text.size() && text[end] != c) {
+        end += text[end] == '\\' ? 2 : 1;
+      }
+      out.append(text, i, end + 1 - i);
+      i = end;
+      continue;
+    }
+    if (c != '$') {
+      out += c;
+      continue;
+    }
+    bool sequence = text.compare(i + 1, 3, "...") == 0;
+    size_t start = i + 1 + (sequence ? 3 : 0);
+    size_t end = start;
+    while (end < text.size() && isWordChar(text[end])) {
+      end++;
+    }
+    if (!sequence && end == start) {
+      return false;
+    }
+    out += sequence ? SEQUENCE : META;
+    out.append(text, start, end - start);
+    i = end - 1;
+    // "{ $... }" stands for statements, so it needs no semicolon.
+    size_t next = text.find_first_not_of(" \t\r\n", end);
+    if (sequence && next != std::string::npos && text[next] == '}') {
+      out += ';';
+    }
+  }
+  // Neither does the pattern itself.
+  size_t last = out.find_last_not_of(" \t\r\n");
+  if (last != std::string::npos && out[last] != ';' && out[last] != '}') {
+    out += ';';
+  }
+  return true;
+}
+
+/**
+ * @brief Gets the source text of a byte range, clamped to the source.
+ */
+std::string slice(std::string_view source, size_t start, size_t end) {
+  start = std::min(start, source.size());
+  end = std::min(std::max(start, end), source.size());
+  return std::string(source.substr(start, end - start));
+}
+
+/**
+ * @brief Gets the line holding a byte offset, without its newline.
+ */
+std::string_view lineAt(std::string_view source, size_t index) {
+  index = std::min(index, source.size());
+  size_t begin = source.rfind('\n', index == 0 ? 0 : index - 1);
+  begin = begin == std::string_view::npos || index == 0 ? 0 : begin + 1;
+  size_t end = source.find('\n', begin);
+  return source.substr(begin, end == std::string_view::npos
+                                  ? std::string_view::npos
+                                  : end - begin);
+}
+
+/**
+ * @brief Searches one parsed file.
+ */
+void searchProgram(const ast::Program &program, const std::string &path,
+                   std::string_view source, const StructuralPattern &pattern,
+                   const StructuralPattern *inside,
+                   std::vector<SearchMatch> &matches) {
+  PassManager manager;
+  std::vector<const ast::Node *> scopes; // Enclosing nodes matching inside
+  ast::NodeTag root = pattern.rootTag();
+  std::vector<PatternBinding> bindings;
+
+  manager.onEnter<ast::Node>([&](const ast::Node &node) {
+    if (inside && inside->match(node)) {
+      scopes.push_back(&node);
+    }
+    if ((root != ast::NodeTag::Node && node.tag() != root) ||
+        (inside && scopes.empty())) {
+      return;
+    }
+    bindings.clear();
+    if (!pattern.match(node, &bindings)) {
+      return;
+    }
+    SearchMatch match;
+    match.path = path;
+    match.start = node.start;
+    match.end = node.end;
+    match.line = std::string(lineAt(source, node.start.index));
+    for (const auto &binding : bindings) {
+      match.bindings.emplace_back(
+          binding.name,
+          binding.first ? slice(source, binding.first->start.index,
+                                binding.last->end.index)
+                        : std::string());
+    }
+    matches.push_back(std::move(match));
+  });
+  if (inside) {
+    manager.onLeave<ast::Node>([&scopes](const ast::Node &node) {
+      if (!scopes.empty() && scopes.back() == &node) {
+        scopes.pop_back();
+      }
+    });
+  }
+  manager.run(program);
+}
+
+} // namespace
+
+bool StructuralPattern::parse(const std::string &text) {
+  this->program_.reset();
+  this->root_ = nullptr;
+  this->tags_ = 0;
+  this->words_.clear();
+  this->error_.clear();
+
+  std::string source;
+  if (!rewrite(text, source)) {
+    this->error_ = "'$' must be followed by a name or '...'";
+    return false;
+  }
+  parser::Parser parser;
+  this->program_ = parser.parse(source);
+  if (!this->program_ || parser.errors() > 0) {
+    this->error_ = "The pattern is not valid ml";
+    return false;
+  }
+  if (this->program_->statements.size() != 1) {
+    this->error_ = "The pattern must be a single statement or expression";
+    return false;
+  }
+
+  const ast::Statement &statement = *this->program_->statements[0];
+  this->root_ = &statement;
+  if (statement.tag() == ast::NodeTag::ExpressionStatement) {
+    const auto &v = static_cast<const ast::ExpressionStatement &>(statement);
+    this->root_ = v.expression.get();
+  }
+
+  // Collect what every match must contain, skipping metavariables and the
+  // nodes that match anything.
+  std::vector<const ast::Node *> stack{this->root_};
+  while (!stack.empty()) {
+    const ast::Node &node = *stack.back();
+    stack.pop_back();
+    if (metaName(node, META) || sequenceName(node) || isImplicit(node)) {
+      continue;
+    }
+    this->tags_ |= uint64_t(1) << static_cast<size_t>(node.tag());
+    if (node.tag() == ast::NodeTag::IdentifierExpression ||
+        node.tag() == ast::NodeTag::ArrayIdentifierExpression) {
+      this->words_.push_back(
+          static_cast<const ast::IdentifierExpression &>(node).name);
+    } else if (const char *keyword = keywordOf(node.tag())) {
+      this->words_.emplace_back(keyword);
+    }
+    ast::forEachChild(node, [&stack](const ast::Node &child) {
+      stack.push_back(&child);
+    });
+  }
+  std::sort(this->words_.begin(), this->words_.end());
+  this->words_.erase(std::unique(this->words_.begin(), this->words_.end()),
+                     this->words_.end());
+  return true;
+}
+
+bool StructuralPattern::match(const ast::Node &node,
+                              std::vector<PatternBinding> *bindings) const {
+  if (!this->root_) {
+    return false;
+  }
+  std::vector<PatternBinding> local;
+  std::vector<PatternBinding> &out = bindings ? *bindings : local;
+  out.clear();
+  return Matcher(out).match(*this->root_, node);
+}
+
+bool StructuralPattern::mayMatchText(std::string_view source) const {
+  for (const auto &word : this->words_) {
+    if (source.find(word) == std::string_view::npos) {
+      return false;
+    }
+  }
+  return true;
+}
+
+ast::NodeTag StructuralPattern::rootTag() const {
+  if (!this->root_ || metaName(*this->root_, META)) {
+    return ast::NodeTag::Node;
+  }
+  return this->root_->tag();
+}
+
+SearchSummary searchFiles(const std::vector<std::string> &sources,
+                          const StructuralPattern &pattern,
+                          const StructuralPattern *inside, unsigned jobs) {
+  enum Outcome : uint8_t { Skipped, Cached, Parsed, Failed };
+  std::vector<Outcome> outcomes(sources.size(), Skipped);
+  std::vector<std::vector<SearchMatch>> matches(sources.size());
+  basic::parallelFor(
+      sources.size(), jobs == 0 ? basic::defaultJobs() : jobs, [&](size_t i) {
+        basic::MappedFile file;
+        if (!file.open(sources[i])) {
+          outcomes[i] = Failed;
+          return;
+        }
+        std::string_view source = file.view();
+        if (!pattern.mayMatchText(source) ||
+            (inside && !inside->mayMatchText(source))) {
+          return;
+        }
+
+        std::unique_ptr<ast::Program> program;
+        ast::AstImage image;
+        if (image.open(sources[i] + "i") &&
+            image.sourceHash() == basic::fnv1a(source)) {
+          // The node kinds of an image are read in place, so a file that
+          // cannot match is rejected without building its tree.
+          uint64_t tags = 0;
+          for (uint32_t id = 0; id < image.nodeCount(); id++) {
+            tags |= uint64_t(1) << image.node(id).tag;
+          }
+          if (!pattern.mayMatchTags(tags) ||
+              (inside && !inside->mayMatchTags(tags))) {
+            return;
+          }
+          program = image.materialize();
+          outcomes[i] = Cached;
+        }
+        if (!program) {
+          parser::Parser parser;
+          program = parser.parse(std::string(source));
+          if (!program || parser.errors() > 0) {
+            outcomes[i] = Failed;
+            return;
+          }
+          outcomes[i] = Parsed;
+        }
+        searchProgram(*program, sources[i], source, pattern, inside,
+                      matches[i]);
+      });
+
+  SearchSummary summary;
+  summary.files = sources.size();
+  for (size_t i = 0; i < sources.size(); i++) {
+    switch (outcomes[i]) {
+    case Skipped:
+      summary.skipped++;
+      break;
+    case Cached:
+      summary.cached++;
+      break;
+    case Parsed:
+      summary.parsed++;
+      break;
+    case Failed:
+      summary.failed++;
+      summary.errors.push_back(sources[i]);
+      break;
+    }
+    for (auto &match : matches[i]) {
+      summary.matches.push_back(std::move(match));
+    }
+  }
+  return summary;
+}
+
+} // namespace ml::analysis
@@ -0,0 +1,799 @@
+/**
+ * @file semantic_tokens.cpp
+ * @brief Semantic token source code for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/analysis/semantic_tokens.h"
+#include "ml/analysis/pass.h"
+#include "ml/analysis/scopes.h"
+#include "ml/ast/ast.h"
+#include "ml/basic/accessor.h"
+#include "ml/basic/flags.h"
+#include "ml/basic/modifier.h"
+#include "ml/lexer/lexer.h"
+#include "ml/parser/parser.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace ml::analysis {
+
+namespace {
+
+constexpr uint32_t DECLARATION =
+    1u << static_cast<unsigned>(SemanticTokenModifier::Declaration);
+constexpr uint32_t READONLY =
+    1u << static_cast<unsigned>(SemanticTokenModifier::Readonly);
+
+/**
+ * @struct Lexeme semantic_tokens.cpp
+ * @brief A token or comment of a statement.
+ */
+struct Lexeme {
+  uint32_t offset;        // Offset in the statement
+  uint32_t length;        // Length in bytes
+  SemanticTokenType type; // The kind, unless name or plain is set
+  bool name;              // Whether it is a name to resolve
+  bool plain;             // Whether it is not highlighted, like delimiters
+
+  bool isComment() const {
+    return !this->name && !this->plain &&
+           this->type == SemanticTokenType::Comment;
+  }
+};
+
+/**
+ * @brief Adds the comments in a trivia, at their offsets in the text.
+ */
+void addComments(std::string_view trivia, size_t base,
+                 std::vector<Lexeme> &out) {
+  size_t i = 0;
+  while (i + 1 < trivia.size()) {
+    if (trivia[i] != '/' || (trivia[i + 1] != '/' && trivia[i + 1] != '*')) {
+      i++;
+      continue;
+    }
+    size_t end = lexer::commentEnd(trivia, i);
+    out.push_back({static_cast<uint32_t>(base + i),
+                   static_cast<uint32_t>(end - i), SemanticTokenType::Comment,
+                   false, false});
+    i = end;
+  }
+}
+
+/**
+ * @brief Lexes a text into lexemes.
+ * @param text The text.
+ * @param clean Set to false if the lexer reported an error.
+ * @details The lexer stops at a character it does not know; lexing resumes
+ * after it, so the rest of the text is still highlighted.
+ */
+std::vector<Lexeme> lexText(const std::string &text, bool &clean) {
+  std::vector<Lexeme> lexemes;
+  clean = true;
+  size_t base = 0;
+  while (base <= text.size()) {
+    lexer::Lexer lexer("");
+    lexer.keepTrivia(true);
+    auto tokens = lexer.lex(text.substr(base));
+    clean = clean && lexer.errors() == 0;
+    size_t resume = std::string::npos;
+    for (size_t i = 0; i < tokens.size(); i++) {
+      std::string_view trivia = lexer.leadingTrivia(i);
+      addComments(trivia, base + (trivia.data() - lexer.source().data()),
+                  lexemes);
+      const lexer::Token &token = *tokens[i];
+      Lexeme lexeme{static_cast<uint32_t>(base + token.start.index),
+                    static_cast<uint32_t>(token.end.index - token.start.index),
+                    SemanticTokenType::Keyword, false, false};
+      switch (token.kind) {
+      case lexer::TokenKind::Keyword:
+      case lexer::TokenKind::Boolean:
+        break;
+      case lexer::TokenKind::Integer:
+      case lexer::TokenKind::Float:
+        lexeme.type = SemanticTokenType::Number;
+        break;
+      case lexer::TokenKind::Character:
+      case lexer::TokenKind::String:
+        lexeme.type = SemanticTokenType::String;
+        break;
+      case lexer::TokenKind::Operator:
+        lexeme.type = SemanticTokenType::Operator;
+        break;
+      case lexer::TokenKind::Identifier:
+        lexeme.name = true;
+        break;
+      case lexer::TokenKind::None:
+        // Skip the unknown character, with its UTF-8 continuation bytes.
+        resume = base + token.start.index + 1;
+        while (resume < text.size() &&
+               (static_cast<unsigned char>(text[resume]) & 0xC0) == 0x80) {
+          resume++;
+        }
+        lexeme.length = static_cast<uint32_t>(resume - lexeme.offset);
+        lexeme.plain = true;
+        break;
+      default:
+        lexeme.plain = true;
+        break;
+      }
+      if (token.kind != lexer::TokenKind::Eof) {
+        lexemes.push_back(lexeme);
+      }
+    }
+    if (resume == std::string::npos) {
+      break;
+    }
+    base = resume;
+  }
+  return lexemes;
+}
+
+bool isConst(const ast::Declaration &declaration) {
+  return declaration.modifier &&
+         basic::hasFlag(declaration.modifier->modifier,
+                        basic::Modifier::Constant);
+}
+
+/**
+ * @brief Counts the UTF-16 code units a UTF-8 byte starts.
+ */
+uint32_t utf16Units(char c) {
+  auto byte = static_cast<unsigned char>(c);
+  if ((byte & 0xC0) == 0x80) {
+    return 0;
+  }
+  return byte >= 0xF0 ? 2 : 1;
+}
+
+} // namespace
+
+/**
+ * @struct SemanticDocument::Chunk semantic_tokens.cpp
+ * @brief A top-level statement, with what it leads and trails.
+ */
+struct SemanticDocument::Chunk {
+  size_t offset = 0;                     // Start in the source
+  size_t length = 0;                     // Length in bytes
+  std::vector<Lexeme> lexemes;           // Tokens and comments, in order
+  std::unique_ptr<ast::Program> program; // Null if it does not parse
+  std::vector<std::pair<std::string, Symbol>> exports; // Declared names
+  std::vector<std::string> free;     // Names looked up in globals_, sorted
+  std::vector<SemanticToken> tokens; // Relative to the start of the chunk
+  uint32_t newlines = 0;             // Newlines in the chunk
+  uint32_t tail = 0;                 // UTF-16 width after the last newline
+};
+
+/**
+ * @class SemanticDocument::Classifier semantic_tokens.cpp
+ * @brief Decides how the names of a statement are highlighted.
+ * @details Added after the scope resolver, like the lint rules.
+ */
+class SemanticDocument::Classifier : public Pass {
+private:
+  const SemanticDocument &document_;              // The document
+  const Scopes &scopes_;                          // The scope resolver
+  PassManager *manager_ = nullptr;                // The running manager
+  std::unordered_map<uint32_t, Symbol> &symbols_; // Names by offset
+  std::vector<std::string> &free_;                // Unresolved names
+
+  void mark(const ast::Node *node, SemanticTokenType type,
+            uint32_t modifiers = 0) {
+    // Synthesized nodes, like the void type of an untyped declaration,
+    // have no location.
+    if (node && node->start.line != 0) {
+      this->symbols_[static_cast<uint32_t>(node->start.index)] = {type,
+                                                                  modifiers};
+    }
+  }
+
+  void markType(const ast::Expression *type) {
+    if (type && (type->tag() == ast::NodeTag::IdentifierExpression ||
+                 type->tag() == ast::NodeTag::ArrayIdentifierExpression)) {
+      this->mark(type, SemanticTokenType::Type);
+    }
+  }
+
+  bool isCallee(const ast::IdentifierExpression &identifier) const {
+    const ast::Node *parent = this->manager_->parent();
+    return parent && parent->tag() == ast::NodeTag::CallExpression &&
+           static_cast<const ast::CallExpression *>(parent)->callee.get() ==
+               &identifier;
+  }
+
+public:
+  Classifier(const SemanticDocument &document, const Scopes &scopes,
+             std::unordered_map<uint32_t, Symbol> &symbols,
+             std::vector<std::string> &free)
+      : document_(document), scopes_(scopes), symbols_(symbols),
+        free_(free) {}
+
+  std::string name() const override { return "classifier"; }
+
+  void attach(PassManager &manager) override {
+    this->manager_ = &manager;
+    manager.onEnter<ast::FunctionDeclaration>(
+        [this](const ast::FunctionDeclaration &v) {
+          this->mark(v.identifier.get(), SemanticTokenType::Function,
+                     DECLARATION);
+          this->markType(v.type.get());
+        });
+    auto type = [this](const ast::Declaration &v) {
+      this->mark(v.identifier.get(), SemanticTokenType::Type, DECLARATION);
+    };
+    manager.onEnter<ast::RecordDeclaration>(type);
+    manager.onEnter<ast::ClassDeclaration>(type);
+    manager.onEnter<ast::Declaration>(
+        [this](const ast::Declaration &v) { this->markType(v.type.get()); });
+    manager.onEnter<ast::VariableDeclaration>(
+        [this](const ast::VariableDeclaration &v) {
+          this->markType(v.type.get());
+        });
+    manager.onLeave<ast::VariableDeclaration>(
+        [this](const ast::VariableDeclaration &v) {
+          uint32_t modifiers = DECLARATION | (isConst(v) ? READONLY : 0);
+          switch (this->scopes_.kindOf()) {
+          case BindingKind::Field:
+            this->mark(v.identifier.get(), SemanticTokenType::Property,
+                       modifiers);
+            break;
+          case BindingKind::Parameter:
+            this->mark(v.identifier.get(), SemanticTokenType::Parameter,
+                       modifiers);
+            break;
+          default:
+            this->mark(v.identifier.get(), SemanticTokenType::Variable,
+                       modifiers);
+            break;
+          }
+        });
+
+    // A member is a field, or a method when it is called.
+    manager.onEnter<ast::AttributeExpression>(
+        [this](const ast::AttributeExpression &v) {
+          const ast::Expression *member = v.attribute.get();
+          bool called = false;
+          while (member &&
+                 member->tag() != ast::NodeTag::IdentifierExpression) {
+            called = member->tag() == ast::NodeTag::CallExpression;
+            switch (member->tag()) {
+            case ast::NodeTag::CallExpression:
+              member = static_cast<const ast::CallExpression *>(member)
+                           ->callee.get();
+              break;
+            case ast::NodeTag::BinaryExpression:
+              member = static_cast<const ast::BinaryExpression *>(member)
+                           ->left.get();
+              break;
+            case ast::NodeTag::UnaryExpression:
+              member = static_cast<const ast::UnaryExpression *>(member)
+                           ->operand.get();
+              break;
+            case ast::NodeTag::IndexExpression:
+              member = static_cast<const ast::IndexExpression *>(member)
+                           ->array.get();
+              break;
+            case ast::NodeTag::AttributeExpression:
+              member = static_cast<const ast::AttributeExpression *>(member)
+                           ->object.get();
+              break;
+            default:
+              member = nullptr;
+              break;
+            }
+          }
+          this->mark(member,
+                     called ? SemanticTokenType::Function
+                            : SemanticTokenType::Property);
+        });
+
+    manager.onEnter<ast::IdentifierExpression>(
+        [this](const ast::IdentifierExpression &v) {
+          if (!this->scopes_.isReference(v)) {
+            return;
+          }
+          if (const Binding *binding = this->scopes_.lookup(v.name)) {
+            this->mark(&v,
+                       binding->kind == BindingKind::Parameter
+                           ? SemanticTokenType::Parameter
+                           : SemanticTokenType::Variable,
+                       isConst(*binding->declaration) ? READONLY : 0);
+            return;
+          }
+          this->free_.push_back(v.name);
+          auto it = this->document_.globals_.find(v.name);
+          if (it != this->document_.globals_.end()) {
+            this->mark(&v, it->second.type, it->second.modifiers);
+          } else {
+            this->mark(&v,
+                       this->isCallee(v) ? SemanticTokenType::Function
+                                         : SemanticTokenType::Variable);
+          }
+        });
+  }
+};
+
+const std::vector<std::string> &semanticTokenTypes() {
+  static const std::vector<std::string> names = {
+      "keyword",  "function", "type",   "property", "parameter",
+      "variable", "string",   "number", "operator", "comment"};
+  return names;
+}
+
+const std::vector<std::string> &semanticTokenModifiers() {
+  static const std::vector<std::string> names = {"declaration", "readonly"};
+  return names;
+}
+
+std::vector<uint32_t> encodeSemanticTokens(
+    const std::vector<SemanticToken> &tokens) {
+  std::vector<uint32_t> data;
+  data.reserve(tokens.size() * 5);
+  uint32_t line = 0;
+  uint32_t column = 0;
+  for (const auto &token : tokens) {
+    data.push_back(token.line - line);
+    data.push_back(token.line == line ? token.column - column : token.column);
+    data.push_back(token.length);
+    data.push_back(static_cast<uint32_t>(token.type));
+    data.push_back(token.modifiers);
+    line = token.line;
+    column = token.column;
+  }
+  return data;
+}
+
+SemanticTokensEdit diffSemanticTokens(const std::vector<uint32_t> &previous,
+                                      const std::vector<uint32_t> &current) {
+  size_t shorter = std::min(previous.size(), current.size());
+  size_t prefix = 0;
+  while (prefix < shorter && previous[prefix] == current[prefix]) {
+    prefix++;
+  }
+  prefix -= prefix % 5;
+  size_t suffix = 0;
+  while (suffix < shorter - prefix &&
+         previous[previous.size() - 1 - suffix] ==
+             current[current.size() - 1 - suffix]) {
+    suffix++;
+  }
+  suffix -= suffix % 5;
+
+  SemanticTokensEdit edit;
+  edit.start = static_cast<uint32_t>(prefix);
+  edit.delete_count = static_cast<uint32_t>(previous.size() - prefix - suffix);
+  edit.data.assign(current.begin() + static_cast<std::ptrdiff_t>(prefix),
+                   current.end() - static_cast<std::ptrdiff_t>(suffix));
+  return edit;
+}
+
+SemanticDocument::SemanticDocument(std::string source) {
+  this->open(std::move(source));
+}
+
+SemanticDocument::~SemanticDocument() = default;
+
+SemanticDocument::SemanticDocument(SemanticDocument &&) noexcept = default;
+
+SemanticDocument &
+SemanticDocument::operator=(SemanticDocument &&) noexcept = default;
+
+std::vector<std::unique_ptr<SemanticDocument::Chunk>>
+SemanticDocument::split(size_t offset, size_t length, bool &complete) const {
+  std::string text = this->source_.substr(offset, length);
+  bool clean = true;
+  std::vector<Lexeme> lexemes = lexText(text, clean);
+
+  // Find the ends of the statements: a semicolon or closing brace outside
+  // any brackets, unless an elif or else continues the statement.
+  auto isBranch = [&](size_t i) {
+    while (i < lexemes.size() && lexemes[i].isComment()) {
+      i++;
+    }
+    if (i == lexemes.size()) {
+      return false;
+    }
+    std::string_view word(text.data() + lexemes[i].offset, lexemes[i].length);
+    return word == "elif" || word == "else";
+  };
+  std::vector<size_t> ends;
+  size_t depth = 0;
+  for (size_t i = 0; i < lexemes.size(); i++) {
+    const Lexeme &lexeme = lexemes[i];
+    if (!lexeme.plain || lexeme.length != 1) {
+      continue;
+    }
+    char c = text[lexeme.offset];
+    if (c == '(' || c == '[' || c == '{') {
+      depth++;
+    } else if (c == ')' || c == ']' || c == '}') {
+      depth -= depth > 0;
+    }
+    if (depth == 0 && (c == ';' || (c == '}' && !isBranch(i + 1)))) {
+      ends.push_back(lexeme.offset + 1);
+    }
+  }
+  size_t last = ends.empty() ? 0 : ends.back();
+  if (last < text.size()) {
+    ends.push_back(text.size());
+  }
+  complete = clean && depth == 0 && last == text.size();
+
+  std::vector<std::unique_ptr<Chunk>> chunks;
+  chunks.reserve(ends.size());
+  size_t start = 0;
+  size_t next = 0;
+  for (size_t end : ends) {
+    auto chunk = std::make_unique<Chunk>();
+    chunk->offset = offset + start;
+    chunk->length = end - start;
+    for (; next < lexemes.size() && lexemes[next].offset < end; next++) {
+      Lexeme lexeme = lexemes[next];
+      lexeme.offset -= static_cast<uint32_t>(start);
+      chunk->lexemes.push_back(lexeme);
+    }
+    chunks.push_back(std::move(chunk));
+    start = end;
+  }
+  return chunks;
+}
+
+size_t SemanticDocument::chunkAt(size_t offset) const {
+  auto it = std::upper_bound(
+      this->chunks_.begin(), this->chunks_.end(), offset,
+      [](size_t offset, const auto &chunk) { return offset < chunk->offset; });
+  return it == this->chunks_.begin()
+             ? 0
+             : static_cast<size_t>(it - this->chunks_.begin()) - 1;
+}
+
+void SemanticDocument::parse(Chunk &chunk) const {
+  std::string text = this->source_.substr(chunk.offset, chunk.length);
+  parser::Parser parser;
+  chunk.program = parser.parse(text);
+  if (parser.errors() > 0) {
+    chunk.program.reset();
+  }
+
+  chunk.exports.clear();
+  if (chunk.program) {
+    for (const auto &statement : chunk.program->statements) {
+      auto &v = static_cast<const ast::Declaration &>(*statement);
+      switch (statement->tag()) {
+      case ast::NodeTag::FunctionDeclaration:
+        chunk.exports.push_back(
+            {v.identifier->name, {SemanticTokenType::Function, 0}});
+        break;
+      case ast::NodeTag::RecordDeclaration:
+      case ast::NodeTag::ClassDeclaration:
+        chunk.exports.push_back(
+            {v.identifier->name, {SemanticTokenType::Type, 0}});
+        break;
+      case ast::NodeTag::VariableDeclaration:
+        chunk.exports.push_back(
+            {v.identifier->name,
+             {SemanticTokenType::Variable, isConst(v) ? READONLY : 0}});
+        break;
+      default:
+        break;
+      }
+    }
+  }
+
+  chunk.newlines = 0;
+  chunk.tail = 0;
+  for (char c : text) {
+    if (c == '\n') {
+      chunk.newlines++;
+      chunk.tail = 0;
+    } else {
+      chunk.tail += utf16Units(c);
+    }
+  }
+}
+
+void SemanticDocument::classify(Chunk &chunk) const {
+  std::unordered_map<uint32_t, Symbol> symbols;
+  chunk.free.clear();
+  if (chunk.program) {
+    PassManager manager;
+    auto &scopes = manager.emplace<Scopes>();
+    manager.emplace<Classifier>(*this, scopes, symbols, chunk.free);
+    manager.run(*chunk.program);
+  }
+
+  const char *text = this->source_.data() + chunk.offset;
+  uint32_t line = 0;
+  uint32_t column = 0;
+  size_t index = 0;
+  chunk.tokens.clear();
+  for (const Lexeme &lexeme : chunk.lexemes) {
+    if (lexeme.plain) {
+      continue;
+    }
+    Symbol symbol{lexeme.type, 0};
+    if (lexeme.name) {
+      auto it = symbols.find(lexeme.offset);
+      std::string word(text + lexeme.offset, lexeme.length);
+      if (it != symbols.end()) {
+        symbol = it->second;
+      } else if (basic::ismod(word) || basic::isacc(word)) {
+        symbol = {SemanticTokenType::Keyword, 0};
+      } else {
+        // Not resolved from the tree, as in a statement that does not
+        // parse: go by the global names.
+        auto global = this->globals_.find(word);
+        symbol = global != this->globals_.end()
+                     ? global->second
+                     : Symbol{SemanticTokenType::Variable, 0};
+        chunk.free.push_back(std::move(word));
+      }
+    }
+
+    // Move to the token, then add one token per line it covers.
+    for (; index < lexeme.offset; index++) {
+      if (text[index] == '\n') {
+        line++;
+        column = 0;
+      } else {
+        column += utf16Units(text[index]);
+      }
+    }
+    uint32_t start = column;
+    for (; index < lexeme.offset + lexeme.length; index++) {
+      if (text[index] == '\n') {
+        if (column > start) {
+          chunk.tokens.push_back(
+              {line, start, column - start, symbol.type, symbol.modifiers});
+        }
+        line++;
+        column = 0;
+        start = 0;
+      } else {
+        column += utf16Units(text[index]);
+      }
+    }
+    if (column > start) {
+      chunk.tokens.push_back(
+          {line, start, column - start, symbol.type, symbol.modifiers});
+    }
+  }
+
+  std::sort(chunk.free.begin(), chunk.free.end());
+  chunk.free.erase(std::unique(chunk.free.begin(), chunk.free.end()),
+                   chunk.free.end());
+}
+
+void SemanticDocument::collectGlobals() {
+  this->globals_.clear();
+  for (const auto &chunk : this->chunks_) {
+    for (const auto &[name, symbol] : chunk->exports) {
+      this->globals_.emplace(name, symbol);
+    }
+  }
+}
+
+SemanticUpdate SemanticDocument::open(std::string source) {
+  this->source_ = std::move(source);
+  bool complete = true;
+  this->chunks_ = this->split(0, this->source_.size(), complete);
+  if (this->chunks_.empty()) {
+    this->chunks_.push_back(std::make_unique<Chunk>());
+  }
+
+  SemanticUpdate update;
+  for (auto &chunk : this->chunks_) {
+    this->parse(*chunk);
+    update.parsed++;
+  }
+  update.bytes = this->source_.size();
+  this->collectGlobals();
+  for (auto &chunk : this->chunks_) {
+    this->classify(*chunk);
+  }
+  return update;
+}
+
+SemanticUpdate SemanticDocument::edit(size_t offset, size_t length,
+                                      std::string_view text) {
+  offset = std::min(offset, this->source_.size());
+  length = std::min(length, this->source_.size() - offset);
+  this->source_.replace(offset, length, text);
+  auto shift = [&](size_t old) { return old - length + text.size(); };
+  // Should the cached statements stop matching the source, tokens would be
+  // reported at the wrong places: tokenize everything again instead.
+  auto restart = [this]() {
+    std::string source = std::move(this->source_);
+    return this->open(std::move(source));
+  };
+
+  // The statements the edit overlaps, and the one before them, in case the
+  // edit continues it with elif or else.
+  size_t first = this->chunkAt(offset);
+  size_t last = std::max(first, length == 0
+                                    ? first
+                                    : this->chunkAt(offset + length - 1));
+  first -= first > 0;
+
+  // Grow the range until it ends where a statement ends. Offsets past the
+  // edit are still those of the old source.
+  size_t begin = this->chunks_[first]->offset;
+  std::vector<std::unique_ptr<Chunk>> fresh;
+  size_t grow = 1;
+  while (true) {
+    const Chunk &end = *this->chunks_[last];
+    bool complete = true;
+    fresh = this->split(begin, shift(end.offset + end.length) - begin,
+                        complete);
+    if (last + 1 == this->chunks_.size()) {
+      break;
+    }
+    if (complete) {
+      const Chunk &next = *this->chunks_[last + 1];
+      auto lexeme = std::find_if(
+          next.lexemes.begin(), next.lexemes.end(),
+          [](const Lexeme &lexeme) { return !lexeme.isComment(); });
+      std::string_view word;
+      if (lexeme != next.lexemes.end()) {
+        size_t at = shift(next.offset) + lexeme->offset;
+        if (next.offset < offset + length ||
+            at + lexeme->length > this->source_.size()) {
+          return restart();
+        }
+        word = std::string_view(this->source_).substr(at, lexeme->length);
+      }
+      if (word != "elif" && word != "else") {
+        break;
+      }
+    }
+    last = std::min(this->chunks_.size() - 1, last + grow);
+    grow *= 2;
+  }
+
+  SemanticUpdate update;
+  std::vector<std::pair<std::string, Symbol>> removed;
+  for (size_t i = first; i <= last; i++) {
+    auto &exports = this->chunks_[i]->exports;
+    std::move(exports.begin(), exports.end(), std::back_inserter(removed));
+  }
+  std::vector<std::pair<std::string, Symbol>> added;
+  for (auto &chunk : fresh) {
+    this->parse(*chunk);
+    update.parsed++;
+    update.bytes += chunk->length;
+    added.insert(added.end(), chunk->exports.begin(), chunk->exports.end());
+  }
+  for (size_t i = last + 1; i < this->chunks_.size(); i++) {
+    this->chunks_[i]->offset = shift(this->chunks_[i]->offset);
+  }
+  size_t count = fresh.size();
+  auto at = this->chunks_.begin() + static_cast<std::ptrdiff_t>(first);
+  at = this->chunks_.erase(at, at + static_cast<std::ptrdiff_t>(last + 1 -
+                                                                first));
+  this->chunks_.insert(at, std::make_move_iterator(fresh.begin()),
+                       std::make_move_iterator(fresh.end()));
+  if (this->chunks_.empty()) {
+    this->chunks_.push_back(std::make_unique<Chunk>());
+  }
+  size_t covered = 0;
+  for (const auto &chunk : this->chunks_) {
+    if (chunk->offset != covered) {
+      return restart();
+    }
+    covered += chunk->length;
+  }
+  if (covered != this->source_.size()) {
+    return restart();
+  }
+
+  // Names whose global declarations changed, which other statements may
+  // use.
+  auto order = [](const auto &a, const auto &b) {
+    if (a.first != b.first) {
+      return a.first < b.first;
+    }
+    if (a.second.type != b.second.type) {
+      return a.second.type < b.second.type;
+    }
+    return a.second.modifiers < b.second.modifiers;
+  };
+  std::sort(removed.begin(), removed.end(), order);
+  std::sort(added.begin(), added.end(), order);
+  std::vector<std::pair<std::string, Symbol>> changes;
+  std::set_symmetric_difference(removed.begin(), removed.end(), added.begin(),
+                                added.end(), std::back_inserter(changes),
+                                order);
+  std::vector<std::string> changed;
+  for (auto &change : changes) {
+    changed.push_back(std::move(change.first));
+  }
+  changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+  if (!changed.empty()) {
+    this->collectGlobals();
+  }
+  for (size_t i = 0; i < this->chunks_.size(); i++) {
+    Chunk &chunk = *this->chunks_[i];
+    if (i >= first && i < first + count) {
+      this->classify(chunk);
+    } else if (!changed.empty()) {
+      // Both lists are sorted.
+      auto a = chunk.free.begin();
+      auto b = changed.begin();
+      while (a != chunk.free.end() && b != changed.end() && *a != *b) {
+        if (*a < *b) {
+          ++a;
+        } else {
+          ++b;
+        }
+      }
+      if (a != chunk.free.end() && b != changed.end()) {
+        this->classify(chunk);
+        update.reclassified++;
+      }
+    }
+  }
+  return update;
+}
+
+size_t SemanticDocument::offsetAt(uint32_t line, uint32_t column) const {
+  // Start from the last statement that starts before the position.
+  uint32_t chunk_line = 0;
+  uint32_t chunk_column = 0;
+  size_t offset = 0;
+  uint32_t at_line = 0;
+  uint32_t at_column = 0;
+  for (const auto &chunk : this->chunks_) {
+    if (chunk_line > line || (chunk_line == line && chunk_column > column)) {
+      break;
+    }
+    offset = chunk->offset;
+    at_line = chunk_line;
+    at_column = chunk_column;
+    if (chunk->newlines > 0) {
+      chunk_line += chunk->newlines;
+      chunk_column = chunk->tail;
+    } else {
+      chunk_column += chunk->tail;
+    }
+  }
+
+  for (; offset < this->source_.size(); offset++) {
+    char c = this->source_[offset];
+    if (at_line == line && (at_column >= column || c == '\n')) {
+      return offset;
+    }
+    if (c == '\n') {
+      at_line++;
+      at_column = 0;
+    } else {
+      at_column += utf16Units(c);
+    }
+  }
+  return offset;
+}
+
+std::vector<SemanticToken> SemanticDocument::tokens() const {
+  std::vector<SemanticToken> tokens;
+  uint32_t line = 0;
+  uint32_t column = 0;
+  for (const auto &chunk : this->chunks_) {
+    for (const auto &token : chunk->tokens) {
+      tokens.push_back({line + token.line,
+                        token.line == 0 ? column + token.column
+                                        : token.column,
+                        token.length, token.type, token.modifiers});
+    }
+    if (chunk->newlines > 0) {
+      line += chunk->newlines;
+      column = chunk->tail;
+    } else {
+      column += chunk->tail;
+    }
+  }
+  return tokens;
+}
+
+} // namespace ml::analysis
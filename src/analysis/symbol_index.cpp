@@ -0,0 +1,503 @@
+/**
+ * @file symbol_index.cpp
+ * @brief Project-wide symbol index source code for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/analysis/symbol_index.h"
+#include "ml/basic/hash.h"
+#include "ml/basic/parallel.h"
+#include "ml/parser/parser.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <unordered_map>
+
+namespace ml::analysis {
+
+namespace {
+
+/**
+ * @brief Where a declaration appears, which decides its SymbolKind.
+ */
+enum class Scope { Global, Type, Local };
+
+constexpr char INDEX_MAGIC[8] = {'M', 'L', 'I', 'N', 'D', 'E', 'X', '\0'};
+constexpr uint32_t INDEX_VERSION = 1;
+
+// On-disk layout. Every section starts on an 8-byte boundary and refers to
+// others through offsets, so the mapped file can be read in place.
+
+struct IndexHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t file_count;
+  uint32_t symbol_count;
+  uint32_t occurrence_count;
+  uint64_t files_offset;
+  uint64_t symbols_offset;
+  uint64_t occurrences_offset;
+  uint64_t strings_offset;
+  uint64_t strings_size;
+};
+
+struct IndexFileRecord {
+  uint32_t path_offset;
+  uint32_t path_length;
+  uint64_t hash;
+};
+
+struct IndexSymbolRecord {
+  uint32_t name_offset;
+  uint32_t name_length;
+  uint32_t first_occurrence;
+  uint32_t occurrence_count;
+};
+
+struct IndexOccurrenceRecord {
+  uint32_t file;
+  uint8_t kind;
+  uint8_t definition;
+  uint16_t reserved;
+  uint32_t line;
+  uint32_t column;
+  uint32_t index;
+};
+
+uint64_t align8(uint64_t offset) { return (offset + 7) & ~uint64_t(7); }
+
+class SymbolCollector {
+private:
+  std::vector<SymbolOccurrence> &out_;
+
+  void define(const ast::IdentifierExpression *identifier, SymbolKind kind) {
+    if (identifier && identifier->start.line != 0) {
+      this->out_.push_back({identifier->name, kind, true, identifier->start});
+    }
+  }
+
+  void reference(const ast::IdentifierExpression &identifier) {
+    // Synthetic identifiers, such as implicit 'void' types, have no location.
+    if (identifier.start.line != 0) {
+      this->out_.push_back(
+          {identifier.name, SymbolKind::Unknown, false, identifier.start});
+    }
+  }
+
+  void optional(const ast::Node *node, Scope scope) {
+    if (node) {
+      this->collect(*node, scope);
+    }
+  }
+
+  void variable(const ast::VariableDeclaration &v, Scope scope) {
+    if (scope == Scope::Type) {
+      this->define(v.identifier.get(), SymbolKind::Field);
+    } else if (scope == Scope::Global) {
+      this->define(v.identifier.get(), SymbolKind::Variable);
+    }
+    this->optional(v.type.get(), Scope::Local);
+    this->optional(v.initializer.get(), Scope::Local);
+  }
+
+public:
+  explicit SymbolCollector(std::vector<SymbolOccurrence> &out) : out_(out) {}
+
+  void collect(const ast::Node &node, Scope scope) {
+    switch (node.tag()) {
+    case ast::NodeTag::FunctionDeclaration: {
+      auto &v = static_cast<const ast::FunctionDeclaration &>(node);
+      this->define(v.identifier.get(), scope == Scope::Type
+                                           ? SymbolKind::Method
+                                           : SymbolKind::Function);
+      for (const auto &parameter : v.parameters) {
+        // Parameter names are locals; only their types are references.
+        this->optional(parameter->type.get(), Scope::Local);
+      }
+      this->optional(v.type.get(), Scope::Local);
+      this->optional(v.body.get(), Scope::Local);
+      break;
+    }
+    case ast::NodeTag::RecordDeclaration: {
+      auto &v = static_cast<const ast::RecordDeclaration &>(node);
+      this->define(v.identifier.get(), SymbolKind::Record);
+      for (const auto &field : v.fields) {
+        this->variable(*field, Scope::Type);
+      }
+      break;
+    }
+    case ast::NodeTag::ClassDeclaration: {
+      auto &v = static_cast<const ast::ClassDeclaration &>(node);
+      this->define(v.identifier.get(), SymbolKind::Class);
+      for (const auto &field : v.fields) {
+        this->variable(*field, Scope::Type);
+      }
+      for (const auto &method : v.methods) {
+        this->collect(*method, Scope::Type);
+      }
+      break;
+    }
+    case ast::NodeTag::VariableDeclaration:
+      this->variable(static_cast<const ast::VariableDeclaration &>(node),
+                     scope);
+      break;
+    case ast::NodeTag::IdentifierExpression:
+    case ast::NodeTag::ArrayIdentifierExpression:
+      this->reference(static_cast<const ast::IdentifierExpression &>(node));
+      ast::forEachChild(node, [&](const ast::Node &child) {
+        this->collect(child, Scope::Local);
+      });
+      break;
+    default: {
+      // Blocks nested in a global statement still declare locals.
+      Scope inner = node.tag() == ast::NodeTag::Program ? Scope::Global
+                                                        : Scope::Local;
+      ast::forEachChild(node, [&](const ast::Node &child) {
+        this->collect(child, inner);
+      });
+      break;
+    }
+    }
+  }
+};
+
+/**
+ * @brief Reads the symbols of one source file.
+ */
+IndexedFile indexFile(const std::string &path, std::string_view source,
+                      uint64_t hash) {
+  IndexedFile file;
+  file.path = path;
+  file.hash = hash;
+
+  parser::Parser parser;
+  auto program = parser.parse(std::string(source));
+  if (program) {
+    file.occurrences = extractSymbols(*program);
+  }
+  return file;
+}
+
+} // namespace
+
+std::vector<SymbolOccurrence> extractSymbols(const ast::Program &program) {
+  std::vector<SymbolOccurrence> occurrences;
+  SymbolCollector(occurrences).collect(program, Scope::Global);
+  return occurrences;
+}
+
+bool writeSymbolIndex(const std::string &file_path,
+                      const std::vector<IndexedFile> &files) {
+  std::string strings;
+  std::vector<IndexFileRecord> file_records;
+  file_records.reserve(files.size());
+  for (const auto &file : files) {
+    file_records.push_back({static_cast<uint32_t>(strings.size()),
+                            static_cast<uint32_t>(file.path.size()),
+                            file.hash});
+    strings += file.path;
+  }
+
+  // Group the occurrences by name; std::map keeps the names sorted.
+  std::map<std::string_view, std::vector<IndexOccurrenceRecord>> symbols;
+  for (uint32_t i = 0; i < files.size(); i++) {
+    for (const auto &occurrence : files[i].occurrences) {
+      symbols[occurrence.name].push_back(
+          {i, static_cast<uint8_t>(occurrence.kind),
+           static_cast<uint8_t>(occurrence.definition ? 1 : 0), 0,
+           static_cast<uint32_t>(occurrence.start.line),
+           static_cast<uint32_t>(occurrence.start.column),
+           static_cast<uint32_t>(occurrence.start.index)});
+    }
+  }
+
+  std::vector<IndexSymbolRecord> symbol_records;
+  std::vector<IndexOccurrenceRecord> occurrence_records;
+  symbol_records.reserve(symbols.size());
+  for (auto &[name, occurrences] : symbols) {
+    std::stable_sort(occurrences.begin(), occurrences.end(),
+                     [](const auto &a, const auto &b) {
+                       return a.definition > b.definition;
+                     });
+    symbol_records.push_back(
+        {static_cast<uint32_t>(strings.size()),
+         static_cast<uint32_t>(name.size()),
+         static_cast<uint32_t>(occurrence_records.size()),
+         static_cast<uint32_t>(occurrences.size())});
+    strings += name;
+    occurrence_records.insert(occurrence_records.end(), occurrences.begin(),
+                              occurrences.end());
+  }
+
+  IndexHeader header{};
+  std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+  header.version = INDEX_VERSION;
+  header.file_count = static_cast<uint32_t>(file_records.size());
+  header.symbol_count = static_cast<uint32_t>(symbol_records.size());
+  header.occurrence_count = static_cast<uint32_t>(occurrence_records.size());
+  header.files_offset = align8(sizeof(IndexHeader));
+  header.symbols_offset = align8(
+      header.files_offset + file_records.size() * sizeof(IndexFileRecord));
+  header.occurrences_offset =
+      align8(header.symbols_offset +
+             symbol_records.size() * sizeof(IndexSymbolRecord));
+  header.strings_offset =
+      align8(header.occurrences_offset +
+             occurrence_records.size() * sizeof(IndexOccurrenceRecord));
+  header.strings_size = strings.size();
+
+  std::string image(header.strings_offset + strings.size(), '\0');
+  auto place = [&image](uint64_t offset, const void *data, size_t size) {
+    if (size != 0) {
+      std::memcpy(&image[offset], data, size);
+    }
+  };
+  place(0, &header, sizeof(header));
+  place(header.files_offset, file_records.data(),
+        file_records.size() * sizeof(IndexFileRecord));
+  place(header.symbols_offset, symbol_records.data(),
+        symbol_records.size() * sizeof(IndexSymbolRecord));
+  place(header.occurrences_offset, occurrence_records.data(),
+        occurrence_records.size() * sizeof(IndexOccurrenceRecord));
+  place(header.strings_offset, strings.data(), strings.size());
+
+  std::filesystem::path path(file_path);
+  std::error_code error;
+  if (path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path(), error);
+  }
+
+  std::string temporary = file_path + ".tmp";
+  {
+    std::ofstream file_stream(temporary, std::ios::binary | std::ios::trunc);
+    if (!file_stream.write(image.data(),
+                           static_cast<std::streamsize>(image.size()))) {
+      return false;
+    }
+  }
+  std::filesystem::rename(temporary, file_path, error);
+  return !error;
+}
+
+namespace {
+
+/**
+ * @brief Gets the header of a mapped index, or nullptr if it is invalid.
+ */
+const IndexHeader *indexHeader(const basic::MappedFile &file) {
+  if (file.size() < sizeof(IndexHeader)) {
+    return nullptr;
+  }
+  auto *header = reinterpret_cast<const IndexHeader *>(file.data());
+  if (std::memcmp(header->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+      header->version != INDEX_VERSION) {
+    return nullptr;
+  }
+  return header;
+}
+
+template <typename T>
+const T *section(const basic::MappedFile &file, uint64_t offset) {
+  return reinterpret_cast<const T *>(file.data() + offset);
+}
+
+/**
+ * @brief Checks that every offset, count and index of a mapped index stays
+ * within the file, so lookups can read it without further checks.
+ */
+bool validIndex(const basic::MappedFile &file) {
+  const IndexHeader *header = indexHeader(file);
+  if (!header) {
+    return false;
+  }
+  uint64_t size = file.size();
+  auto fits = [size](uint64_t offset, uint64_t count, uint64_t width) {
+    return offset % 8 == 0 && offset <= size &&
+           count <= (size - offset) / width;
+  };
+  if (!fits(header->files_offset, header->file_count,
+            sizeof(IndexFileRecord)) ||
+      !fits(header->symbols_offset, header->symbol_count,
+            sizeof(IndexSymbolRecord)) ||
+      !fits(header->occurrences_offset, header->occurrence_count,
+            sizeof(IndexOccurrenceRecord)) ||
+      header->strings_offset > size ||
+      header->strings_size > size - header->strings_offset) {
+    return false;
+  }
+
+  auto *files = section<IndexFileRecord>(file, header->files_offset);
+  auto *symbols = section<IndexSymbolRecord>(file, header->symbols_offset);
+  auto *occurrences =
+      section<IndexOccurrenceRecord>(file, header->occurrences_offset);
+  for (uint32_t i = 0; i < header->file_count; i++) {
+    if (uint64_t(files[i].path_offset) + files[i].path_length >
+        header->strings_size) {
+      return false;
+    }
+  }
+  for (uint32_t s = 0; s < header->symbol_count; s++) {
+    if (uint64_t(symbols[s].name_offset) + symbols[s].name_length >
+            header->strings_size ||
+        uint64_t(symbols[s].first_occurrence) + symbols[s].occurrence_count >
+            header->occurrence_count) {
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < header->occurrence_count; i++) {
+    if (occurrences[i].file >= header->file_count) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+bool SymbolIndex::open(const std::string &file_path) {
+  if (!this->file_.open(file_path)) {
+    return false;
+  }
+  if (!validIndex(this->file_)) {
+    this->file_ = basic::MappedFile();
+    return false;
+  }
+  return true;
+}
+
+size_t SymbolIndex::fileCount() const {
+  const IndexHeader *header = indexHeader(this->file_);
+  return header ? header->file_count : 0;
+}
+
+size_t SymbolIndex::symbolCount() const {
+  const IndexHeader *header = indexHeader(this->file_);
+  return header ? header->symbol_count : 0;
+}
+
+std::vector<SymbolLocation> SymbolIndex::lookup(std::string_view name) const {
+  std::vector<SymbolLocation> locations;
+  const IndexHeader *header = indexHeader(this->file_);
+  if (!header) {
+    return locations;
+  }
+
+  const char *strings = this->file_.data() + header->strings_offset;
+  auto *files = section<IndexFileRecord>(this->file_, header->files_offset);
+  auto *symbols =
+      section<IndexSymbolRecord>(this->file_, header->symbols_offset);
+  auto *occurrences =
+      section<IndexOccurrenceRecord>(this->file_, header->occurrences_offset);
+
+  auto nameOf = [strings](const IndexSymbolRecord &symbol) {
+    return std::string_view(strings + symbol.name_offset, symbol.name_length);
+  };
+  auto *end = symbols + header->symbol_count;
+  auto *symbol = std::lower_bound(
+      symbols, end, name, [&](const IndexSymbolRecord &s, std::string_view n) {
+        return nameOf(s) < n;
+      });
+  if (symbol == end || nameOf(*symbol) != name) {
+    return locations;
+  }
+
+  locations.reserve(symbol->occurrence_count);
+  for (uint32_t i = 0; i < symbol->occurrence_count; i++) {
+    const auto &occurrence = occurrences[symbol->first_occurrence + i];
+    const auto &file = files[occurrence.file];
+    locations.push_back(
+        {std::string_view(strings + file.path_offset, file.path_length),
+         static_cast<SymbolKind>(occurrence.kind), occurrence.definition != 0,
+         occurrence.line, occurrence.column, occurrence.index});
+  }
+  return locations;
+}
+
+std::vector<IndexedFile> SymbolIndex::files() const {
+  std::vector<IndexedFile> result;
+  const IndexHeader *header = indexHeader(this->file_);
+  if (!header) {
+    return result;
+  }
+
+  const char *strings = this->file_.data() + header->strings_offset;
+  auto *files = section<IndexFileRecord>(this->file_, header->files_offset);
+  auto *symbols =
+      section<IndexSymbolRecord>(this->file_, header->symbols_offset);
+  auto *occurrences =
+      section<IndexOccurrenceRecord>(this->file_, header->occurrences_offset);
+
+  result.resize(header->file_count);
+  for (uint32_t i = 0; i < header->file_count; i++) {
+    result[i].path.assign(strings + files[i].path_offset,
+                          files[i].path_length);
+    result[i].hash = files[i].hash;
+  }
+  for (uint32_t s = 0; s < header->symbol_count; s++) {
+    std::string name(strings + symbols[s].name_offset,
+                     symbols[s].name_length);
+    for (uint32_t i = 0; i < symbols[s].occurrence_count; i++) {
+      const auto &occurrence = occurrences[symbols[s].first_occurrence + i];
+      result[occurrence.file].occurrences.push_back(
+          {name, static_cast<SymbolKind>(occurrence.kind),
+           occurrence.definition != 0,
+           basic::Locus(occurrence.line, occurrence.column,
+                        occurrence.index)});
+    }
+  }
+  return result;
+}
+
+IndexSummary updateSymbolIndex(const std::string &file_path,
+                               const std::vector<std::string> &sources,
+                               unsigned jobs) {
+  std::unordered_map<std::string, IndexedFile> previous;
+  {
+    SymbolIndex index;
+    if (index.open(file_path)) {
+      for (auto &file : index.files()) {
+        std::string path = file.path;
+        previous.emplace(std::move(path), std::move(file));
+      }
+    }
+  }
+
+  IndexSummary summary;
+  std::vector<IndexedFile> files(sources.size());
+  std::vector<char> reused(sources.size(), 0);
+  basic::parallelFor(
+      sources.size(), jobs == 0 ? basic::defaultJobs() : jobs, [&](size_t i) {
+        basic::MappedFile source;
+        if (!source.open(sources[i])) {
+          files[i].path = sources[i];
+          return;
+        }
+        uint64_t hash = basic::fnv1a(source.view());
+        auto it = previous.find(sources[i]);
+        if (it != previous.end() && it->second.hash == hash) {
+          files[i] = it->second;
+          reused[i] = 1;
+        } else {
+          files[i] = indexFile(sources[i], source.view(), hash);
+        }
+      });
+
+  summary.files = files.size();
+  summary.reused = static_cast<size_t>(
+      std::count(reused.begin(), reused.end(), static_cast<char>(1)));
+  for (const auto &file : files) {
+    summary.occurrences += file.occurrences.size();
+  }
+  summary.written = writeSymbolIndex(file_path, files);
+
+  SymbolIndex index;
+  if (summary.written && index.open(file_path)) {
+    summary.symbols = index.symbolCount();
+  }
+  return summary;
+}
+
+} // namespace ml::analysis
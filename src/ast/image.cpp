@@ -0,0 +1,830 @@
+/**
+ * @file image.cpp
+ * @brief Flat AST image source code for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/ast/image.h"
+#include "ml/ast/ast.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+namespace ml::ast {
+
+namespace {
+
+constexpr char IMAGE_MAGIC[8] = {'M', 'L', 'I', 'M', 'A', 'G', 'E', '\0'};
+
+// On-disk layout. Every section starts on an 8-byte boundary and refers to
+// others through offsets and node numbers, so the mapped file can be read in
+// place wherever it is mapped.
+
+struct ImageHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t node_count;
+  uint64_t source_hash;
+  uint32_t slot_count;
+  uint32_t string_count;
+  uint32_t function_count;
+  uint32_t reserved;
+  uint64_t nodes_offset;
+  uint64_t slots_offset;
+  uint64_t strings_offset;
+  uint64_t functions_offset;
+  uint64_t blob_offset;
+  uint64_t blob_size;
+};
+
+uint64_t align8(uint64_t offset) { return (offset + 7) & ~uint64_t(7); }
+
+/**
+ * @struct Slot
+ * @brief One child slot of a node before it is numbered.
+ */
+struct Slot {
+  const Node *node; // The child, or nullptr
+  uint32_t list;    // IMAGE_LIST | length for a list header, 0 otherwise
+};
+
+/**
+ * @brief Lists the child slots of a node in the layout of its tag.
+ * @details Must agree with Reader::decode().
+ */
+std::vector<Slot> layoutOf(const Node &node) {
+  std::vector<Slot> slots;
+  auto slot = [&slots](const auto &child) {
+    slots.push_back({child.get(), 0});
+  };
+  auto list = [&slots](const auto &children) {
+    slots.push_back(
+        {nullptr, IMAGE_LIST | static_cast<uint32_t>(children.size())});
+    for (const auto &child : children) {
+      slots.push_back({child.get(), 0});
+    }
+  };
+  auto declaration = [&slot](const Declaration &v) {
+    slot(v.modifier);
+    slot(v.identifier);
+    slot(v.type);
+  };
+
+  switch (node.tag()) {
+  case NodeTag::Program:
+    list(static_cast<const Program &>(node).statements);
+    break;
+  case NodeTag::BinaryExpression: {
+    auto &v = static_cast<const BinaryExpression &>(node);
+    slot(v.left);
+    slot(v.right);
+    break;
+  }
+  case NodeTag::UnaryExpression:
+    slot(static_cast<const UnaryExpression &>(node).operand);
+    break;
+  case NodeTag::ArrayIdentifierExpression:
+    slot(static_cast<const ArrayIdentifierExpression &>(node).size);
+    break;
+  case NodeTag::IndexExpression: {
+    auto &v = static_cast<const IndexExpression &>(node);
+    slot(v.array);
+    slot(v.index);
+    break;
+  }
+  case NodeTag::ArrayExpression:
+    list(static_cast<const ArrayExpression &>(node).elements);
+    break;
+  case NodeTag::CallExpression: {
+    auto &v = static_cast<const CallExpression &>(node);
+    slot(v.callee);
+    list(v.arguments);
+    break;
+  }
+  case NodeTag::AttributeExpression: {
+    auto &v = static_cast<const AttributeExpression &>(node);
+    slot(v.object);
+    slot(v.attribute);
+    break;
+  }
+  case NodeTag::SpawnExpression:
+    slot(static_cast<const SpawnExpression &>(node).call);
+    break;
+  case NodeTag::AwaitExpression:
+    slot(static_cast<const AwaitExpression &>(node).task);
+    break;
+  case NodeTag::ReturnStatement:
+    slot(static_cast<const ReturnStatement &>(node).expression);
+    break;
+  case NodeTag::ExpressionStatement:
+    slot(static_cast<const ExpressionStatement &>(node).expression);
+    break;
+  case NodeTag::BlockStatement:
+    list(static_cast<const BlockStatement &>(node).statements);
+    break;
+  case NodeTag::Declaration:
+    declaration(static_cast<const Declaration &>(node));
+    break;
+  case NodeTag::VariableDeclaration: {
+    auto &v = static_cast<const VariableDeclaration &>(node);
+    declaration(v);
+    slot(v.initializer);
+    break;
+  }
+  case NodeTag::FunctionDeclaration: {
+    auto &v = static_cast<const FunctionDeclaration &>(node);
+    slot(v.modifier);
+    slot(v.identifier);
+    list(v.parameters);
+    slot(v.type);
+    slot(v.body);
+    break;
+  }
+  case NodeTag::RecordDeclaration: {
+    auto &v = static_cast<const RecordDeclaration &>(node);
+    declaration(v);
+    list(v.fields);
+    break;
+  }
+  case NodeTag::ClassDeclaration: {
+    auto &v = static_cast<const ClassDeclaration &>(node);
+    declaration(v);
+    list(v.fields);
+    list(v.methods);
+    break;
+  }
+  case NodeTag::Conditional:
+  case NodeTag::WhileConditional: {
+    auto &v = static_cast<const Conditional &>(node);
+    slot(v.condition);
+    slot(v.then_branch);
+    break;
+  }
+  case NodeTag::IfConditional: {
+    auto &v = static_cast<const IfConditional &>(node);
+    slot(v.condition);
+    slot(v.then_branch);
+    list(v.elif_branches);
+    slot(v.else_branch);
+    break;
+  }
+  case NodeTag::SwitchConditional: {
+    auto &v = static_cast<const SwitchConditional &>(node);
+    slot(v.switch_expression);
+    list(v.case_branches);
+    break;
+  }
+  case NodeTag::ForConditional: {
+    auto &v = static_cast<const ForConditional &>(node);
+    slot(v.initializer);
+    slot(v.condition);
+    slot(v.increment);
+    slot(v.then_branch);
+    break;
+  }
+  default:
+    break;
+  }
+  return slots;
+}
+
+/**
+ * @brief Gets the text a node carries, or nullptr.
+ */
+const std::string *textOf(const Node &node) {
+  switch (node.tag()) {
+  case NodeTag::BinaryExpression:
+    return &static_cast<const BinaryExpression &>(node).op;
+  case NodeTag::UnaryExpression:
+    return &static_cast<const UnaryExpression &>(node).op;
+  case NodeTag::LiteralExpression:
+    return &static_cast<const LiteralExpression &>(node).value;
+  case NodeTag::IdentifierExpression:
+  case NodeTag::ArrayIdentifierExpression:
+    return &static_cast<const IdentifierExpression &>(node).name;
+  default:
+    return nullptr;
+  }
+}
+
+/**
+ * @class ImageWriter
+ * @brief Flattens a tree into the sections of an image.
+ */
+class ImageWriter {
+private:
+  std::unordered_map<std::string_view, uint32_t> interned_; // String numbers
+
+public:
+  std::vector<ImageNode> nodes;    // The node table
+  std::vector<uint32_t> slots;     // The child slots
+  std::vector<uint32_t> strings;   // Offset and length of each string
+  std::vector<uint32_t> functions; // Name and node of each function
+  std::string blob;                // The characters of the strings
+
+  /**
+   * @brief Interns a string.
+   * @return Its number.
+   * @details The keys view the tree being written, which outlives the
+   * writer.
+   */
+  uint32_t intern(const std::string &text) {
+    auto [it, inserted] = this->interned_.try_emplace(
+        text, static_cast<uint32_t>(this->strings.size() / 2));
+    if (inserted) {
+      this->strings.push_back(static_cast<uint32_t>(this->blob.size()));
+      this->strings.push_back(static_cast<uint32_t>(text.size()));
+      this->blob += text;
+    }
+    return it->second;
+  }
+
+  /**
+   * @brief Appends a node and its subtree in pre-order.
+   * @details Iterative, so the depth of the tree does not bound the stack.
+   * Each pending node carries the slot of its parent that receives its
+   * number once it is appended.
+   */
+  void write(const Node &root) {
+    std::vector<std::pair<const Node *, uint32_t>> pending;
+    pending.emplace_back(&root, IMAGE_NONE);
+    while (!pending.empty()) {
+      auto [node, parent_slot] = pending.back();
+      pending.pop_back();
+      auto id = static_cast<uint32_t>(this->nodes.size());
+      if (parent_slot != IMAGE_NONE) {
+        this->slots[parent_slot] = id;
+      }
+      std::vector<Slot> layout = layoutOf(*node);
+
+      ImageNode record{};
+      record.tag = static_cast<uint16_t>(node->tag());
+      if (node->tag() == NodeTag::ModifierStatement) {
+        auto &v = static_cast<const ModifierStatement &>(*node);
+        record.accessor = static_cast<uint8_t>(v.accessor);
+        record.modifier = static_cast<uint8_t>(v.modifier);
+      }
+      const std::string *text = textOf(*node);
+      record.text = text ? this->intern(*text) : IMAGE_NONE;
+      record.first_slot = static_cast<uint32_t>(this->slots.size());
+      record.slot_count = static_cast<uint32_t>(layout.size());
+      record.start_line = static_cast<uint32_t>(node->start.line);
+      record.start_column = static_cast<uint32_t>(node->start.column);
+      record.start_index = static_cast<uint32_t>(node->start.index);
+      record.end_line = static_cast<uint32_t>(node->end.line);
+      record.end_column = static_cast<uint32_t>(node->end.column);
+      record.end_index = static_cast<uint32_t>(node->end.index);
+      this->nodes.push_back(record);
+
+      // Reserve the slots first so they stay contiguous while the children
+      // append their own. Children are pushed last to first so the first
+      // is numbered next.
+      this->slots.resize(this->slots.size() + layout.size(), IMAGE_NONE);
+      for (size_t i = layout.size(); i-- > 0;) {
+        auto slot = static_cast<uint32_t>(record.first_slot + i);
+        if (layout[i].list != 0) {
+          this->slots[slot] = layout[i].list;
+        } else if (layout[i].node) {
+          pending.emplace_back(layout[i].node, slot);
+        }
+      }
+    }
+  }
+};
+
+/**
+ * @class Reader
+ * @brief Rebuilds the pointer tree of an image.
+ */
+class Reader {
+private:
+  const AstImage &image_;                    // The image
+  const uint32_t *slots_;                    // The child slots
+  std::vector<std::unique_ptr<Node>> built_; // Built nodes not yet adopted
+  bool failed_ = false;                      // Whether a slot broke its layout
+
+  /**
+   * @struct Cursor
+   * @brief Position in the slots of one node.
+   */
+  struct Cursor {
+    uint32_t position; // The next slot
+    uint32_t end;      // One past the last slot
+  };
+
+  uint32_t next(Cursor &cursor) {
+    if (cursor.position >= cursor.end) {
+      this->failed_ = true;
+      return IMAGE_NONE;
+    }
+    return this->slots_[cursor.position++];
+  }
+
+  /**
+   * @brief Adopts the built node in the next slot, which must be a T.
+   */
+  template <typename T> std::unique_ptr<T> node(Cursor &cursor) {
+    uint32_t slot = this->next(cursor);
+    if (slot == IMAGE_NONE) {
+      return nullptr;
+    }
+    if ((slot & IMAGE_LIST) != 0) {
+      this->failed_ = true;
+      return nullptr;
+    }
+    // Children are numbered after their parent, so they are built first;
+    // a child that is already adopted is shared by two parents.
+    std::unique_ptr<Node> decoded = std::move(this->built_[slot]);
+    if (!decoded) {
+      this->failed_ = true;
+      return nullptr;
+    }
+    if (auto *typed = dynamic_cast<T *>(decoded.get())) {
+      decoded.release();
+      return std::unique_ptr<T>(typed);
+    }
+    this->failed_ = true;
+    return nullptr;
+  }
+
+  /**
+   * @brief Adopts the list in the next slots, whose elements must be Ts.
+   */
+  template <typename T> std::vector<std::unique_ptr<T>> list(Cursor &cursor) {
+    std::vector<std::unique_ptr<T>> elements;
+    uint32_t header = this->next(cursor);
+    if (header == IMAGE_NONE || (header & IMAGE_LIST) == 0) {
+      this->failed_ = true;
+      return elements;
+    }
+    uint32_t length = header & ~IMAGE_LIST;
+    if (length > cursor.end - cursor.position) {
+      this->failed_ = true;
+      return elements;
+    }
+    elements.reserve(length);
+    for (uint32_t i = 0; i < length; i++) {
+      elements.push_back(this->node<T>(cursor));
+    }
+    return elements;
+  }
+
+public:
+  Reader(const AstImage &image, const uint32_t *slots)
+      : image_(image), slots_(slots) {}
+
+  bool failed() const { return this->failed_; }
+
+  /**
+   * @brief Decodes the tree rooted at node 0.
+   * @details Nodes are built from the last number to the first, so every
+   * child exists before its parent adopts it and no recursion is needed.
+   */
+  std::unique_ptr<Node> decode() {
+    auto count = static_cast<uint32_t>(this->image_.nodeCount());
+    this->built_.clear();
+    this->built_.resize(count);
+    for (uint32_t id = count; id-- > 0 && !this->failed_;) {
+      this->built_[id] = this->build(id);
+    }
+    return std::move(this->built_[0]);
+  }
+
+private:
+  /**
+   * @brief Builds a node from its already built children.
+   * @details Must agree with layoutOf().
+   */
+  std::unique_ptr<Node> build(uint32_t id) {
+    const ImageNode &record = this->image_.node(id);
+    Cursor cursor{record.first_slot, record.first_slot + record.slot_count};
+    basic::Locus start = record.start();
+    basic::Locus end = record.end();
+    std::string text(this->image_.text(id));
+    std::unique_ptr<Node> result;
+
+    switch (record.nodeTag()) {
+    case NodeTag::Program:
+      result = std::make_unique<Program>(start, end,
+                                         this->list<Statement>(cursor));
+      break;
+    case NodeTag::BinaryExpression: {
+      auto left = this->node<Expression>(cursor);
+      auto right = this->node<Expression>(cursor);
+      result = std::make_unique<BinaryExpression>(start, end, std::move(left),
+                                                  text, std::move(right));
+      break;
+    }
+    case NodeTag::UnaryExpression:
+      result = std::make_unique<UnaryExpression>(
+          start, end, text, this->node<Expression>(cursor));
+      break;
+    case NodeTag::LiteralExpression:
+      result = std::make_unique<LiteralExpression>(start, end, text);
+      break;
+    case NodeTag::IdentifierExpression:
+      result = std::make_unique<IdentifierExpression>(start, end, text);
+      break;
+    case NodeTag::ArrayIdentifierExpression:
+      result = std::make_unique<ArrayIdentifierExpression>(
+          start, end, text, this->node<Expression>(cursor));
+      break;
+    case NodeTag::IndexExpression: {
+      auto array = this->node<Expression>(cursor);
+      auto index = this->node<Expression>(cursor);
+      result = std::make_unique<IndexExpression>(start, end, std::move(array),
+                                                 std::move(index));
+      break;
+    }
+    case NodeTag::ArrayExpression:
+      result = std::make_unique<ArrayExpression>(
+          start, end, this->list<Expression>(cursor));
+      break;
+    case NodeTag::CallExpression: {
+      auto callee = this->node<Expression>(cursor);
+      auto arguments = this->list<Expression>(cursor);
+      result = std::make_unique<CallExpression>(
+          start, end, std::move(callee), std::move(arguments));
+      break;
+    }
+    case NodeTag::AttributeExpression: {
+      auto object = this->node<Expression>(cursor);
+      auto attribute = this->node<Expression>(cursor);
+      result = std::make_unique<AttributeExpression>(
+          start, end, std::move(object), std::move(attribute));
+      break;
+    }
+    case NodeTag::SpawnExpression:
+      result = std::make_unique<SpawnExpression>(
+          start, end, this->node<CallExpression>(cursor));
+      break;
+    case NodeTag::AwaitExpression:
+      result = std::make_unique<AwaitExpression>(
+          start, end, this->node<Expression>(cursor));
+      break;
+    case NodeTag::ReturnStatement:
+      result = std::make_unique<ReturnStatement>(
+          start, end, this->node<Expression>(cursor));
+      break;
+    case NodeTag::BreakStatement:
+      result = std::make_unique<BreakStatement>(start, end);
+      break;
+    case NodeTag::ContinueStatement:
+      result = std::make_unique<ContinueStatement>(start, end);
+      break;
+    case NodeTag::ExpressionStatement:
+      result = std::make_unique<ExpressionStatement>(
+          start, end, this->node<Expression>(cursor));
+      break;
+    case NodeTag::BlockStatement:
+      result = std::make_unique<BlockStatement>(
+          start, end, this->list<Statement>(cursor));
+      break;
+    case NodeTag::ModifierStatement:
+      result = std::make_unique<ModifierStatement>(
+          start, end, static_cast<basic::Accessor>(record.accessor),
+          static_cast<basic::Modifier>(record.modifier));
+      break;
+    case NodeTag::Declaration: {
+      auto modifier = this->node<ModifierStatement>(cursor);
+      auto identifier = this->node<IdentifierExpression>(cursor);
+      auto type = this->node<Expression>(cursor);
+      result = std::make_unique<Declaration>(start, end, std::move(identifier),
+                                             std::move(type),
+                                             std::move(modifier));
+      break;
+    }
+    case NodeTag::VariableDeclaration: {
+      auto modifier = this->node<ModifierStatement>(cursor);
+      auto identifier = this->node<IdentifierExpression>(cursor);
+      auto type = this->node<Expression>(cursor);
+      auto initializer = this->node<Expression>(cursor);
+      result = std::make_unique<VariableDeclaration>(
+          start, end, std::move(identifier), std::move(type),
+          std::move(modifier), std::move(initializer));
+      break;
+    }
+    case NodeTag::FunctionDeclaration: {
+      auto modifier = this->node<ModifierStatement>(cursor);
+      auto identifier = this->node<IdentifierExpression>(cursor);
+      auto parameters = this->list<Declaration>(cursor);
+      auto type = this->node<Expression>(cursor);
+      auto body = this->node<BlockStatement>(cursor);
+      result = std::make_unique<FunctionDeclaration>(
+          start, end, std::move(identifier), std::move(type),
+          std::move(modifier), std::move(parameters), std::move(body));
+      break;
+    }
+    case NodeTag::RecordDeclaration: {
+      auto modifier = this->node<ModifierStatement>(cursor);
+      auto identifier = this->node<IdentifierExpression>(cursor);
+      auto type = this->node<Expression>(cursor);
+      auto fields = this->list<VariableDeclaration>(cursor);
+      result = std::make_unique<RecordDeclaration>(
+          start, end, std::move(identifier), std::move(type),
+          std::move(modifier), std::move(fields));
+      break;
+    }
+    case NodeTag::ClassDeclaration: {
+      auto modifier = this->node<ModifierStatement>(cursor);
+      auto identifier = this->node<IdentifierExpression>(cursor);
+      auto type = this->node<Expression>(cursor);
+      auto fields = this->list<VariableDeclaration>(cursor);
+      auto methods = this->list<FunctionDeclaration>(cursor);
+      result = std::make_unique<ClassDeclaration>(
+          start, end, std::move(identifier), std::move(type),
+          std::move(modifier), std::move(fields), std::move(methods));
+      break;
+    }
+    case NodeTag::Conditional:
+    case NodeTag::WhileConditional: {
+      auto condition = this->node<Expression>(cursor);
+      auto then_branch = this->node<BlockStatement>(cursor);
+      if (record.nodeTag() == NodeTag::Conditional) {
+        result = std::make_unique<Conditional>(start, end, std::move(condition),
+                                               std::move(then_branch));
+      } else {
+        result = std::make_unique<WhileConditional>(
+            start, end, std::move(condition), std::move(then_branch));
+      }
+      break;
+    }
+    case NodeTag::IfConditional: {
+      auto condition = this->node<Expression>(cursor);
+      auto then_branch = this->node<BlockStatement>(cursor);
+      auto elif_branches = this->list<IfConditional>(cursor);
+      auto else_branch = this->node<BlockStatement>(cursor);
+      result = std::make_unique<IfConditional>(
+          start, end, std::move(condition), std::move(then_branch),
+          std::move(elif_branches), std::move(else_branch));
+      break;
+    }
+    case NodeTag::SwitchConditional: {
+      auto expression = this->node<Expression>(cursor);
+      auto cases = this->list<Conditional>(cursor);
+      result = std::make_unique<SwitchConditional>(
+          start, end, std::move(expression), std::move(cases));
+      break;
+    }
+    case NodeTag::ForConditional: {
+      auto initializer = this->node<Declaration>(cursor);
+      auto condition = this->node<Expression>(cursor);
+      auto increment = this->node<Expression>(cursor);
+      auto then_branch = this->node<BlockStatement>(cursor);
+      result = std::make_unique<ForConditional>(
+          start, end, std::move(initializer), std::move(condition),
+          std::move(increment), std::move(then_branch));
+      break;
+    }
+    default:
+      this->failed_ = true;
+      return nullptr;
+    }
+
+    if (cursor.position != cursor.end) {
+      this->failed_ = true;
+    }
+    return result;
+  }
+};
+
+} // namespace
+
+std::string buildImage(const Program &program, uint64_t source_hash) {
+  ImageWriter writer;
+  writer.write(program);
+
+  // The function table, sorted by name; stable, so overloads keep their
+  // source order. The top-level statements follow the list header in the
+  // slots of the Program, and the identifier is the second slot of a
+  // function.
+  auto nameOf = [&writer](uint32_t text) {
+    return std::string_view(writer.blob.data() + writer.strings[2 * text],
+                            writer.strings[2 * text + 1]);
+  };
+  std::vector<std::pair<uint32_t, uint32_t>> functions;
+  const ImageNode &root = writer.nodes[0];
+  for (uint32_t i = 1; i < root.slot_count; i++) {
+    uint32_t child = writer.slots[root.first_slot + i];
+    if (child == IMAGE_NONE ||
+        writer.nodes[child].nodeTag() != NodeTag::FunctionDeclaration) {
+      continue;
+    }
+    uint32_t identifier = writer.slots[writer.nodes[child].first_slot + 1];
+    if (identifier != IMAGE_NONE) {
+      functions.emplace_back(writer.nodes[identifier].text, child);
+    }
+  }
+  std::stable_sort(functions.begin(), functions.end(),
+                   [&nameOf](const auto &a, const auto &b) {
+                     return nameOf(a.first) < nameOf(b.first);
+                   });
+  for (const auto &[name, node] : functions) {
+    writer.functions.push_back(name);
+    writer.functions.push_back(node);
+  }
+
+  ImageHeader header{};
+  std::memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+  header.version = IMAGE_VERSION;
+  header.node_count = static_cast<uint32_t>(writer.nodes.size());
+  header.source_hash = source_hash;
+  header.slot_count = static_cast<uint32_t>(writer.slots.size());
+  header.string_count = static_cast<uint32_t>(writer.strings.size() / 2);
+  header.function_count = static_cast<uint32_t>(writer.functions.size() / 2);
+  header.nodes_offset = align8(sizeof(ImageHeader));
+  header.slots_offset = align8(header.nodes_offset +
+                               writer.nodes.size() * sizeof(ImageNode));
+  header.strings_offset = align8(header.slots_offset +
+                                 writer.slots.size() * sizeof(uint32_t));
+  header.functions_offset = align8(header.strings_offset +
+                                   writer.strings.size() * sizeof(uint32_t));
+  header.blob_offset = align8(header.functions_offset +
+                              writer.functions.size() * sizeof(uint32_t));
+  header.blob_size = writer.blob.size();
+
+  std::string image(header.blob_offset + writer.blob.size(), '\0');
+  auto place = [&image](uint64_t offset, const void *data, size_t size) {
+    if (size != 0) {
+      std::memcpy(&image[offset], data, size);
+    }
+  };
+  place(0, &header, sizeof(header));
+  place(header.nodes_offset, writer.nodes.data(),
+        writer.nodes.size() * sizeof(ImageNode));
+  place(header.slots_offset, writer.slots.data(),
+        writer.slots.size() * sizeof(uint32_t));
+  place(header.strings_offset, writer.strings.data(),
+        writer.strings.size() * sizeof(uint32_t));
+  place(header.functions_offset, writer.functions.data(),
+        writer.functions.size() * sizeof(uint32_t));
+  place(header.blob_offset, writer.blob.data(), writer.blob.size());
+  return image;
+}
+
+bool writeImage(const std::string &file_path, const Program &program,
+                uint64_t source_hash) {
+  std::string image = buildImage(program, source_hash);
+
+  std::filesystem::path path(file_path);
+  std::error_code error;
+  if (path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path(), error);
+  }
+
+  std::string temporary = file_path + ".tmp";
+  {
+    std::ofstream file_stream(temporary, std::ios::binary | std::ios::trunc);
+    if (!file_stream.write(image.data(),
+                           static_cast<std::streamsize>(image.size()))) {
+      return false;
+    }
+  }
+  std::filesystem::rename(temporary, file_path, error);
+  return !error;
+}
+
+bool AstImage::open(const std::string &file_path) {
+  *this = AstImage();
+  if (!this->file_.open(file_path)) {
+    return false;
+  }
+  if (!this->validate()) {
+    *this = AstImage();
+    return false;
+  }
+  return true;
+}
+
+bool AstImage::validate() {
+  const char *data = this->file_.data();
+  uint64_t size = this->file_.size();
+  if (size < sizeof(ImageHeader)) {
+    return false;
+  }
+  ImageHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0 ||
+      header.version != IMAGE_VERSION || header.node_count == 0 ||
+      header.node_count >= IMAGE_LIST) {
+    return false;
+  }
+
+  auto fits = [size](uint64_t offset, uint64_t count, uint64_t width) {
+    return offset % 8 == 0 && offset <= size &&
+           count <= (size - offset) / width;
+  };
+  if (!fits(header.nodes_offset, header.node_count, sizeof(ImageNode)) ||
+      !fits(header.slots_offset, header.slot_count, sizeof(uint32_t)) ||
+      !fits(header.strings_offset, uint64_t(header.string_count) * 2,
+            sizeof(uint32_t)) ||
+      !fits(header.functions_offset, uint64_t(header.function_count) * 2,
+            sizeof(uint32_t)) ||
+      !fits(header.blob_offset, header.blob_size, 1)) {
+    return false;
+  }
+
+  auto *nodes = reinterpret_cast<const ImageNode *>(data + header.nodes_offset);
+  auto *slots = reinterpret_cast<const uint32_t *>(data + header.slots_offset);
+  auto *strings =
+      reinterpret_cast<const uint32_t *>(data + header.strings_offset);
+  auto *functions =
+      reinterpret_cast<const uint32_t *>(data + header.functions_offset);
+
+  for (uint32_t s = 0; s < header.string_count; s++) {
+    if (uint64_t(strings[2 * s]) + strings[2 * s + 1] > header.blob_size) {
+      return false;
+    }
+  }
+  if (nodes[0].nodeTag() != NodeTag::Program) {
+    return false;
+  }
+  std::vector<char> adopted(header.node_count, 0);
+  for (uint32_t id = 0; id < header.node_count; id++) {
+    const ImageNode &node = nodes[id];
+    if (node.tag >= NODE_TAG_COUNT ||
+        (node.text != IMAGE_NONE && node.text >= header.string_count) ||
+        uint64_t(node.first_slot) + node.slot_count > header.slot_count) {
+      return false;
+    }
+    // Children come after their parent, which rules out cycles, and have
+    // only one parent, which keeps materialize() linear in the image.
+    for (uint32_t i = 0; i < node.slot_count; i++) {
+      uint32_t slot = slots[node.first_slot + i];
+      if (slot == IMAGE_NONE || (slot & IMAGE_LIST) != 0) {
+        continue;
+      }
+      if (slot <= id || slot >= header.node_count || adopted[slot]) {
+        return false;
+      }
+      adopted[slot] = 1;
+    }
+  }
+  for (uint32_t f = 0; f < header.function_count; f++) {
+    if (functions[2 * f] >= header.string_count ||
+        functions[2 * f + 1] >= header.node_count) {
+      return false;
+    }
+  }
+
+  this->nodes_ = nodes;
+  this->slots_ = slots;
+  this->strings_ = strings;
+  this->functions_ = functions;
+  this->blob_ = data + header.blob_offset;
+  this->source_hash_ = header.source_hash;
+  this->node_count_ = header.node_count;
+  this->function_count_ = header.function_count;
+  return true;
+}
+
+std::string_view AstImage::text(uint32_t id) const {
+  uint32_t text = this->nodes_[id].text;
+  if (text == IMAGE_NONE) {
+    return std::string_view();
+  }
+  return std::string_view(this->blob_ + this->strings_[2 * text],
+                          this->strings_[2 * text + 1]);
+}
+
+std::vector<uint32_t> AstImage::functions(std::string_view name) const {
+  std::vector<uint32_t> result;
+  auto nameOf = [this](uint32_t f) {
+    uint32_t text = this->functions_[2 * f];
+    return std::string_view(this->blob_ + this->strings_[2 * text],
+                            this->strings_[2 * text + 1]);
+  };
+
+  // Binary search for the first entry not below the name.
+  uint32_t low = 0;
+  uint32_t high = this->function_count_;
+  while (low < high) {
+    uint32_t middle = low + (high - low) / 2;
+    if (nameOf(middle) < name) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  for (; low < this->function_count_ && nameOf(low) == name; low++) {
+    result.push_back(this->functions_[2 * low + 1]);
+  }
+  return result;
+}
+
+std::unique_ptr<Program> AstImage::materialize() const {
+  if (this->node_count_ == 0) {
+    return nullptr;
+  }
+  Reader reader(*this, this->slots_);
+  std::unique_ptr<Node> root = reader.decode();
+  if (reader.failed() || !root) {
+    return nullptr;
+  }
+  return std::unique_ptr<Program>(static_cast<Program *>(root.release()));
+}
+
+} // namespace ml::ast
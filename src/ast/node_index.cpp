@@ -0,0 +1,105 @@
+/**
+ * @file node_index.cpp
+ * @brief NodeIndex definitions for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/ast/node_index.h"
+#include "ml/ast/walk.h"
+
+#include <algorithm>
+
+namespace ml::ast {
+
+void NodeIndex::build(const Node &root) {
+  this->spans_.clear();
+  this->ancestors_.clear();
+
+  walk(root, [this](const Node &node) {
+    if (node.start.line != 0 && node.end.index > node.start.index) {
+      this->spans_.push_back({node.start.index, node.end.index, &node});
+    }
+    return true;
+  });
+
+  // Pre-order already lists parents before children; the stable sort only
+  // reorders siblings that the parser produced out of order.
+  std::stable_sort(this->spans_.begin(), this->spans_.end(),
+                   [](const Span &a, const Span &b) {
+                     return a.start < b.start ||
+                            (a.start == b.start && a.end > b.end);
+                   });
+
+  std::vector<uint32_t> parents(this->spans_.size(), NONE);
+  std::vector<uint32_t> stack;
+  for (uint32_t i = 0; i < this->spans_.size(); i++) {
+    Span &span = this->spans_[i];
+    while (!stack.empty() && this->spans_[stack.back()].end <= span.start) {
+      stack.pop_back();
+    }
+    if (!stack.empty()) {
+      parents[i] = stack.back();
+      span.end = std::min(span.end, this->spans_[stack.back()].end);
+    }
+    stack.push_back(i);
+  }
+
+  this->ancestors_.push_back(std::move(parents));
+  for (size_t level = 1;; level++) {
+    const auto &previous = this->ancestors_[level - 1];
+    std::vector<uint32_t> next(previous.size(), NONE);
+    bool any = false;
+    for (size_t i = 0; i < previous.size(); i++) {
+      if (previous[i] != NONE) {
+        next[i] = previous[previous[i]];
+        any = any || next[i] != NONE;
+      }
+    }
+    if (!any) {
+      break;
+    }
+    this->ancestors_.push_back(std::move(next));
+  }
+}
+
+uint32_t NodeIndex::innermost(uint64_t offset) const {
+  // The last span starting at or before the offset is either the answer or a
+  // descendant of it, because the spans are properly nested.
+  auto it = std::upper_bound(
+      this->spans_.begin(), this->spans_.end(), offset,
+      [](uint64_t value, const Span &span) { return value < span.start; });
+  if (it == this->spans_.begin()) {
+    return NONE;
+  }
+
+  uint32_t current = static_cast<uint32_t>(it - this->spans_.begin() - 1);
+  if (offset < this->spans_[current].end) {
+    return current;
+  }
+
+  // Ends grow towards the root, so jump to the highest ancestor that still
+  // ends at or before the offset; its parent is the answer.
+  for (size_t level = this->ancestors_.size(); level-- > 0;) {
+    uint32_t ancestor = this->ancestors_[level][current];
+    if (ancestor != NONE && this->spans_[ancestor].end <= offset) {
+      current = ancestor;
+    }
+  }
+  return this->ancestors_.empty() ? NONE : this->ancestors_[0][current];
+}
+
+const Node *NodeIndex::at(uint64_t offset) const {
+  uint32_t position = this->innermost(offset);
+  return position == NONE ? nullptr : this->spans_[position].node;
+}
+
+std::vector<const Node *> NodeIndex::path(uint64_t offset) const {
+  std::vector<const Node *> nodes;
+  for (uint32_t position = this->innermost(offset); position != NONE;
+       position = this->ancestors_[0][position]) {
+    nodes.push_back(this->spans_[position].node);
+  }
+  return nodes;
+}
+
+} // namespace ml::ast
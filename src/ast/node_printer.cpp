@@ -168,6 +168,30 @@ void NodePrinter::visit(AttributeExpression &v) {
   exit_node();
 }
 
+void NodePrinter::visit(SpawnExpression &v) {
+  print_line("SpawnExpression");
+  enter_node();
+
+  print_line("Call:");
+  enter_node();
+  print_node(*v.call);
+  exit_node();
+
+  exit_node();
+}
+
+void NodePrinter::visit(AwaitExpression &v) {
+  print_line("AwaitExpression");
+  enter_node();
+
+  print_line("Task:");
+  enter_node();
+  print_node(*v.task);
+  exit_node();
+
+  exit_node();
+}
+
 void NodePrinter::visit(Statement &v) { print_line("Statement"); }
 
 void NodePrinter::visit(ReturnStatement &v) {
@@ -0,0 +1,98 @@
+/**
+ * @file query.cpp
+ * @brief AST query definitions for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/ast/query.h"
+#include "ml/ast/cond.h"
+#include "ml/ast/walk.h"
+
+#include <algorithm>
+
+namespace ml::ast {
+
+namespace {
+
+/**
+ * @brief Checks whether a subtree contains a break that leaves it.
+ * @details Breaks inside nested loops leave those loops instead.
+ */
+bool breaks(const Node &node) {
+  switch (node.tag()) {
+  case NodeTag::BreakStatement:
+    return true;
+  case NodeTag::WhileConditional:
+  case NodeTag::ForConditional:
+  case NodeTag::FunctionDeclaration:
+    return false;
+  default: {
+    bool found = false;
+    forEachChild(node, [&found](const Node &child) {
+      found = found || breaks(child);
+    });
+    return found;
+  }
+  }
+}
+
+} // namespace
+
+const std::string *identifierName(const Node *node) {
+  if (node && node->tag() == NodeTag::IdentifierExpression) {
+    return &static_cast<const IdentifierExpression *>(node)->name;
+  }
+  return nullptr;
+}
+
+bool terminates(const Statement *statement) {
+  if (!statement) {
+    return false;
+  }
+  switch (statement->tag()) {
+  case NodeTag::ReturnStatement:
+  case NodeTag::BreakStatement:
+  case NodeTag::ContinueStatement:
+    return true;
+  case NodeTag::BlockStatement: {
+    const auto &statements =
+        static_cast<const BlockStatement *>(statement)->statements;
+    return std::any_of(statements.begin(), statements.end(),
+                       [](const auto &v) { return terminates(v.get()); });
+  }
+  case NodeTag::IfConditional: {
+    auto &v = static_cast<const IfConditional &>(*statement);
+    if (!v.else_branch || !terminates(v.then_branch.get()) ||
+        !terminates(v.else_branch.get())) {
+      return false;
+    }
+    return std::all_of(v.elif_branches.begin(), v.elif_branches.end(),
+                       [](const auto &elif) {
+                         return elif && terminates(elif->then_branch.get());
+                       });
+  }
+  case NodeTag::SwitchConditional: {
+    auto &v = static_cast<const SwitchConditional &>(*statement);
+    bool fallback = false;
+    for (const auto &branch : v.case_branches) {
+      if (!branch || !terminates(branch->then_branch.get()) ||
+          breaks(*branch->then_branch)) {
+        return false;
+      }
+      fallback = fallback || !branch->condition;
+    }
+    return fallback;
+  }
+  case NodeTag::WhileConditional: {
+    auto &v = static_cast<const WhileConditional &>(*statement);
+    auto *condition =
+        dynamic_cast<const LiteralExpression *>(v.condition.get());
+    return condition && condition->value == "true" && v.then_branch &&
+           !breaks(*v.then_branch);
+  }
+  default:
+    return false;
+  }
+}
+
+} // namespace ml::ast
@@ -0,0 +1,209 @@
+/**
+ * @file structural.cpp
+ * @brief Structural hashing definitions for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/ast/structural.h"
+#include "ml/ast/walk.h"
+#include "ml/basic/hash.h"
+
+namespace ml::ast {
+
+namespace {
+
+/**
+ * @brief Encodes which child slots of a node are filled.
+ * @details Optional children are skipped by forEachChild, so without the
+ * shape a declaration without a type and one without an initializer could
+ * produce the same child sequence.
+ */
+uint64_t shapeOf(const Node &node) {
+  uint64_t shape = 0;
+  forEachSlot(
+      node,
+      [&shape](const auto &child) { shape = (shape << 1) | (child ? 1 : 0); },
+      [&shape](const auto &children) {
+        uint64_t count = 0;
+        for (const auto &child : children) {
+          count += child ? 1 : 0;
+        }
+        shape = basic::hashCombine(shape, count);
+      });
+  return shape;
+}
+
+/**
+ * @brief Gets the text payload of a node: operator, literal value or name.
+ */
+std::string_view payloadOf(const Node &node) {
+  switch (node.tag()) {
+  case NodeTag::BinaryExpression:
+    return static_cast<const BinaryExpression &>(node).op;
+  case NodeTag::UnaryExpression:
+    return static_cast<const UnaryExpression &>(node).op;
+  case NodeTag::LiteralExpression:
+    return static_cast<const LiteralExpression &>(node).value;
+  case NodeTag::IdentifierExpression:
+  case NodeTag::ArrayIdentifierExpression:
+    return static_cast<const IdentifierExpression &>(node).name;
+  default:
+    return {};
+  }
+}
+
+/**
+ * @brief Gets the accessor and modifier flags of a ModifierStatement.
+ */
+uint64_t flagsOf(const Node &node) {
+  if (node.tag() != NodeTag::ModifierStatement) {
+    return 0;
+  }
+  auto &v = static_cast<const ModifierStatement &>(node);
+  return (static_cast<uint64_t>(v.accessor) << 32) |
+         static_cast<uint64_t>(v.modifier);
+}
+
+/**
+ * @brief Checks whether a node, ignoring its children, cannot change state.
+ */
+bool isLocallySideEffectFree(const Node &node) {
+  switch (node.tag()) {
+  case NodeTag::LiteralExpression:
+  case NodeTag::IdentifierExpression:
+  case NodeTag::IndexExpression:
+  case NodeTag::AttributeExpression:
+  case NodeTag::ArrayExpression:
+    return true;
+  case NodeTag::BinaryExpression:
+    return static_cast<const BinaryExpression &>(node).op != "=";
+  case NodeTag::UnaryExpression: {
+    auto &op = static_cast<const UnaryExpression &>(node).op;
+    return op != "++" && op != "--";
+  }
+  default:
+    return false;
+  }
+}
+
+} // namespace
+
+uint64_t localHash(const Node &node) {
+  uint64_t hash = basic::hashCombine(basic::FNV_OFFSET,
+                                     static_cast<uint64_t>(node.tag()));
+  hash = basic::fnv1a(payloadOf(node), hash);
+  hash = basic::hashCombine(hash, flagsOf(node));
+  return basic::hashCombine(hash, shapeOf(node));
+}
+
+bool localEqual(const Node &a, const Node &b) {
+  return a.tag() == b.tag() && payloadOf(a) == payloadOf(b) &&
+         flagsOf(a) == flagsOf(b) && shapeOf(a) == shapeOf(b);
+}
+
+bool structurallyEqual(const Node &a, const Node &b) {
+  struct Pair {
+    const Node *a;
+    const Node *b;
+  };
+  basic::SmallVector<Pair, ITERATOR_INLINE_DEPTH> stack;
+  basic::SmallVector<const Node *, ITERATOR_INLINE_DEPTH> children;
+  stack.push_back({&a, &b});
+
+  while (!stack.empty()) {
+    Pair pair = stack.back();
+    stack.pop_back();
+    if (pair.a == pair.b) {
+      continue;
+    }
+    if (!localEqual(*pair.a, *pair.b)) {
+      return false;
+    }
+
+    // Equal shapes guarantee the same number of children in the same slots.
+    children.clear();
+    forEachChild(*pair.a, [&children](const Node &child) {
+      children.push_back(&child);
+    });
+    size_t index = 0;
+    forEachChild(*pair.b, [&](const Node &child) {
+      stack.push_back({children[index++], &child});
+    });
+  }
+  return true;
+}
+
+bool isSideEffectFree(const Node &node) {
+  for (const Node &child : preOrder(node)) {
+    if (!isLocallySideEffectFree(child)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint64_t StructuralHashes::add(const Node &root) {
+  for (const Node &node : postOrder(root)) {
+    uint64_t hash = localHash(node);
+    forEachChild(node, [this, &hash](const Node &child) {
+      hash = basic::hashCombine(hash, this->hashes_.at(&child));
+    });
+    this->hashes_[&node] = hash;
+  }
+  return this->hashes_.at(&root);
+}
+
+uint64_t structuralHash(const Node &node) {
+  return StructuralHashes().add(node);
+}
+
+void HashConsTable::add(const Node &root) {
+  this->hashes_.add(root);
+
+  // Purity is computed bottom-up so each node is only inspected once.
+  std::unordered_map<const Node *, bool> pure;
+  for (const Node &node : postOrder(root)) {
+    bool eligible = true;
+    if (this->immutable_only_) {
+      eligible = isLocallySideEffectFree(node);
+      forEachChild(node, [&pure, &eligible](const Node &child) {
+        eligible = eligible && pure[&child];
+      });
+      pure[&node] = eligible;
+    }
+    if (!eligible) {
+      continue;
+    }
+
+    Bucket &bucket = this->buckets_[this->hashes_.of(node)];
+    const Node *canonical = nullptr;
+    for (const Node *candidate : bucket) {
+      if (structurallyEqual(*candidate, node)) {
+        canonical = candidate;
+        break;
+      }
+    }
+    if (canonical) {
+      this->duplicates_++;
+    } else {
+      canonical = &node;
+      bucket.push_back(canonical);
+    }
+    this->canonical_[&node] = canonical;
+  }
+}
+
+const Node *HashConsTable::canonical(const Node &node) const {
+  auto it = this->canonical_.find(&node);
+  return it == this->canonical_.end() ? nullptr : it->second;
+}
+
+size_t HashConsTable::uniqueCount() const {
+  size_t count = 0;
+  for (const auto &[hash, bucket] : this->buckets_) {
+    count += bucket.size();
+  }
+  return count;
+}
+
+} // namespace ml::ast
@@ -6,6 +6,8 @@
 
 #include "ml/basic/error.h"
 
+#include <mutex>
+
 namespace ml::basic {
 
 const char *Error::what() const noexcept { return this->desc.c_str(); }
@@ -118,6 +120,10 @@ void Error::log() const noexcept {
   std::string blue = use_colors ? BLUE : "";
   std::string white = use_colors ? WHITE : "";
 
+  // Build the whole message first, so diagnostics logged from several
+  // threads never interleave.
+  std::ostringstream out;
+
   // Error level prefix
   std::string level_str;
   switch (this->level) {
@@ -135,31 +141,31 @@ void Error::log() const noexcept {
     break;
   }
 
-  std::cerr << level_color << bold << level_str << reset;
+  out << level_color << bold << level_str << reset;
   if (code != 0) {
-    std::cerr << dim << "[" << std::setfill('0') << std::setw(4) << code << "]"
-              << reset;
+    out << dim << "[" << std::setfill('0') << std::setw(4) << code << "]"
+        << reset;
   }
-  std::cerr << ": " << bold << this->what() << reset << std::endl;
+  out << ": " << bold << this->what() << reset << std::endl;
 
   if (this->start_.line > 0) {
     uint64_t display_column = (this->start_.column > 1)
                                   ? this->start_.column - 1
                                   : this->start_.column;
-    std::cerr << dim << "   --> " << file_ << ":" << this->start_.line << ":"
-              << display_column << reset << std::endl;
+    out << dim << "   --> " << file_ << ":" << this->start_.line << ":"
+        << display_column << reset << std::endl;
   }
 
-  std::cerr << dim << "  |" << reset << std::endl;
+  out << dim << "  |" << reset << std::endl;
 
   if (start_.line > 0) {
     int line_width = this->getLineNumberWidth();
     std::string error_line = this->getErrorLine();
 
-    std::cerr << dim << std::setw(line_width) << this->start_.line << " | "
-              << reset << error_line << std::endl;
+    out << dim << std::setw(line_width) << this->start_.line << " | "
+        << reset << error_line << std::endl;
 
-    std::cerr << dim << std::string(line_width, ' ') << " | " << reset;
+    out << dim << std::string(line_width, ' ') << " | " << reset;
 
     uint64_t error_start =
         (this->start_.column > 1) ? this->start_.column - 1 : 0;
@@ -167,23 +173,26 @@ void Error::log() const noexcept {
         (end_.column > start_.column) ? (end_.column - start_.column) : 2;
 
     for (uint64_t i = 0; i < error_start; i++) {
-      std::cerr << " ";
+      out << " ";
     }
 
-    std::cerr << level_color << bold;
+    out << level_color << bold;
     for (uint64_t i = 0; i < error_length; i++) {
-      std::cerr << "^";
+      out << "^";
     }
-    std::cerr << reset << std::endl;
+    out << reset << std::endl;
 
-    std::cerr << dim << std::string(line_width, ' ') << " | " << reset
-              << std::endl;
-    std::cerr << dim << std::string(line_width, ' ') << " | " << reset;
-    std::cerr << blue << "help: " << reset << this->help << std::endl;
-    std::cerr << std::endl;
+    out << dim << std::string(line_width, ' ') << " | " << reset << std::endl;
+    out << dim << std::string(line_width, ' ') << " | " << reset;
+    out << blue << "help: " << reset << this->help << std::endl;
+    out << std::endl;
   }
 
-  std::cerr << std::endl;
+  out << std::endl;
+
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+  std::cerr << out.str();
   std::cerr.flush();
 }
 
@@ -0,0 +1,118 @@
+/**
+ * @file mapped_file.cpp
+ * @brief Memory-mapped file source code for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/basic/mapped_file.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ml::basic {
+
+MappedFile::MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    this->close();
+    this->data_ = std::exchange(other.data_, nullptr);
+    this->size_ = std::exchange(other.size_, 0);
+#ifdef _WIN32
+    this->file_ = std::exchange(other.file_, nullptr);
+    this->mapping_ = std::exchange(other.mapping_, nullptr);
+#endif
+  }
+  return *this;
+}
+
+void MappedFile::close() noexcept {
+#ifdef _WIN32
+  if (this->data_) {
+    UnmapViewOfFile(this->data_);
+  }
+  if (this->mapping_) {
+    CloseHandle(this->mapping_);
+  }
+  if (this->file_) {
+    CloseHandle(this->file_);
+  }
+  this->file_ = nullptr;
+  this->mapping_ = nullptr;
+#else
+  if (this->data_) {
+    munmap(const_cast<char *>(this->data_), this->size_);
+  }
+#endif
+  this->data_ = nullptr;
+  this->size_ = 0;
+}
+
+bool MappedFile::open(const std::string &file_path) {
+  this->close();
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    return false;
+  }
+  this->file_ = file;
+  if (size.QuadPart == 0) {
+    return true;
+  }
+  this->mapping_ =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!this->mapping_) {
+    this->close();
+    return false;
+  }
+  this->data_ = static_cast<const char *>(
+      MapViewOfFile(this->mapping_, FILE_MAP_READ, 0, 0, 0));
+  if (!this->data_) {
+    this->close();
+    return false;
+  }
+  this->size_ = static_cast<size_t>(size.QuadPart);
+  return true;
+#else
+  int fd = ::open(file_path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    ::close(fd);
+    return false;
+  }
+  if (info.st_size == 0) {
+    ::close(fd);
+    return true;
+  }
+  void *data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ,
+                    MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  this->data_ = static_cast<const char *>(data);
+  this->size_ = static_cast<size_t>(info.st_size);
+  return true;
+#endif
+}
+
+} // namespace ml::basic
@@ -0,0 +1,251 @@
+/**
+ * @file number.cpp
+ * @brief Implementation of numeric literal scanning and conversion.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/basic/number.h"
+
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <string>
+
+namespace ml::basic {
+
+namespace {
+
+bool isDigit(char c, int base) {
+  switch (base) {
+  case 2:
+    return c == '0' || c == '1';
+  case 16:
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') ||
+           (c >= 'A' && c <= 'F');
+  default:
+    return c >= '0' && c <= '9';
+  }
+}
+
+/**
+ * @brief Reads the base prefix of a literal.
+ * @return The base, with the length of its prefix in prefix.
+ */
+int baseOf(std::string_view text, size_t index, size_t &prefix) {
+  prefix = 0;
+  if (index + 2 < text.size() && text[index] == '0') {
+    char marker = text[index + 1];
+    int base = marker == 'x' || marker == 'X'   ? 16
+               : marker == 'b' || marker == 'B' ? 2
+                                                : 10;
+    if (base != 10 && isDigit(text[index + 2], base)) {
+      prefix = 2;
+      return base;
+    }
+  }
+  return 10;
+}
+
+NumberSuffix suffixOf(std::string_view text) {
+  static constexpr NumberSuffix suffixes[] = {
+      NumberSuffix::I8,  NumberSuffix::I16, NumberSuffix::I32,
+      NumberSuffix::I64, NumberSuffix::U8,  NumberSuffix::U16,
+      NumberSuffix::U32, NumberSuffix::U64, NumberSuffix::F32,
+      NumberSuffix::F64,
+  };
+  for (NumberSuffix suffix : suffixes) {
+    if (text == suffixName(suffix)) {
+      return suffix;
+    }
+  }
+  return NumberSuffix::None;
+}
+
+bool isFloatSuffix(NumberSuffix suffix) {
+  return suffix == NumberSuffix::F32 || suffix == NumberSuffix::F64;
+}
+
+/**
+ * @brief Gets the largest magnitude an integer literal may have.
+ */
+uint64_t limitOf(NumberSuffix suffix) {
+  switch (suffix) {
+  case NumberSuffix::I8:
+    return uint64_t(1) << 7;
+  case NumberSuffix::I16:
+    return uint64_t(1) << 15;
+  case NumberSuffix::I32:
+    return uint64_t(1) << 31;
+  case NumberSuffix::I64:
+    return uint64_t(1) << 63;
+  case NumberSuffix::U8:
+    return 0xFF;
+  case NumberSuffix::U16:
+    return 0xFFFF;
+  case NumberSuffix::U32:
+    return 0xFFFFFFFF;
+  default:
+    return std::numeric_limits<uint64_t>::max();
+  }
+}
+
+} // namespace
+
+std::string_view suffixName(NumberSuffix suffix) {
+  switch (suffix) {
+  case NumberSuffix::I8:
+    return "i8";
+  case NumberSuffix::I16:
+    return "i16";
+  case NumberSuffix::I32:
+    return "i32";
+  case NumberSuffix::I64:
+    return "i64";
+  case NumberSuffix::U8:
+    return "u8";
+  case NumberSuffix::U16:
+    return "u16";
+  case NumberSuffix::U32:
+    return "u32";
+  case NumberSuffix::U64:
+    return "u64";
+  case NumberSuffix::F32:
+    return "f32";
+  case NumberSuffix::F64:
+    return "f64";
+  default:
+    return "";
+  }
+}
+
+size_t scanNumber(std::string_view text, size_t index) {
+  size_t size = text.size();
+  if (index >= size || !isDigit(text[index], 10)) {
+    return index;
+  }
+
+  size_t prefix;
+  int base = baseOf(text, index, prefix);
+  size_t i = index + prefix;
+  auto digits = [&text, size, base](size_t at) {
+    while (at < size && (isDigit(text[at], base) || text[at] == '_')) {
+      at++;
+    }
+    return at;
+  };
+  i = digits(i);
+
+  if (base == 10) {
+    if (i + 1 < size && text[i] == '.' && isDigit(text[i + 1], 10)) {
+      i = digits(i + 1);
+    }
+    if (i < size && (text[i] == 'e' || text[i] == 'E')) {
+      size_t exponent = i + 1;
+      if (exponent < size &&
+          (text[exponent] == '+' || text[exponent] == '-')) {
+        exponent++;
+      }
+      if (exponent < size && isDigit(text[exponent], 10)) {
+        i = digits(exponent);
+      }
+    }
+  }
+
+  if (i < size && (text[i] == 'i' || text[i] == 'u' || text[i] == 'f')) {
+    size_t end = i + 1;
+    while (end < size && isDigit(text[end], 10)) {
+      end++;
+    }
+    bool boundary =
+        end >= size ||
+        !(std::isalnum(static_cast<unsigned char>(text[end])) ||
+          text[end] == '_');
+    if (boundary && suffixOf(text.substr(i, end - i)) != NumberSuffix::None) {
+      i = end;
+    }
+  }
+  return i;
+}
+
+bool parseNumber(std::string_view literal, Number &number) {
+  number = Number();
+  if (literal.empty() || !isDigit(literal[0], 10)) {
+    return false;
+  }
+
+  size_t prefix;
+  int base = baseOf(literal, 0, prefix);
+  size_t i = prefix;
+  bool is_float = false;
+  bool separated = false;
+  while (i < literal.size()) {
+    char c = literal[i];
+    if (isDigit(c, base)) {
+      i++;
+    } else if (c == '_') {
+      separated = true;
+      i++;
+    } else if (base == 10 && c == '.') {
+      is_float = true;
+      i++;
+    } else if (base == 10 && (c == 'e' || c == 'E')) {
+      is_float = true;
+      i++;
+      if (i < literal.size() && (literal[i] == '+' || literal[i] == '-')) {
+        i++;
+      }
+    } else {
+      break;
+    }
+  }
+
+  std::string_view rest = literal.substr(i);
+  number.suffix = suffixOf(rest);
+  if (!rest.empty() && number.suffix == NumberSuffix::None) {
+    return false;
+  }
+  if (isFloatSuffix(number.suffix)) {
+    if (base != 10) {
+      return false;
+    }
+    is_float = true;
+  } else if (is_float && number.suffix != NumberSuffix::None) {
+    return false;
+  }
+  number.kind = is_float ? NumberKind::Float : NumberKind::Integer;
+
+  // Separators are rare; only literals that use them pay for a copy.
+  std::string_view digits = literal.substr(prefix, i - prefix);
+  std::string compact;
+  if (separated) {
+    compact.reserve(digits.size());
+    for (char c : digits) {
+      if (c != '_') {
+        compact += c;
+      }
+    }
+    digits = compact;
+  }
+  const char *first = digits.data();
+  const char *last = digits.data() + digits.size();
+
+  if (is_float) {
+    std::from_chars_result result;
+    if (number.suffix == NumberSuffix::F32) {
+      float value = 0.0f;
+      result = std::from_chars(first, last, value);
+      number.real = value;
+    } else {
+      result = std::from_chars(first, last, number.real);
+    }
+    return result.ec == std::errc() && result.ptr == last &&
+           std::isfinite(number.real);
+  }
+
+  auto result = std::from_chars(first, last, number.integer, base);
+  return result.ec == std::errc() && result.ptr == last &&
+         number.integer <= limitOf(number.suffix);
+}
+
+} // namespace ml::basic
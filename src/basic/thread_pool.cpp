@@ -0,0 +1,247 @@
+/**
+ * @file thread_pool.cpp
+ * @brief Implementation of the work-stealing thread pool.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/basic/thread_pool.h"
+#include "ml/basic/parallel.h"
+
+namespace ml::basic {
+
+namespace {
+
+/**
+ * @struct CurrentWorker thread_pool.cpp
+ * @brief Identifies the pool and worker the calling thread belongs to.
+ */
+struct CurrentWorker {
+  const ThreadPool *pool = nullptr; // The pool, or nullptr outside any pool
+  size_t index = 0;                 // The worker index in the pool
+};
+
+thread_local CurrentWorker current;
+
+/**
+ * @brief Advances a xorshift generator, used to spread steal attempts.
+ */
+uint64_t nextRandom(uint64_t &state) {
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+thread_local uint64_t outside_seed = 0x9E3779B97F4A7C15ull;
+
+} // namespace
+
+ThreadPool::ThreadPool(unsigned threads) {
+  if (threads == 0) {
+    threads = defaultJobs();
+  }
+  for (unsigned i = 0; i < threads; i++) {
+    auto worker = std::make_unique<Worker>();
+    worker->seed = 0x9E3779B97F4A7C15ull * (i + 1);
+    this->workers_.push_back(std::move(worker));
+  }
+  this->threads_.reserve(threads);
+  for (unsigned i = 0; i < threads; i++) {
+    this->threads_.emplace_back([this, i]() { this->work(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  this->stopping_.store(true);
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+  }
+  this->wake_.notify_all();
+  for (auto &thread : this->threads_) {
+    thread.join();
+  }
+}
+
+ThreadPool &ThreadPool::global() {
+  static ThreadPool pool;
+  return pool;
+}
+
+void ThreadPool::submit(Task *task) {
+  if (current.pool == this) {
+    this->workers_[current.index]->deque.push(task);
+    this->queued_.fetch_add(1);
+    // A sleeping worker either sees queued_ before it blocks, or blocks
+    // before we look at sleeping_ and is woken here.
+    if (this->sleeping_.load() > 0) {
+      {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+      }
+      this->wake_.notify_one();
+    }
+    this->signalJoiners();
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->injected_.push_back(task);
+    this->queued_.fetch_add(1);
+  }
+  this->inject_count_.fetch_add(1, std::memory_order_relaxed);
+  this->wake_.notify_one();
+  this->signalJoiners();
+}
+
+ThreadPool::Task *ThreadPool::take() {
+  Worker *self = current.pool == this
+                     ? this->workers_[current.index].get()
+                     : nullptr;
+  Task *task = nullptr;
+  if (self != nullptr && self->deque.pop(task)) {
+    this->queued_.fetch_sub(1);
+    return task;
+  }
+  if (this->queued_.load() == 0) {
+    return nullptr;
+  }
+
+  size_t count = this->workers_.size();
+  uint64_t &seed = self != nullptr ? self->seed : outside_seed;
+  size_t start = static_cast<size_t>(nextRandom(seed) % count);
+  for (size_t i = 0; i < count; i++) {
+    Worker *victim = this->workers_[(start + i) % count].get();
+    if (victim != self && victim->deque.steal(task)) {
+      this->queued_.fetch_sub(1);
+      this->stolen_.fetch_add(1, std::memory_order_relaxed);
+      return task;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  if (this->injected_.empty()) {
+    return nullptr;
+  }
+  task = this->injected_.front();
+  this->injected_.pop_front();
+  this->queued_.fetch_sub(1);
+  return task;
+}
+
+void ThreadPool::execute(Task *task) {
+  TaskGroup *group = task->group;
+  if (!group->cancelled()) {
+    try {
+      task->function();
+    } catch (...) {
+      group->fail(std::current_exception());
+    }
+  }
+  delete task;
+  this->executed_.fetch_add(1, std::memory_order_relaxed);
+  // Last: once pending_ drops, the waiter may destroy the group, so only
+  // the pool is touched afterwards.
+  if (group->pending_.fetch_sub(1) == 1) {
+    this->signalJoiners();
+  }
+}
+
+void ThreadPool::work(size_t index) {
+  current.pool = this;
+  current.index = index;
+  while (true) {
+    if (Task *task = this->take()) {
+      this->execute(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    if (this->stopping_.load() && this->queued_.load() == 0) {
+      break;
+    }
+    this->sleeping_.fetch_add(1);
+    this->wake_.wait(lock, [this]() {
+      return this->queued_.load() > 0 || this->stopping_.load();
+    });
+    this->sleeping_.fetch_sub(1);
+  }
+  current = CurrentWorker();
+}
+
+void ThreadPool::signalJoiners() {
+  // A joiner either sees the change before it blocks, or blocks before we
+  // look at joining_ and is woken here.
+  if (this->joining_.load() > 0) {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+    }
+    this->joined_.notify_all();
+  }
+}
+
+bool ThreadPool::runPending() {
+  Task *task = this->take();
+  if (task == nullptr) {
+    return false;
+  }
+  this->execute(task);
+  return true;
+}
+
+PoolStats ThreadPool::stats() const {
+  PoolStats stats;
+  stats.executed = this->executed_.load(std::memory_order_relaxed);
+  stats.stolen = this->stolen_.load(std::memory_order_relaxed);
+  stats.injected = this->inject_count_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+TaskGroup::TaskGroup(ThreadPool &pool) : pool_(pool) {}
+
+TaskGroup::~TaskGroup() { this->join(); }
+
+void TaskGroup::fail(std::exception_ptr error) {
+  {
+    std::lock_guard<std::mutex> lock(this->error_mutex_);
+    if (!this->error_) {
+      this->error_ = error;
+    }
+  }
+  this->cancel();
+}
+
+void TaskGroup::run(std::function<void()> function) {
+  this->pending_.fetch_add(1, std::memory_order_relaxed);
+  this->pool_.submit(
+      new ThreadPool::Task{std::move(function), this});
+}
+
+void TaskGroup::join() {
+  ThreadPool &pool = this->pool_;
+  while (this->pending_.load() > 0) {
+    if (pool.runPending()) {
+      continue;
+    }
+    // Nothing to help with: the remaining tasks are running elsewhere.
+    // Sleep until one of them finishes the group or more work is queued.
+    std::unique_lock<std::mutex> lock(pool.mutex_);
+    pool.joining_.fetch_add(1);
+    pool.joined_.wait(lock, [this, &pool]() {
+      return this->pending_.load() == 0 || pool.queued_.load() > 0;
+    });
+    pool.joining_.fetch_sub(1);
+  }
+}
+
+void TaskGroup::wait() {
+  this->join();
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> lock(this->error_mutex_);
+    std::swap(error, this->error_);
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace ml::basic
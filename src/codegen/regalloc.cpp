@@ -0,0 +1,186 @@
+/**
+ * @file regalloc.cpp
+ * @brief Register allocation source code for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/codegen/regalloc.h"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <numeric>
+#include <queue>
+
+namespace ml::codegen {
+
+namespace {
+
+/**
+ * @brief Gets the number of uses of an interval per position it covers.
+ * @details Values used rarely over a long range are the cheapest to keep
+ * in memory.
+ */
+double spillWeight(const LiveInterval &interval) {
+  return static_cast<double>(interval.uses.size()) /
+         static_cast<double>(interval.end - interval.start + 1);
+}
+
+/**
+ * @brief Gets the number of virtual registers the intervals refer to.
+ */
+size_t registerCount(const std::vector<LiveInterval> &intervals) {
+  size_t count = 0;
+  for (const auto &interval : intervals) {
+    count = std::max(count, static_cast<size_t>(interval.vreg) + 1);
+  }
+  return count;
+}
+
+/**
+ * @brief Orders intervals by start, then end.
+ */
+std::vector<size_t> byStart(const std::vector<LiveInterval> &intervals,
+                            std::vector<size_t> order) {
+  std::stable_sort(order.begin(), order.end(),
+                   [&intervals](size_t a, size_t b) {
+                     if (intervals[a].start != intervals[b].start) {
+                       return intervals[a].start < intervals[b].start;
+                     }
+                     return intervals[a].end < intervals[b].end;
+                   });
+  return order;
+}
+
+/**
+ * @brief Gives stack slots to spilled intervals, sharing a slot between
+ * intervals that do not overlap.
+ */
+void assignStackSlots(const std::vector<LiveInterval> &intervals,
+                      const std::vector<size_t> &spilled,
+                      Allocation &allocation) {
+  std::multimap<uint32_t, uint32_t> live; // Slots in use, by end position
+  std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<>> free;
+
+  for (size_t index : byStart(intervals, spilled)) {
+    const LiveInterval &interval = intervals[index];
+    while (!live.empty() && live.begin()->first <= interval.start) {
+      free.push(live.begin()->second);
+      live.erase(live.begin());
+    }
+    uint32_t slot;
+    if (free.empty()) {
+      slot = static_cast<uint32_t>(allocation.stack_slots++);
+    } else {
+      slot = free.top();
+      free.pop();
+    }
+    allocation.locations[interval.vreg] = {Location::Kind::Stack, slot};
+    live.emplace(interval.end, slot);
+    allocation.spilled++;
+    allocation.memory_accesses += interval.uses.size();
+  }
+}
+
+} // namespace
+
+Allocation allocateLinearScan(const std::vector<LiveInterval> &intervals,
+                              const std::vector<Move> &moves,
+                              uint32_t registers) {
+  Allocation allocation;
+  size_t count = registerCount(intervals);
+  allocation.locations.resize(count);
+
+  std::vector<std::vector<uint32_t>> partners(count);
+  for (const Move &move : moves) {
+    if (move.from < count && move.to < count) {
+      partners[move.from].push_back(move.to);
+      partners[move.to].push_back(move.from);
+    }
+  }
+
+  std::vector<size_t> order(intervals.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::multimap<uint32_t, size_t> active; // Intervals in registers, by end
+  std::vector<bool> free(registers, true);
+  std::vector<size_t> spilled;
+
+  for (size_t index : byStart(intervals, std::move(order))) {
+    const LiveInterval &current = intervals[index];
+    while (!active.empty() && active.begin()->first <= current.start) {
+      const LiveInterval &expired = intervals[active.begin()->second];
+      free[allocation.locations[expired.vreg].index] = true;
+      active.erase(active.begin());
+    }
+
+    // The register of a move partner coalesces the move.
+    int64_t chosen = -1;
+    for (uint32_t partner : partners[current.vreg]) {
+      const Location &location = allocation.locations[partner];
+      if (location.kind == Location::Kind::Register && free[location.index]) {
+        chosen = location.index;
+        break;
+      }
+    }
+    if (chosen < 0) {
+      auto it = std::find(free.begin(), free.end(), true);
+      if (it != free.end()) {
+        chosen = it - free.begin();
+      }
+    }
+    if (chosen >= 0) {
+      free[chosen] = false;
+      allocation.locations[current.vreg] = {Location::Kind::Register,
+                                            static_cast<uint32_t>(chosen)};
+      active.emplace(current.end, index);
+      continue;
+    }
+
+    // Every register is taken: spill the interval that is worth least.
+    auto victim = active.end();
+    double lowest = spillWeight(current);
+    uint32_t last = current.end;
+    for (auto it = active.begin(); it != active.end(); ++it) {
+      double weight = spillWeight(intervals[it->second]);
+      if (weight < lowest || (weight == lowest && it->first > last)) {
+        victim = it;
+        lowest = weight;
+        last = it->first;
+      }
+    }
+    if (victim == active.end()) {
+      spilled.push_back(index);
+      continue;
+    }
+    allocation.locations[current.vreg] =
+        allocation.locations[intervals[victim->second].vreg];
+    spilled.push_back(victim->second);
+    active.erase(victim);
+    active.emplace(current.end, index);
+  }
+
+  assignStackSlots(intervals, spilled, allocation);
+  for (const Move &move : moves) {
+    Location from = allocation.at(move.from);
+    Location to = allocation.at(move.to);
+    if (from.kind == Location::Kind::Register &&
+        to.kind == Location::Kind::Register && from.index == to.index) {
+      allocation.coalesced++;
+    }
+  }
+  return allocation;
+}
+
+Allocation allocateStackSlots(const std::vector<LiveInterval> &intervals) {
+  Allocation allocation;
+  allocation.locations.resize(registerCount(intervals));
+  for (const auto &interval : intervals) {
+    allocation.locations[interval.vreg] = {
+        Location::Kind::Stack, static_cast<uint32_t>(allocation.stack_slots++)};
+    allocation.spilled++;
+    allocation.memory_accesses += interval.uses.size();
+  }
+  return allocation;
+}
+
+} // namespace ml::codegen
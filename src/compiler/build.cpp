@@ -0,0 +1,259 @@
+/**
+ * @file build.cpp
+ * @brief Incremental build source code for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/compiler/build.h"
+#include "ml/basic/hash.h"
+#include "ml/basic/parallel.h"
+#include "ml/compiler/compiler.h"
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace ml::compiler {
+
+namespace {
+
+const char *const DATABASE_HEADER = "# my_lang build database v1";
+
+std::string toHex(uint64_t value) {
+  std::ostringstream stream;
+  stream << std::hex << std::setw(16) << std::setfill('0') << value;
+  return stream.str();
+}
+
+} // namespace
+
+bool BuildDatabase::load(const std::string &file_path) {
+  this->entries_.clear();
+
+  std::ifstream file_stream(file_path);
+  if (!file_stream.is_open()) {
+    return false;
+  }
+
+  std::string line;
+  if (!std::getline(file_stream, line) || line != DATABASE_HEADER) {
+    return false;
+  }
+
+  BuildEntry *current = nullptr;
+  while (std::getline(file_stream, line)) {
+    std::istringstream fields(line);
+    std::string tag;
+    fields >> tag;
+
+    if (tag == "file") {
+      std::string hash;
+      std::string ok;
+      fields >> hash >> ok;
+      fields.ignore(1);
+
+      BuildEntry entry;
+      std::getline(fields, entry.path);
+      const char *end = hash.data() + hash.size();
+      auto [rest, error] = std::from_chars(hash.data(), end, entry.hash, 16);
+      if (error != std::errc() || rest != end || hash.empty() ||
+          (ok != "0" && ok != "1") || entry.path.empty()) {
+        this->entries_.clear();
+        return false;
+      }
+      entry.ok = ok == "1";
+      current = &(this->entries_[entry.path] = std::move(entry));
+    } else if (current && (tag == "out" || tag == "import")) {
+      fields.ignore(1);
+      std::string value;
+      std::getline(fields, value);
+      if (tag == "out") {
+        current->output = value;
+      } else {
+        current->imports.push_back(value);
+      }
+    } else {
+      this->entries_.clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+bool BuildDatabase::save(const std::string &file_path) const {
+  std::filesystem::path path(file_path);
+  std::error_code error;
+  if (path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path(), error);
+  }
+
+  std::ofstream file_stream(file_path, std::ios::trunc);
+  if (!file_stream.is_open()) {
+    return false;
+  }
+
+  // Sort the entries so the file is stable between runs.
+  std::vector<const BuildEntry *> entries;
+  entries.reserve(this->entries_.size());
+  for (const auto &[path, entry] : this->entries_) {
+    entries.push_back(&entry);
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const BuildEntry *a, const BuildEntry *b) {
+              return a->path < b->path;
+            });
+
+  file_stream << DATABASE_HEADER << "\n";
+  for (const auto *entry : entries) {
+    file_stream << "file " << toHex(entry->hash) << " " << (entry->ok ? 1 : 0)
+                << " " << entry->path << "\n";
+    if (!entry->output.empty()) {
+      file_stream << "out " << entry->output << "\n";
+    }
+    for (const auto &import : entry->imports) {
+      file_stream << "import " << import << "\n";
+    }
+  }
+  return static_cast<bool>(file_stream);
+}
+
+const BuildEntry *BuildDatabase::find(const std::string &path) const {
+  auto it = this->entries_.find(path);
+  return it == this->entries_.end() ? nullptr : &it->second;
+}
+
+void BuildDatabase::update(BuildEntry entry) {
+  std::string path = entry.path;
+  this->entries_[path] = std::move(entry);
+}
+
+std::vector<std::string>
+Builder::collectSources(const std::vector<std::string> &paths) {
+  std::vector<std::string> sources;
+  for (const auto &path : paths) {
+    std::error_code error;
+    if (std::filesystem::is_directory(path, error)) {
+      for (const auto &item :
+           std::filesystem::recursive_directory_iterator(path, error)) {
+        if (item.is_regular_file() && item.path().extension() == ".ml") {
+          sources.push_back(item.path().generic_string());
+        }
+      }
+    } else {
+      sources.push_back(std::filesystem::path(path).generic_string());
+    }
+  }
+  std::sort(sources.begin(), sources.end());
+  sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+  return sources;
+}
+
+BuildSummary Builder::build(const std::vector<std::string> &sources) {
+  BuildDatabase database;
+  database.load(this->options_.database);
+
+  unsigned jobs = this->options_.jobs == 0 ? basic::defaultJobs()
+                                           : this->options_.jobs;
+
+  BuildSummary summary;
+  summary.total = sources.size();
+
+  // Read and hash every source file.
+  std::vector<std::string> contents(sources.size());
+  std::vector<uint64_t> hashes(sources.size(), 0);
+  std::vector<char> readable(sources.size(), 0);
+  basic::parallelFor(sources.size(), jobs, [&](size_t i) {
+    try {
+      contents[i] = Compiler::readFile(sources[i]);
+      hashes[i] = basic::fnv1a(contents[i]);
+      readable[i] = 1;
+    } catch (const std::exception &) {
+      readable[i] = 0;
+    }
+  });
+
+  // A file is dirty when it changed or did not build cleanly last time.
+  std::vector<char> dirty(sources.size(), 0);
+  std::unordered_map<std::string, size_t> indices;
+  for (size_t i = 0; i < sources.size(); i++) {
+    indices[sources[i]] = i;
+    const BuildEntry *entry = database.find(sources[i]);
+    dirty[i] = !entry || !entry->ok || entry->hash != hashes[i];
+  }
+
+  // Propagate dirtiness along the recorded import edges.
+  std::unordered_map<size_t, std::vector<size_t>> importers;
+  for (size_t i = 0; i < sources.size(); i++) {
+    if (const BuildEntry *entry = database.find(sources[i])) {
+      for (const auto &import : entry->imports) {
+        auto it = indices.find(import);
+        if (it != indices.end()) {
+          importers[it->second].push_back(i);
+        }
+      }
+    }
+  }
+  std::vector<size_t> worklist;
+  for (size_t i = 0; i < sources.size(); i++) {
+    if (dirty[i]) {
+      worklist.push_back(i);
+    }
+  }
+  while (!worklist.empty()) {
+    size_t index = worklist.back();
+    worklist.pop_back();
+    for (size_t importer : importers[index]) {
+      if (!dirty[importer]) {
+        dirty[importer] = 1;
+        worklist.push_back(importer);
+      }
+    }
+  }
+
+  // Compile the dirty files.
+  std::vector<size_t> schedule;
+  for (size_t i = 0; i < sources.size(); i++) {
+    if (dirty[i]) {
+      schedule.push_back(i);
+    } else {
+      summary.cached++;
+    }
+  }
+
+  std::vector<BuildEntry> results(schedule.size());
+  basic::parallelFor(schedule.size(), jobs, [&](size_t slot) {
+    size_t index = schedule[slot];
+    BuildEntry &entry = results[slot];
+    entry.path = sources[index];
+    entry.hash = hashes[index];
+
+    if (!readable[index]) {
+      entry.ok = false;
+      return;
+    }
+
+    Compiler compiler;
+    auto program =
+        compiler.compileSource(contents[index], Configuration(), entry.path);
+    entry.ok = program != nullptr && compiler.errors() == 0;
+    // The language has no import statement yet, so compiled files record no
+    // import edges.
+  });
+
+  for (auto &entry : results) {
+    summary.rebuilt++;
+    if (!entry.ok) {
+      summary.failed++;
+      summary.failures.push_back(entry.path);
+    }
+    database.update(std::move(entry));
+  }
+
+  summary.saved = database.save(this->options_.database);
+  return summary;
+}
+
+} // namespace ml::compiler
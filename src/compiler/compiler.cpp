@@ -21,10 +21,25 @@ std::string Compiler::readFile(const std::string &file_path) {
 
 std::unique_ptr<ast::Program>
 Compiler::compileSource(const std::string &source,
-                        const Configuration &config) {
+                        const Configuration &config,
+                        const std::string &file_path) {
   this->parser_ = parser::Parser();
+  this->parser_.setFile(file_path);
+  this->statistics_ = opt::OptimizerStatistics();
   auto program = this->parser_.parse(source);
+  // Only well-formed programs are optimized; error recovery may leave holes.
+  if (program && config.optimize && this->parser_.errors() == 0) {
+    this->statistics_ = opt::optimize(*program);
+    for (const auto &diagnostic : this->statistics_.diagnostics) {
+      basic::Error(diagnostic.level, diagnostic.desc, diagnostic.help,
+                   diagnostic.start, diagnostic.end, file_path, source)
+          .log();
+    }
+  }
   if (config.debug) {
+    for (const auto &token : this->parser_.tokens()) {
+      std::cout << (std::string)*token << std::endl;
+    }
     std::cout << "Compilation finished." << std::endl;
     ast::NodePrinter printer;
     program->accept(printer);
@@ -36,7 +51,7 @@ std::unique_ptr<ast::Program>
 Compiler::compileFile(const std::string &file_path,
                       const Configuration &config) {
   std::string source = readFile(file_path);
-  return this->compileSource(source, config);
+  return this->compileSource(source, config, file_path);
 }
 
 } // namespace ml::compiler
@@ -0,0 +1,781 @@
+/**
+ * @file snapshot.cpp
+ * @brief Startup snapshot source code for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/compiler/snapshot.h"
+#include "ml/lexer/literal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ml::compiler {
+
+namespace {
+
+constexpr char SNAPSHOT_MAGIC[8] = {'M', 'L', 'S', 'N', 'A', 'P', 'S', '\0'};
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+// On-disk layout. Every section starts on an 8-byte boundary and refers to
+// others through offsets, so the mapped file can be read in place.
+
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t global_count;
+  uint64_t source_hash;
+  uint32_t type_count;
+  uint32_t member_count;
+  uint64_t globals_offset;
+  uint64_t types_offset;
+  uint64_t members_offset;
+  uint64_t strings_offset;
+  uint64_t strings_size;
+};
+
+struct GlobalRecord {
+  uint32_t name_offset;
+  uint32_t name_length;
+  uint32_t text_offset;
+  uint32_t text_length;
+  uint8_t kind;
+  uint8_t reserved[7];
+  int64_t integer;
+  double real;
+};
+
+struct TypeRecord {
+  uint32_t name_offset;
+  uint32_t name_length;
+  uint32_t first_member;
+  uint32_t field_count;
+  uint32_t method_count;
+  uint8_t record;
+  uint8_t reserved[3];
+};
+
+struct MemberRecord {
+  uint32_t name_offset;
+  uint32_t name_length;
+  uint32_t type_offset;
+  uint32_t type_length;
+};
+
+uint64_t align8(uint64_t offset) { return (offset + 7) & ~uint64_t(7); }
+
+bool isFloatType(const std::string &name) {
+  return name == "f32" || name == "f64" || name == "float" ||
+         name == "double";
+}
+
+bool isIntegerType(const std::string &name) {
+  return name == "i8" || name == "i16" || name == "i32" || name == "i64" ||
+         name == "u8" || name == "u16" || name == "u32" || name == "u64" ||
+         name == "int";
+}
+
+/**
+ * @brief Gets the spelling of a type expression, such as i32 or i32[].
+ */
+std::string typeName(const ast::Expression *type) {
+  if (!type || (type->tag() != ast::NodeTag::IdentifierExpression &&
+                type->tag() != ast::NodeTag::ArrayIdentifierExpression)) {
+    return "";
+  }
+  auto &v = static_cast<const ast::IdentifierExpression &>(*type);
+  return type->tag() == ast::NodeTag::ArrayIdentifierExpression
+             ? v.name + "[]"
+             : v.name;
+}
+
+Value deferred() { return Value(); }
+
+Value integer(int64_t value) {
+  Value result;
+  result.kind = ValueKind::Integer;
+  result.integer = value;
+  return result;
+}
+
+Value real(double value) {
+  Value result;
+  result.kind = ValueKind::Float;
+  result.real = value;
+  return result;
+}
+
+Value boolean(bool value) {
+  Value result;
+  result.kind = ValueKind::Boolean;
+  result.integer = value ? 1 : 0;
+  return result;
+}
+
+Value string(std::string value) {
+  Value result;
+  result.kind = ValueKind::String;
+  result.text = std::move(value);
+  return result;
+}
+
+bool isNumber(const Value &value) {
+  return value.kind == ValueKind::Integer || value.kind == ValueKind::Float;
+}
+
+double asReal(const Value &value) {
+  return value.kind == ValueKind::Float ? value.real
+                                        : static_cast<double>(value.integer);
+}
+
+/**
+ * @class Evaluator
+ * @brief Evaluates global initializers at compile time.
+ */
+class Evaluator {
+private:
+  std::unordered_map<std::string, Value> globals_; // Values by name
+
+  Value literal(const ast::LiteralExpression &node) const {
+    const std::string &text = node.value;
+    if (text == "true" || text == "false") {
+      return boolean(text == "true");
+    }
+    if (!text.empty() && text.front() == '"') {
+      std::string storage;
+      std::string_view payload;
+      return lexer::decodeLiteral(text, storage, payload)
+                 ? string(std::string(payload))
+                 : deferred();
+    }
+    switch (node.number.kind) {
+    case basic::NumberKind::Integer:
+      return node.number.integer <=
+                     uint64_t(std::numeric_limits<int64_t>::max())
+                 ? integer(static_cast<int64_t>(node.number.integer))
+                 : deferred();
+    case basic::NumberKind::Float:
+      return real(node.number.real);
+    default:
+      return deferred();
+    }
+  }
+
+  Value unary(const std::string &op, const Value &operand) const {
+    if (op == "-" && operand.kind == ValueKind::Integer &&
+        operand.integer != std::numeric_limits<int64_t>::min()) {
+      return integer(-operand.integer);
+    }
+    if (op == "-" && operand.kind == ValueKind::Float) {
+      return real(-operand.real);
+    }
+    if (op == "!" && operand.kind == ValueKind::Boolean) {
+      return boolean(operand.integer == 0);
+    }
+    return deferred();
+  }
+
+  Value arithmetic(const std::string &op, int64_t a, int64_t b) const {
+    int64_t result = 0;
+    bool overflow = false;
+    if (op == "+") {
+      overflow = __builtin_add_overflow(a, b, &result);
+    } else if (op == "-") {
+      overflow = __builtin_sub_overflow(a, b, &result);
+    } else if (op == "*") {
+      overflow = __builtin_mul_overflow(a, b, &result);
+    } else if (op == "/" || op == "%") {
+      if (b == 0 || (a == std::numeric_limits<int64_t>::min() && b == -1)) {
+        return deferred();
+      }
+      result = op == "/" ? a / b : a % b;
+    } else {
+      return deferred();
+    }
+    return overflow ? deferred() : integer(result);
+  }
+
+  Value arithmetic(const std::string &op, double a, double b) const {
+    if (op == "+") {
+      return real(a + b);
+    }
+    if (op == "-") {
+      return real(a - b);
+    }
+    if (op == "*") {
+      return real(a * b);
+    }
+    if (op == "/" && b != 0.0) {
+      return real(a / b);
+    }
+    return deferred();
+  }
+
+  template <typename T>
+  Value compare(const std::string &op, const T &a, const T &b) const {
+    if (op == "==") {
+      return boolean(a == b);
+    }
+    if (op == "!=") {
+      return boolean(a != b);
+    }
+    if (op == "<") {
+      return boolean(a < b);
+    }
+    if (op == "<=") {
+      return boolean(a <= b);
+    }
+    if (op == ">") {
+      return boolean(a > b);
+    }
+    if (op == ">=") {
+      return boolean(a >= b);
+    }
+    return deferred();
+  }
+
+  Value binary(const std::string &op, const Value &a, const Value &b) const {
+    if (a.kind == ValueKind::Integer && b.kind == ValueKind::Integer) {
+      Value result = this->arithmetic(op, a.integer, b.integer);
+      return result.kind == ValueKind::Deferred
+                 ? this->compare(op, a.integer, b.integer)
+                 : result;
+    }
+    if (isNumber(a) && isNumber(b)) {
+      Value result = this->arithmetic(op, asReal(a), asReal(b));
+      return result.kind == ValueKind::Deferred
+                 ? this->compare(op, asReal(a), asReal(b))
+                 : result;
+    }
+    if (a.kind == ValueKind::String && b.kind == ValueKind::String) {
+      return op == "+" ? string(a.text + b.text)
+                       : this->compare(op, a.text, b.text);
+    }
+    if (a.kind == ValueKind::Boolean && b.kind == ValueKind::Boolean) {
+      if (op == "&&") {
+        return boolean(a.integer != 0 && b.integer != 0);
+      }
+      if (op == "||") {
+        return boolean(a.integer != 0 || b.integer != 0);
+      }
+      if (op == "==" || op == "!=") {
+        return this->compare(op, a.integer, b.integer);
+      }
+    }
+    return deferred();
+  }
+
+public:
+  /**
+   * @brief Evaluates an expression.
+   * @return Its value, deferred if it cannot be computed now.
+   */
+  Value evaluate(const ast::Expression *expression) const {
+    if (!expression) {
+      return deferred();
+    }
+    switch (expression->tag()) {
+    case ast::NodeTag::LiteralExpression:
+      return this->literal(
+          static_cast<const ast::LiteralExpression &>(*expression));
+    case ast::NodeTag::IdentifierExpression: {
+      auto &v = static_cast<const ast::IdentifierExpression &>(*expression);
+      auto it = this->globals_.find(v.name);
+      return it == this->globals_.end() ? deferred() : it->second;
+    }
+    case ast::NodeTag::UnaryExpression: {
+      auto &v = static_cast<const ast::UnaryExpression &>(*expression);
+      Value operand = this->evaluate(v.operand.get());
+      return operand.kind == ValueKind::Deferred ? operand
+                                                 : this->unary(v.op, operand);
+    }
+    case ast::NodeTag::BinaryExpression: {
+      auto &v = static_cast<const ast::BinaryExpression &>(*expression);
+      Value left = this->evaluate(v.left.get());
+      if (left.kind == ValueKind::Deferred) {
+        return left;
+      }
+      Value right = this->evaluate(v.right.get());
+      if (right.kind == ValueKind::Deferred) {
+        return right;
+      }
+      return this->binary(v.op, left, right);
+    }
+    default:
+      return deferred();
+    }
+  }
+
+  /**
+   * @brief Evaluates the initializer of a global and records its value.
+   */
+  Value declare(const ast::VariableDeclaration &declaration) {
+    Value value = this->evaluate(declaration.initializer.get());
+    std::string type = typeName(declaration.type.get());
+    if (value.kind == ValueKind::Integer && isFloatType(type)) {
+      value = real(static_cast<double>(value.integer));
+    } else if ((value.kind == ValueKind::Float && isIntegerType(type)) ||
+               type.find('[') != std::string::npos) {
+      value = deferred();
+    }
+    this->globals_[declaration.identifier->name] = value;
+    return value;
+  }
+
+  /**
+   * @brief Forgets the value of a global, whose initializer must run.
+   */
+  void forget(const std::string &name) { this->globals_[name] = deferred(); }
+};
+
+TypeLayout layoutOf(const ast::Declaration &declaration) {
+  TypeLayout layout;
+  layout.name = declaration.identifier->name;
+  auto field = [&layout](const auto &v) {
+    if (v && v->identifier) {
+      layout.fields.push_back(
+          {v->identifier->name, typeName(v->type.get())});
+    }
+  };
+  if (declaration.tag() == ast::NodeTag::RecordDeclaration) {
+    layout.record = true;
+    for (const auto &v :
+         static_cast<const ast::RecordDeclaration &>(declaration).fields) {
+      field(v);
+    }
+    return layout;
+  }
+  auto &v = static_cast<const ast::ClassDeclaration &>(declaration);
+  for (const auto &f : v.fields) {
+    field(f);
+  }
+  for (const auto &method : v.methods) {
+    if (method && method->identifier) {
+      layout.methods.push_back({method->identifier->name, ""});
+    }
+  }
+  return layout;
+}
+
+/**
+ * @brief Gets the header of a mapped snapshot, or nullptr if it is invalid.
+ */
+const SnapshotHeader *snapshotHeader(const basic::MappedFile &file) {
+  if (file.size() < sizeof(SnapshotHeader)) {
+    return nullptr;
+  }
+  auto *header = reinterpret_cast<const SnapshotHeader *>(file.data());
+  if (std::memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) !=
+          0 ||
+      header->version != SNAPSHOT_VERSION ||
+      header->strings_offset > file.size() ||
+      header->strings_size > file.size() - header->strings_offset) {
+    return nullptr;
+  }
+  return header;
+}
+
+template <typename T>
+const T *section(const basic::MappedFile &file, uint64_t offset) {
+  return reinterpret_cast<const T *>(file.data() + offset);
+}
+
+/**
+ * @brief Checks that every table and string of a snapshot is in bounds.
+ */
+bool isWellFormed(const basic::MappedFile &file,
+                  const SnapshotHeader &header) {
+  auto fits = [&header](uint64_t offset, uint64_t count, uint64_t width) {
+    return offset % 8 == 0 && offset <= header.strings_offset &&
+           count <= (header.strings_offset - offset) / width;
+  };
+  if (!fits(header.globals_offset, header.global_count,
+            sizeof(GlobalRecord)) ||
+      !fits(header.types_offset, header.type_count, sizeof(TypeRecord)) ||
+      !fits(header.members_offset, header.member_count,
+            sizeof(MemberRecord))) {
+    return false;
+  }
+  auto inStrings = [&header](uint32_t offset, uint32_t length) {
+    return uint64_t(offset) + length <= header.strings_size;
+  };
+
+  auto *globals = section<GlobalRecord>(file, header.globals_offset);
+  for (uint32_t i = 0; i < header.global_count; i++) {
+    if (!inStrings(globals[i].name_offset, globals[i].name_length) ||
+        !inStrings(globals[i].text_offset, globals[i].text_length) ||
+        globals[i].kind > static_cast<uint8_t>(ValueKind::String)) {
+      return false;
+    }
+  }
+  auto *types = section<TypeRecord>(file, header.types_offset);
+  for (uint32_t i = 0; i < header.type_count; i++) {
+    if (!inStrings(types[i].name_offset, types[i].name_length) ||
+        uint64_t(types[i].first_member) + types[i].field_count +
+                types[i].method_count >
+            header.member_count) {
+      return false;
+    }
+  }
+  auto *members = section<MemberRecord>(file, header.members_offset);
+  for (uint32_t i = 0; i < header.member_count; i++) {
+    if (!inStrings(members[i].name_offset, members[i].name_length) ||
+        !inStrings(members[i].type_offset, members[i].type_length)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Collects every name the program assigns or increments.
+ * @details Locals that share a name with a global are collected too, which
+ * only defers more globals than needed.
+ */
+std::unordered_set<std::string> assignedNames(const ast::Program &program) {
+  std::unordered_set<std::string> names;
+  auto target = [&names](const ast::Expression *expression) {
+    if (expression &&
+        expression->tag() == ast::NodeTag::IdentifierExpression) {
+      names.insert(
+          static_cast<const ast::IdentifierExpression &>(*expression).name);
+    }
+  };
+  ast::walk(program, [&target](const ast::Node &node) {
+    if (node.tag() == ast::NodeTag::BinaryExpression) {
+      auto &v = static_cast<const ast::BinaryExpression &>(node);
+      if (v.op == "=") {
+        target(v.left.get());
+      }
+    } else if (node.tag() == ast::NodeTag::UnaryExpression) {
+      auto &v = static_cast<const ast::UnaryExpression &>(node);
+      if (v.op == "++" || v.op == "--") {
+        target(v.operand.get());
+      }
+    }
+    return true;
+  });
+  return names;
+}
+
+} // namespace
+
+size_t StartupState::deferred() const {
+  return std::count_if(this->globals.begin(), this->globals.end(),
+                       [](const Global &global) {
+                         return global.value.kind == ValueKind::Deferred;
+                       });
+}
+
+StartupState initialize(const ast::Program &program) {
+  StartupState state;
+  Evaluator evaluator;
+  bool observed = false; // Whether a side effect has run
+  std::unordered_set<std::string> assigned = assignedNames(program);
+
+  // The first side effect may call any function, so every earlier global
+  // that anything assigns loses its compile-time value.
+  auto observe = [&]() {
+    if (observed) {
+      return;
+    }
+    observed = true;
+    for (auto &global : state.globals) {
+      if (assigned.count(global.name) != 0) {
+        evaluator.forget(global.name);
+        global.value = Value();
+      }
+    }
+  };
+
+  for (const auto &statement : program.statements) {
+    if (!statement) {
+      continue;
+    }
+    switch (statement->tag()) {
+    case ast::NodeTag::VariableDeclaration: {
+      auto &v = static_cast<const ast::VariableDeclaration &>(*statement);
+      if (!v.identifier) {
+        break;
+      }
+      if (v.initializer && !ast::isSideEffectFree(*v.initializer)) {
+        observe();
+      }
+      if (observed) {
+        evaluator.forget(v.identifier->name);
+        state.globals.push_back({v.identifier->name, Value()});
+      } else {
+        state.globals.push_back({v.identifier->name, evaluator.declare(v)});
+      }
+      break;
+    }
+    case ast::NodeTag::ClassDeclaration:
+    case ast::NodeTag::RecordDeclaration: {
+      auto &v = static_cast<const ast::Declaration &>(*statement);
+      if (v.identifier) {
+        state.types.push_back(layoutOf(v));
+      }
+      break;
+    }
+    case ast::NodeTag::FunctionDeclaration:
+      break;
+    case ast::NodeTag::ExpressionStatement: {
+      auto &v = static_cast<const ast::ExpressionStatement &>(*statement);
+      if (!v.expression || !ast::isSideEffectFree(*v.expression)) {
+        observe();
+      }
+      break;
+    }
+    default:
+      observe();
+      break;
+    }
+  }
+  return state;
+}
+
+bool writeSnapshot(const std::string &file_path, const StartupState &state,
+                   uint64_t source_hash) {
+  std::string strings;
+  auto add = [&strings](const std::string &text) {
+    auto offset = static_cast<uint32_t>(strings.size());
+    strings += text;
+    return offset;
+  };
+
+  // Both tables are sorted by name; stable, so the last of several
+  // declarations of a name comes last.
+  std::vector<const Global *> globals;
+  for (const auto &global : state.globals) {
+    globals.push_back(&global);
+  }
+  std::stable_sort(globals.begin(), globals.end(),
+                   [](const Global *a, const Global *b) {
+                     return a->name < b->name;
+                   });
+  std::vector<const TypeLayout *> types;
+  for (const auto &type : state.types) {
+    types.push_back(&type);
+  }
+  std::stable_sort(types.begin(), types.end(),
+                   [](const TypeLayout *a, const TypeLayout *b) {
+                     return a->name < b->name;
+                   });
+
+  std::vector<GlobalRecord> global_records;
+  for (const Global *global : globals) {
+    GlobalRecord record{};
+    record.name_offset = add(global->name);
+    record.name_length = static_cast<uint32_t>(global->name.size());
+    record.text_offset = add(global->value.text);
+    record.text_length = static_cast<uint32_t>(global->value.text.size());
+    record.kind = static_cast<uint8_t>(global->value.kind);
+    record.integer = global->value.integer;
+    record.real = global->value.real;
+    global_records.push_back(record);
+  }
+  std::vector<TypeRecord> type_records;
+  std::vector<MemberRecord> member_records;
+  auto member = [&](const Member &m) {
+    member_records.push_back({add(m.name), static_cast<uint32_t>(m.name.size()),
+                              add(m.type),
+                              static_cast<uint32_t>(m.type.size())});
+  };
+  for (const TypeLayout *type : types) {
+    TypeRecord record{};
+    record.name_offset = add(type->name);
+    record.name_length = static_cast<uint32_t>(type->name.size());
+    record.first_member = static_cast<uint32_t>(member_records.size());
+    record.field_count = static_cast<uint32_t>(type->fields.size());
+    record.method_count = static_cast<uint32_t>(type->methods.size());
+    record.record = type->record ? 1 : 0;
+    type_records.push_back(record);
+    for (const auto &field : type->fields) {
+      member(field);
+    }
+    for (const auto &method : type->methods) {
+      member(method);
+    }
+  }
+
+  SnapshotHeader header{};
+  std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  header.version = SNAPSHOT_VERSION;
+  header.global_count = static_cast<uint32_t>(global_records.size());
+  header.source_hash = source_hash;
+  header.type_count = static_cast<uint32_t>(type_records.size());
+  header.member_count = static_cast<uint32_t>(member_records.size());
+  header.globals_offset = align8(sizeof(SnapshotHeader));
+  header.types_offset = align8(header.globals_offset +
+                               global_records.size() * sizeof(GlobalRecord));
+  header.members_offset = align8(header.types_offset +
+                                 type_records.size() * sizeof(TypeRecord));
+  header.strings_offset =
+      align8(header.members_offset +
+             member_records.size() * sizeof(MemberRecord));
+  header.strings_size = strings.size();
+
+  std::string image(header.strings_offset + strings.size(), '\0');
+  auto place = [&image](uint64_t offset, const void *data, size_t size) {
+    if (size != 0) {
+      std::memcpy(&image[offset], data, size);
+    }
+  };
+  place(0, &header, sizeof(header));
+  place(header.globals_offset, global_records.data(),
+        global_records.size() * sizeof(GlobalRecord));
+  place(header.types_offset, type_records.data(),
+        type_records.size() * sizeof(TypeRecord));
+  place(header.members_offset, member_records.data(),
+        member_records.size() * sizeof(MemberRecord));
+  place(header.strings_offset, strings.data(), strings.size());
+
+  std::filesystem::path path(file_path);
+  std::error_code error;
+  if (path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path(), error);
+  }
+
+  std::string temporary = file_path + ".tmp";
+  {
+    std::ofstream file_stream(temporary, std::ios::binary | std::ios::trunc);
+    if (!file_stream.write(image.data(),
+                           static_cast<std::streamsize>(image.size()))) {
+      return false;
+    }
+  }
+  std::filesystem::rename(temporary, file_path, error);
+  return !error;
+}
+
+bool StartupSnapshot::open(const std::string &file_path,
+                           uint64_t source_hash) {
+  if (!this->file_.open(file_path)) {
+    return false;
+  }
+  const SnapshotHeader *header = snapshotHeader(this->file_);
+  if (!header || header->source_hash != source_hash ||
+      !isWellFormed(this->file_, *header)) {
+    this->file_ = basic::MappedFile();
+    return false;
+  }
+  return true;
+}
+
+size_t StartupSnapshot::globalCount() const {
+  const SnapshotHeader *header = snapshotHeader(this->file_);
+  return header ? header->global_count : 0;
+}
+
+size_t StartupSnapshot::typeCount() const {
+  const SnapshotHeader *header = snapshotHeader(this->file_);
+  return header ? header->type_count : 0;
+}
+
+bool StartupSnapshot::find(std::string_view name, Value &value) const {
+  const SnapshotHeader *header = snapshotHeader(this->file_);
+  if (!header) {
+    return false;
+  }
+
+  const char *strings = this->file_.data() + header->strings_offset;
+  auto *globals = section<GlobalRecord>(this->file_, header->globals_offset);
+  auto *end = globals + header->global_count;
+  auto *it = std::upper_bound(
+      globals, end, name, [strings](std::string_view n, const GlobalRecord &g) {
+        return n < std::string_view(strings + g.name_offset, g.name_length);
+      });
+  if (it == globals) {
+    return false;
+  }
+  const GlobalRecord &global = *(it - 1);
+  if (std::string_view(strings + global.name_offset, global.name_length) !=
+      name) {
+    return false;
+  }
+  value.kind = static_cast<ValueKind>(global.kind);
+  value.integer = global.integer;
+  value.real = global.real;
+  value.text.assign(strings + global.text_offset, global.text_length);
+  return true;
+}
+
+int64_t StartupSnapshot::fieldSlot(std::string_view type,
+                                   std::string_view field) const {
+  const SnapshotHeader *header = snapshotHeader(this->file_);
+  if (!header) {
+    return -1;
+  }
+
+  const char *strings = this->file_.data() + header->strings_offset;
+  auto *types = section<TypeRecord>(this->file_, header->types_offset);
+  auto *members = section<MemberRecord>(this->file_, header->members_offset);
+  auto *end = types + header->type_count;
+  auto *it = std::upper_bound(
+      types, end, type, [strings](std::string_view n, const TypeRecord &t) {
+        return n < std::string_view(strings + t.name_offset, t.name_length);
+      });
+  if (it == types ||
+      std::string_view(strings + (it - 1)->name_offset,
+                       (it - 1)->name_length) != type) {
+    return -1;
+  }
+  const TypeRecord &record = *(it - 1);
+  for (uint32_t i = 0; i < record.field_count; i++) {
+    const MemberRecord &m = members[record.first_member + i];
+    if (std::string_view(strings + m.name_offset, m.name_length) == field) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+StartupState StartupSnapshot::restore() const {
+  StartupState state;
+  const SnapshotHeader *header = snapshotHeader(this->file_);
+  if (!header) {
+    return state;
+  }
+
+  const char *strings = this->file_.data() + header->strings_offset;
+  auto text = [strings](uint32_t offset, uint32_t length) {
+    return std::string(strings + offset, length);
+  };
+  auto *globals = section<GlobalRecord>(this->file_, header->globals_offset);
+  auto *types = section<TypeRecord>(this->file_, header->types_offset);
+  auto *members = section<MemberRecord>(this->file_, header->members_offset);
+
+  state.globals.reserve(header->global_count);
+  for (uint32_t i = 0; i < header->global_count; i++) {
+    const GlobalRecord &g = globals[i];
+    Value value;
+    value.kind = static_cast<ValueKind>(g.kind);
+    value.integer = g.integer;
+    value.real = g.real;
+    value.text = text(g.text_offset, g.text_length);
+    state.globals.push_back({text(g.name_offset, g.name_length), value});
+  }
+  state.types.reserve(header->type_count);
+  for (uint32_t i = 0; i < header->type_count; i++) {
+    const TypeRecord &t = types[i];
+    TypeLayout layout;
+    layout.name = text(t.name_offset, t.name_length);
+    layout.record = t.record != 0;
+    for (uint32_t m = 0; m < t.field_count + t.method_count; m++) {
+      const MemberRecord &r = members[t.first_member + m];
+      Member member{text(r.name_offset, r.name_length),
+                    text(r.type_offset, r.type_length)};
+      (m < t.field_count ? layout.fields : layout.methods)
+          .push_back(std::move(member));
+    }
+    state.types.push_back(std::move(layout));
+  }
+  return state;
+}
+
+} // namespace ml::compiler
@@ -0,0 +1,225 @@
+/**
+ * @file doc.cpp
+ * @brief Implementation of document layout.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/format/doc.h"
+#include "ml/basic/syntax.h"
+
+#include <cctype>
+#include <limits>
+
+namespace ml::format {
+
+namespace {
+
+constexpr uint64_t UNBOUNDED = std::numeric_limits<uint64_t>::max();
+
+bool isWordChar(char c) {
+  auto byte = static_cast<unsigned char>(c);
+  return std::isalnum(byte) || c == '_' || byte >= 0x80;
+}
+
+/**
+ * @brief Checks whether two adjacent characters must be kept apart.
+ * @details The lexer joins any two operator characters into one operator,
+ * so those are kept apart even where they would not form a valid one.
+ */
+bool needsSpace(char left, char right) {
+  if (isWordChar(left) && isWordChar(right)) {
+    return true;
+  }
+  return basic::isOp(std::string(1, left)) &&
+         basic::isOp(std::string(1, right));
+}
+
+} // namespace
+
+size_t displayWidth(std::string_view text) {
+  size_t width = 0;
+  for (char c : text) {
+    // Count every byte except UTF-8 continuation bytes.
+    width += (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+  }
+  return width;
+}
+
+Doc &Doc::text(std::string_view text) {
+  while (!text.empty()) {
+    size_t newline = text.find('\n');
+    std::string_view piece = text.substr(0, newline);
+    if (!piece.empty()) {
+      this->items_.push_back({DocOp::Text,
+                              static_cast<uint32_t>(this->text_.size()),
+                              static_cast<uint32_t>(piece.size()),
+                              static_cast<uint32_t>(displayWidth(piece))});
+      this->text_.append(piece);
+    }
+    if (newline == std::string_view::npos) {
+      break;
+    }
+    this->push(DocOp::RawLine);
+    text.remove_prefix(newline + 1);
+  }
+  return *this;
+}
+
+void Doc::render(std::string &out, unsigned width, unsigned indent) const {
+  size_t count = this->items_.size();
+
+  // Backward pass: the width a group needs is its flat width plus the text
+  // after it up to the next break, or unbounded if it holds a hard newline.
+  // The sums run from the end, so a group is measured when its Begin is
+  // reached, from the sums saved at its End.
+  struct Suffix {
+    uint64_t flat; // Flat width from the End to the end of the document
+    uint64_t hard; // Hard newlines from the End to the end of the document
+    uint64_t rest; // Width from the End to the next break
+  };
+  std::vector<uint64_t> needs(count, 0);
+  std::vector<Suffix> ends;
+  uint64_t flat = 0;
+  uint64_t hard = 0;
+  uint64_t rest = 0;
+  for (size_t i = count; i-- > 0;) {
+    const Item &item = this->items_[i];
+    switch (item.op) {
+    case DocOp::Text:
+      flat += item.width;
+      rest += item.width;
+      break;
+    case DocOp::Line:
+      flat += 1;
+      rest = 0;
+      break;
+    case DocOp::SoftLine:
+      rest = 0;
+      break;
+    case DocOp::HardLine:
+    case DocOp::RawLine:
+      hard++;
+      rest = 0;
+      break;
+    case DocOp::End:
+      ends.push_back({flat, hard, rest});
+      break;
+    case DocOp::Begin:
+      if (!ends.empty()) {
+        const Suffix &end = ends.back();
+        needs[i] = hard != end.hard ? UNBOUNDED : flat - end.flat + end.rest;
+        ends.pop_back();
+      }
+      break;
+    default:
+      break;
+    }
+  }
+
+  // Forward pass: a group is flat if its parent is, or if it fits. The
+  // indentation of a line is only written once text follows, so blank lines
+  // stay empty.
+  std::vector<bool> flats;
+  bool is_flat = false;
+  uint64_t column = 0;
+  uint64_t level = 0;
+  uint64_t pending = 0;
+  auto newline = [&]() {
+    out += '\n';
+    column = level * indent;
+    pending = column;
+  };
+  for (size_t i = 0; i < count; i++) {
+    const Item &item = this->items_[i];
+    switch (item.op) {
+    case DocOp::Text:
+      out.append(pending, ' ');
+      pending = 0;
+      out.append(this->text_, item.offset, item.length);
+      column += item.width;
+      break;
+    case DocOp::Line:
+      if (is_flat) {
+        // A space at the start of a line would be trailing or indentation.
+        if (pending == 0) {
+          out += ' ';
+        } else {
+          pending++;
+        }
+        column++;
+      } else {
+        newline();
+      }
+      break;
+    case DocOp::SoftLine:
+      if (!is_flat) {
+        newline();
+      }
+      break;
+    case DocOp::HardLine:
+      newline();
+      break;
+    case DocOp::RawLine:
+      out += '\n';
+      column = 0;
+      pending = 0;
+      break;
+    case DocOp::Begin:
+      flats.push_back(is_flat);
+      is_flat =
+          is_flat || (needs[i] != UNBOUNDED && column + needs[i] <= width);
+      break;
+    case DocOp::End:
+      if (!flats.empty()) {
+        is_flat = flats.back();
+        flats.pop_back();
+      }
+      break;
+    case DocOp::Indent:
+      level++;
+      break;
+    case DocOp::Dedent:
+      if (level > 0) {
+        level--;
+      }
+      break;
+    }
+  }
+}
+
+void Doc::compact(std::string &out) const {
+  char last = '\0';
+  for (size_t i = 0; i < this->items_.size(); i++) {
+    const Item &item = this->items_[i];
+    if (item.op == DocOp::RawLine) {
+      out += '\n';
+      last = '\n';
+      continue;
+    }
+    if (item.op != DocOp::Text) {
+      continue;
+    }
+
+    // Spaces next to a verbatim newline are inside a string literal.
+    bool raw_before = i > 0 && this->items_[i - 1].op == DocOp::RawLine;
+    bool raw_after = i + 1 < this->items_.size() &&
+                     this->items_[i + 1].op == DocOp::RawLine;
+    std::string_view piece(this->text_.data() + item.offset, item.length);
+    while (!raw_before && !piece.empty() && piece.front() == ' ') {
+      piece.remove_prefix(1);
+    }
+    while (!raw_after && !piece.empty() && piece.back() == ' ') {
+      piece.remove_suffix(1);
+    }
+    if (piece.empty()) {
+      continue;
+    }
+    if (!raw_before && last != '\0' && needsSpace(last, piece.front())) {
+      out += ' ';
+    }
+    out.append(piece);
+    last = piece.back();
+  }
+}
+
+} // namespace ml::format
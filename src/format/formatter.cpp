@@ -0,0 +1,1083 @@
+/**
+ * @file formatter.cpp
+ * @brief Implementation of the source formatter.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/format/formatter.h"
+#include "ml/analysis/pass.h"
+#include "ml/analysis/scopes.h"
+#include "ml/ast/ast.h"
+#include "ml/basic/flags.h"
+#include "ml/basic/mapped_file.h"
+#include "ml/basic/parallel.h"
+#include "ml/basic/syntax.h"
+#include "ml/format/doc.h"
+#include "ml/lexer/lexer.h"
+#include "ml/parser/parser.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ml::format {
+
+namespace {
+
+/**
+ * @struct Comment formatter.cpp
+ * @brief A comment found in the trivia of a token.
+ */
+struct Comment {
+  std::string_view text; // The comment, without trailing whitespace
+  size_t token;          // The index of the token it precedes
+  size_t newlines;       // Newlines between it and the code before it
+};
+
+/**
+ * @brief Collects the comments of every token's trivia, in source order.
+ */
+std::vector<Comment> collectComments(const lexer::Lexer &lexer,
+                                     size_t token_count) {
+  std::vector<Comment> comments;
+  for (size_t token = 0; token < token_count; token++) {
+    std::string_view trivia = lexer.leadingTrivia(token);
+    size_t newlines = 0;
+    size_t i = 0;
+    while (i < trivia.size()) {
+      char c = trivia[i];
+      if (c == '/' && i + 1 < trivia.size() &&
+          (trivia[i + 1] == '/' || trivia[i + 1] == '*')) {
+        size_t end = lexer::commentEnd(trivia, i);
+        std::string_view text = trivia.substr(i, end - i);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t' ||
+                                 text.back() == '\r')) {
+          text.remove_suffix(1);
+        }
+        comments.push_back({text, token, newlines});
+        newlines = 0;
+        i = end;
+      } else {
+        newlines += c == '\n';
+        i++;
+      }
+    }
+  }
+  return comments;
+}
+
+/**
+ * @brief Gets the binding strength of a binary operator.
+ */
+int binaryPrecedence(const std::string &op) {
+  if (op == "=") {
+    return 1;
+  }
+  if (op == "||") {
+    return 2;
+  }
+  if (op == "&&") {
+    return 3;
+  }
+  if (op == "==" || op == "!=") {
+    return 4;
+  }
+  if (op == "+" || op == "-") {
+    return 6;
+  }
+  if (op == "*" || op == "/" || op == "%") {
+    return 7;
+  }
+  return 5; // Comparisons and ranges
+}
+
+constexpr int PREFIX = 8;  // Prefix operators, spawn and await
+constexpr int POSTFIX = 9; // Calls, indexing, attributes and ++, --
+constexpr int PRIMARY = 10;
+
+bool isPostfixOperator(const std::string &op) {
+  return op == "++" || op == "--";
+}
+
+int precedence(const ast::Expression &expression) {
+  switch (expression.tag()) {
+  case ast::NodeTag::BinaryExpression:
+    return binaryPrecedence(
+        static_cast<const ast::BinaryExpression &>(expression).op);
+  case ast::NodeTag::UnaryExpression:
+    return isPostfixOperator(
+               static_cast<const ast::UnaryExpression &>(expression).op)
+               ? POSTFIX
+               : PREFIX;
+  case ast::NodeTag::SpawnExpression:
+  case ast::NodeTag::AwaitExpression:
+    return PREFIX;
+  case ast::NodeTag::CallExpression:
+  case ast::NodeTag::IndexExpression:
+  case ast::NodeTag::AttributeExpression:
+    return POSTFIX;
+  default:
+    return PRIMARY;
+  }
+}
+
+/**
+ * @brief New names of identifiers, keyed by the identifier nodes.
+ */
+using Renames = std::unordered_map<const ast::Node *, std::string>;
+
+/**
+ * @class Printer formatter.cpp
+ * @brief Builds the Doc of a parsed program.
+ */
+class Printer {
+private:
+  const std::vector<std::unique_ptr<lexer::Token>> &tokens_; // The tokens
+  const lexer::Lexer &lexer_;     // The lexer, with the trivia table
+  std::vector<Comment> comments_; // Comments not yet printed, in order
+  size_t next_comment_ = 0;       // The first comment not yet printed
+  Doc &doc_;                      // The document being built
+  const Renames *renames_;        // New names of identifiers, or null
+
+  /**
+   * @brief Gets the name to print for an identifier.
+   */
+  const std::string &nameOf(const ast::IdentifierExpression &identifier) {
+    if (this->renames_) {
+      auto it = this->renames_->find(&identifier);
+      if (it != this->renames_->end()) {
+        return it->second;
+      }
+    }
+    return identifier.name;
+  }
+
+  /**
+   * @brief Finds the token starting at a location.
+   */
+  size_t tokenAt(const basic::Locus &locus) const {
+    auto it = std::lower_bound(
+        this->tokens_.begin(), this->tokens_.end(), locus.index,
+        [](const auto &token, uint64_t index) {
+          return token->start.index < index;
+        });
+    return static_cast<size_t>(it - this->tokens_.begin());
+  }
+
+  /**
+   * @brief Finds the token ending at a location.
+   */
+  size_t tokenEndingAt(const basic::Locus &locus) const {
+    auto it = std::lower_bound(
+        this->tokens_.begin(), this->tokens_.end(), locus.index,
+        [](const auto &token, uint64_t index) {
+          return token->end.index < index;
+        });
+    return static_cast<size_t>(it - this->tokens_.begin());
+  }
+
+  /**
+   * @brief Walks back from a token to the keyword that opens its construct.
+   */
+  size_t backTo(size_t token, const char *keyword) const {
+    while (token > 0 && this->tokens_[token]->value != keyword) {
+      token--;
+    }
+    return token;
+  }
+
+  /**
+   * @brief Finds the first modifier or the name of a declaration.
+   * @details Initializers have no name token, but always a modifier.
+   */
+  size_t declarationToken(const ast::Node &node) const {
+    auto &v = static_cast<const ast::Declaration &>(node);
+    return this->tokenAt(v.modifier->start);
+  }
+
+  /**
+   * @brief Finds the first token of a statement or member.
+   * @details Nodes start at their name or condition, so the keyword and any
+   * modifiers or parentheses before that are walked back over.
+   */
+  size_t firstToken(const ast::Node &node) const {
+    switch (node.tag()) {
+    case ast::NodeTag::VariableDeclaration:
+      return this->backTo(this->declarationToken(node), "let");
+    case ast::NodeTag::FunctionDeclaration:
+      return this->backTo(this->declarationToken(node), "fn");
+    case ast::NodeTag::RecordDeclaration:
+      return this->backTo(this->declarationToken(node), "rec");
+    case ast::NodeTag::ClassDeclaration:
+      return this->backTo(this->declarationToken(node), "cls");
+    case ast::NodeTag::IfConditional:
+      return this->backTo(this->tokenAt(node.start), "if");
+    case ast::NodeTag::WhileConditional:
+      return this->backTo(this->tokenAt(node.start), "while");
+    case ast::NodeTag::SwitchConditional:
+      return this->backTo(this->tokenAt(node.start), "switch");
+    case ast::NodeTag::ForConditional:
+      return this->backTo(this->tokenAt(node.start), "for");
+    case ast::NodeTag::Conditional: {
+      // A switch case starts at its value, or at its block for default.
+      auto &v = static_cast<const ast::Conditional &>(node);
+      return this->backTo(this->tokenAt(node.start),
+                          v.condition ? "case" : "default");
+    }
+    case ast::NodeTag::ExpressionStatement: {
+      size_t token = this->tokenAt(node.start);
+      while (token > 0 && this->tokens_[token - 1]->value == "(") {
+        token--;
+      }
+      return token;
+    }
+    default:
+      return this->tokenAt(node.start);
+    }
+  }
+
+  /**
+   * @brief Counts the newlines between a token and the comment or code
+   * before it.
+   */
+  size_t newlinesBefore(size_t token) const {
+    std::string_view trivia = this->lexer_.leadingTrivia(token);
+    size_t newlines = 0;
+    for (size_t i = trivia.size(); i-- > 0;) {
+      char c = trivia[i];
+      if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+        break;
+      }
+      newlines += c == '\n';
+    }
+    return newlines;
+  }
+
+  /**
+   * @brief Starts an item of a statement list on its own line.
+   * @param newlines The newlines in front of the item in the source; two
+   * or more keep one blank line.
+   * @param first Whether no item of the list was printed yet.
+   * @param top Whether the list is the program, whose first line needs no
+   * break before it.
+   */
+  void separate(size_t newlines, bool &first, bool top) {
+    if (!first || !top) {
+      this->doc_.hardLine();
+    }
+    if (!first && newlines >= 2) {
+      this->doc_.hardLine();
+    }
+    first = false;
+  }
+
+  /**
+   * @brief Checks whether comments come before a token.
+   */
+  bool hasComments(size_t token) const {
+    return this->next_comment_ < this->comments_.size() &&
+           this->comments_[this->next_comment_].token <= token;
+  }
+
+  /**
+   * @brief Prints the comments before and in the trivia of a token.
+   * @details A comment on the same line as the code before it stays at the
+   * end of that line; the others get lines of their own.
+   */
+  void flush(size_t token, bool &first, bool top) {
+    while (this->hasComments(token)) {
+      const Comment &comment = this->comments_[this->next_comment_++];
+      if (comment.newlines == 0 && !(first && top)) {
+        this->doc_.text(" ").text(comment.text);
+      } else {
+        this->separate(comment.newlines, first, top);
+        this->doc_.text(comment.text);
+      }
+    }
+  }
+
+  /**
+   * @brief Prints a braced list of statements or members.
+   * @param items The items, in source order.
+   * @param close The index of the closing brace.
+   */
+  void list(const std::vector<const ast::Node *> &items, size_t close) {
+    if (items.empty() && !this->hasComments(close)) {
+      this->doc_.text("{}");
+      return;
+    }
+    this->doc_.text("{").indent();
+    bool first = true;
+    for (const ast::Node *item : items) {
+      size_t token = this->firstToken(*item);
+      this->flush(token, first, false);
+      this->separate(this->newlinesBefore(token), first, false);
+      this->statement(*item);
+    }
+    this->flush(close, first, false);
+    this->doc_.dedent().hardLine().text("}");
+  }
+
+  void block(const ast::BlockStatement &block) {
+    std::vector<const ast::Node *> items;
+    items.reserve(block.statements.size());
+    for (const auto &statement : block.statements) {
+      items.push_back(statement.get());
+    }
+    this->list(items, this->tokenEndingAt(block.end));
+  }
+
+  /**
+   * @brief Prints a comma-separated list that breaks one item per line.
+   */
+  template <typename T>
+  void arguments(const char *open, const std::vector<T> &items,
+                 const char *close) {
+    this->doc_.text(open);
+    if (items.empty()) {
+      this->doc_.text(close);
+      return;
+    }
+    this->doc_.begin().indent().softLine();
+    for (size_t i = 0; i < items.size(); i++) {
+      if (i > 0) {
+        this->doc_.text(",").line();
+      }
+      this->item(*items[i]);
+    }
+    this->doc_.dedent().softLine().end().text(close);
+  }
+
+  void item(const ast::Expression &expression) {
+    this->expression(expression, 0, false);
+  }
+
+  void item(const ast::Declaration &declaration) {
+    this->declaration(declaration);
+  }
+
+  void modifiers(const ast::ModifierStatement *modifier) {
+    if (!modifier) {
+      return;
+    }
+    if (modifier->accessor == basic::Accessor::Public) {
+      this->doc_.text("pub ");
+    } else if (modifier->accessor == basic::Accessor::Protected) {
+      this->doc_.text("pro ");
+    }
+    if (basic::hasFlag(modifier->modifier, basic::Modifier::Static)) {
+      this->doc_.text("static ");
+    }
+    if (basic::hasFlag(modifier->modifier, basic::Modifier::Constant)) {
+      this->doc_.text("const ");
+    }
+    if (basic::hasFlag(modifier->modifier, basic::Modifier::Init)) {
+      this->doc_.text("init ");
+    }
+  }
+
+  bool isNullable(const ast::Declaration &declaration) const {
+    return declaration.modifier &&
+           basic::hasFlag(declaration.modifier->modifier,
+                          basic::Modifier::Nullable);
+  }
+
+  /**
+   * @brief Checks whether a declaration spells out its type.
+   * @details The parser gives untyped declarations a void type without a
+   * location.
+   */
+  bool hasType(const ast::Declaration &declaration) const {
+    if (!declaration.type) {
+      return false;
+    }
+    if (declaration.type->tag() == ast::NodeTag::IdentifierExpression &&
+        declaration.type->start.line == 0) {
+      return false;
+    }
+    return true;
+  }
+
+  void type(const ast::Expression &type) {
+    if (type.tag() == ast::NodeTag::ArrayIdentifierExpression) {
+      auto &v = static_cast<const ast::ArrayIdentifierExpression &>(type);
+      this->doc_.text(v.name).text("[");
+      // The parser stands in -1 for an unsized array.
+      bool unsized = v.size &&
+                     v.size->tag() == ast::NodeTag::LiteralExpression &&
+                     static_cast<const ast::LiteralExpression &>(*v.size)
+                             .value == "-1";
+      if (v.size && !unsized) {
+        this->expression(*v.size, 0, false);
+      }
+      this->doc_.text("]");
+    } else if (type.tag() == ast::NodeTag::IdentifierExpression) {
+      auto &v = static_cast<const ast::IdentifierExpression &>(type);
+      this->doc_.text(this->nameOf(v));
+    } else {
+      this->expression(type, 0, false);
+    }
+  }
+
+  /**
+   * @brief Prints a variable declaration without let and semicolon, as in
+   * parameters and for-each loops.
+   */
+  void declaration(const ast::Declaration &declaration) {
+    this->modifiers(declaration.modifier.get());
+    this->doc_.text(this->nameOf(*declaration.identifier));
+    if (this->isNullable(declaration)) {
+      this->doc_.text("?");
+    }
+    if (this->hasType(declaration)) {
+      this->doc_.text(": ");
+      this->type(*declaration.type);
+    }
+    if (declaration.tag() == ast::NodeTag::VariableDeclaration) {
+      auto &v = static_cast<const ast::VariableDeclaration &>(declaration);
+      if (v.initializer) {
+        this->doc_.text(" = ");
+        this->expression(*v.initializer, 0, false);
+      }
+    }
+  }
+
+  void function(const ast::FunctionDeclaration &function) {
+    // An initializer is named by its init modifier.
+    auto modifier = *function.modifier;
+    bool init = basic::hasFlag(modifier.modifier, basic::Modifier::Init);
+    modifier.modifier &= ~basic::Modifier::Init;
+    this->doc_.text("fn ");
+    this->modifiers(&modifier);
+    this->doc_.text(init ? "init" : function.identifier->name);
+    if (this->isNullable(function)) {
+      this->doc_.text("?");
+    }
+    this->arguments("(", function.parameters, ")");
+    if (this->hasType(function)) {
+      this->doc_.text(" ");
+      this->type(*function.type);
+    }
+    this->doc_.text(" ");
+    this->block(*function.body);
+  }
+
+  /**
+   * @brief Prints the members of a record or class in source order.
+   */
+  void members(const ast::Declaration &declaration,
+               std::vector<const ast::Node *> items) {
+    std::sort(items.begin(), items.end(),
+              [](const ast::Node *a, const ast::Node *b) {
+                return static_cast<const ast::Declaration *>(a)
+                           ->modifier->start.index <
+                       static_cast<const ast::Declaration *>(b)
+                           ->modifier->start.index;
+              });
+    this->modifiers(declaration.modifier.get());
+    this->doc_.text(declaration.identifier->name).text(" ");
+    this->list(items, this->tokenEndingAt(declaration.end));
+  }
+
+  void conditional(const char *keyword, const ast::Conditional &conditional) {
+    this->doc_.text(keyword).text(" (");
+    this->expression(*conditional.condition, 0, false);
+    this->doc_.text(") ");
+    this->block(*conditional.then_branch);
+  }
+
+  void forLoop(const ast::ForConditional &loop) {
+    this->doc_.text("for").text(" (");
+    if (loop.initializer && loop.condition) {
+      this->doc_.text("let ");
+      this->declaration(*loop.initializer);
+      this->doc_.text("; ");
+      this->expression(*loop.condition, 0, false);
+      this->doc_.text(";");
+      if (loop.increment) {
+        this->doc_.text(" ");
+        this->expression(*loop.increment, 0, false);
+      }
+    } else if (loop.initializer) {
+      this->declaration(*loop.initializer);
+      this->doc_.text(" in ");
+      this->expression(*loop.increment, 0, false);
+    } else {
+      this->expression(*loop.condition, 0, false);
+    }
+    this->doc_.text(") ");
+    this->block(*loop.then_branch);
+  }
+
+  void statement(const ast::Node &node) {
+    switch (node.tag()) {
+    case ast::NodeTag::ReturnStatement: {
+      auto &v = static_cast<const ast::ReturnStatement &>(node);
+      this->doc_.text("return");
+      if (v.expression) {
+        this->doc_.text(" ");
+        this->expression(*v.expression, 0, false);
+      }
+      this->doc_.text(";");
+      break;
+    }
+    case ast::NodeTag::BreakStatement:
+      this->doc_.text("break;");
+      break;
+    case ast::NodeTag::ContinueStatement:
+      this->doc_.text("continue;");
+      break;
+    case ast::NodeTag::ExpressionStatement:
+      this->expression(
+          *static_cast<const ast::ExpressionStatement &>(node).expression, 0,
+          false);
+      this->doc_.text(";");
+      break;
+    case ast::NodeTag::BlockStatement:
+      this->block(static_cast<const ast::BlockStatement &>(node));
+      break;
+    case ast::NodeTag::VariableDeclaration:
+      this->doc_.text("let ");
+      this->declaration(static_cast<const ast::Declaration &>(node));
+      this->doc_.text(";");
+      break;
+    case ast::NodeTag::FunctionDeclaration:
+      this->function(static_cast<const ast::FunctionDeclaration &>(node));
+      break;
+    case ast::NodeTag::RecordDeclaration: {
+      auto &v = static_cast<const ast::RecordDeclaration &>(node);
+      std::vector<const ast::Node *> items;
+      items.reserve(v.fields.size());
+      for (const auto &field : v.fields) {
+        items.push_back(field.get());
+      }
+      this->doc_.text("rec ");
+      this->members(v, std::move(items));
+      break;
+    }
+    case ast::NodeTag::ClassDeclaration: {
+      auto &v = static_cast<const ast::ClassDeclaration &>(node);
+      std::vector<const ast::Node *> items;
+      items.reserve(v.fields.size() + v.methods.size());
+      for (const auto &field : v.fields) {
+        items.push_back(field.get());
+      }
+      for (const auto &method : v.methods) {
+        items.push_back(method.get());
+      }
+      this->doc_.text("cls ");
+      this->members(v, std::move(items));
+      break;
+    }
+    case ast::NodeTag::IfConditional: {
+      auto &v = static_cast<const ast::IfConditional &>(node);
+      this->conditional("if", v);
+      for (const auto &branch : v.elif_branches) {
+        this->doc_.text(" ");
+        this->conditional("elif", *branch);
+      }
+      if (v.else_branch) {
+        this->doc_.text(" else ");
+        this->block(*v.else_branch);
+      }
+      break;
+    }
+    case ast::NodeTag::SwitchConditional: {
+      auto &v = static_cast<const ast::SwitchConditional &>(node);
+      this->doc_.text("switch").text(" (");
+      this->expression(*v.switch_expression, 0, false);
+      this->doc_.text(") ");
+      std::vector<const ast::Node *> items;
+      items.reserve(v.case_branches.size());
+      for (const auto &branch : v.case_branches) {
+        items.push_back(branch.get());
+      }
+      // The switch ends at its last case; its brace is the next token.
+      size_t close =
+          v.case_branches.empty()
+              ? this->tokenEndingAt(v.end)
+              : this->tokenEndingAt(v.case_branches.back()->then_branch->end) +
+                    1;
+      this->list(items, close);
+      break;
+    }
+    case ast::NodeTag::Conditional: {
+      auto &v = static_cast<const ast::Conditional &>(node);
+      if (v.condition) {
+        this->doc_.text("case ");
+        this->expression(*v.condition, 0, false);
+        this->doc_.text(" ");
+      } else {
+        this->doc_.text("default ");
+      }
+      this->block(*v.then_branch);
+      break;
+    }
+    case ast::NodeTag::WhileConditional:
+      this->conditional("while", static_cast<const ast::Conditional &>(node));
+      break;
+    case ast::NodeTag::ForConditional:
+      this->forLoop(static_cast<const ast::ForConditional &>(node));
+      break;
+    default:
+      break;
+    }
+  }
+
+  /**
+   * @brief Prints a chain of binary operators of one precedence as a group
+   * that breaks after every operator.
+   */
+  void binary(const ast::BinaryExpression &root, bool closed) {
+    int strength = binaryPrecedence(root.op);
+    if (root.op == "=") {
+      // Assignment is right-associative.
+      this->expression(*root.left, strength + 1, true);
+      this->doc_.text(" = ");
+      this->expression(*root.right, strength, closed);
+      return;
+    }
+
+    // Collect the left spine of the chain, innermost first.
+    std::vector<const ast::BinaryExpression *> chain;
+    const ast::Expression *left = &root;
+    while (left->tag() == ast::NodeTag::BinaryExpression &&
+           binaryPrecedence(
+               static_cast<const ast::BinaryExpression *>(left)->op) ==
+               strength) {
+      chain.push_back(static_cast<const ast::BinaryExpression *>(left));
+      left = chain.back()->left.get();
+    }
+
+    this->doc_.begin();
+    this->expression(*left, strength, true);
+    this->doc_.indent();
+    for (size_t i = chain.size(); i-- > 0;) {
+      const ast::BinaryExpression &link = *chain[i];
+      if (link.op == ".." || link.op == ".=") {
+        this->doc_.text(link.op);
+      } else {
+        this->doc_.text(" ").text(link.op).line();
+      }
+      this->expression(*link.right, strength + 1, i == 0 ? closed : true);
+    }
+    this->doc_.dedent().end();
+  }
+
+  /**
+   * @brief Prints an expression, in parentheses if its context needs them.
+   * @param expression The expression.
+   * @param strength The weakest precedence printable without parentheses.
+   * @param closed Whether more of the enclosing expression follows it.
+   * @details An attribute's member is a whole expression, so an attribute
+   * that is followed by more of its enclosing expression needs parentheses
+   * to end it.
+   */
+  void expression(const ast::Expression &expression, int strength,
+                  bool closed) {
+    bool parentheses =
+        precedence(expression) < strength ||
+        (closed && expression.tag() == ast::NodeTag::AttributeExpression);
+    if (parentheses) {
+      this->doc_.text("(");
+      closed = false;
+    }
+
+    switch (expression.tag()) {
+    case ast::NodeTag::BinaryExpression:
+      this->binary(static_cast<const ast::BinaryExpression &>(expression),
+                   closed);
+      break;
+    case ast::NodeTag::UnaryExpression: {
+      auto &v = static_cast<const ast::UnaryExpression &>(expression);
+      if (isPostfixOperator(v.op)) {
+        this->expression(*v.operand, POSTFIX, true);
+        this->doc_.text(v.op);
+        break;
+      }
+      this->doc_.text(v.op);
+      // Keep two minus signs apart, so they do not lex as a decrement.
+      if (v.op == "-" && v.operand->tag() == ast::NodeTag::UnaryExpression &&
+          static_cast<const ast::UnaryExpression &>(*v.operand).op == "-") {
+        this->doc_.text(" ");
+      }
+      this->expression(*v.operand, PREFIX, closed);
+      break;
+    }
+    case ast::NodeTag::LiteralExpression:
+      this->doc_.text(
+          static_cast<const ast::LiteralExpression &>(expression).value);
+      break;
+    case ast::NodeTag::IdentifierExpression:
+    case ast::NodeTag::ArrayIdentifierExpression:
+      this->type(expression);
+      break;
+    case ast::NodeTag::IndexExpression: {
+      auto &v = static_cast<const ast::IndexExpression &>(expression);
+      this->expression(*v.array, POSTFIX, true);
+      this->doc_.text("[");
+      this->expression(*v.index, 0, false);
+      this->doc_.text("]");
+      break;
+    }
+    case ast::NodeTag::ArrayExpression:
+      this->arguments(
+          "[", static_cast<const ast::ArrayExpression &>(expression).elements,
+          "]");
+      break;
+    case ast::NodeTag::CallExpression: {
+      auto &v = static_cast<const ast::CallExpression &>(expression);
+      this->expression(*v.callee, POSTFIX, true);
+      this->arguments("(", v.arguments, ")");
+      break;
+    }
+    case ast::NodeTag::AttributeExpression: {
+      auto &v = static_cast<const ast::AttributeExpression &>(expression);
+      this->expression(*v.object, POSTFIX, true);
+      this->doc_.text(".");
+      this->expression(*v.attribute, 0, false);
+      break;
+    }
+    case ast::NodeTag::SpawnExpression:
+      this->doc_.text("spawn ");
+      this->expression(
+          *static_cast<const ast::SpawnExpression &>(expression).call,
+          POSTFIX, closed);
+      break;
+    case ast::NodeTag::AwaitExpression:
+      this->doc_.text("await ");
+      this->expression(
+          *static_cast<const ast::AwaitExpression &>(expression).task,
+          PREFIX, closed);
+      break;
+    default:
+      break;
+    }
+
+    if (parentheses) {
+      this->doc_.text(")");
+    }
+  }
+
+public:
+  /**
+   * @brief Creates a printer.
+   * @param parser The parser of the program, with the tokens and trivia.
+   * @param doc The document to build.
+   * @param renames New names of identifiers, or null to keep every name.
+   * @details Comments are only printed if the parser kept its trivia.
+   */
+  Printer(const parser::Parser &parser, Doc &doc,
+          const Renames *renames = nullptr)
+      : tokens_(parser.tokens()), lexer_(parser.lexer()),
+        comments_(collectComments(parser.lexer(), parser.tokens().size())),
+        doc_(doc), renames_(renames) {}
+
+  /**
+   * @brief Prints a program, with the comments after its last statement.
+   * @return Whether anything was printed.
+   */
+  bool program(const ast::Program &program) {
+    bool first = true;
+    for (const auto &statement : program.statements) {
+      size_t token = this->firstToken(*statement);
+      this->flush(token, first, true);
+      this->separate(this->newlinesBefore(token), first, true);
+      this->statement(*statement);
+    }
+    this->flush(this->tokens_.size(), first, true);
+    return !first;
+  }
+};
+
+/**
+ * @brief Makes the n-th short identifier: a to Z, then aa, ba and so on.
+ */
+std::string shortName(size_t n) {
+  static constexpr std::string_view HEAD =
+      "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  static constexpr std::string_view TAIL =
+      "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_";
+  std::string name(1, HEAD[n % HEAD.size()]);
+  n /= HEAD.size();
+  while (n > 0) {
+    n--;
+    name += TAIL[n % TAIL.size()];
+    n /= TAIL.size();
+  }
+  return name;
+}
+
+/**
+ * @class Locals formatter.cpp
+ * @brief Collects the parameters and local variables of every outermost
+ * function, and every identifier, for renaming.
+ * @details Added after the scope resolver, so the kind of a declaration is
+ * known when it is left. A nested function shares the locals of the
+ * function around it, so no two variables it can see get the same name.
+ */
+class Locals : public analysis::Pass {
+private:
+  const analysis::Scopes &scopes_; // The scope resolver
+  size_t depth_ = 0;               // Functions entered and not yet left
+  std::vector<std::vector<const ast::VariableDeclaration *>>
+      functions_;                                      // Locals by function
+  std::vector<const ast::IdentifierExpression *> all_; // Every identifier
+
+public:
+  explicit Locals(const analysis::Scopes &scopes) : scopes_(scopes) {}
+
+  std::string name() const override { return "locals"; }
+
+  void attach(analysis::PassManager &manager) override {
+    manager.onEnter<ast::FunctionDeclaration>(
+        [this](const ast::FunctionDeclaration &) {
+          if (this->depth_++ == 0) {
+            this->functions_.emplace_back();
+          }
+        });
+    manager.onLeave<ast::FunctionDeclaration>(
+        [this](const ast::FunctionDeclaration &) { this->depth_--; });
+    manager.onLeave<ast::VariableDeclaration>(
+        [this](const ast::VariableDeclaration &v) {
+          analysis::BindingKind kind = this->scopes_.kindOf();
+          if (this->depth_ > 0 && (kind == analysis::BindingKind::Parameter ||
+                                   kind == analysis::BindingKind::Local)) {
+            this->functions_.back().push_back(&v);
+          }
+        });
+    manager.onEnter<ast::IdentifierExpression>(
+        [this](const ast::IdentifierExpression &v) {
+          this->all_.push_back(&v);
+        });
+    manager.onEnter<ast::ArrayIdentifierExpression>(
+        [this](const ast::ArrayIdentifierExpression &v) {
+          this->all_.push_back(&v);
+        });
+  }
+
+  /**
+   * @brief Gives every local a short name.
+   * @details Names of identifiers that are not renamed, and keywords, are
+   * never handed out. Within a function, locals are named in order of use,
+   * most used first, then in declaration order, so renaming the output
+   * again gives the same names.
+   */
+  Renames rename() const {
+    std::unordered_map<const ast::VariableDeclaration *, size_t> uses;
+    for (const auto &function : this->functions_) {
+      for (const auto *local : function) {
+        uses.emplace(local, 0);
+      }
+    }
+    Renames renames;
+    for (const auto &[reference, declaration] : this->scopes_.references()) {
+      auto it = uses.find(declaration);
+      if (it != uses.end()) {
+        it->second++;
+        renames.emplace(reference, std::string());
+      }
+    }
+    for (const auto &[local, count] : uses) {
+      renames.emplace(local->identifier.get(), std::string());
+    }
+    std::unordered_set<std::string> reserved;
+    for (const auto *identifier : this->all_) {
+      if (renames.count(identifier) == 0) {
+        reserved.insert(identifier->name);
+      }
+    }
+
+    std::unordered_map<const ast::VariableDeclaration *, std::string> names;
+    for (auto function : this->functions_) {
+      std::stable_sort(function.begin(), function.end(),
+                       [&uses](const auto *a, const auto *b) {
+                         return uses.at(a) > uses.at(b);
+                       });
+      size_t next = 0;
+      for (const auto *local : function) {
+        std::string name;
+        do {
+          name = shortName(next++);
+        } while (reserved.count(name) != 0 || basic::isKwy(name));
+        names.emplace(local, name);
+        renames[local->identifier.get()] = name;
+      }
+    }
+    for (const auto &[reference, declaration] : this->scopes_.references()) {
+      auto it = names.find(declaration);
+      if (it != names.end()) {
+        renames[reference] = it->second;
+      }
+    }
+    return renames;
+  }
+};
+
+} // namespace
+
+bool formatSource(const std::string &source, std::string &out,
+                  const FormatOptions &options) {
+  parser::Parser parser;
+  parser.keepTrivia(true);
+  auto program = parser.parse(source);
+  if (!program || parser.errors() > 0) {
+    return false;
+  }
+
+  Doc doc;
+  Printer printer(parser, doc);
+  out.clear();
+  out.reserve(source.size() + source.size() / 8);
+  if (printer.program(*program)) {
+    doc.render(out, options.width, options.indent);
+    out += '\n';
+  }
+  return true;
+}
+
+FormatSummary formatFiles(const std::vector<std::string> &sources,
+                          const FormatOptions &options, bool write,
+                          unsigned jobs) {
+  enum Outcome : uint8_t { Unchanged, Changed, Failed };
+  std::vector<Outcome> outcomes(sources.size(), Unchanged);
+  basic::parallelFor(
+      sources.size(), jobs == 0 ? basic::defaultJobs() : jobs, [&](size_t i) {
+        basic::MappedFile file;
+        if (!file.open(sources[i])) {
+          outcomes[i] = Failed;
+          return;
+        }
+        std::string source(file.view());
+        std::string formatted;
+        if (!formatSource(source, formatted, options)) {
+          outcomes[i] = Failed;
+          return;
+        }
+        if (formatted == source) {
+          return;
+        }
+        outcomes[i] = Changed;
+        if (write) {
+          // Write beside the source and rename over it, so an interrupted
+          // write never leaves the source truncated.
+          file = basic::MappedFile();
+          std::string temporary = sources[i] + ".tmp";
+          bool written;
+          {
+            std::ofstream stream(temporary,
+                                 std::ios::binary | std::ios::trunc);
+            written = static_cast<bool>(stream.write(
+                formatted.data(),
+                static_cast<std::streamsize>(formatted.size())));
+          }
+          std::error_code error;
+          if (written) {
+            std::filesystem::rename(temporary, sources[i], error);
+          }
+          if (!written || error) {
+            std::filesystem::remove(temporary, error);
+            outcomes[i] = Failed;
+          }
+        }
+      });
+
+  FormatSummary summary;
+  summary.files = sources.size();
+  for (size_t i = 0; i < sources.size(); i++) {
+    if (outcomes[i] == Changed) {
+      summary.changed++;
+      summary.changes.push_back(sources[i]);
+    } else if (outcomes[i] == Failed) {
+      summary.failed++;
+      summary.errors.push_back(sources[i]);
+    }
+  }
+  return summary;
+}
+
+bool minifySource(const std::string &source, std::string &out,
+                  const MinifyOptions &options) {
+  parser::Parser parser;
+  auto program = parser.parse(source);
+  if (!program || parser.errors() > 0) {
+    return false;
+  }
+
+  Renames renames;
+  if (options.rename) {
+    analysis::PassManager manager;
+    auto &scopes = manager.emplace<analysis::Scopes>(true);
+    auto &locals = manager.emplace<Locals>(scopes);
+    manager.run(*program);
+    renames = locals.rename();
+  }
+
+  Doc doc;
+  Printer printer(parser, doc, options.rename ? &renames : nullptr);
+  out.clear();
+  out.reserve(source.size() / 2);
+  printer.program(*program);
+  doc.compact(out);
+  return true;
+}
+
+MinifySummary minifyFiles(const std::vector<std::string> &sources,
+                          const MinifyOptions &options,
+                          const std::string &output, unsigned jobs) {
+  std::vector<size_t> input_bytes(sources.size(), 0);
+  std::vector<size_t> output_bytes(sources.size(), 0);
+  std::vector<char> failed(sources.size(), false);
+  basic::parallelFor(
+      sources.size(), jobs == 0 ? basic::defaultJobs() : jobs, [&](size_t i) {
+        std::string minified;
+        {
+          basic::MappedFile file;
+          if (!file.open(sources[i]) ||
+              !minifySource(std::string(file.view()), minified, options)) {
+            failed[i] = true;
+            return;
+          }
+          input_bytes[i] = file.view().size();
+        }
+
+        // Keep the source's path below the output directory.
+        std::filesystem::path relative;
+        for (const auto &part :
+             std::filesystem::path(sources[i]).lexically_normal()
+                 .relative_path()) {
+          if (!(relative.empty() && part == "..")) {
+            relative /= part;
+          }
+        }
+        std::filesystem::path target =
+            std::filesystem::path(output) / relative;
+        std::error_code error;
+        std::filesystem::create_directories(target.parent_path(), error);
+        std::ofstream stream(target, std::ios::binary | std::ios::trunc);
+        if (!stream.write(minified.data(),
+                          static_cast<std::streamsize>(minified.size()))) {
+          failed[i] = true;
+          return;
+        }
+        output_bytes[i] = minified.size();
+      });
+
+  MinifySummary summary;
+  summary.files = sources.size();
+  for (size_t i = 0; i < sources.size(); i++) {
+    if (failed[i]) {
+      summary.failed++;
+      summary.errors.push_back(sources[i]);
+    } else {
+      summary.input_bytes += input_bytes[i];
+      summary.output_bytes += output_bytes[i];
+    }
+  }
+  return summary;
+}
+
+} // namespace ml::format
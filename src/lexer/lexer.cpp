@@ -5,9 +5,59 @@
  */
 
 #include "ml/lexer/lexer.h"
+#include "ml/basic/number.h"
+#include "ml/basic/unicode.h"
+#include "ml/lexer/literal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
 
 namespace ml::lexer {
 
+namespace {
+
+/**
+ * @brief Computes the locus of a byte offset.
+ */
+basic::Locus locusAt(const std::string &source, size_t index) {
+  auto begin = source.begin();
+  auto end = begin + index;
+  auto line_start = std::find(std::make_reverse_iterator(end),
+                              std::make_reverse_iterator(begin), '\n');
+  return basic::Locus(std::count(begin, end, '\n') + 1,
+                      std::distance(line_start.base(), end) + 1, index);
+}
+
+/**
+ * @brief Finds the next quote or backslash in a string literal.
+ * @return The offset of the character, or length if there is none.
+ * @details Scans a word at a time: XOR-ing a word with a broadcast byte
+ * zeroes the matching bytes, and the classic has-zero-byte test spots them,
+ * so plain text between the stops costs one test per eight bytes.
+ */
+size_t findStringStop(const char *data, size_t index, size_t length) {
+  constexpr uint64_t ones = 0x0101010101010101ull;
+  constexpr uint64_t highs = 0x8080808080808080ull;
+  while (index + 8 <= length) {
+    uint64_t chunk;
+    std::memcpy(&chunk, data + index, sizeof(chunk));
+    uint64_t quotes = chunk ^ (ones * '"');
+    uint64_t escapes = chunk ^ (ones * '\\');
+    if ((((quotes - ones) & ~quotes) | ((escapes - ones) & ~escapes)) &
+        highs) {
+      break;
+    }
+    index += 8;
+  }
+  while (index < length && data[index] != '"' && data[index] != '\\') {
+    index++;
+  }
+  return index;
+}
+
+} // namespace
+
 bool Lexer::isEof() const {
   return this->current_.index >= this->source_.length();
 }
@@ -82,77 +132,222 @@ void Lexer::take(const std::function<bool(char)> predicate) {
 
 void Lexer::ignore() { this->start_ = this->current_; }
 
+void Lexer::skipTo(size_t index) {
+  const char *from = this->source_.data() + this->current_.index;
+  const char *to = this->source_.data() + index;
+  size_t lines = std::count(from, to, '\n');
+  if (lines > 0) {
+    auto last = std::find(std::make_reverse_iterator(to),
+                          std::make_reverse_iterator(from), '\n');
+    this->current_.line += lines;
+    this->current_.column = std::distance(last.base(), to) + 1;
+  } else {
+    this->current_.column += to - from;
+  }
+  this->current_.index = index;
+
+  this->peek_dirty_ = true;
+  this->look_dirty_ = true;
+  this->value_dirty_ = true;
+}
+
+size_t blockCommentEnd(std::string_view source, size_t index) {
+  // Both delimiters contain a slash, and slashes are rare inside comments,
+  // so jump from slash to slash with memchr and look at the neighbours.
+  const char *data = source.data();
+  size_t length = source.length();
+  size_t depth = 1;
+  size_t i = index + 2;
+  while (depth > 0) {
+    const void *slash = std::memchr(data + i, '/', length - i);
+    if (slash == nullptr) {
+      return std::string::npos;
+    }
+    size_t at = static_cast<const char *>(slash) - data;
+    if (at > i && data[at - 1] == '*') {
+      depth--;
+      i = at + 1;
+    } else if (at + 1 < length && data[at + 1] == '*') {
+      depth++;
+      i = at + 2;
+    } else {
+      i = at + 1;
+    }
+  }
+  return i;
+}
+
+size_t commentEnd(std::string_view source, size_t index) {
+  if (source[index + 1] == '/') {
+    size_t end = source.find('\n', index + 2);
+    return end == std::string_view::npos ? source.size() : end;
+  }
+  size_t end = blockCommentEnd(source, index);
+  return end == std::string::npos ? source.size() : end;
+}
+
+void Lexer::skipTrivia() {
+  const char *data = this->source_.data();
+  size_t length = this->source_.length();
+  size_t index = this->current_.index;
+
+  while (true) {
+    while (index < length && basic::isWsp(data[index])) {
+      index++;
+    }
+    if (index + 1 >= length || data[index] != '/' ||
+        (data[index + 1] != '/' && data[index + 1] != '*')) {
+      break;
+    }
+
+    size_t end;
+    bool doc;
+    if (data[index + 1] == '/') {
+      const void *newline =
+          std::memchr(data + index + 2, '\n', length - index - 2);
+      end = newline ? static_cast<const char *>(newline) - data : length;
+      doc = end - index >= 3 && data[index + 2] == '/' &&
+            (end - index == 3 || data[index + 3] != '/');
+    } else {
+      end = blockCommentEnd(this->source_, index);
+      if (end == std::string::npos) {
+        this->skipTo(index);
+        basic::Error err(basic::ErrorLevel::Error, "Unterminated block comment",
+                         "Add a closing */ to terminate the comment.",
+                         this->current_, this->current_, this->file_,
+                         this->source_);
+        err.log();
+        this->errors_++;
+        end = length;
+      }
+      doc = end - index >= 5 && data[index + 2] == '*' &&
+            data[index + 3] != '*' && data[index + 3] != '/';
+    }
+
+    if (doc && this->keep_docs_) {
+      this->skipTo(index);
+      basic::Locus start = this->current_;
+      this->skipTo(end);
+      this->docs_.push_back(DocComment{this->token_index_, start,
+                                       this->current_,
+                                       this->source_.substr(index,
+                                                            end - index)});
+    }
+    index = end;
+  }
+
+  this->skipTo(index);
+  this->ignore();
+}
+
 std::unique_ptr<Token> Lexer::makeToken(const TokenKind kind) {
 
-  std::string value = this->value();
+  // Copy the lexeme straight out of the source; going through value() would
+  // copy long literals twice more.
+  std::string value = this->source_.substr(
+      this->start_.index, this->current_.index - this->start_.index);
 
   basic::Locus start = this->start_;
   this->ignore();
 
-  return std::make_unique<Token>(Token(kind, value, start, this->current_));
+  return std::make_unique<Token>(kind, std::move(value), start,
+                                 this->current_);
 }
 
 std::unique_ptr<Token> Lexer::lexAlpha() {
-  if (std::isalpha(this->peek()) || this->peek() == '_') {
-    this->take([](char c) {
-      return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
-    });
+  size_t end = basic::scanIdentifier(this->source_, this->current_.index);
+  if (end == this->current_.index) {
+    return nullptr;
+  }
+  this->skipTo(end);
 
-    if (basic::isKwy(this->value())) {
-      return this->makeToken(TokenKind::Keyword);
-    } else {
-      return this->makeToken(TokenKind::Identifier);
-    }
+  if (basic::isKwy(this->value())) {
+    return this->makeToken(TokenKind::Keyword);
   } else {
-    return nullptr;
+    return this->makeToken(TokenKind::Identifier);
   }
 }
 
 std::unique_ptr<Token> Lexer::lexNumeric() {
-  if (std::isdigit(this->peek())) {
-    this->take(
-        [](char c) { return std::isdigit(static_cast<unsigned char>(c)); });
-
-    if (this->peek() == '.') {
-      // Check if this is a range operator '..'/'...' instead of a float
-      if (this->current_.index + 1 < this->source_.length() &&
-          this->source_[this->current_.index + 1] == '.') {
-        return this->makeToken(TokenKind::Integer);
-      } else {
-        this->advance();
-        this->take(
-            [](char c) { return std::isdigit(static_cast<unsigned char>(c)); });
-        return this->makeToken(TokenKind::Float);
+  size_t end = basic::scanNumber(this->source_, this->current_.index);
+  if (end == this->current_.index) {
+    return nullptr;
+  }
+
+  basic::Number number;
+  std::string_view literal(this->source_.data() + this->current_.index,
+                           end - this->current_.index);
+  if (!basic::parseNumber(literal, number)) {
+    basic::Error err(basic::ErrorLevel::Error, "Invalid numeric literal",
+                     "Check the digits and the suffix; the value must fit "
+                     "its type, or 64 bits without a suffix.",
+                     this->start_, this->start_, this->file_, this->source_);
+    err.log();
+    this->errors_++;
+  }
+  this->skipTo(end);
+
+  auto token = this->makeToken(number.kind == basic::NumberKind::Float
+                                   ? TokenKind::Float
+                                   : TokenKind::Integer);
+  token->number = number;
+  return token;
+}
+
+void Lexer::skipEscape() {
+  size_t remaining = this->source_.length() - this->current_.index;
+  size_t length = escapeLength(this->source_, this->current_.index);
+  if (length == 0) {
+    // A backslash at the very end is reported as an unterminated literal.
+    if (remaining > 1) {
+      basic::Error err(basic::ErrorLevel::Error, "Invalid escape sequence",
+                       "Use \\n, \\t, \\r, \\0, \\\\, \\\", \\', \\xHH or "
+                       "\\u{H...}.",
+                       this->current_, this->current_, this->file_,
+                       this->source_);
+      err.log();
+      this->errors_++;
+    }
+    length = std::min<size_t>(2, remaining);
+    // Skip the braces of a bad \u{...} too, so the literal still closes.
+    size_t brace = this->current_.index + 2;
+    if (length == 2 && brace < this->source_.length() &&
+        this->source_[brace] == '{') {
+      size_t close = this->source_.find_first_of("}\"'\n", brace);
+      if (close != std::string::npos && this->source_[close] == '}') {
+        length = close + 1 - this->current_.index;
       }
-    } else {
-      return this->makeToken(TokenKind::Integer);
     }
-  } else {
-    return nullptr;
   }
+  this->skipTo(this->current_.index + length);
 }
 
 std::unique_ptr<Token> Lexer::lexCharacter() {
   if (this->peek() == '\'') {
     this->advance(); // Opening quote
     if (this->peek() == '\\') {
-      this->advance(); // Escape character
-      this->advance(); // Escaped character
-    } else if (this->peek() != '\'') {
-      this->advance(); // Character
-    } else {
+      this->skipEscape(); // Escape sequence
+    } else if (this->peek() == '\'') {
       basic::Error err(basic::ErrorLevel::Error, "Empty character literal",
                        "Add a character between the single quotes (').",
-                       this->start_, this->start_, "<input>", this->source_);
+                       this->start_, this->start_, this->file_, this->source_);
       err.log();
+      this->errors_++;
+    } else if (!this->isEof()) {
+      // Character, which may take several bytes
+      char32_t code_point;
+      size_t length =
+          basic::decodeUtf8(this->source_, this->current_.index, code_point);
+      this->skipTo(this->current_.index + std::max<size_t>(length, 1));
     }
 
     if (this->peek() != '\'') {
       basic::Error err(
           basic::ErrorLevel::Error, "Unterminated character literal",
           "Add a closing single quote (') to terminate the character literal.",
-          this->start_, this->start_, "<input>", this->source_);
+          this->start_, this->start_, this->file_, this->source_);
       err.log();
+      this->errors_++;
     } else {
       this->advance(); // Closing quote
     }
@@ -164,22 +359,32 @@ std::unique_ptr<Token> Lexer::lexCharacter() {
 
 std::unique_ptr<Token> Lexer::lexString() {
   if (this->peek() == '"') {
-    this->advance(); // Opening quote
-
-    while (this->peek() != '"') {
-      if (this->isEof()) {
+    const char *data = this->source_.data();
+    size_t length = this->source_.length();
+    size_t index = this->current_.index + 1; // Opening quote
+
+    while (true) {
+      index = findStringStop(data, index, length);
+      if (index >= length) {
+        this->skipTo(length);
         basic::Error err(basic::ErrorLevel::Error,
                          "Unterminated string literal",
                          "Add a closing double quote (\") to terminate the "
                          "string literal.",
-                         this->start_, this->start_, "<input>", this->source_);
+                         this->start_, this->start_, this->file_,
+                         this->source_);
         err.log();
+        this->errors_++;
         break;
       }
-
-      this->advance();
+      if (data[index] == '"') {
+        this->skipTo(index + 1); // Closing quote
+        break;
+      }
+      this->skipTo(index);
+      this->skipEscape();
+      index = this->current_.index;
     }
-    this->advance(); // Closing quote
     return this->makeToken(TokenKind::String);
   } else {
     return nullptr;
@@ -208,8 +413,13 @@ std::unique_ptr<Token> Lexer::lexDelimiter() {
 }
 
 std::unique_ptr<Token> Lexer::next() {
-  this->take(basic::isWsp);
-  this->ignore();
+  size_t trivia_start = this->current_.index;
+  this->skipTrivia();
+  if (this->keep_trivia_) {
+    this->trivia_.push_back(TriviaSpan{
+        static_cast<uint32_t>(trivia_start),
+        static_cast<uint32_t>(this->current_.index - trivia_start)});
+  }
 
   if (this->isEof()) {
     // Create EOF token with empty value
@@ -238,16 +448,39 @@ void Lexer::reset() {
   this->peek_dirty_ = true;
   this->look_dirty_ = true;
   this->value_dirty_ = true;
+  this->errors_ = 0;
+  this->docs_.clear();
+  this->token_index_ = 0;
+  this->trivia_.clear();
+}
+
+std::string_view Lexer::leadingTrivia(size_t token) const {
+  if (token >= this->trivia_.size()) {
+    return std::string_view();
+  }
+  const TriviaSpan &span = this->trivia_[token];
+  return std::string_view(this->source_).substr(span.offset, span.length);
 }
 
 std::vector<std::unique_ptr<Token>> Lexer::lex(const std::string source) {
   this->source_ = source;
   this->reset();
 
+  size_t error_offset = 0;
+  if (!basic::validateUtf8(this->source_, &error_offset)) {
+    basic::Locus locus = locusAt(this->source_, error_offset);
+    basic::Error err(basic::ErrorLevel::Error, "Invalid UTF-8",
+                     "Save the source file as UTF-8.", locus, locus,
+                     this->file_, this->source_);
+    err.log();
+    this->errors_++;
+  }
+
   auto tokens = std::vector<std::unique_ptr<Token>>();
 
   while (true) {
 
+    this->token_index_ = tokens.size();
     std::unique_ptr<Token> next = this->next();
 
     TokenKind kind = next->kind;
@@ -0,0 +1,161 @@
+/**
+ * @file literal.cpp
+ * @brief Implementation of literal decoding.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/lexer/literal.h"
+
+#include <cstring>
+
+namespace ml::lexer {
+
+namespace {
+
+int hexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+/**
+ * @brief Appends a code point to a string as UTF-8.
+ */
+void appendUtf8(std::string &out, char32_t code_point) {
+  if (code_point < 0x80) {
+    out += static_cast<char>(code_point);
+  } else if (code_point < 0x800) {
+    out += static_cast<char>(0xC0 | (code_point >> 6));
+    out += static_cast<char>(0x80 | (code_point & 0x3F));
+  } else if (code_point < 0x10000) {
+    out += static_cast<char>(0xE0 | (code_point >> 12));
+    out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (code_point & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (code_point >> 18));
+    out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (code_point & 0x3F));
+  }
+}
+
+} // namespace
+
+size_t escapeLength(std::string_view text, size_t index,
+                    char32_t *code_point) {
+  if (index + 1 >= text.size() || text[index] != '\\') {
+    return 0;
+  }
+  char32_t value;
+  size_t length = 2;
+  switch (text[index + 1]) {
+  case 'n':
+    value = '\n';
+    break;
+  case 't':
+    value = '\t';
+    break;
+  case 'r':
+    value = '\r';
+    break;
+  case '0':
+    value = '\0';
+    break;
+  case '\\':
+  case '"':
+  case '\'':
+    value = static_cast<unsigned char>(text[index + 1]);
+    break;
+  case 'x': {
+    if (index + 4 > text.size()) {
+      return 0;
+    }
+    int high = hexValue(text[index + 2]);
+    int low = hexValue(text[index + 3]);
+    if (high < 0 || low < 0 || high > 7) {
+      return 0;
+    }
+    value = static_cast<char32_t>(high * 16 + low);
+    length = 4;
+    break;
+  }
+  case 'u': {
+    size_t i = index + 2;
+    if (i >= text.size() || text[i] != '{') {
+      return 0;
+    }
+    value = 0;
+    size_t digits = 0;
+    for (i++; i < text.size() && text[i] != '}'; i++) {
+      int digit = hexValue(text[i]);
+      if (digit < 0 || ++digits > 6) {
+        return 0;
+      }
+      value = value * 16 + digit;
+    }
+    if (i >= text.size() || digits == 0 || value > 0x10FFFF ||
+        (value >= 0xD800 && value <= 0xDFFF)) {
+      return 0;
+    }
+    length = i + 1 - index;
+    break;
+  }
+  default:
+    return 0;
+  }
+  if (code_point != nullptr) {
+    *code_point = value;
+  }
+  return length;
+}
+
+bool decodeLiteral(std::string_view literal, std::string &storage,
+                   std::string_view &payload, size_t *error_offset) {
+  if (literal.size() < 2 || literal.front() != literal.back() ||
+      (literal.front() != '"' && literal.front() != '\'')) {
+    if (error_offset != nullptr) {
+      *error_offset = 0;
+    }
+    return false;
+  }
+  std::string_view body = literal.substr(1, literal.size() - 2);
+  const void *backslash = std::memchr(body.data(), '\\', body.size());
+  if (backslash == nullptr) {
+    payload = body;
+    return true;
+  }
+
+  // Copy the runs between escapes whole, decoding each escape on the way.
+  storage.clear();
+  storage.reserve(body.size());
+  size_t run = 0;
+  size_t i = static_cast<const char *>(backslash) - body.data();
+  while (i < body.size()) {
+    storage.append(body.data() + run, i - run);
+    char32_t code_point;
+    size_t length = escapeLength(body, i, &code_point);
+    if (length == 0) {
+      if (error_offset != nullptr) {
+        *error_offset = i + 1;
+      }
+      return false;
+    }
+    appendUtf8(storage, code_point);
+    run = i + length;
+    const void *next =
+        std::memchr(body.data() + run, '\\', body.size() - run);
+    i = next ? static_cast<const char *>(next) - body.data() : body.size();
+  }
+  storage.append(body.data() + run, body.size() - run);
+  payload = storage;
+  return true;
+}
+
+} // namespace ml::lexer
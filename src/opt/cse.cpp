@@ -0,0 +1,262 @@
+/**
+ * @file cse.cpp
+ * @brief Common subexpression elimination source code for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/opt/cse.h"
+#include "ml/opt/rewrite.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace ml::opt {
+
+namespace {
+
+using Slot = std::unique_ptr<ast::Expression>;
+
+/**
+ * @struct Candidate
+ * @brief A pure subexpression that may be shared.
+ */
+struct Candidate {
+  Slot *slot;   // The slot holding the subexpression
+  size_t size;  // Number of nodes in the subexpression
+  size_t order; // Position in evaluation order
+};
+
+/**
+ * @brief Counts the nodes of a subtree.
+ */
+size_t subtreeSize(const ast::Node &node) {
+  auto range = ast::preOrder(node);
+  return static_cast<size_t>(std::distance(range.begin(), range.end()));
+}
+
+/**
+ * @brief Checks whether a subtree creates an array.
+ */
+bool createsArray(const ast::Node &node) {
+  for (const ast::Node &child : ast::preOrder(node)) {
+    if (child.tag() == ast::NodeTag::ArrayExpression) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Collects the subexpressions that are always evaluated.
+ * @param root The slot of the expression to scan.
+ * @param out The candidates, appended in evaluation order.
+ */
+void collectCandidates(Slot &root, std::vector<Candidate> &out) {
+  std::vector<Slot *> stack{&root};
+  while (!stack.empty()) {
+    Slot *slot = stack.back();
+    stack.pop_back();
+    ast::Expression &expression = **slot;
+
+    switch (expression.tag()) {
+    case ast::NodeTag::LiteralExpression:
+    case ast::NodeTag::IdentifierExpression:
+      continue;
+    case ast::NodeTag::BinaryExpression: {
+      auto &v = static_cast<ast::BinaryExpression &>(expression);
+      out.push_back({slot, subtreeSize(expression), out.size()});
+      // The right operand of a short-circuit operator is conditional.
+      if (v.right && v.op != "&&" && v.op != "||") {
+        stack.push_back(&v.right);
+      }
+      if (v.left) {
+        stack.push_back(&v.left);
+      }
+      continue;
+    }
+    case ast::NodeTag::AttributeExpression: {
+      // The attribute is a member name, not a value of its own.
+      auto &v = static_cast<ast::AttributeExpression &>(expression);
+      out.push_back({slot, subtreeSize(expression), out.size()});
+      if (v.object) {
+        stack.push_back(&v.object);
+      }
+      continue;
+    }
+    case ast::NodeTag::CallExpression: {
+      auto &v = static_cast<ast::CallExpression &>(expression);
+      out.push_back({slot, subtreeSize(expression), out.size()});
+      for (auto it = v.arguments.rbegin(); it != v.arguments.rend(); ++it) {
+        if (*it) {
+          stack.push_back(&*it);
+        }
+      }
+      continue;
+    }
+    default:
+      break;
+    }
+
+    out.push_back({slot, subtreeSize(expression), out.size()});
+    size_t first = stack.size();
+    forEachSlot(expression,
+                [&stack](Slot &child) { stack.push_back(&child); });
+    std::reverse(stack.begin() + first, stack.end());
+  }
+}
+
+/**
+ * @brief Finds the slot of the expression a statement evaluates.
+ * @param statement The statement.
+ * @param purity The purity analysis.
+ * @return The slot whose subexpressions may be shared, or nullptr.
+ * @details For an assignment only the right-hand side is used, since the
+ * target is a location rather than a value.
+ */
+Slot *rewritableSlot(ast::Statement &statement,
+                     const analysis::PurityAnalysis &purity) {
+  Slot *slot = nullptr;
+  switch (statement.tag()) {
+  case ast::NodeTag::ExpressionStatement:
+    slot = &static_cast<ast::ExpressionStatement &>(statement).expression;
+    break;
+  case ast::NodeTag::ReturnStatement:
+    slot = &static_cast<ast::ReturnStatement &>(statement).expression;
+    break;
+  case ast::NodeTag::VariableDeclaration:
+    slot = &static_cast<ast::VariableDeclaration &>(statement).initializer;
+    break;
+  default:
+    return nullptr;
+  }
+  if (!*slot) {
+    return nullptr;
+  }
+
+  if ((*slot)->tag() == ast::NodeTag::BinaryExpression) {
+    auto &assignment = static_cast<ast::BinaryExpression &>(**slot);
+    if (assignment.op == "=") {
+      if (!assignment.left || !assignment.right ||
+          !purity.isPure(*assignment.left)) {
+        return nullptr;
+      }
+      slot = &assignment.right;
+    }
+  }
+  return purity.isPure(**slot) ? slot : nullptr;
+}
+
+/**
+ * @brief Shares the largest repeated subexpression of an expression.
+ * @return The number of evaluations removed, or 0 if nothing repeats.
+ */
+size_t shareOnce(Slot &root, NameGenerator &names,
+                 std::unique_ptr<ast::VariableDeclaration> &temporary) {
+  std::vector<Candidate> candidates;
+  collectCandidates(root, candidates);
+
+  ast::StructuralHashes hashes(*root);
+  std::unordered_map<uint64_t, std::vector<std::vector<Candidate *>>> groups;
+  for (auto &candidate : candidates) {
+    if (createsArray(**candidate.slot)) {
+      continue;
+    }
+    auto &buckets = groups[hashes.of(**candidate.slot)];
+    auto bucket = std::find_if(
+        buckets.begin(), buckets.end(), [&candidate](const auto &members) {
+          return ast::structurallyEqual(**members.front()->slot,
+                                        **candidate.slot);
+        });
+    if (bucket == buckets.end()) {
+      buckets.push_back({&candidate});
+    } else {
+      bucket->push_back(&candidate);
+    }
+  }
+
+  // Prefer the largest repeated subexpression, then the earliest one.
+  const std::vector<Candidate *> *best = nullptr;
+  for (const auto &[hash, buckets] : groups) {
+    for (const auto &members : buckets) {
+      if (members.size() < 2) {
+        continue;
+      }
+      if (!best || members.front()->size > best->front()->size ||
+          (members.front()->size == best->front()->size &&
+           members.front()->order < best->front()->order)) {
+        best = &members;
+      }
+    }
+  }
+  if (!best) {
+    return 0;
+  }
+
+  // Occurrences of one subexpression cannot contain each other, so the
+  // slots stay valid while they are replaced.
+  std::string name = names.next("__cse");
+  for (size_t i = 0; i < best->size(); i++) {
+    Slot &slot = *(*best)[i]->slot;
+    auto reference = makeReference(name, *slot);
+    if (i == 0) {
+      temporary = makeTemporary(name, std::move(slot));
+    }
+    slot = std::move(reference);
+  }
+  return best->size() - 1;
+}
+
+/**
+ * @brief Rewrites one statement list, inserting temporaries in place.
+ */
+void rewriteList(std::vector<std::unique_ptr<ast::Statement>> &statements,
+                 const analysis::PurityAnalysis &purity, NameGenerator &names,
+                 CseStatistics &statistics) {
+  for (size_t i = 0; i < statements.size(); i++) {
+    if (!statements[i]) {
+      continue;
+    }
+    Slot *slot = rewritableSlot(*statements[i], purity);
+    if (!slot) {
+      continue;
+    }
+    statistics.statements++;
+
+    while (true) {
+      std::unique_ptr<ast::VariableDeclaration> temporary;
+      size_t eliminated = shareOnce(*slot, names, temporary);
+      if (eliminated == 0) {
+        break;
+      }
+      statements.insert(statements.begin() + i, std::move(temporary));
+      i++;
+      statistics.temporaries++;
+      statistics.eliminated += eliminated;
+    }
+  }
+}
+
+} // namespace
+
+CseStatistics
+eliminateCommonSubexpressions(ast::Program &program,
+                              const analysis::PurityAnalysis &purity) {
+  CseStatistics statistics;
+  NameGenerator names(program);
+
+  // Collect the lists first: inserting temporaries must not disturb the
+  // traversal.
+  std::vector<std::vector<std::unique_ptr<ast::Statement>> *> lists{
+      &program.statements};
+  for (ast::Node &node : ast::preOrder(static_cast<ast::Node &>(program))) {
+    if (node.tag() == ast::NodeTag::BlockStatement) {
+      lists.push_back(&static_cast<ast::BlockStatement &>(node).statements);
+    }
+  }
+  for (auto *statements : lists) {
+    rewriteList(*statements, purity, names, statistics);
+  }
+  return statistics;
+}
+
+} // namespace ml::opt
@@ -0,0 +1,328 @@
+/**
+ * @file dce.cpp
+ * @brief Dead code elimination source code for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/opt/dce.h"
+#include "ml/ast/query.h"
+#include "ml/opt/rewrite.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ml::opt {
+
+namespace {
+
+using StatementList = std::vector<std::unique_ptr<ast::Statement>>;
+
+/**
+ * @brief Checks whether an expression is the boolean literal given.
+ */
+bool isLiteral(const ast::Expression *expression, const char *value) {
+  return expression &&
+         expression->tag() == ast::NodeTag::LiteralExpression &&
+         static_cast<const ast::LiteralExpression *>(expression)->value ==
+             value;
+}
+
+/**
+ * @class Reachability
+ * @brief Removes the statements of a program that can never run.
+ */
+class Reachability {
+private:
+  DceStatistics &statistics_; // Statistics of the pass
+  Diagnostics &diagnostics_;  // Warnings of the pass
+
+  /**
+   * @brief Records a warning about removed code.
+   */
+  void warn(const std::string &desc, const std::string &help,
+            basic::Locus start, basic::Locus end) {
+    this->diagnostics_.push_back(
+        {basic::ErrorLevel::Warning, desc, help, start, end});
+  }
+
+  /**
+   * @brief Resolves the branches of an 'if' on constant conditions.
+   * @param node The conditional.
+   * @return The statement that replaces it, possibly the conditional itself,
+   * or nullptr if nothing of it can run.
+   */
+  std::unique_ptr<ast::Statement>
+  resolve(std::unique_ptr<ast::IfConditional> node) {
+    auto &elifs = node->elif_branches;
+    for (size_t i = 0; i < elifs.size();) {
+      if (!elifs[i]) {
+        i++;
+        continue;
+      }
+      if (isLiteral(elifs[i]->condition.get(), "false")) {
+        this->warn("Branch never runs", "The condition is always false",
+                   elifs[i]->start, elifs[i]->end);
+        this->statistics_.branches++;
+        elifs.erase(elifs.begin() + i);
+        continue;
+      }
+      if (isLiteral(elifs[i]->condition.get(), "true")) {
+        // This branch runs whenever it is reached, so it becomes the 'else'.
+        size_t dropped = elifs.size() - i - 1 + (node->else_branch ? 1 : 0);
+        if (dropped > 0) {
+          basic::Locus start =
+              i + 1 < elifs.size() ? elifs[i + 1]->start
+                                   : node->else_branch->start;
+          basic::Locus end =
+              node->else_branch ? node->else_branch->end : elifs.back()->end;
+          this->warn("Branch never runs",
+                     "An earlier condition is always true", start, end);
+          this->statistics_.branches += dropped;
+        }
+        node->else_branch = std::move(elifs[i]->then_branch);
+        elifs.erase(elifs.begin() + i, elifs.end());
+        break;
+      }
+      i++;
+    }
+
+    if (isLiteral(node->condition.get(), "true")) {
+      if (!elifs.empty() || node->else_branch) {
+        basic::Locus start =
+            elifs.empty() ? node->else_branch->start : elifs.front()->start;
+        basic::Locus end =
+            node->else_branch ? node->else_branch->end : elifs.back()->end;
+        this->warn("Branch never runs", "The 'if' condition is always true",
+                   start, end);
+        this->statistics_.branches +=
+            elifs.size() + (node->else_branch ? 1 : 0);
+      }
+      return std::move(node->then_branch);
+    }
+
+    if (isLiteral(node->condition.get(), "false")) {
+      if (node->then_branch) {
+        this->warn("Branch never runs", "The condition is always false",
+                   node->then_branch->start, node->then_branch->end);
+      }
+      this->statistics_.branches++;
+      if (!elifs.empty()) {
+        // The first 'elif' takes the place of the 'if'.
+        std::unique_ptr<ast::IfConditional> first = std::move(elifs.front());
+        elifs.erase(elifs.begin());
+        first->elif_branches = std::move(elifs);
+        first->else_branch = std::move(node->else_branch);
+        return first;
+      }
+      return std::move(node->else_branch);
+    }
+    return node;
+  }
+
+public:
+  Reachability(DceStatistics &statistics, Diagnostics &diagnostics)
+      : statistics_(statistics), diagnostics_(diagnostics) {}
+
+  /**
+   * @brief Removes the statements of a list that can never run.
+   * @param statements The list, and the blocks nested in it.
+   */
+  void simplify(StatementList &statements) {
+    for (size_t i = 0; i < statements.size();) {
+      auto &statement = statements[i];
+      if (!statement) {
+        i++;
+        continue;
+      }
+
+      if (statement->tag() == ast::NodeTag::IfConditional) {
+        statement = this->resolve(std::unique_ptr<ast::IfConditional>(
+            static_cast<ast::IfConditional *>(statement.release())));
+        if (!statement) {
+          statements.erase(statements.begin() + i);
+          continue;
+        }
+      } else if (statement->tag() == ast::NodeTag::WhileConditional &&
+                 isLiteral(static_cast<ast::WhileConditional &>(*statement)
+                               .condition.get(),
+                           "false")) {
+        this->warn("Loop never runs", "The condition is always false",
+                   statement->start, statement->end);
+        this->statistics_.branches++;
+        statements.erase(statements.begin() + i);
+        continue;
+      }
+
+      forEachBlock(*statement, [this](ast::BlockStatement &block) {
+        this->simplify(block.statements);
+      });
+      i++;
+    }
+
+    for (size_t i = 0; i + 1 < statements.size(); i++) {
+      if (ast::terminates(statements[i].get())) {
+        this->warn("Unreachable code",
+                   "Control never reaches past the statement before it",
+                   statements[i + 1]->start, statements.back()->end);
+        this->statistics_.unreachable += statements.size() - i - 1;
+        statements.erase(statements.begin() + i + 1, statements.end());
+        break;
+      }
+    }
+  }
+};
+
+/**
+ * @brief Counts the references to every name in a tree.
+ * @details The names introduced by declarations are not references.
+ */
+std::unordered_map<std::string, size_t> countReferences(const ast::Node &root) {
+  std::unordered_set<const ast::Node *> declared;
+  std::unordered_map<std::string, size_t> counts;
+  for (const ast::Node &node : ast::preOrder(root)) {
+    switch (node.tag()) {
+    case ast::NodeTag::Declaration:
+    case ast::NodeTag::VariableDeclaration:
+    case ast::NodeTag::FunctionDeclaration:
+    case ast::NodeTag::RecordDeclaration:
+    case ast::NodeTag::ClassDeclaration:
+      declared.insert(
+          static_cast<const ast::Declaration &>(node).identifier.get());
+      break;
+    case ast::NodeTag::IdentifierExpression:
+    case ast::NodeTag::ArrayIdentifierExpression:
+      // A declaration is visited before its identifier.
+      if (declared.count(&node) == 0) {
+        counts[static_cast<const ast::IdentifierExpression &>(node).name]++;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+  return counts;
+}
+
+/**
+ * @brief Checks whether a declaration is private and may be removed when it
+ * is unused.
+ */
+bool isRemovable(const ast::Declaration &declaration) {
+  if (!declaration.identifier || declaration.identifier->name == "main" ||
+      declaration.identifier->name == "init") {
+    return false;
+  }
+  const auto *modifier = declaration.modifier.get();
+  return !modifier ||
+         (modifier->accessor == basic::Accessor::Private &&
+          (modifier->modifier & basic::Modifier::Init) ==
+              basic::Modifier::None);
+}
+
+/**
+ * @brief Counts the references to a declaration's name from outside it.
+ */
+size_t outsideReferences(const ast::Declaration &declaration,
+                         const std::unordered_map<std::string, size_t> &uses) {
+  const std::string &name = declaration.identifier->name;
+  auto total = uses.find(name);
+  if (total == uses.end()) {
+    return 0;
+  }
+  auto inside = countReferences(declaration);
+  auto own = inside.find(name);
+  return total->second - (own == inside.end() ? 0 : own->second);
+}
+
+/**
+ * @brief Removes unused private members of a class.
+ * @return True if a member was removed.
+ */
+bool removeUnusedMembers(ast::ClassDeclaration &declaration,
+                         const std::unordered_map<std::string, size_t> &uses,
+                         DceStatistics &statistics,
+                         Diagnostics &diagnostics) {
+  bool changed = false;
+  auto &fields = declaration.fields;
+  for (size_t i = 0; i < fields.size();) {
+    auto *field = fields[i].get();
+    if (field && isRemovable(*field) &&
+        outsideReferences(*field, uses) == 0 &&
+        (!field->initializer || ast::isSideEffectFree(*field->initializer))) {
+      diagnostics.push_back(
+          {basic::ErrorLevel::Warning,
+           "Unused private field '" + field->identifier->name + "'",
+           "Remove it, or make it 'pub' if it is used elsewhere",
+           field->identifier->start, field->identifier->end});
+      statistics.members++;
+      fields.erase(fields.begin() + i);
+      changed = true;
+      continue;
+    }
+    i++;
+  }
+
+  auto &methods = declaration.methods;
+  for (size_t i = 0; i < methods.size();) {
+    auto *method = methods[i].get();
+    if (method && isRemovable(*method) &&
+        outsideReferences(*method, uses) == 0) {
+      diagnostics.push_back(
+          {basic::ErrorLevel::Warning,
+           "Unused private method '" + method->identifier->name + "'",
+           "Remove it, or make it 'pub' if it is used elsewhere",
+           method->identifier->start, method->identifier->end});
+      statistics.members++;
+      methods.erase(methods.begin() + i);
+      changed = true;
+      continue;
+    }
+    i++;
+  }
+  return changed;
+}
+
+} // namespace
+
+DceStatistics eliminateDeadCode(ast::Program &program,
+                                Diagnostics &diagnostics) {
+  DceStatistics statistics;
+  Reachability(statistics, diagnostics).simplify(program.statements);
+
+  // Removing a declaration can leave the ones it used unreferenced, so
+  // repeat until nothing changes. The counts of a round may include
+  // references from declarations removed in it, which only delays removal.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    auto uses = countReferences(program);
+    auto &statements = program.statements;
+    for (size_t i = 0; i < statements.size();) {
+      auto *statement = statements[i].get();
+      if (statement &&
+          statement->tag() == ast::NodeTag::FunctionDeclaration) {
+        auto &function = static_cast<ast::FunctionDeclaration &>(*statement);
+        if (isRemovable(function) && outsideReferences(function, uses) == 0) {
+          diagnostics.push_back(
+              {basic::ErrorLevel::Warning,
+               "Unused private function '" + function.identifier->name + "'",
+               "Remove it, or make it 'pub' if it is used elsewhere",
+               function.identifier->start, function.identifier->end});
+          statistics.functions++;
+          statements.erase(statements.begin() + i);
+          changed = true;
+          continue;
+        }
+      } else if (statement &&
+                 statement->tag() == ast::NodeTag::ClassDeclaration) {
+        changed |= removeUnusedMembers(
+            static_cast<ast::ClassDeclaration &>(*statement), uses, statistics,
+            diagnostics);
+      }
+      i++;
+    }
+  }
+  return statistics;
+}
+
+} // namespace ml::opt
@@ -0,0 +1,685 @@
+/**
+ * @file loop.cpp
+ * @brief Loop optimizations source code for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/opt/loop.h"
+#include "ml/ast/query.h"
+#include "ml/opt/rewrite.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ml::opt {
+
+namespace {
+
+using Slot = std::unique_ptr<ast::Expression>;
+using StatementList = std::vector<std::unique_ptr<ast::Statement>>;
+
+/**
+ * @brief The names of the integer types.
+ */
+const std::unordered_set<std::string> INTEGER_TYPES = {
+    "int", "i8",  "i16", "i32",   "i64",  "u8",
+    "u16", "u32", "u64", "isize", "usize"};
+
+/**
+ * @brief Reads a non-negative integer literal.
+ * @return True if the expression is one, with its value in value.
+ */
+bool integerLiteral(const ast::Node *node, long long &value) {
+  if (!node || node->tag() != ast::NodeTag::LiteralExpression) {
+    return false;
+  }
+  const basic::Number &number =
+      static_cast<const ast::LiteralExpression *>(node)->number;
+  // Stay well below the overflow of the arithmetic done on the value.
+  if (number.kind != basic::NumberKind::Integer ||
+      number.integer >= 1000000000000000000ull) {
+    return false;
+  }
+  value = static_cast<long long>(number.integer);
+  return true;
+}
+
+/**
+ * @brief Creates an integer literal.
+ */
+std::unique_ptr<ast::LiteralExpression> makeInteger(long long value,
+                                                    const ast::Node &at) {
+  return std::make_unique<ast::LiteralExpression>(at.start, at.end,
+                                                  std::to_string(value));
+}
+
+/**
+ * @brief Creates a binary expression located at a node.
+ */
+std::unique_ptr<ast::BinaryExpression>
+makeBinary(std::unique_ptr<ast::Expression> left, const std::string &op,
+           std::unique_ptr<ast::Expression> right, const ast::Node &at) {
+  return std::make_unique<ast::BinaryExpression>(at.start, at.end,
+                                                 std::move(left), op,
+                                                 std::move(right));
+}
+
+/**
+ * @brief Matches a change of a variable by a constant.
+ * @param expression 'i++', 'i--', 'i = i + c', 'i = c + i' or 'i = i - c'.
+ * @param name Receives the variable.
+ * @param step Receives the signed change.
+ * @return True if the expression has one of those forms.
+ */
+bool matchUpdate(const ast::Expression &expression, std::string &name,
+                 long long &step) {
+  if (expression.tag() == ast::NodeTag::UnaryExpression) {
+    auto &v = static_cast<const ast::UnaryExpression &>(expression);
+    const std::string *target = ast::identifierName(v.operand.get());
+    if (!target || (v.op != "++" && v.op != "--")) {
+      return false;
+    }
+    name = *target;
+    step = v.op == "++" ? 1 : -1;
+    return true;
+  }
+
+  if (expression.tag() != ast::NodeTag::BinaryExpression) {
+    return false;
+  }
+  auto &assignment = static_cast<const ast::BinaryExpression &>(expression);
+  const std::string *target = ast::identifierName(assignment.left.get());
+  if (!target || assignment.op != "=" || !assignment.right ||
+      assignment.right->tag() != ast::NodeTag::BinaryExpression) {
+    return false;
+  }
+  auto &change = static_cast<const ast::BinaryExpression &>(*assignment.right);
+  const std::string *left = ast::identifierName(change.left.get());
+  const std::string *right = ast::identifierName(change.right.get());
+  long long amount = 0;
+  if (change.op == "+" && left && *left == *target &&
+      integerLiteral(change.right.get(), amount)) {
+    step = amount;
+  } else if (change.op == "+" && right && *right == *target &&
+             integerLiteral(change.left.get(), amount)) {
+    step = amount;
+  } else if (change.op == "-" && left && *left == *target &&
+             integerLiteral(change.right.get(), amount)) {
+    step = -amount;
+  } else {
+    return false;
+  }
+  name = *target;
+  return true;
+}
+
+/**
+ * @struct Scope
+ * @brief What is known about the names of the function around a loop.
+ */
+struct Scope {
+  std::unordered_set<std::string> locals;         // Parameters and locals
+  std::unordered_map<std::string, bool> integers; // Whether each is integer
+};
+
+/**
+ * @brief Collects the parameters and local variables of a function.
+ */
+Scope scopeOf(const ast::FunctionDeclaration &function) {
+  Scope scope;
+  auto add = [&scope](const ast::Declaration &declaration,
+                      const ast::Expression *initializer) {
+    if (!declaration.identifier) {
+      return;
+    }
+    const std::string &name = declaration.identifier->name;
+    const std::string *type = ast::identifierName(declaration.type.get());
+    long long value = 0;
+    bool integer = type && (INTEGER_TYPES.count(*type) != 0 ||
+                            (*type == "void" &&
+                             integerLiteral(initializer, value)));
+    scope.locals.insert(name);
+    // A name declared twice is an integer only if both declarations agree.
+    auto [it, inserted] = scope.integers.emplace(name, integer);
+    if (!inserted) {
+      it->second = it->second && integer;
+    }
+  };
+
+  for (const auto &parameter : function.parameters) {
+    if (parameter) {
+      add(*parameter, nullptr);
+    }
+  }
+  if (function.body) {
+    for (const ast::Node &node : ast::preOrder(
+             static_cast<const ast::Node &>(*function.body))) {
+      if (node.tag() == ast::NodeTag::VariableDeclaration) {
+        auto &v = static_cast<const ast::VariableDeclaration &>(node);
+        add(v, v.initializer.get());
+      }
+    }
+  }
+  return scope;
+}
+
+/**
+ * @struct LoopFacts
+ * @brief The names a loop changes and whether it may change others.
+ */
+struct LoopFacts {
+  std::unordered_map<std::string, size_t> assignments;  // Changes per name
+  std::unordered_map<std::string, size_t> declarations; // Declarations
+  bool calls = false; // Whether the loop calls a function that is not pure
+
+  /**
+   * @brief Checks whether the loop changes or declares a name.
+   */
+  bool changes(const std::string &name) const {
+    return this->assignments.count(name) != 0 ||
+           this->declarations.count(name) != 0;
+  }
+};
+
+/**
+ * @brief Gathers the facts of a loop, including its header.
+ */
+LoopFacts analyze(const ast::Conditional &loop,
+                  const analysis::PurityAnalysis &purity) {
+  LoopFacts facts;
+  for (const ast::Node &node :
+       ast::preOrder(static_cast<const ast::Node &>(loop))) {
+    switch (node.tag()) {
+    case ast::NodeTag::BinaryExpression: {
+      auto &v = static_cast<const ast::BinaryExpression &>(node);
+      const std::string *target = ast::identifierName(v.left.get());
+      if (v.op == "=" && target) {
+        facts.assignments[*target]++;
+      }
+      break;
+    }
+    case ast::NodeTag::UnaryExpression: {
+      auto &v = static_cast<const ast::UnaryExpression &>(node);
+      const std::string *target = ast::identifierName(v.operand.get());
+      if ((v.op == "++" || v.op == "--") && target) {
+        facts.assignments[*target]++;
+      }
+      break;
+    }
+    case ast::NodeTag::Declaration:
+    case ast::NodeTag::VariableDeclaration: {
+      auto &v = static_cast<const ast::Declaration &>(node);
+      if (v.identifier) {
+        facts.declarations[v.identifier->name]++;
+      }
+      break;
+    }
+    case ast::NodeTag::CallExpression:
+    case ast::NodeTag::AttributeExpression:
+      if (!purity.isPure(node)) {
+        facts.calls = true;
+      }
+      break;
+    case ast::NodeTag::SpawnExpression:
+    case ast::NodeTag::AwaitExpression:
+      facts.calls = true;
+      break;
+    default:
+      break;
+    }
+  }
+  return facts;
+}
+
+/**
+ * @brief Checks whether a loop is a C-style for loop, whose condition and
+ * increment run on every iteration.
+ */
+bool isCounting(const ast::Conditional &loop) {
+  if (loop.tag() != ast::NodeTag::ForConditional) {
+    return false;
+  }
+  auto &v = static_cast<const ast::ForConditional &>(loop);
+  return v.initializer && v.condition;
+}
+
+/**
+ * @brief Collects the expression slots a loop evaluates on every iteration.
+ * @param loop The while or for loop.
+ * @param header Whether to include the condition and increment.
+ */
+std::vector<Slot *> iterationSlots(ast::Conditional &loop, bool header) {
+  std::vector<Slot *> slots;
+  auto add = [&slots](Slot &slot) { slots.push_back(&slot); };
+  if (header && loop.tag() == ast::NodeTag::WhileConditional) {
+    forEachStatementSlot(loop, add);
+  } else if (header && isCounting(loop)) {
+    forEachStatementSlot(loop, add);
+  }
+  if (loop.then_branch) {
+    for (ast::Node &node :
+         ast::preOrder(static_cast<ast::Node &>(*loop.then_branch))) {
+      if (node.kind != ast::NodeKind::Expression) {
+        forEachStatementSlot(static_cast<ast::Statement &>(node), add);
+      }
+    }
+  }
+  return slots;
+}
+
+/**
+ * @struct Induction
+ * @brief A variable changed by a constant once per iteration.
+ */
+struct Induction {
+  std::string name;       // The variable
+  long long step;         // The signed change per iteration
+  size_t update;          // Index of the updating statement in a while body
+  const ast::Expression *initial; // Start value declared by a for loop
+};
+
+/**
+ * @struct Product
+ * @brief A multiplication of an induction variable by an invariant.
+ */
+struct Product {
+  Slot *slot;                      // The slot holding 'i * k'
+  size_t induction;                // Index of i among the inductions
+  const ast::Expression *multiple; // The invariant k
+};
+
+/**
+ * @class LoopOptimizer
+ * @brief Applies the loop optimizations, innermost loop first.
+ */
+class LoopOptimizer {
+private:
+  const analysis::PurityAnalysis &purity_; // Purity of the functions
+  LoopStatistics &statistics_;             // Statistics of the pass
+  NameGenerator names_;                    // Names of the new variables
+  Scope scope_;                            // Names of the current function
+
+  /**
+   * @brief Checks whether an expression may be evaluated once, before a
+   * loop, instead of on every iteration.
+   */
+  bool isInvariant(const ast::Expression &expression,
+                   const LoopFacts &facts) const {
+    for (const ast::Node &node :
+         ast::preOrder(static_cast<const ast::Node &>(expression))) {
+      switch (node.tag()) {
+      case ast::NodeTag::LiteralExpression:
+        break;
+      case ast::NodeTag::IdentifierExpression: {
+        auto &name = static_cast<const ast::IdentifierExpression &>(node).name;
+        if (facts.changes(name) ||
+            (facts.calls && this->scope_.locals.count(name) == 0)) {
+          return false;
+        }
+        break;
+      }
+      case ast::NodeTag::BinaryExpression: {
+        auto &op = static_cast<const ast::BinaryExpression &>(node).op;
+        if (op == "=" || op == "/" || op == "%") {
+          return false;
+        }
+        break;
+      }
+      case ast::NodeTag::UnaryExpression: {
+        auto &op = static_cast<const ast::UnaryExpression &>(node).op;
+        if (op == "++" || op == "--") {
+          return false;
+        }
+        break;
+      }
+      default:
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Checks whether an expression is an integer literal or a local
+   * integer variable.
+   */
+  bool isInteger(const ast::Expression &expression) const {
+    long long value = 0;
+    if (integerLiteral(&expression, value)) {
+      return true;
+    }
+    const std::string *name = ast::identifierName(&expression);
+    if (!name) {
+      return false;
+    }
+    auto it = this->scope_.integers.find(*name);
+    return it != this->scope_.integers.end() && it->second;
+  }
+
+  /**
+   * @brief Finds the induction variables of a loop.
+   */
+  std::vector<Induction> findInductions(ast::Conditional &loop,
+                                        const LoopFacts &facts) const {
+    std::vector<Induction> inductions;
+    std::string name;
+    long long step = 0;
+    auto once = [&facts](const std::string &name) {
+      auto it = facts.assignments.find(name);
+      return it != facts.assignments.end() && it->second == 1;
+    };
+    auto integer = [this](const std::string &name) {
+      auto it = this->scope_.integers.find(name);
+      return it != this->scope_.integers.end() && it->second;
+    };
+
+    if (loop.tag() == ast::NodeTag::WhileConditional && loop.then_branch) {
+      auto &statements = loop.then_branch->statements;
+      for (size_t i = 0; i < statements.size(); i++) {
+        if (!statements[i] ||
+            statements[i]->tag() != ast::NodeTag::ExpressionStatement) {
+          continue;
+        }
+        auto &expression =
+            static_cast<ast::ExpressionStatement &>(*statements[i]).expression;
+        if (expression && matchUpdate(*expression, name, step) &&
+            once(name) && !facts.declarations.count(name) && integer(name)) {
+          inductions.push_back({name, step, i, nullptr});
+        }
+      }
+    } else if (isCounting(loop)) {
+      auto &v = static_cast<ast::ForConditional &>(loop);
+      if (!v.increment || !matchUpdate(*v.increment, name, step) ||
+          !once(name) || !integer(name)) {
+        return inductions;
+      }
+      const ast::Expression *initial = nullptr;
+      auto declared = facts.declarations.find(name);
+      if (declared != facts.declarations.end()) {
+        // Only the loop's own counter may be declared in it.
+        auto *counter =
+            dynamic_cast<const ast::VariableDeclaration *>(v.initializer.get());
+        if (declared->second != 1 || !counter || !counter->identifier ||
+            counter->identifier->name != name || !counter->initializer ||
+            !this->isInvariant(*counter->initializer, LoopFacts())) {
+          return inductions;
+        }
+        initial = counter->initializer.get();
+      }
+      inductions.push_back({name, step, 0, initial});
+    }
+    return inductions;
+  }
+
+  /**
+   * @brief Replaces the products of induction variables in a loop with
+   * variables advanced by addition.
+   * @param loop The loop.
+   * @param before Receives the declarations to place before the loop.
+   */
+  void reduce(ast::Conditional &loop, StatementList &before) {
+    LoopFacts facts = analyze(loop, this->purity_);
+    std::vector<Induction> inductions = this->findInductions(loop, facts);
+    if (inductions.empty()) {
+      return;
+    }
+
+    // The condition of a for loop runs after the increment but before the
+    // body, where the new variables are advanced, so it is left alone.
+    bool counting = isCounting(loop);
+    std::vector<Product> products;
+    for (Slot *root : iterationSlots(loop, !counting)) {
+      std::vector<Slot *> stack{root};
+      while (!stack.empty()) {
+        Slot *slot = stack.back();
+        stack.pop_back();
+        ast::Expression &expression = **slot;
+        if (expression.tag() == ast::NodeTag::BinaryExpression) {
+          auto &v = static_cast<ast::BinaryExpression &>(expression);
+          bool matched = false;
+          for (size_t i = 0; v.op == "*" && i < inductions.size(); i++) {
+            const std::string *left = ast::identifierName(v.left.get());
+            const std::string *right = ast::identifierName(v.right.get());
+            const ast::Expression *multiple = nullptr;
+            if (left && *left == inductions[i].name) {
+              multiple = v.right.get();
+            } else if (right && *right == inductions[i].name) {
+              multiple = v.left.get();
+            }
+            if (multiple && this->isInteger(*multiple) &&
+                this->isInvariant(*multiple, facts)) {
+              products.push_back({slot, i, multiple});
+              matched = true;
+              break;
+            }
+          }
+          if (matched) {
+            continue;
+          }
+        }
+        forEachSlot(expression, [&stack](Slot &child) {
+          stack.push_back(&child);
+        });
+      }
+    }
+
+    std::vector<std::pair<size_t, std::unique_ptr<ast::Statement>>> updates;
+    std::vector<bool> done(products.size(), false);
+    for (size_t first = 0; first < products.size(); first++) {
+      if (done[first]) {
+        continue;
+      }
+      const Product &product = products[first];
+      const Induction &induction = inductions[product.induction];
+      // Keep a copy of k: the first occurrence is replaced below.
+      std::unique_ptr<ast::Expression> copy =
+          cloneExpression(*product.multiple);
+      const ast::Expression &multiple = *copy;
+      const ast::Expression &at = **product.slot;
+      std::string name = this->names_.next("__sr");
+
+      // The change of the new variable per iteration, |step| * k.
+      long long amount =
+          induction.step < 0 ? -induction.step : induction.step;
+      long long constant = 0;
+      auto change = [&]() -> std::unique_ptr<ast::Expression> {
+        if (integerLiteral(&multiple, constant)) {
+          return makeInteger(amount * constant, at);
+        }
+        if (amount == 1) {
+          return cloneExpression(multiple);
+        }
+        return makeBinary(makeInteger(amount, at), "*",
+                          cloneExpression(multiple), at);
+      };
+      const char *forward = induction.step < 0 ? "-" : "+";
+      const char *backward = induction.step < 0 ? "+" : "-";
+
+      if (!counting) {
+        // A while loop advances the variable right after the induction.
+        before.push_back(makeTemporary(name, cloneExpression(at), false));
+        updates.emplace_back(
+            induction.update + 1,
+            makeAssignment(name, makeBinary(makeReference(name, at), forward,
+                                            change(), at)));
+      } else {
+        // A for loop advances it first thing in the body, so it starts one
+        // step behind the counter.
+        std::unique_ptr<ast::Expression> initial =
+            induction.initial ? cloneExpression(*induction.initial)
+                              : makeReference(induction.name, at);
+        long long start = 0;
+        std::unique_ptr<ast::Expression> value;
+        if (integerLiteral(initial.get(), start) &&
+            integerLiteral(&multiple, constant)) {
+          value = makeInteger(start * constant - induction.step * constant,
+                              at);
+        } else {
+          value = makeBinary(makeBinary(std::move(initial), "*",
+                                        cloneExpression(multiple), at),
+                             backward, change(), at);
+        }
+        before.push_back(makeTemporary(name, std::move(value), false));
+        updates.emplace_back(
+            0, makeAssignment(name, makeBinary(makeReference(name, at),
+                                               forward, change(), at)));
+      }
+
+      for (size_t i = first; i < products.size(); i++) {
+        if (done[i] || products[i].induction != product.induction ||
+            !ast::structurallyEqual(*products[i].multiple, multiple)) {
+          continue;
+        }
+        done[i] = true;
+        Slot &slot = *products[i].slot;
+        slot = makeReference(name, *slot);
+        this->statistics_.reduced++;
+      }
+    }
+
+    // Insert from the back so the earlier positions stay valid.
+    auto &statements = loop.then_branch->statements;
+    std::stable_sort(updates.begin(), updates.end(),
+                     [](const auto &a, const auto &b) {
+                       return a.first > b.first;
+                     });
+    for (auto it = updates.begin(); it != updates.end();) {
+      auto last = std::find_if(it, updates.end(), [&it](const auto &update) {
+        return update.first != it->first;
+      });
+      for (auto update = last; update != it;) {
+        --update;
+        statements.insert(statements.begin() + update->first,
+                          std::move(update->second));
+      }
+      it = last;
+    }
+  }
+
+  /**
+   * @brief Moves the invariant expressions of a loop in front of it.
+   * @param loop The loop.
+   * @param before Receives the declarations to place before the loop.
+   */
+  void hoist(ast::Conditional &loop, StatementList &before) {
+    LoopFacts facts = analyze(loop, this->purity_);
+    std::vector<Slot *> candidates;
+    for (Slot *root : iterationSlots(loop, true)) {
+      std::vector<Slot *> stack{root};
+      while (!stack.empty()) {
+        Slot *slot = stack.back();
+        stack.pop_back();
+        ast::Expression &expression = **slot;
+        bool compound = expression.tag() == ast::NodeTag::BinaryExpression ||
+                        expression.tag() == ast::NodeTag::UnaryExpression;
+        if (compound && this->isInvariant(expression, facts)) {
+          candidates.push_back(slot);
+          continue;
+        }
+        size_t first = stack.size();
+        forEachSlot(expression,
+                    [&stack](Slot &child) { stack.push_back(&child); });
+        std::reverse(stack.begin() + first, stack.end());
+      }
+    }
+
+    std::vector<bool> done(candidates.size(), false);
+    for (size_t first = 0; first < candidates.size(); first++) {
+      if (done[first]) {
+        continue;
+      }
+      std::string name = this->names_.next("__licm");
+      const ast::Expression &pattern = **candidates[first];
+      std::unique_ptr<ast::VariableDeclaration> temporary;
+      // Occurrences are maximal, so none contains another.
+      for (size_t i = first; i < candidates.size(); i++) {
+        if (done[i] || !ast::structurallyEqual(**candidates[i], pattern)) {
+          continue;
+        }
+        done[i] = true;
+        Slot &slot = *candidates[i];
+        auto reference = makeReference(name, *slot);
+        if (i == first) {
+          temporary = makeTemporary(name, std::move(slot));
+        }
+        slot = std::move(reference);
+        this->statistics_.hoisted++;
+      }
+      before.push_back(std::move(temporary));
+    }
+  }
+
+  /**
+   * @brief Optimizes the loops of a function body with its scope.
+   */
+  void function(ast::FunctionDeclaration &function) {
+    Scope outer = std::move(this->scope_);
+    this->scope_ = scopeOf(function);
+    if (function.body) {
+      this->run(function.body->statements);
+    }
+    this->scope_ = std::move(outer);
+  }
+
+public:
+  LoopOptimizer(ast::Program &program,
+                const analysis::PurityAnalysis &purity,
+                LoopStatistics &statistics)
+      : purity_(purity), statistics_(statistics), names_(program) {}
+
+  /**
+   * @brief Optimizes the loops of a statement list and the blocks nested in
+   * it, placing new declarations in the list.
+   */
+  void run(StatementList &statements) {
+    for (size_t i = 0; i < statements.size(); i++) {
+      ast::Statement *statement = statements[i].get();
+      if (!statement) {
+        continue;
+      }
+
+      if (statement->tag() == ast::NodeTag::FunctionDeclaration) {
+        this->function(static_cast<ast::FunctionDeclaration &>(*statement));
+        continue;
+      }
+      if (statement->tag() == ast::NodeTag::ClassDeclaration) {
+        for (auto &method :
+             static_cast<ast::ClassDeclaration &>(*statement).methods) {
+          if (method) {
+            this->function(*method);
+          }
+        }
+        continue;
+      }
+      forEachBlock(*statement, [this](ast::BlockStatement &block) {
+        this->run(block.statements);
+      });
+
+      if (statement->tag() != ast::NodeTag::WhileConditional &&
+          statement->tag() != ast::NodeTag::ForConditional) {
+        continue;
+      }
+      auto &loop = static_cast<ast::Conditional &>(*statement);
+      this->statistics_.loops++;
+      StatementList before;
+      this->reduce(loop, before);
+      this->hoist(loop, before);
+      statements.insert(statements.begin() + i,
+                        std::make_move_iterator(before.begin()),
+                        std::make_move_iterator(before.end()));
+      i += before.size();
+    }
+  }
+};
+
+} // namespace
+
+LoopStatistics optimizeLoops(ast::Program &program,
+                             const analysis::PurityAnalysis &purity) {
+  LoopStatistics statistics;
+  LoopOptimizer(program, purity, statistics).run(program.statements);
+  return statistics;
+}
+
+} // namespace ml::opt
@@ -0,0 +1,33 @@
+/**
+ * @file optimizer.cpp
+ * @brief AST optimization pipeline source code for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/opt/optimizer.h"
+#include "ml/analysis/purity.h"
+
+namespace ml::opt {
+
+OptimizerStatistics optimize(ast::Program &program,
+                             const OptimizerOptions &options) {
+  OptimizerStatistics statistics;
+  if (options.dce) {
+    statistics.dce = eliminateDeadCode(program, statistics.diagnostics);
+  }
+  if (options.tail_calls) {
+    statistics.tail_calls = eliminateTailCalls(program);
+  }
+
+  analysis::PurityAnalysis purity(program);
+  if (options.loops) {
+    statistics.loops = optimizeLoops(program, purity);
+  }
+
+  if (options.cse) {
+    statistics.cse = eliminateCommonSubexpressions(program, purity);
+  }
+  return statistics;
+}
+
+} // namespace ml::opt
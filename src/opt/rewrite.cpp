@@ -0,0 +1,142 @@
+/**
+ * @file rewrite.cpp
+ * @brief AST rewriting helpers source code for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/opt/rewrite.h"
+
+#include <stdexcept>
+
+namespace ml::opt {
+
+std::unique_ptr<ast::Expression>
+cloneExpression(const ast::Expression &expression) {
+  auto clone = [](const std::unique_ptr<ast::Expression> &slot) {
+    return slot ? cloneExpression(*slot) : nullptr;
+  };
+  auto cloneAll = [&clone](const auto &slots) {
+    std::vector<std::unique_ptr<ast::Expression>> copies;
+    copies.reserve(slots.size());
+    for (const auto &slot : slots) {
+      copies.push_back(clone(slot));
+    }
+    return copies;
+  };
+
+  basic::Locus start = expression.start;
+  basic::Locus end = expression.end;
+  switch (expression.tag()) {
+  case ast::NodeTag::BinaryExpression: {
+    auto &v = static_cast<const ast::BinaryExpression &>(expression);
+    return std::make_unique<ast::BinaryExpression>(start, end, clone(v.left),
+                                                   v.op, clone(v.right));
+  }
+  case ast::NodeTag::UnaryExpression: {
+    auto &v = static_cast<const ast::UnaryExpression &>(expression);
+    return std::make_unique<ast::UnaryExpression>(start, end, v.op,
+                                                  clone(v.operand));
+  }
+  case ast::NodeTag::LiteralExpression: {
+    auto &v = static_cast<const ast::LiteralExpression &>(expression);
+    return std::make_unique<ast::LiteralExpression>(start, end, v.value,
+                                                    v.number);
+  }
+  case ast::NodeTag::IdentifierExpression:
+    return std::make_unique<ast::IdentifierExpression>(
+        start, end,
+        static_cast<const ast::IdentifierExpression &>(expression).name);
+  case ast::NodeTag::ArrayIdentifierExpression: {
+    auto &v = static_cast<const ast::ArrayIdentifierExpression &>(expression);
+    return std::make_unique<ast::ArrayIdentifierExpression>(start, end, v.name,
+                                                            clone(v.size));
+  }
+  case ast::NodeTag::IndexExpression: {
+    auto &v = static_cast<const ast::IndexExpression &>(expression);
+    return std::make_unique<ast::IndexExpression>(start, end, clone(v.array),
+                                                  clone(v.index));
+  }
+  case ast::NodeTag::CallExpression: {
+    auto &v = static_cast<const ast::CallExpression &>(expression);
+    return std::make_unique<ast::CallExpression>(start, end, clone(v.callee),
+                                                 cloneAll(v.arguments));
+  }
+  case ast::NodeTag::AttributeExpression: {
+    auto &v = static_cast<const ast::AttributeExpression &>(expression);
+    return std::make_unique<ast::AttributeExpression>(
+        start, end, clone(v.object), clone(v.attribute));
+  }
+  case ast::NodeTag::ArrayExpression:
+    return std::make_unique<ast::ArrayExpression>(
+        start, end,
+        cloneAll(static_cast<const ast::ArrayExpression &>(expression)
+                     .elements));
+  case ast::NodeTag::SpawnExpression:
+    return std::make_unique<ast::SpawnExpression>(
+        start, end,
+        clone(static_cast<const ast::SpawnExpression &>(expression).call));
+  case ast::NodeTag::AwaitExpression:
+    return std::make_unique<ast::AwaitExpression>(
+        start, end,
+        clone(static_cast<const ast::AwaitExpression &>(expression).task));
+  default:
+    // Returning a bare Expression would silently drop the subtree.
+    throw std::logic_error("cloneExpression: cannot copy a " +
+                           ast::nodeTagName(expression.tag()));
+  }
+}
+
+NameGenerator::NameGenerator(const ast::Node &root) {
+  for (const ast::Node &node : ast::preOrder(root)) {
+    if (node.tag() == ast::NodeTag::IdentifierExpression ||
+        node.tag() == ast::NodeTag::ArrayIdentifierExpression) {
+      this->used_.insert(static_cast<const ast::IdentifierExpression &>(node)
+                             .name);
+    }
+  }
+}
+
+std::string NameGenerator::next(const std::string &prefix) {
+  std::string name;
+  do {
+    name = prefix + std::to_string(this->counter_++);
+  } while (!this->used_.insert(name).second);
+  return name;
+}
+
+std::unique_ptr<ast::VariableDeclaration>
+makeTemporary(const std::string &name,
+              std::unique_ptr<ast::Expression> initializer, bool constant) {
+  basic::Locus start = initializer->start;
+  basic::Locus end = initializer->end;
+  return std::make_unique<ast::VariableDeclaration>(
+      start, end, std::make_unique<ast::IdentifierExpression>(start, end, name),
+      std::make_unique<ast::IdentifierExpression>(basic::Locus(0, 0),
+                                                  basic::Locus(0, 0), "void"),
+      std::make_unique<ast::ModifierStatement>(start, start,
+                                               basic::Accessor::Private,
+                                               constant
+                                                   ? basic::Modifier::Constant
+                                                   : basic::Modifier::None),
+      std::move(initializer));
+}
+
+std::unique_ptr<ast::ExpressionStatement>
+makeAssignment(const std::string &name,
+               std::unique_ptr<ast::Expression> value) {
+  basic::Locus start = value->start;
+  basic::Locus end = value->end;
+  return std::make_unique<ast::ExpressionStatement>(
+      start, end,
+      std::make_unique<ast::BinaryExpression>(
+          start, end,
+          std::make_unique<ast::IdentifierExpression>(start, end, name), "=",
+          std::move(value)));
+}
+
+std::unique_ptr<ast::IdentifierExpression>
+makeReference(const std::string &name, const ast::Node &at) {
+  return std::make_unique<ast::IdentifierExpression>(at.start, at.end, name);
+}
+
+} // namespace ml::opt
@@ -0,0 +1,224 @@
+/**
+ * @file tail.cpp
+ * @brief Tail call elimination source code for My Language.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/opt/tail.h"
+#include "ml/ast/query.h"
+#include "ml/opt/rewrite.h"
+
+#include <unordered_map>
+
+namespace ml::opt {
+
+namespace {
+
+using StatementList = std::vector<std::unique_ptr<ast::Statement>>;
+
+/**
+ * @brief Checks whether a function may be rewritten at all.
+ */
+bool isEligible(const ast::FunctionDeclaration &function) {
+  if (!function.identifier || !function.body) {
+    return false;
+  }
+  const std::string &name = function.identifier->name;
+  for (const auto &parameter : function.parameters) {
+    if (!parameter || !parameter->identifier ||
+        parameter->identifier->name == name) {
+      return false;
+    }
+    if (parameter->modifier &&
+        (parameter->modifier->modifier & basic::Modifier::Constant) !=
+            basic::Modifier::None) {
+      return false;
+    }
+  }
+  for (const ast::Node &node :
+       ast::preOrder(static_cast<const ast::Node &>(*function.body))) {
+    if (node.tag() == ast::NodeTag::VariableDeclaration) {
+      auto &v = static_cast<const ast::VariableDeclaration &>(node);
+      if (v.identifier && v.identifier->name == name) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @class TailCallRewriter
+ * @brief Replaces the tail calls of one function with jumps.
+ */
+class TailCallRewriter {
+private:
+  ast::FunctionDeclaration &function_; // The function being rewritten
+  NameGenerator &names_;               // Names of the temporaries
+  size_t calls_ = 0;                   // Tail calls replaced so far
+
+  /**
+   * @brief Gets the call of a tail call statement, or nullptr.
+   */
+  ast::CallExpression *tailCall(ast::Statement &statement) const {
+    if (statement.tag() != ast::NodeTag::ReturnStatement) {
+      return nullptr;
+    }
+    auto &v = static_cast<ast::ReturnStatement &>(statement);
+    if (!v.expression || v.expression->tag() != ast::NodeTag::CallExpression) {
+      return nullptr;
+    }
+    auto &call = static_cast<ast::CallExpression &>(*v.expression);
+    if (!call.callee ||
+        call.callee->tag() != ast::NodeTag::IdentifierExpression ||
+        static_cast<ast::IdentifierExpression &>(*call.callee).name !=
+            this->function_.identifier->name ||
+        call.arguments.size() != this->function_.parameters.size()) {
+      return nullptr;
+    }
+    for (const auto &argument : call.arguments) {
+      if (!argument) {
+        return nullptr;
+      }
+    }
+    return &call;
+  }
+
+  /**
+   * @brief Builds the jump that replaces a tail call.
+   * @param call The call, whose arguments are taken.
+   * @param at The return statement, whose location the jump takes.
+   */
+  std::unique_ptr<ast::BlockStatement> jump(ast::CallExpression &call,
+                                            const ast::Node &at) {
+    auto &parameters = this->function_.parameters;
+    std::vector<size_t> changed;
+    for (size_t i = 0; i < parameters.size(); i++) {
+      auto *argument = call.arguments[i].get();
+      bool same =
+          argument->tag() == ast::NodeTag::IdentifierExpression &&
+          static_cast<ast::IdentifierExpression &>(*argument).name ==
+              parameters[i]->identifier->name;
+      if (!same) {
+        changed.push_back(i);
+      }
+    }
+
+    StatementList statements;
+    std::vector<std::unique_ptr<ast::Expression>> values;
+    for (size_t i : changed) {
+      auto &argument = call.arguments[i];
+      if (changed.size() == 1) {
+        values.push_back(std::move(argument));
+        continue;
+      }
+      std::string name = this->names_.next("__tco");
+      values.push_back(makeReference(name, *argument));
+      statements.push_back(makeTemporary(name, std::move(argument)));
+    }
+    for (size_t j = 0; j < changed.size(); j++) {
+      statements.push_back(makeAssignment(
+          parameters[changed[j]]->identifier->name, std::move(values[j])));
+    }
+    statements.push_back(
+        std::make_unique<ast::ContinueStatement>(at.start, at.end));
+    return std::make_unique<ast::BlockStatement>(at.start, at.end,
+                                                 std::move(statements));
+  }
+
+  /**
+   * @brief Rewrites the tail calls of a statement list and the blocks
+   * nested in it.
+   * @param statements The list.
+   * @param looping Whether the list is inside a loop or switch.
+   */
+  void rewrite(StatementList &statements, bool looping) {
+    for (auto &statement : statements) {
+      if (!statement) {
+        continue;
+      }
+      if (!looping) {
+        if (auto *call = this->tailCall(*statement)) {
+          statement = this->jump(*call, *statement);
+          this->calls_++;
+          continue;
+        }
+      }
+      bool nested = looping ||
+                    statement->tag() == ast::NodeTag::WhileConditional ||
+                    statement->tag() == ast::NodeTag::ForConditional ||
+                    statement->tag() == ast::NodeTag::SwitchConditional;
+      forEachBlock(*statement, [this, nested](ast::BlockStatement &block) {
+        this->rewrite(block.statements, nested);
+      });
+    }
+  }
+
+public:
+  TailCallRewriter(ast::FunctionDeclaration &function, NameGenerator &names)
+      : function_(function), names_(names) {}
+
+  /**
+   * @brief Rewrites the function.
+   * @return The number of tail calls replaced.
+   */
+  size_t run() {
+    auto &body = *this->function_.body;
+    this->rewrite(body.statements, false);
+    if (this->calls_ == 0) {
+      return 0;
+    }
+
+    // Wrap the body in the loop the jumps continue.
+    StatementList statements = std::move(body.statements);
+    if (statements.empty() || !ast::terminates(statements.back().get())) {
+      statements.push_back(
+          std::make_unique<ast::BreakStatement>(body.end, body.end));
+    }
+    auto loop = std::make_unique<ast::WhileConditional>(
+        body.start, body.end,
+        std::make_unique<ast::LiteralExpression>(body.start, body.start,
+                                                 "true"),
+        std::make_unique<ast::BlockStatement>(body.start, body.end,
+                                              std::move(statements)));
+    body.statements.clear();
+    body.statements.push_back(std::move(loop));
+    return this->calls_;
+  }
+};
+
+} // namespace
+
+TailCallStatistics eliminateTailCalls(ast::Program &program) {
+  TailCallStatistics statistics;
+  NameGenerator names(program);
+
+  std::unordered_map<std::string, size_t> overloads;
+  for (const auto &statement : program.statements) {
+    if (statement && statement->tag() == ast::NodeTag::FunctionDeclaration) {
+      auto &function = static_cast<ast::FunctionDeclaration &>(*statement);
+      if (function.identifier) {
+        overloads[function.identifier->name]++;
+      }
+    }
+  }
+
+  for (auto &statement : program.statements) {
+    if (!statement || statement->tag() != ast::NodeTag::FunctionDeclaration) {
+      continue;
+    }
+    auto &function = static_cast<ast::FunctionDeclaration &>(*statement);
+    if (!isEligible(function) ||
+        overloads[function.identifier->name] != 1) {
+      continue;
+    }
+    size_t calls = TailCallRewriter(function, names).run();
+    if (calls > 0) {
+      statistics.functions++;
+      statistics.calls += calls;
+    }
+  }
+  return statistics;
+}
+
+} // namespace ml::opt
@@ -47,16 +47,29 @@ bool Parser::isEof() const {
 
 const ml::lexer::Token *Parser::expectToken(const ml::lexer::TokenKind kind,
                                             const std::string &message) {
-  if (auto *tok = this->peek(); tok->kind != kind || this->isEof()) {
+  if (this->isEof()) {
+    basic::Error err(basic::ErrorLevel::Error, "Unexpected end of input",
+                     "Expected token of kind: '" +
+                         ml::lexer::tokenKindName(kind) + "' " + message,
+                     basic::Locus(1, 1), basic::Locus(1, 1), this->file_,
+                     this->lexer_.source(), 0);
+    err.log();
+    this->errors_++;
+    // Hand out the end-of-input token so callers can keep building nodes.
+    return this->tokens_.back().get();
+  }
+
+  if (auto *tok = this->peek(); tok->kind != kind) {
     basic::Error err(basic::ErrorLevel::Error,
                      "Unexpected token: '" +
                          ml::lexer::tokenKindName(tok->kind) + "'",
                      "Expected token of kind: '" +
                          ml::lexer::tokenKindName(kind) + "' " + message,
                      tok ? tok->start : basic::Locus(0, 0),
-                     tok ? tok->end : basic::Locus(0, 0), "<input>",
+                     tok ? tok->end : basic::Locus(0, 0), this->file_,
                      this->lexer_.source(), 0);
     err.log();
+    this->errors_++;
   }
   return this->advance();
 }
@@ -66,10 +79,12 @@ const ml::lexer::Token *Parser::expectValue(const std::string &value,
   if (this->isEof()) {
     basic::Error err(basic::ErrorLevel::Error, "Unexpected end of input",
                      "Expected value: '" + value + "' " + message,
-                     basic::Locus(1, 1), basic::Locus(1, 1), "<input>",
+                     basic::Locus(1, 1), basic::Locus(1, 1), this->file_,
                      this->lexer_.source(), 0);
     err.log();
-    return nullptr;
+    this->errors_++;
+    // Hand out the end-of-input token so callers can keep building nodes.
+    return this->tokens_.back().get();
   }
 
   const auto *tok = this->peek();
@@ -78,9 +93,10 @@ const ml::lexer::Token *Parser::expectValue(const std::string &value,
                      "Unexpected value: '" + (tok ? tok->value : "null") + "'",
                      "Expected value: '" + value + "' " + message,
                      tok ? tok->start : basic::Locus(1, 1),
-                     tok ? tok->end : basic::Locus(1, 1), "<input>",
+                     tok ? tok->end : basic::Locus(1, 1), this->file_,
                      this->lexer_.source(), 0);
     err.log();
+    this->errors_++;
   }
   return this->advance();
 }
@@ -170,6 +186,10 @@ std::unique_ptr<ml::ast::ReturnStatement> Parser::parseReturn() {
   }
   auto expr = this->parseExpression();
   this->expectValue(";", "after return expression");
+  if (!expr) {
+    return std::make_unique<ml::ast::ReturnStatement>(
+        returnToken->start, returnToken->end, nullptr);
+  }
   return std::make_unique<ml::ast::ReturnStatement>(returnToken->start,
                                                     expr->end, std::move(expr));
 }
@@ -204,15 +224,15 @@ std::unique_ptr<ml::ast::BlockStatement> Parser::parseBlock() {
 }
 
 std::unique_ptr<ml::ast::ModifierStatement> Parser::parseModifier() {
-  basic::Locus start = this->peek()->start;
+  basic::Locus start = this->look(0)->start;
   auto accessor = ml::basic::Accessor::Private;
-  if (basic::isacc(this->peek()->value)) {
+  if (basic::isacc(this->look(0)->value)) {
     auto accToken = this->advance();
     accessor = basic::getacc(accToken->value);
   }
   auto modifier = ml::basic::Modifier::None;
   basic::Locus end = start;
-  while (basic::ismod(this->peek()->value)) {
+  while (basic::ismod(this->look(0)->value)) {
     auto modToken = this->advance();
     modifier |= basic::getmod(modToken->value);
     end = modToken->end;
@@ -419,8 +439,8 @@ std::unique_ptr<ml::ast::FunctionDeclaration> Parser::parseFunction() {
 
   return std::make_unique<ml::ast::FunctionDeclaration>(
       identifier->start, body->end, std::move(identifier),
-      std::move(typeIdentifier), std::move(modifier), std::move(parameters),
-      std::move(body));
+      type ? std::move(type) : std::move(typeIdentifier), std::move(modifier),
+      std::move(parameters), std::move(body));
 }
 
 std::unique_ptr<ml::ast::RecordDeclaration> Parser::parseRecord() {
@@ -493,8 +513,9 @@ std::unique_ptr<ml::ast::ClassDeclaration> Parser::parseClass() {
 }
 
 std::unique_ptr<ml::ast::IfConditional> Parser::parseIf() {
-  this->expectValue("if", "to start if conditional");
+  auto *ifToken = this->expectValue("if", "to start if conditional");
   auto condition = this->parseExpression();
+  basic::Locus start = condition ? condition->start : ifToken->start;
   auto thenBranch = this->parseBlock();
 
   std::vector<std::unique_ptr<ml::ast::IfConditional>> elifBranches = {};
@@ -503,7 +524,8 @@ std::unique_ptr<ml::ast::IfConditional> Parser::parseIf() {
       auto elifCondition = this->parseExpression();
       auto elifThenBranch = this->parseBlock();
       elifBranches.push_back(std::make_unique<ml::ast::IfConditional>(
-          elifCondition->start, elifThenBranch->end, std::move(elifCondition),
+          elifCondition ? elifCondition->start : elifThenBranch->start,
+          elifThenBranch->end, std::move(elifCondition),
           std::move(elifThenBranch),
           std::vector<std::unique_ptr<ml::ast::IfConditional>>{}, nullptr));
     } while (this->matchValue("elif"));
@@ -512,8 +534,7 @@ std::unique_ptr<ml::ast::IfConditional> Parser::parseIf() {
       elseBranch = this->parseBlock();
     }
     return std::make_unique<ml::ast::IfConditional>(
-        condition->start,
-        elseBranch ? elseBranch->end : elifBranches.back()->end,
+        start, elseBranch ? elseBranch->end : elifBranches.back()->end,
         std::move(condition), std::move(thenBranch), std::move(elifBranches),
         std::move(elseBranch));
   }
@@ -524,13 +545,14 @@ std::unique_ptr<ml::ast::IfConditional> Parser::parseIf() {
   }
 
   return std::make_unique<ml::ast::IfConditional>(
-      condition->start, elseBranch ? elseBranch->end : thenBranch->end,
+      start, elseBranch ? elseBranch->end : thenBranch->end,
       std::move(condition), std::move(thenBranch), std::move(elifBranches),
       std::move(elseBranch));
 }
 
 std::unique_ptr<ml::ast::SwitchConditional> Parser::parseSwitch() {
-  this->expectValue("switch", "to start switch conditional");
+  auto *switchToken =
+      this->expectValue("switch", "to start switch conditional");
   auto switchExpression = this->parseExpression();
   this->expectValue("{", "after switch expression in switch conditional");
   std::vector<std::unique_ptr<ml::ast::Conditional>> cases;
@@ -546,25 +568,27 @@ std::unique_ptr<ml::ast::SwitchConditional> Parser::parseSwitch() {
     auto caseExpression = this->parseExpression();
     auto caseBlock = this->parseBlock();
     cases.push_back(std::make_unique<ml::ast::Conditional>(
-        caseExpression->start, caseBlock->end, std::move(caseExpression),
-        std::move(caseBlock)));
+        caseExpression ? caseExpression->start : caseBlock->start,
+        caseBlock->end, std::move(caseExpression), std::move(caseBlock)));
   }
-  this->expectValue("}", "to end switch conditional");
+  auto *rightBrace = this->expectValue("}", "to end switch conditional");
   return std::make_unique<ml::ast::SwitchConditional>(
-      switchExpression->start, cases.back()->end, std::move(switchExpression),
-      std::move(cases));
+      switchExpression ? switchExpression->start : switchToken->start,
+      cases.empty() ? rightBrace->end : cases.back()->end,
+      std::move(switchExpression), std::move(cases));
 }
 
 std::unique_ptr<ml::ast::WhileConditional> Parser::parseWhile() {
-  this->expectValue("while", "to start while conditional");
+  auto *whileToken = this->expectValue("while", "to start while conditional");
   auto condition = this->parseExpression();
   auto body = this->parseBlock();
   return std::make_unique<ml::ast::WhileConditional>(
-      condition->start, body->end, std::move(condition), std::move(body));
+      condition ? condition->start : whileToken->start, body->end,
+      std::move(condition), std::move(body));
 }
 
 std::unique_ptr<ml::ast::ForConditional> Parser::parseFor() {
-  this->expectValue("for", "to start for conditional");
+  auto *forToken = this->expectValue("for", "to start for conditional");
   this->expectValue("(", "after 'for' in for conditional");
 
   if (this->checkValue("let")) {
@@ -584,7 +608,7 @@ std::unique_ptr<ml::ast::ForConditional> Parser::parseFor() {
         initializer->start, body->end, std::move(initializer),
         std::move(condition), std::move(increment), std::move(body));
   } else {
-    if (this->checkToken(ml::lexer::TokenKind::Identifier) &&
+    if (this->checkToken(ml::lexer::TokenKind::Identifier) && this->look(3) &&
         (this->look(1)->value == "in" ||
          (this->look(1)->value == ":" &&
           this->look(2)->kind == ml::lexer::TokenKind::Identifier &&
@@ -602,8 +626,8 @@ std::unique_ptr<ml::ast::ForConditional> Parser::parseFor() {
       this->expectValue(")", "after for-range condition");
       auto body = this->parseBlock();
       return std::make_unique<ml::ast::ForConditional>(
-          condition->start, body->end, nullptr, std::move(condition), nullptr,
-          std::move(body));
+          condition ? condition->start : forToken->start, body->end, nullptr,
+          std::move(condition), nullptr, std::move(body));
     }
   }
 }
@@ -614,8 +638,11 @@ std::unique_ptr<ml::ast::Expression> Parser::parseExpression() {
 
 std::unique_ptr<ml::ast::Expression> Parser::parseAssignment() {
   auto expr = this->parseLogicalOr();
-  if (this->matchValue("=")) {
+  if (expr && this->matchValue("=")) {
     auto right = this->parseExpression();
+    if (!right) {
+      return expr;
+    }
     return std::make_unique<ml::ast::BinaryExpression>(
         expr->start, right->end, std::move(expr), "=", std::move(right));
   }
@@ -624,9 +651,15 @@ std::unique_ptr<ml::ast::Expression> Parser::parseAssignment() {
 
 std::unique_ptr<ml::ast::Expression> Parser::parseLogicalOr() {
   auto expr = this->parseLogicalAnd();
+  if (!expr) {
+    return nullptr;
+  }
   while (this->matchValue("||")) {
     auto opToken = this->tokens_[this->index_ - 1].get();
     auto right = this->parseLogicalAnd();
+    if (!right) {
+      break;
+    }
     expr = std::make_unique<ml::ast::BinaryExpression>(
         expr->start, right->end, std::move(expr), opToken->value,
         std::move(right));
@@ -636,9 +669,15 @@ std::unique_ptr<ml::ast::Expression> Parser::parseLogicalOr() {
 
 std::unique_ptr<ml::ast::Expression> Parser::parseLogicalAnd() {
   auto expr = this->parseEquality();
+  if (!expr) {
+    return nullptr;
+  }
   while (this->matchValue("&&")) {
     auto opToken = this->tokens_[this->index_ - 1].get();
     auto right = this->parseEquality();
+    if (!right) {
+      break;
+    }
     expr = std::make_unique<ml::ast::BinaryExpression>(
         expr->start, right->end, std::move(expr), opToken->value,
         std::move(right));
@@ -648,9 +687,15 @@ std::unique_ptr<ml::ast::Expression> Parser::parseLogicalAnd() {
 
 std::unique_ptr<ml::ast::Expression> Parser::parseEquality() {
   auto expr = this->parseComparison();
+  if (!expr) {
+    return nullptr;
+  }
   while (this->matchValue("==") || this->matchValue("!=")) {
     auto opToken = this->tokens_[this->index_ - 1].get();
     auto right = this->parseComparison();
+    if (!right) {
+      break;
+    }
     expr = std::make_unique<ml::ast::BinaryExpression>(
         expr->start, right->end, std::move(expr), opToken->value,
         std::move(right));
@@ -660,11 +705,17 @@ std::unique_ptr<ml::ast::Expression> Parser::parseEquality() {
 
 std::unique_ptr<ml::ast::Expression> Parser::parseComparison() {
   auto expr = this->parseTerm();
+  if (!expr) {
+    return nullptr;
+  }
   while (this->matchValue("<") || this->matchValue(">") ||
          this->matchValue("<=") || this->matchValue(">=") ||
          this->matchValue("..") || this->matchValue(".=")) {
     auto opToken = this->tokens_[this->index_ - 1].get();
     auto right = this->parseTerm();
+    if (!right) {
+      break;
+    }
     expr = std::make_unique<ml::ast::BinaryExpression>(
         expr->start, right->end, std::move(expr), opToken->value,
         std::move(right));
@@ -674,9 +725,15 @@ std::unique_ptr<ml::ast::Expression> Parser::parseComparison() {
 
 std::unique_ptr<ml::ast::Expression> Parser::parseTerm() {
   auto expr = this->parseFactor();
+  if (!expr) {
+    return nullptr;
+  }
   while (this->matchValue("+") || this->matchValue("-")) {
     auto opToken = this->tokens_[this->index_ - 1].get();
     auto right = this->parseFactor();
+    if (!right) {
+      break;
+    }
     expr = std::make_unique<ml::ast::BinaryExpression>(
         expr->start, right->end, std::move(expr), opToken->value,
         std::move(right));
@@ -686,10 +743,16 @@ std::unique_ptr<ml::ast::Expression> Parser::parseTerm() {
 
 std::unique_ptr<ml::ast::Expression> Parser::parseFactor() {
   auto expr = this->parseUnary();
+  if (!expr) {
+    return nullptr;
+  }
   while (this->matchValue("*") || this->matchValue("/") ||
          this->matchValue("%")) {
     auto opToken = this->tokens_[this->index_ - 1].get();
     auto right = this->parseUnary();
+    if (!right) {
+      break;
+    }
     expr = std::make_unique<ml::ast::BinaryExpression>(
         expr->start, right->end, std::move(expr), opToken->value,
         std::move(right));
@@ -698,9 +761,39 @@ std::unique_ptr<ml::ast::Expression> Parser::parseFactor() {
 }
 
 std::unique_ptr<ml::ast::Expression> Parser::parseUnary() {
+  if (this->matchValue("spawn")) {
+    auto spawnToken = this->tokens_[this->index_ - 1].get();
+    auto call = this->parsePostfix();
+    if (!call) {
+      return nullptr;
+    }
+    if (call->tag() != ml::ast::NodeTag::CallExpression) {
+      basic::Error err(basic::ErrorLevel::Error,
+                       "Expected a call after 'spawn'",
+                       "A task runs a function call, as in 'spawn f(x)'",
+                       call->start, call->end, this->file_,
+                       this->lexer_.source(), 0);
+      err.log();
+      this->errors_++;
+    }
+    return std::make_unique<ml::ast::SpawnExpression>(
+        spawnToken->start, call->end, std::move(call));
+  }
+  if (this->matchValue("await")) {
+    auto awaitToken = this->tokens_[this->index_ - 1].get();
+    auto task = this->parseUnary();
+    if (!task) {
+      return nullptr;
+    }
+    return std::make_unique<ml::ast::AwaitExpression>(
+        awaitToken->start, task->end, std::move(task));
+  }
   if (this->matchValue("!") || this->matchValue("-")) {
     auto opToken = this->tokens_[this->index_ - 1].get();
     auto right = this->parseUnary();
+    if (!right) {
+      return nullptr;
+    }
     return std::make_unique<ml::ast::UnaryExpression>(
         opToken->start, right->end, opToken->value, std::move(right));
   }
@@ -709,6 +802,9 @@ std::unique_ptr<ml::ast::Expression> Parser::parseUnary() {
 
 std::unique_ptr<ml::ast::Expression> Parser::parsePostfix() {
   auto expr = this->parsePrimary();
+  if (!expr) {
+    return nullptr;
+  }
 
   while (true) {
     if (this->matchValue("(")) {
@@ -729,11 +825,17 @@ std::unique_ptr<ml::ast::Expression> Parser::parsePostfix() {
           expr->start, opToken->end, opToken->value, std::move(expr));
     } else if (this->matchValue(".")) {
       auto attribute = this->parseExpression();
+      if (!attribute) {
+        break;
+      }
       expr = std::make_unique<ml::ast::AttributeExpression>(
           expr->start, attribute->end, std::move(expr), std::move(attribute));
     } else if (this->matchValue("[")) {
       auto index = this->parseExpression();
       this->expectValue("]", "after index expression");
+      if (!index) {
+        break;
+      }
       expr = std::make_unique<ml::ast::IndexExpression>(
           expr->start, index->end, std::move(expr), std::move(index));
     } else {
@@ -763,7 +865,7 @@ std::unique_ptr<ml::ast::Expression> Parser::parsePrimary() {
       this->matchToken(ml::lexer::TokenKind::Float)) {
     auto *token = this->tokens_[this->index_ - 1].get();
     return std::make_unique<ml::ast::LiteralExpression>(
-        token->start, token->end, token->value);
+        token->start, token->end, token->value, token->number);
   }
   if (this->matchToken(ml::lexer::TokenKind::String)) {
     auto *token = this->tokens_[this->index_ - 1].get();
@@ -806,8 +908,9 @@ std::unique_ptr<ml::ast::Expression> Parser::parsePrimary() {
                    "Expected primary expression",
                    this->peek() ? this->peek()->start : basic::Locus(0, 0),
                    this->peek() ? this->peek()->end : basic::Locus(0, 0),
-                   "<input>", this->lexer_.source(), 0);
+                   this->file_, this->lexer_.source(), 0);
   err.log();
+  this->errors_++;
 
   this->advance();
   return nullptr;
@@ -815,12 +918,11 @@ std::unique_ptr<ml::ast::Expression> Parser::parsePrimary() {
 
 std::unique_ptr<ml::ast::Program> Parser::parse(const std::string &source) {
   this->lexer_ = ml::lexer::Lexer(source);
+  this->lexer_.setFile(this->file_);
+  this->lexer_.keepTrivia(this->keep_trivia_);
   this->tokens_ = this->lexer_.lex(source);
   this->index_ = 0;
-
-  for (const auto &token : this->tokens_) {
-    std::cout << (std::string)*token << std::endl;
-  }
+  this->errors_ = 0;
 
   auto result = this->parseProgram();
   return result;
@@ -0,0 +1,835 @@
+#include "ml/analysis/lint.h"
+#include "ml/analysis/pass.h"
+#include "ml/analysis/search.h"
+#include "ml/analysis/semantic_tokens.h"
+#include "ml/analysis/symbol_index.h"
+#include "ml/ast/image.h"
+#include "ml/basic/hash.h"
+#include "ml/parser/parser.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace ml::analysis;
+
+class SymbolIndexTest : public ::testing::Test {
+protected:
+  std::filesystem::path root_;
+
+  void SetUp() override {
+    root_ = std::filesystem::temp_directory_path() /
+            ("ml_index_test_" +
+             std::string(
+                 ::testing::UnitTest::GetInstance()->current_test_info()->name()));
+    std::filesystem::remove_all(root_);
+    std::filesystem::create_directories(root_);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(root_); }
+
+  // Helper function to write a source file below the test directory
+  std::string writeSource(const std::string &name, const std::string &source) {
+    auto path = root_ / name;
+    std::ofstream(path) << source;
+    return path.generic_string();
+  }
+
+  // Helper function to extract the symbols of a source string
+  std::vector<SymbolOccurrence> extract(const std::string &source) {
+    ml::parser::Parser parser;
+    auto program = parser.parse(source);
+    EXPECT_NE(program, nullptr);
+    return program ? extractSymbols(*program) : std::vector<SymbolOccurrence>{};
+  }
+
+  std::string indexPath() const { return (root_ / "symbols.idx").string(); }
+};
+
+TEST_F(SymbolIndexTest, ExtractsDefinitionKinds) {
+  auto symbols = extract(R"(
+    rec Point { let x: float; }
+    cls Shape { let area: float; fn grow(by: float) { let t: float = by; } }
+    let origin: Point;
+    fn main() { grow(1); }
+  )");
+
+  auto kindOf = [&symbols](const std::string &name) {
+    for (const auto &symbol : symbols) {
+      if (symbol.name == name && symbol.definition) {
+        return symbol.kind;
+      }
+    }
+    return SymbolKind::Unknown;
+  };
+  EXPECT_EQ(kindOf("Point"), SymbolKind::Record);
+  EXPECT_EQ(kindOf("x"), SymbolKind::Field);
+  EXPECT_EQ(kindOf("Shape"), SymbolKind::Class);
+  EXPECT_EQ(kindOf("area"), SymbolKind::Field);
+  EXPECT_EQ(kindOf("grow"), SymbolKind::Method);
+  EXPECT_EQ(kindOf("origin"), SymbolKind::Variable);
+  EXPECT_EQ(kindOf("main"), SymbolKind::Function);
+  // Locals and parameters are not definitions.
+  EXPECT_EQ(kindOf("t"), SymbolKind::Unknown);
+  EXPECT_EQ(kindOf("by"), SymbolKind::Unknown);
+}
+
+TEST_F(SymbolIndexTest, LookupReturnsDefinitionsFirst) {
+  std::vector<IndexedFile> files;
+  files.push_back({"b.ml", 2, extract("fn helper() { }")});
+  files.push_back({"a.ml", 1, extract("fn main() { helper(); helper(); }")});
+  ASSERT_TRUE(writeSymbolIndex(indexPath(), files));
+
+  SymbolIndex index;
+  ASSERT_TRUE(index.open(indexPath()));
+  EXPECT_EQ(index.fileCount(), 2);
+
+  auto locations = index.lookup("helper");
+  ASSERT_EQ(locations.size(), 3);
+  EXPECT_TRUE(locations[0].definition);
+  EXPECT_EQ(locations[0].path, "b.ml");
+  EXPECT_EQ(locations[0].kind, SymbolKind::Function);
+  EXPECT_EQ(locations[0].line, 1);
+  EXPECT_EQ(locations[0].column, 4);
+  EXPECT_FALSE(locations[1].definition);
+  EXPECT_EQ(locations[1].path, "a.ml");
+
+  EXPECT_TRUE(index.lookup("missing").empty());
+}
+
+TEST_F(SymbolIndexTest, RoundTripsFiles) {
+  std::vector<IndexedFile> files;
+  files.push_back({"a.ml", 42, extract("let count: int = 1;")});
+  ASSERT_TRUE(writeSymbolIndex(indexPath(), files));
+
+  SymbolIndex index;
+  ASSERT_TRUE(index.open(indexPath()));
+  auto loaded = index.files();
+  ASSERT_EQ(loaded.size(), 1);
+  EXPECT_EQ(loaded[0].path, "a.ml");
+  EXPECT_EQ(loaded[0].hash, 42);
+  EXPECT_EQ(loaded[0].occurrences.size(), files[0].occurrences.size());
+}
+
+TEST_F(SymbolIndexTest, RejectsInvalidFile) {
+  std::ofstream(indexPath()) << "not an index";
+  SymbolIndex index;
+  EXPECT_FALSE(index.open(indexPath()));
+  EXPECT_EQ(index.symbolCount(), 0);
+}
+
+TEST_F(SymbolIndexTest, RejectsDamagedFile) {
+  std::vector<IndexedFile> files;
+  files.push_back({"a.ml", 1, extract("fn main() { main(); }")});
+  ASSERT_TRUE(writeSymbolIndex(indexPath(), files));
+  std::string image;
+  {
+    std::ifstream stream(indexPath(), std::ios::binary);
+    image.assign(std::istreambuf_iterator<char>(stream), {});
+  }
+
+  // Header fields: counts at 12, 16 and 20, section offsets from 24.
+  auto damaged = [&](size_t offset, uint32_t value) {
+    std::string copy = image;
+    std::memcpy(&copy[offset], &value, sizeof(value));
+    std::ofstream(indexPath(), std::ios::binary | std::ios::trunc) << copy;
+    SymbolIndex index;
+    return !index.open(indexPath());
+  };
+  EXPECT_TRUE(damaged(16, 0xffffff));   // symbol_count
+  EXPECT_TRUE(damaged(20, 0xffffff));   // occurrence_count
+  EXPECT_TRUE(damaged(12, 0));          // file_count, below the references
+  EXPECT_TRUE(damaged(32, 0x7ffffff8)); // symbols_offset
+  EXPECT_TRUE(damaged(32, 4));          // symbols_offset, misaligned
+
+  // The first symbol record: name and occurrence range.
+  uint64_t symbols_offset;
+  std::memcpy(&symbols_offset, &image[32], sizeof(symbols_offset));
+  EXPECT_TRUE(damaged(symbols_offset, 0xfffffff0));  // name_offset
+  EXPECT_TRUE(damaged(symbols_offset + 12, 0xffff)); // occurrence_count
+  EXPECT_FALSE(damaged(8, 1)); // version, unchanged
+}
+
+TEST_F(SymbolIndexTest, ReportsWriteFailure) {
+  auto a = writeSource("a.ml", "fn alpha() { }");
+  // A directory where the index should be cannot be replaced by a file.
+  std::filesystem::create_directories(indexPath());
+  auto summary = updateSymbolIndex(indexPath(), {a}, 1);
+  EXPECT_FALSE(summary.written);
+  EXPECT_EQ(summary.symbols, 0);
+}
+
+TEST_F(SymbolIndexTest, ReusesUnchangedFiles) {
+  auto a = writeSource("a.ml", "fn alpha() { }");
+  auto b = writeSource("b.ml", "fn beta() { alpha(); }");
+
+  auto first = updateSymbolIndex(indexPath(), {a, b}, 2);
+  EXPECT_TRUE(first.written);
+  EXPECT_EQ(first.files, 2);
+  EXPECT_EQ(first.reused, 0);
+
+  writeSource("b.ml", "fn gamma() { alpha(); }");
+  auto second = updateSymbolIndex(indexPath(), {a, b}, 2);
+  EXPECT_EQ(second.reused, 1);
+
+  SymbolIndex index;
+  ASSERT_TRUE(index.open(indexPath()));
+  EXPECT_TRUE(index.lookup("beta").empty());
+  EXPECT_EQ(index.lookup("gamma").size(), 1);
+  EXPECT_EQ(index.lookup("alpha").size(), 2);
+}
+
+// Counts the function declarations of a program
+class FunctionCounter : public Pass {
+public:
+  size_t functions = 0;
+  bool finished = false;
+
+  std::string name() const override { return "function-counter"; }
+
+  void attach(PassManager &manager) override {
+    manager.onEnter<ml::ast::FunctionDeclaration>(
+        [this](const ml::ast::FunctionDeclaration &) { functions++; });
+  }
+
+  void finish() override { finished = true; }
+};
+
+// Records the names of call targets and the depth of every node
+class CallCollector : public Pass {
+private:
+  PassManager *manager_ = nullptr;
+
+public:
+  std::vector<std::string> callees;
+  size_t nodes = 0;
+  size_t deepest = 0;
+
+  std::string name() const override { return "call-collector"; }
+
+  void attach(PassManager &manager) override {
+    manager_ = &manager;
+    manager.onEnter<ml::ast::CallExpression>(
+        [this](const ml::ast::CallExpression &call) {
+          auto *callee = dynamic_cast<const ml::ast::IdentifierExpression *>(
+              call.callee.get());
+          if (callee) {
+            callees.push_back(callee->name);
+          }
+        });
+    manager.onEnter<ml::ast::Node>([this](const ml::ast::Node &) {
+      nodes++;
+      deepest = std::max(deepest, manager_->ancestors().size());
+    });
+  }
+};
+
+TEST(PassManagerTest, RunsFusedPassesInOneTraversal) {
+  ml::parser::Parser parser;
+  auto program = parser.parse(
+      "fn a() { b(); } fn b() { if x { c(1); } } let y: int = a();");
+  ASSERT_NE(program, nullptr);
+
+  PassManager manager;
+  auto &counter = manager.emplace<FunctionCounter>();
+  auto &collector = manager.emplace<CallCollector>();
+  manager.run(*program);
+
+  size_t walked = 0;
+  ml::ast::walk(static_cast<const ml::ast::Node &>(*program),
+                [&walked](const ml::ast::Node &) { return ++walked > 0; });
+
+  EXPECT_EQ(counter.functions, 2);
+  EXPECT_TRUE(counter.finished);
+  EXPECT_EQ(collector.callees, (std::vector<std::string>{"b", "c", "a"}));
+  EXPECT_EQ(collector.nodes, walked);
+  EXPECT_EQ(manager.visited(), walked);
+  EXPECT_GE(collector.deepest, 4);
+  EXPECT_EQ(manager.parent(), nullptr);
+}
+
+TEST(PassManagerTest, LeaveRunsAfterChildren) {
+  ml::parser::Parser parser;
+  auto program = parser.parse("let x: int = 1 + 2;");
+  ASSERT_NE(program, nullptr);
+
+  std::vector<ml::ast::NodeTag> order;
+  PassManager manager;
+  manager.onLeave<ml::ast::LiteralExpression>(
+      [&order](const ml::ast::Node &v) { order.push_back(v.tag()); });
+  manager.onLeave<ml::ast::BinaryExpression>(
+      [&order](const ml::ast::Node &v) { order.push_back(v.tag()); });
+  manager.run(*program);
+
+  EXPECT_EQ(order, (std::vector<ml::ast::NodeTag>{
+                       ml::ast::NodeTag::LiteralExpression,
+                       ml::ast::NodeTag::LiteralExpression,
+                       ml::ast::NodeTag::BinaryExpression}));
+}
+
+TEST(PassManagerTest, LeaveRunsInReverseOrder) {
+  ml::parser::Parser parser;
+  auto program = parser.parse("x;");
+  ASSERT_NE(program, nullptr);
+
+  std::vector<int> order;
+  PassManager manager;
+  for (int i = 0; i < 2; i++) {
+    manager.onEnter<ml::ast::Program>(
+        [&order, i](const ml::ast::Program &) { order.push_back(i); });
+    manager.onLeave<ml::ast::Program>(
+        [&order, i](const ml::ast::Program &) { order.push_back(10 + i); });
+  }
+  manager.run(*program);
+
+  EXPECT_EQ(order, (std::vector<int>{0, 1, 11, 10}));
+}
+
+TEST(PassManagerTest, TimesEachPass) {
+  ml::parser::Parser parser;
+  auto program = parser.parse("fn a() { b(); } fn b() { c(1); }");
+  ASSERT_NE(program, nullptr);
+
+  PassManager manager;
+  manager.emplace<FunctionCounter>();
+  manager.emplace<CallCollector>();
+  manager.run(*program);
+  EXPECT_EQ(manager.time(0), PassManager::Duration::zero());
+
+  manager.setTimed(true);
+  manager.run(*program);
+  EXPECT_GT(manager.time(0), PassManager::Duration::zero());
+  EXPECT_GT(manager.time(1), PassManager::Duration::zero());
+  EXPECT_EQ(manager.time(2), PassManager::Duration::zero());
+}
+
+// Helper function to lint a source string with some rules
+std::vector<LintDiagnostic> lintSource(const std::string &source,
+                                       std::vector<std::string> rules = {}) {
+  ml::parser::Parser parser;
+  auto program = parser.parse(source);
+  EXPECT_NE(program, nullptr);
+  EXPECT_EQ(parser.errors(), 0u);
+  LintOptions options;
+  options.rules = std::move(rules);
+  return program ? lint(*program, options) : std::vector<LintDiagnostic>{};
+}
+
+// Helper function to get the rule and line of every finding
+std::vector<std::pair<std::string, uint64_t>>
+findings(const std::vector<LintDiagnostic> &diagnostics) {
+  std::vector<std::pair<std::string, uint64_t>> out;
+  for (const auto &diagnostic : diagnostics) {
+    out.emplace_back(diagnostic.rule, diagnostic.start.line);
+  }
+  return out;
+}
+
+using Findings = std::vector<std::pair<std::string, uint64_t>>;
+
+TEST(LintTest, FindsUnusedVariables) {
+  auto diagnostics = lintSource("let global = 1;\n"
+                                "fn f(unused: i32) {\n"
+                                "  let a = 1;\n"
+                                "  let b = 2;\n"
+                                "  let _c = 3;\n"
+                                "  let d = d;\n"
+                                "  outputln(b);\n"
+                                "  this.a = 1;\n"
+                                "}",
+                                {"unused-variable"});
+  EXPECT_EQ(findings(diagnostics),
+            (Findings{{"unused-variable", 3}, {"unused-variable", 6}}));
+  EXPECT_EQ(diagnostics[0].level, ml::basic::ErrorLevel::Warning);
+}
+
+TEST(LintTest, FindsShadowing) {
+  auto diagnostics = lintSource("let x = 1;\n"
+                                "fn f(x: i32) {\n"
+                                "  let y = x;\n"
+                                "  { let y = 2; }\n"
+                                "  let y = 3;\n"
+                                "}\n"
+                                "rec P { let x: i32; }",
+                                {"shadowing"});
+  EXPECT_EQ(findings(diagnostics), (Findings{{"shadowing", 2},
+                                             {"shadowing", 4},
+                                             {"shadowing", 5}}));
+  EXPECT_NE(diagnostics[2].desc.find("redeclares"), std::string::npos);
+}
+
+TEST(LintTest, FindsMissingReturns) {
+  auto diagnostics =
+      lintSource("fn a() i32 { if (x) { return 1; } }\n"
+                 "fn b() i32 { if (x) { return 1; } else { return 2; } }\n"
+                 "fn c() i32 { switch (x) { case 1 { return 1; } } }\n"
+                 "fn d() i32 { switch (x) { case 1 { return 1; } "
+                 "default { return 2; } } }\n"
+                 "fn e() i32 { while (true) { return 1; } }\n"
+                 "fn f() i32 { while (true) { break; } }\n"
+                 "fn g() { }\n"
+                 "cls C { fn init() { } }",
+                 {"missing-return"});
+  EXPECT_EQ(findings(diagnostics), (Findings{{"missing-return", 1},
+                                             {"missing-return", 3},
+                                             {"missing-return", 6}}));
+}
+
+TEST(LintTest, FindsConstReassignments) {
+  auto diagnostics = lintSource("let const limit = 10;\n"
+                                "let count = 0;\n"
+                                "limit = 1;\n"
+                                "limit++;\n"
+                                "count = limit;\n"
+                                "fn f(limit: i32) { limit = 2; }\n"
+                                "this.limit = 3;",
+                                {"const-reassignment"});
+  EXPECT_EQ(findings(diagnostics), (Findings{{"const-reassignment", 3},
+                                             {"const-reassignment", 4}}));
+  EXPECT_EQ(diagnostics[0].level, ml::basic::ErrorLevel::Error);
+}
+
+TEST(LintTest, FindsEmptyBlocks) {
+  auto diagnostics = lintSource("fn f() {}\n"
+                                "if (x) {} else { y(); }\n"
+                                "while (x) { }",
+                                {"empty-block"});
+  EXPECT_EQ(findings(diagnostics),
+            (Findings{{"empty-block", 2}, {"empty-block", 3}}));
+}
+
+TEST(LintTest, RunsEveryRuleInLocationOrder) {
+  auto diagnostics = lintSource("fn f() i32 {\n"
+                                "  let a = 1;\n"
+                                "  if (a) {}\n"
+                                "}");
+  EXPECT_EQ(findings(diagnostics),
+            (Findings{{"missing-return", 1}, {"empty-block", 3}}));
+  EXPECT_EQ(lintRules().size(), 5u);
+}
+
+TEST(LintTest, LintsFilesInParallelWithTimings) {
+  auto root = std::filesystem::temp_directory_path() / "ml_lint_test";
+  std::filesystem::remove_all(root);
+  std::filesystem::create_directories(root);
+  std::vector<std::string> sources;
+  for (int i = 0; i < 8; i++) {
+    auto path = root / ("file" + std::to_string(i) + ".ml");
+    std::ofstream(path) << (i % 2 == 0 ? "fn f() { let x = 1; }" : "x();");
+    sources.push_back(path.string());
+  }
+  auto invalid = root / "invalid.ml";
+  std::ofstream(invalid) << "let = ;";
+  sources.push_back(invalid.string());
+
+  LintOptions options;
+  options.timed = true;
+  auto summary = lintFiles(sources, options, 4);
+  EXPECT_EQ(summary.files, 9u);
+  EXPECT_EQ(summary.failed, 1u);
+  EXPECT_EQ(summary.diagnostics, 4u);
+  ASSERT_EQ(summary.results.size(), 4u);
+  EXPECT_EQ(summary.results[0].path, sources[0]);
+  EXPECT_EQ(summary.results[1].path, sources[2]);
+
+  // The scope resolver is timed first, followed by every rule.
+  ASSERT_EQ(summary.timings.size(), lintRules().size() + 1);
+  EXPECT_EQ(summary.timings[0].rule, "scopes");
+  EXPECT_EQ(summary.timings[1].rule, lintRules()[0]);
+  EXPECT_GT(summary.timings[0].time.count(), 0);
+  std::filesystem::remove_all(root);
+}
+
+// Helper function to find the matches of a pattern in a source string,
+// with the code bound to each metavariable
+std::vector<std::string> search(const std::string &pattern_text,
+                                const std::string &source) {
+  StructuralPattern pattern;
+  EXPECT_TRUE(pattern.parse(pattern_text)) << pattern.error();
+  ml::parser::Parser parser;
+  auto program = parser.parse(source);
+  EXPECT_NE(program, nullptr);
+
+  std::vector<std::string> out;
+  std::vector<PatternBinding> bindings;
+  for (const auto &node : ml::ast::preOrder(
+           static_cast<const ml::ast::Node &>(*program))) {
+    if (!pattern.match(node, &bindings)) {
+      continue;
+    }
+    std::string match = std::to_string(node.start.line);
+    for (const auto &binding : bindings) {
+      match += " " + binding.name + "=";
+      if (binding.first) {
+        match += source.substr(binding.first->start.index,
+                               binding.last->end.index -
+                                   binding.first->start.index);
+      }
+    }
+    out.push_back(match);
+  }
+  return out;
+}
+
+TEST(SearchTest, BindsMetavariables) {
+  EXPECT_EQ(search("$a + $b", "x = 1 + f(2);\ny = a * b;"),
+            (std::vector<std::string>{"1 a=1 b=f(2)"}));
+  EXPECT_EQ(search("$x = $x + 1", "i = i + 1;\ni = j + 1;\n"),
+            (std::vector<std::string>{"1 x=i"}));
+  EXPECT_EQ(search("f($_, 2)", "f(1, 2);\nf(1, 3);\ng(1, 2);"),
+            (std::vector<std::string>{"1"}));
+}
+
+TEST(SearchTest, MatchesLists) {
+  std::string source = "outputln();\noutputln(1, 2, 3);\nprint(1);";
+  EXPECT_EQ(search("outputln($...)", source),
+            (std::vector<std::string>{"1", "2"}));
+  EXPECT_EQ(search("outputln($first, $...rest)", source),
+            (std::vector<std::string>{"2 first=1 rest=2, 3"}));
+  EXPECT_EQ(search("outputln($...init, 3)", source),
+            (std::vector<std::string>{"2 init=1, 2"}));
+  EXPECT_EQ(search("while ($c) { $...; g(); $... }",
+                   "while (a) { f(); g(); }\nwhile (b) { f(); }"),
+            (std::vector<std::string>{"1 c=a"}));
+}
+
+TEST(SearchTest, LeftOutPartsMatchAnything) {
+  std::string source = "let a: i32 = 1;\nlet const b = 1;\nlet c = 2;\n"
+                       "fn f(x: i32) i32 { return x; }";
+  EXPECT_EQ(search("let $v = 1", source),
+            (std::vector<std::string>{"1 v=a", "2 v=b"}));
+  EXPECT_EQ(search("let const $v = $_", source),
+            (std::vector<std::string>{"2 v=b"}));
+  EXPECT_EQ(search("fn $name($...) { return $e; }", source),
+            (std::vector<std::string>{"4 name=f e=x"}));
+}
+
+TEST(SearchTest, RejectsInvalidPatterns) {
+  StructuralPattern pattern;
+  EXPECT_FALSE(pattern.parse("f($)"));
+  EXPECT_FALSE(pattern.error().empty());
+  EXPECT_FALSE(pattern.parse("f(); g();"));
+  EXPECT_TRUE(pattern.parse("f()"));
+  EXPECT_TRUE(pattern.error().empty());
+  EXPECT_EQ(pattern.rootTag(), ml::ast::NodeTag::CallExpression);
+  EXPECT_TRUE(pattern.mayMatchText("x = f();"));
+  EXPECT_FALSE(pattern.mayMatchText("x = g();"));
+}
+
+TEST(SearchTest, SearchesFilesWithImages) {
+  auto root = std::filesystem::temp_directory_path() / "ml_search_test";
+  std::filesystem::remove_all(root);
+  std::filesystem::create_directories(root);
+  auto writeSource = [&root](const std::string &name,
+                             const std::string &source) {
+    auto path = root / name;
+    std::ofstream(path) << source;
+    return path.string();
+  };
+  std::string loops = "fn main() {\n"
+                      "  while (a) { outputln(a); }\n"
+                      "  outputln(b);\n"
+                      "}";
+  std::vector<std::string> sources = {
+      writeSource("loops.ml", loops),
+      writeSource("plain.ml", "outputln(c);"),
+      writeSource("other.ml", "let x = 1;"),
+      writeSource("cached.ml", "outputln(d);"),
+      writeSource("invalid.ml", "outputln(;"),
+  };
+  // An up-to-date image without a while loop, and a stale one
+  ml::parser::Parser parser;
+  auto cached = parser.parse("outputln(d);");
+  ASSERT_TRUE(ml::ast::writeImage(sources[3] + "i", *cached,
+                                  ml::basic::fnv1a("outputln(d);")));
+  auto stale = parser.parse("let y = 2;");
+  ASSERT_TRUE(ml::ast::writeImage(sources[0] + "i", *stale, 0));
+
+  StructuralPattern pattern;
+  ASSERT_TRUE(pattern.parse("outputln($x)"));
+  auto all = searchFiles(sources, pattern, nullptr, 2);
+  EXPECT_EQ(all.files, 5u);
+  EXPECT_EQ(all.skipped, 1u);
+  EXPECT_EQ(all.cached, 1u);
+  EXPECT_EQ(all.parsed, 2u);
+  EXPECT_EQ(all.failed, 1u);
+  ASSERT_EQ(all.matches.size(), 4u);
+  EXPECT_EQ(all.matches[0].path, sources[0]);
+  EXPECT_EQ(all.matches[0].line, "  while (a) { outputln(a); }");
+  EXPECT_EQ(all.matches[0].bindings,
+            (std::vector<std::pair<std::string, std::string>>{{"x", "a"}}));
+  EXPECT_EQ(all.matches[3].path, sources[3]);
+  EXPECT_EQ(all.matches[3].bindings[0].second, "d");
+
+  // Only loops.ml has the word "while"; the image of cached.ml is rejected
+  // by its node kinds before it is materialized.
+  StructuralPattern inside;
+  ASSERT_TRUE(inside.parse("while ($c) { $... }"));
+  std::ofstream(sources[3]) << "outputln(d); // while";
+  ASSERT_TRUE(ml::ast::writeImage(
+      sources[3] + "i", *cached,
+      ml::basic::fnv1a("outputln(d); // while")));
+  auto looped = searchFiles(sources, pattern, &inside, 2);
+  EXPECT_EQ(looped.cached, 0u);
+  EXPECT_EQ(looped.parsed, 1u);
+  EXPECT_EQ(looped.skipped, 4u);
+  ASSERT_EQ(looped.matches.size(), 1u);
+  EXPECT_EQ(looped.matches[0].start.line, 2u);
+  std::filesystem::remove_all(root);
+}
+
+namespace {
+
+constexpr uint32_t DECLARED = 1u;
+constexpr uint32_t READONLY = 2u;
+
+// Finds the token at the nth occurrence of a text in an ASCII source
+SemanticToken tokenAt(const SemanticDocument &document,
+                      const std::string &text, size_t nth = 0) {
+  const std::string &source = document.source();
+  size_t offset = source.find(text);
+  for (size_t i = 0; i < nth; i++) {
+    offset = source.find(text, offset + 1);
+  }
+  uint32_t line = 0;
+  uint32_t column = 0;
+  for (size_t i = 0; i < offset; i++) {
+    column = source[i] == '\n' ? 0 : column + 1;
+    line += source[i] == '\n';
+  }
+  for (const auto &token : document.tokens()) {
+    if (token.line == line && token.column == column) {
+      return token;
+    }
+  }
+  ADD_FAILURE() << "No token at " << text;
+  return {};
+}
+
+void expectToken(const SemanticDocument &document, const std::string &text,
+                 size_t nth, SemanticTokenType type, uint32_t modifiers = 0) {
+  SemanticToken token = tokenAt(document, text, nth);
+  EXPECT_EQ(token.type, type) << text << " #" << nth;
+  EXPECT_EQ(token.modifiers, modifiers) << text << " #" << nth;
+}
+
+} // namespace
+
+TEST(SemanticTokensTest, ClassifiesNames) {
+  SemanticDocument document("// counter\n"
+                            "cls Counter {\n"
+                            "    let const limit: i32 = 10;\n"
+                            "    fn pub next(step: i32) i32 {\n"
+                            "        return this.limit + step;\n"
+                            "    }\n"
+                            "}\n"
+                            "fn main() {\n"
+                            "    let c = Counter();\n"
+                            "    outputln(c.next(1), \"done\");\n"
+                            "}\n");
+  using T = SemanticTokenType;
+  expectToken(document, "// counter", 0, T::Comment);
+  expectToken(document, "cls", 0, T::Keyword);
+  expectToken(document, "Counter", 0, T::Type, DECLARED);
+  expectToken(document, "const", 0, T::Keyword);
+  expectToken(document, "limit", 0, T::Property, DECLARED | READONLY);
+  expectToken(document, "i32", 0, T::Type);
+  expectToken(document, "10", 0, T::Number);
+  expectToken(document, "next", 0, T::Function, DECLARED);
+  expectToken(document, "step", 0, T::Parameter, DECLARED);
+  expectToken(document, "this", 0, T::Keyword);
+  expectToken(document, "limit", 1, T::Property);
+  expectToken(document, "+", 0, T::Operator);
+  expectToken(document, "step", 1, T::Parameter);
+  expectToken(document, "main", 0, T::Function, DECLARED);
+  expectToken(document, "c =", 0, T::Variable, DECLARED);
+  expectToken(document, "Counter", 1, T::Type);
+  expectToken(document, "outputln", 0, T::Function);
+  expectToken(document, "c.", 0, T::Variable);
+  expectToken(document, "next", 1, T::Function);
+  expectToken(document, "\"done\"", 0, T::String);
+  EXPECT_EQ(document.chunks(), 3u);
+}
+
+TEST(SemanticTokensTest, PositionsInUtf16) {
+  SemanticDocument document("let s = \"\xF0\x9F\x98\x80\"; let \xC3\xA9 = "
+                            "\"a\nb\";");
+  auto tokens = document.tokens();
+  ASSERT_EQ(tokens.size(), 9u);
+  EXPECT_EQ(tokens[3].length, 4u); // The emoji is two UTF-16 units
+  EXPECT_EQ(tokens[4].column, 14u);
+  EXPECT_EQ(tokens[5].column, 18u);
+  EXPECT_EQ(tokens[5].length, 1u);
+  EXPECT_EQ(tokens[6].column, 20u);
+  // A string spanning lines is one token per line.
+  EXPECT_EQ(tokens[7].line, 0u);
+  EXPECT_EQ(tokens[7].column, 22u);
+  EXPECT_EQ(tokens[7].length, 2u);
+  EXPECT_EQ(tokens[8].line, 1u);
+  EXPECT_EQ(tokens[8].column, 0u);
+  EXPECT_EQ(tokens[8].length, 2u);
+  EXPECT_EQ(document.offsetAt(0, 18), 20u);
+  EXPECT_EQ(document.offsetAt(1, 1), 29u);
+  EXPECT_EQ(document.offsetAt(1, 99), document.source().size());
+}
+
+TEST(SemanticTokensTest, EncodesAndDiffs) {
+  std::vector<SemanticToken> tokens = {
+      {0, 0, 3, SemanticTokenType::Keyword, 0},
+      {0, 4, 1, SemanticTokenType::Variable, DECLARED},
+      {2, 2, 5, SemanticTokenType::Number, 0}};
+  auto data = encodeSemanticTokens(tokens);
+  EXPECT_EQ(data, (std::vector<uint32_t>{0, 0, 3, 0, 0, 0, 4, 1, 5, 1, 2, 2,
+                                         5, 7, 0}));
+  EXPECT_EQ(semanticTokenTypes()[static_cast<size_t>(
+                SemanticTokenType::Property)],
+            "property");
+
+  auto changed = data;
+  changed[7] = 2;
+  auto edit = diffSemanticTokens(data, changed);
+  EXPECT_EQ(edit.start, 5u);
+  EXPECT_EQ(edit.delete_count, 5u);
+  EXPECT_EQ(edit.data, std::vector<uint32_t>(changed.begin() + 5,
+                                             changed.begin() + 10));
+  EXPECT_EQ(diffSemanticTokens(data, data).delete_count, 0u);
+}
+
+TEST(SemanticTokensTest, EditsMatchAFreshDocument) {
+  SemanticDocument document("fn helper(x: i32) i32 { return x; }\n"
+                            "let total = 0;\n"
+                            "fn main() {\n"
+                            "    if (total) { helper(1); }\n"
+                            "    /* note */ total = helper(2);\n"
+                            "}\n");
+  struct Edit {
+    const char *anchor; // Text the edit starts at
+    size_t removed;     // Bytes removed there
+    const char *text;   // Text inserted there
+  };
+  const Edit edits[] = {
+      {"total = 0", 0, "const "},           // Changes a global's modifiers
+      {"helper(x", 6, "assist"},            // Renames a function
+      {"\n    /*", 0, " else { x(); }"},   // Continues an if
+      {"fn main", 0, "{ "},                 // Opens a brace up to the end
+      {"{ fn main", 2, ""},                 // Closes it again
+      {"total = h", 0, "@ \xC3\xA9 "},      // Adds unknown characters
+      {"/* note", 0, "/* "},                // Opens a nested comment
+      {"/* /* note", 3, ""},                // Closes it again
+      {"total = helper", 0, "\"unfinished "}, // Opens a string
+      {"\"unfinished ", 12, ""},            // Closes it again
+      {"let const total", 20, ""},          // Deletes a whole statement
+      {"", 0, "rec R { let f: i32; }\n"},   // Inserts at the start
+  };
+  for (const auto &edit : edits) {
+    size_t offset = document.source().find(edit.anchor);
+    ASSERT_NE(offset, std::string::npos) << edit.anchor;
+    document.edit(offset, edit.removed, edit.text);
+    SemanticDocument fresh(document.source());
+    EXPECT_EQ(document.chunks(), fresh.chunks()) << document.source();
+    EXPECT_EQ(document.tokens(), fresh.tokens()) << document.source();
+  }
+
+  // Ending the source in an unterminated character
+  document.edit(document.source().size(), 0, "r; { let x: f64; }");
+  document.edit(document.source().size() - 2, 2, "'");
+  EXPECT_EQ(document.tokens(), SemanticDocument(document.source()).tokens());
+  document.edit(document.source().size() - 1, 1, " }");
+
+  // Appending at the end, then clearing everything
+  document.edit(document.source().size(), 0, "fn tail() {}");
+  EXPECT_EQ(document.tokens(), SemanticDocument(document.source()).tokens());
+  document.edit(0, document.source().size(), "");
+  EXPECT_TRUE(document.tokens().empty());
+  EXPECT_EQ(document.chunks(), 1u);
+}
+
+TEST(SemanticTokensTest, ReparsesOnlyTheEditedStatements) {
+  std::string source;
+  for (int i = 0; i < 200; i++) {
+    source += "fn f" + std::to_string(i) + "(a: i32) i32 {\n    return a;\n}\n";
+  }
+  source += "let limit = 3;\nfn main() { f7(limit); }\n";
+  SemanticDocument document(source);
+  EXPECT_EQ(document.chunks(), 203u);
+
+  // Typing inside one function re-parses it and the one before it.
+  size_t offset = document.source().find("return a;", 50 * 40);
+  for (char c : std::string("a + 1 + ")) {
+    auto update = document.edit(offset + 7, 0, std::string(1, c));
+    offset++;
+    EXPECT_LE(update.parsed, 2u);
+    EXPECT_LT(update.bytes, 200u);
+    EXPECT_EQ(update.reclassified, 0u);
+  }
+
+  // Changing a global classifies its users again, without parsing them.
+  auto update = document.edit(document.source().find("limit = 3"), 0,
+                              "const ");
+  EXPECT_LE(update.parsed, 2u);
+  EXPECT_EQ(update.reclassified, 1u);
+  expectToken(document, "limit)", 0, SemanticTokenType::Variable, READONLY);
+  update = document.edit(document.source().find("fn f7(") + 3, 2, "g7");
+  EXPECT_LE(update.parsed, 2u);
+  EXPECT_EQ(update.reclassified, 1u);
+  EXPECT_EQ(document.tokens(), SemanticDocument(document.source()).tokens());
+}
+
+TEST(SemanticTokensTest, RandomEditsMatchAFreshDocument) {
+  // Pieces of statements, so edits open and close brackets, comments,
+  // literals and branches in every combination.
+  const char *pieces[] = {"fn f(x: i32) i32 { return x; }\n",
+                          "let y = 1;",
+                          "cls D { }",
+                          "rec R { let f: i32; }",
+                          "if (y) { g(); }",
+                          "elif (x) {",
+                          "else {",
+                          "while (true) {",
+                          "switch (x) { case 1 { } }",
+                          "const ",
+                          "let x:",
+                          "f64",
+                          "{",
+                          "}",
+                          " }",
+                          "(",
+                          ")",
+                          ";",
+                          "'",
+                          "\"",
+                          "/*",
+                          "*/",
+                          "//",
+                          "\n",
+                          " ",
+                          "4",
+                          "r",
+                          "@",
+                          "\xC3\xA9"};
+  const size_t count = sizeof(pieces) / sizeof(pieces[0]);
+
+  testing::internal::CaptureStderr();
+  for (unsigned seed = 0; seed < 30; seed++) {
+    std::mt19937 random(seed);
+    std::string source;
+    for (int i = 0; i < 12; i++) {
+      source += pieces[random() % count];
+    }
+    SemanticDocument document(source);
+    for (int step = 0; step < 40; step++) {
+      size_t size = document.source().size();
+      size_t offset = random() % (size + 1);
+      size_t length = random() % 6;
+      std::string text = random() % 3 == 0 ? "" : pieces[random() % count];
+      std::string before = document.source();
+      ASSERT_NO_THROW(document.edit(offset, length, text))
+          << before << "\nat " << offset << ", " << length << ": " << text;
+      ASSERT_EQ(document.tokens(),
+                SemanticDocument(document.source()).tokens())
+          << before << "\nat " << offset << ", " << length << ": " << text;
+    }
+  }
+  testing::internal::GetCapturedStderr();
+}
@@ -0,0 +1,99 @@
+#include "ml/codegen/regalloc.h"
+#include <gtest/gtest.h>
+
+using namespace ml::codegen;
+
+class RegisterAllocatorTest : public ::testing::Test {
+protected:
+  // Helper function to create an interval used at its ends and at extra
+  // positions
+  LiveInterval interval(uint32_t vreg, uint32_t start, uint32_t end,
+                        std::vector<uint32_t> extra = {}) {
+    LiveInterval result{vreg, start, end, {start}};
+    result.uses.insert(result.uses.end(), extra.begin(), extra.end());
+    result.uses.push_back(end);
+    return result;
+  }
+
+  // Helper function to check that no two overlapping intervals share a
+  // location
+  void expectNoConflicts(const std::vector<LiveInterval> &intervals,
+                         const Allocation &allocation) {
+    for (const auto &a : intervals) {
+      for (const auto &b : intervals) {
+        if (a.vreg >= b.vreg || a.end <= b.start || b.end <= a.start) {
+          continue;
+        }
+        Location x = allocation.at(a.vreg);
+        Location y = allocation.at(b.vreg);
+        EXPECT_FALSE(x.kind == y.kind && x.index == y.index)
+            << "v" << a.vreg << " and v" << b.vreg << " share a location";
+      }
+    }
+  }
+};
+
+TEST_F(RegisterAllocatorTest, ReusesRegistersOfExpiredIntervals) {
+  std::vector<LiveInterval> intervals = {
+      interval(0, 0, 4), interval(1, 1, 2), interval(2, 2, 6),
+      interval(3, 4, 8)};
+  auto allocation = allocateLinearScan(intervals, {}, 2);
+  EXPECT_EQ(allocation.spilled, 0);
+  EXPECT_EQ(allocation.stack_slots, 0);
+  for (const auto &i : intervals) {
+    EXPECT_EQ(allocation.at(i.vreg).kind, Location::Kind::Register);
+  }
+  expectNoConflicts(intervals, allocation);
+}
+
+TEST_F(RegisterAllocatorTest, SpillsTheLeastUsedInterval) {
+  // v0 is long and rarely used; v1 and v2 are short and busy.
+  std::vector<LiveInterval> intervals = {
+      interval(0, 0, 20), interval(1, 1, 4, {2, 3}),
+      interval(2, 2, 5, {3, 4})};
+  auto allocation = allocateLinearScan(intervals, {}, 2);
+  EXPECT_EQ(allocation.spilled, 1);
+  EXPECT_EQ(allocation.at(0).kind, Location::Kind::Stack);
+  EXPECT_EQ(allocation.at(1).kind, Location::Kind::Register);
+  EXPECT_EQ(allocation.at(2).kind, Location::Kind::Register);
+  EXPECT_EQ(allocation.memory_accesses, 2);
+  expectNoConflicts(intervals, allocation);
+}
+
+TEST_F(RegisterAllocatorTest, CoalescesMoves) {
+  // v2 = v0 at position 5; v1 takes another register meanwhile.
+  std::vector<LiveInterval> intervals = {
+      interval(0, 0, 5), interval(1, 1, 8), interval(3, 3, 5),
+      interval(2, 5, 9)};
+  auto allocation = allocateLinearScan(intervals, {{0, 2}}, 3);
+  EXPECT_EQ(allocation.coalesced, 1);
+  EXPECT_EQ(allocation.at(0).index, allocation.at(2).index);
+  expectNoConflicts(intervals, allocation);
+}
+
+TEST_F(RegisterAllocatorTest, SharesStackSlotsBetweenSpills) {
+  std::vector<LiveInterval> intervals;
+  for (uint32_t v = 0; v < 6; v++) {
+    intervals.push_back(interval(v, (v / 3) * 10, (v / 3) * 10 + 9));
+  }
+  auto allocation = allocateLinearScan(intervals, {}, 1);
+  EXPECT_EQ(allocation.spilled, 4);
+  EXPECT_EQ(allocation.stack_slots, 2);
+  expectNoConflicts(intervals, allocation);
+
+  auto naive = allocateStackSlots(intervals);
+  EXPECT_EQ(naive.spilled, 6);
+  EXPECT_EQ(naive.stack_slots, 6);
+  EXPECT_EQ(naive.memory_accesses, 12);
+  EXPECT_EQ(naive.at(5).kind, Location::Kind::Stack);
+  EXPECT_EQ(naive.at(6).kind, Location::Kind::None);
+}
+
+TEST_F(RegisterAllocatorTest, WorksWithoutRegisters) {
+  std::vector<LiveInterval> intervals = {interval(0, 0, 3),
+                                         interval(1, 1, 2)};
+  auto allocation = allocateLinearScan(intervals, {{0, 1}}, 0);
+  EXPECT_EQ(allocation.spilled, 2);
+  EXPECT_EQ(allocation.coalesced, 0);
+  expectNoConflicts(intervals, allocation);
+}
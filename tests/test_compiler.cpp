@@ -0,0 +1,307 @@
+#include "ml/compiler/build.h"
+#include "ml/compiler/compiler.h"
+#include "ml/compiler/snapshot.h"
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+
+using namespace ml::compiler;
+
+class BuildTest : public ::testing::Test {
+protected:
+  std::filesystem::path root_;
+
+  void SetUp() override {
+    root_ = std::filesystem::temp_directory_path() /
+            ("ml_build_test_" +
+             std::string(
+                 ::testing::UnitTest::GetInstance()->current_test_info()->name()));
+    std::filesystem::remove_all(root_);
+    std::filesystem::create_directories(root_ / "src");
+  }
+
+  void TearDown() override { std::filesystem::remove_all(root_); }
+
+  // Helper function to write a source file below the test directory
+  std::string writeSource(const std::string &name, const std::string &source) {
+    auto path = root_ / "src" / name;
+    std::ofstream(path) << source;
+    return path.generic_string();
+  }
+
+  BuildOptions options(unsigned jobs = 2) {
+    BuildOptions options;
+    options.jobs = jobs;
+    options.database = (root_ / "build.db").string();
+    return options;
+  }
+};
+
+TEST_F(BuildTest, DatabaseRoundTrip) {
+  BuildDatabase database;
+  BuildEntry entry;
+  entry.path = "dir with spaces/a.ml";
+  entry.hash = 0x0123456789abcdefULL;
+  entry.ok = true;
+  entry.output = "out/a.mli";
+  entry.imports = {"b.ml", "c.ml"};
+  database.update(entry);
+
+  auto file = (root_ / "nested" / "db").string();
+  ASSERT_TRUE(database.save(file));
+
+  BuildDatabase loaded;
+  ASSERT_TRUE(loaded.load(file));
+  const BuildEntry *found = loaded.find("dir with spaces/a.ml");
+  ASSERT_NE(found, nullptr);
+  EXPECT_EQ(found->hash, entry.hash);
+  EXPECT_TRUE(found->ok);
+  EXPECT_EQ(found->output, "out/a.mli");
+  EXPECT_EQ(found->imports, entry.imports);
+}
+
+TEST_F(BuildTest, MissingDatabaseIsEmpty) {
+  BuildDatabase database;
+  EXPECT_FALSE(database.load((root_ / "missing.db").string()));
+  EXPECT_EQ(database.size(), 0);
+}
+
+TEST_F(BuildTest, CorruptDatabaseIsEmpty) {
+  const char *lines[] = {
+      "file zz 1 a.ml",
+      "file 0123 2 a.ml",
+      "file 99999999999999999999 1 a.ml",
+      "file 0123",
+      "file 0123x 1 a.ml",
+  };
+  for (const char *line : lines) {
+    auto file = (root_ / "corrupt.db").string();
+    std::ofstream(file) << "# my_lang build database v1\n"
+                        << "file 00ff 1 b.ml\n"
+                        << line << "\n";
+    BuildDatabase database;
+    EXPECT_FALSE(database.load(file)) << line;
+    EXPECT_EQ(database.size(), 0) << line;
+  }
+}
+
+TEST_F(BuildTest, CollectsSourcesRecursively) {
+  writeSource("a.ml", "let a: i32 = 1;");
+  std::filesystem::create_directories(root_ / "src" / "sub");
+  std::ofstream(root_ / "src" / "sub" / "b.ml") << "let b: i32 = 2;";
+  std::ofstream(root_ / "src" / "notes.txt") << "not a source";
+
+  auto sources = Builder::collectSources({(root_ / "src").string()});
+  ASSERT_EQ(sources.size(), 2);
+  EXPECT_NE(sources[0].find("a.ml"), std::string::npos);
+  EXPECT_NE(sources[1].find("b.ml"), std::string::npos);
+}
+
+TEST_F(BuildTest, SkipsUpToDateFiles) {
+  auto a = writeSource("a.ml", "let a: i32 = 1;");
+  auto b = writeSource("b.ml", "fn f() { return 2; }");
+
+  Builder first(options());
+  auto summary = first.build({a, b});
+  EXPECT_EQ(summary.total, 2);
+  EXPECT_EQ(summary.rebuilt, 2);
+  EXPECT_EQ(summary.cached, 0);
+  EXPECT_EQ(summary.failed, 0);
+
+  Builder second(options());
+  summary = second.build({a, b});
+  EXPECT_EQ(summary.rebuilt, 0);
+  EXPECT_EQ(summary.cached, 2);
+  EXPECT_DOUBLE_EQ(summary.hitRate(), 1.0);
+
+  writeSource("b.ml", "fn f() { return 3; }");
+  Builder third(options(1));
+  summary = third.build({a, b});
+  EXPECT_EQ(summary.rebuilt, 1);
+  EXPECT_EQ(summary.cached, 1);
+}
+
+TEST_F(BuildTest, RebuildsImporters) {
+  auto a = writeSource("a.ml", "let a: i32 = 1;");
+  auto b = writeSource("b.ml", "let b: i32 = 2;");
+
+  Builder(options()).build({a, b});
+
+  // Record an edge b -> a, then touch a: both files must be rebuilt.
+  BuildDatabase database;
+  database.load(options().database);
+  BuildEntry entry = *database.find(b);
+  entry.imports.push_back(a);
+  database.update(entry);
+  database.save(options().database);
+
+  writeSource("a.ml", "let a: i32 = 10;");
+  auto summary = Builder(options()).build({a, b});
+  EXPECT_EQ(summary.rebuilt, 2);
+  EXPECT_EQ(summary.cached, 0);
+}
+
+TEST_F(BuildTest, FailedFilesStayDirty) {
+  testing::internal::CaptureStderr();
+  auto a = writeSource("a.ml", "let x = ;");
+  auto summary = Builder(options()).build({a});
+  EXPECT_EQ(summary.failed, 1);
+  EXPECT_EQ(summary.failures, std::vector<std::string>{a});
+  EXPECT_TRUE(summary.saved);
+  std::string log = testing::internal::GetCapturedStderr();
+  EXPECT_NE(log.find(a), std::string::npos);
+
+  testing::internal::CaptureStderr();
+  summary = Builder(options()).build({a});
+  testing::internal::GetCapturedStderr();
+  EXPECT_EQ(summary.rebuilt, 1);
+  EXPECT_EQ(summary.cached, 0);
+}
+
+TEST_F(BuildTest, ReportsUnwritableDatabase) {
+  auto a = writeSource("a.ml", "let a: i32 = 1;");
+  BuildOptions blocked = options();
+  blocked.database = (root_ / "src").string();
+  auto summary = Builder(blocked).build({a});
+  EXPECT_EQ(summary.failed, 0);
+  EXPECT_FALSE(summary.saved);
+}
+
+class SnapshotTest : public ::testing::Test {
+protected:
+  // Helper function to run the top-level initialization of a source
+  StartupState initializeSource(const std::string &source) {
+    ml::parser::Parser parser;
+    auto program = parser.parse(source);
+    EXPECT_NE(program, nullptr);
+    return program ? initialize(*program) : StartupState();
+  }
+
+  // Helper function to find a global by name
+  const Global *global(const StartupState &state, const std::string &name) {
+    for (const auto &g : state.globals) {
+      if (g.name == name) {
+        return &g;
+      }
+    }
+    return nullptr;
+  }
+};
+
+TEST_F(SnapshotTest, EvaluatesConstantInitializers) {
+  auto state = initializeSource(
+      "let a: i32 = 2 * 3 + 1;\n"
+      "let b: i32 = a * a;\n"
+      "let c: f64 = b;\n"
+      "let s = \"ab\" + \"cd\";\n"
+      "let t = a > 5 && !(b == 0);\n"
+      "let d: i32 = 1 / 0;\n"
+      "let e: i32 = 9223372036854775807 + 1;\n");
+  ASSERT_EQ(state.globals.size(), 7);
+  EXPECT_EQ(global(state, "a")->value.kind, ValueKind::Integer);
+  EXPECT_EQ(global(state, "a")->value.integer, 7);
+  EXPECT_EQ(global(state, "b")->value.integer, 49);
+  EXPECT_EQ(global(state, "c")->value.kind, ValueKind::Float);
+  EXPECT_DOUBLE_EQ(global(state, "c")->value.real, 49.0);
+  EXPECT_EQ(global(state, "s")->value.text, "abcd");
+  EXPECT_EQ(global(state, "t")->value.kind, ValueKind::Boolean);
+  EXPECT_EQ(global(state, "t")->value.integer, 1);
+  EXPECT_EQ(global(state, "d")->value.kind, ValueKind::Deferred);
+  EXPECT_EQ(global(state, "e")->value.kind, ValueKind::Deferred);
+  EXPECT_EQ(state.deferred(), 2);
+}
+
+TEST_F(SnapshotTest, DecodesStringEscapes) {
+  auto state = initializeSource("let s = \"a\\tb\\\"c\\u{3C0}\";\n");
+  ASSERT_EQ(state.globals.size(), 1);
+  EXPECT_EQ(global(state, "s")->value.kind, ValueKind::String);
+  EXPECT_EQ(global(state, "s")->value.text, "a\tb\"c\xCF\x80");
+}
+
+TEST_F(SnapshotTest, UsesConvertedNumbers) {
+  auto state = initializeSource("let m: i32 = 0xFF + 1_000;\n"
+                                "let r: f64 = 2.5e2 + 0b11;\n"
+                                "let h = 18446744073709551615;\n");
+  EXPECT_EQ(global(state, "m")->value.integer, 1255);
+  EXPECT_DOUBLE_EQ(global(state, "r")->value.real, 253.0);
+  EXPECT_EQ(global(state, "h")->value.kind, ValueKind::Deferred);
+}
+
+TEST_F(SnapshotTest, SideEffectsDeferLaterGlobals) {
+  auto state = initializeSource("let a: i32 = 1;\n"
+                                "let b: i32 = f();\n"
+                                "let c: i32 = 2;\n"
+                                "fn f(): i32 { a = 5; return a; }\n");
+  ASSERT_EQ(state.globals.size(), 3);
+  EXPECT_EQ(global(state, "a")->value.kind, ValueKind::Deferred);
+  EXPECT_EQ(global(state, "b")->value.kind, ValueKind::Deferred);
+  EXPECT_EQ(global(state, "c")->value.kind, ValueKind::Deferred);
+}
+
+TEST_F(SnapshotTest, SideEffectsDeferAssignedGlobals) {
+  auto state = initializeSource("let x: i32 = 1;\n"
+                                "let k: i32 = 7;\n"
+                                "x = 2;\n"
+                                "let y: i32 = x + 1;\n");
+  ASSERT_EQ(state.globals.size(), 3);
+  EXPECT_EQ(global(state, "x")->value.kind, ValueKind::Deferred);
+  EXPECT_EQ(global(state, "k")->value.kind, ValueKind::Integer);
+  EXPECT_EQ(global(state, "k")->value.integer, 7);
+  EXPECT_EQ(global(state, "y")->value.kind, ValueKind::Deferred);
+
+  state = initializeSource("let n: i32 = 0;\n"
+                           "let m: i32 = 0;\n"
+                           "fn bump() { n++; }\n"
+                           "bump();\n");
+  EXPECT_EQ(global(state, "n")->value.kind, ValueKind::Deferred);
+  EXPECT_EQ(global(state, "m")->value.kind, ValueKind::Integer);
+}
+
+TEST_F(SnapshotTest, RecordsTypeLayouts) {
+  auto state = initializeSource("rec Point { let x: i32; let y: i32; }\n"
+                                "cls Shape { let pub name: str; "
+                                "fn pub area(): f64 { return 0.0; } }\n");
+  ASSERT_EQ(state.types.size(), 2);
+  EXPECT_EQ(state.types[0].name, "Point");
+  EXPECT_TRUE(state.types[0].record);
+  ASSERT_EQ(state.types[0].fields.size(), 2);
+  EXPECT_EQ(state.types[0].fields[1].name, "y");
+  EXPECT_EQ(state.types[0].fields[1].type, "i32");
+  EXPECT_FALSE(state.types[1].record);
+  ASSERT_EQ(state.types[1].methods.size(), 1);
+  EXPECT_EQ(state.types[1].methods[0].name, "area");
+}
+
+TEST_F(SnapshotTest, RestoresOnlyMatchingSnapshots) {
+  auto state = initializeSource("let b = \"x\";\n"
+                                "let a: i32 = 3;\n"
+                                "let a: i32 = 4;\n"
+                                "rec P { let x: i32; let y: i32; }\n");
+  auto path = std::filesystem::temp_directory_path() / "ml_snapshot.snap";
+  ASSERT_TRUE(writeSnapshot(path.string(), state, 11));
+
+  StartupSnapshot snapshot;
+  EXPECT_FALSE(snapshot.open(path.string(), 12));
+  EXPECT_EQ(snapshot.globalCount(), 0);
+  ASSERT_TRUE(snapshot.open(path.string(), 11));
+  EXPECT_EQ(snapshot.globalCount(), 3);
+  EXPECT_EQ(snapshot.typeCount(), 1);
+
+  Value value;
+  ASSERT_TRUE(snapshot.find("a", value));
+  EXPECT_EQ(value.integer, 4);
+  ASSERT_TRUE(snapshot.find("b", value));
+  EXPECT_EQ(value.text, "x");
+  EXPECT_FALSE(snapshot.find("c", value));
+  EXPECT_EQ(snapshot.fieldSlot("P", "y"), 1);
+  EXPECT_EQ(snapshot.fieldSlot("P", "z"), -1);
+  EXPECT_EQ(snapshot.fieldSlot("Q", "x"), -1);
+
+  auto restored = snapshot.restore();
+  ASSERT_EQ(restored.globals.size(), 3);
+  EXPECT_EQ(restored.globals[0].name, "a");
+  EXPECT_EQ(restored.globals[2].name, "b");
+  ASSERT_EQ(restored.types.size(), 1);
+  EXPECT_EQ(restored.types[0].fields.size(), 2);
+  std::filesystem::remove(path);
+}
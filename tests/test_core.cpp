@@ -1,7 +1,14 @@
 #include "ml/basic/error.h"
 #include "ml/basic/locus.h"
+#include "ml/basic/number.h"
+#include "ml/basic/parallel.h"
+#include "ml/basic/small_vector.h"
+#include "ml/basic/unicode.h"
+#include <chrono>
+#include <ctime>
 #include <gtest/gtest.h>
 #include <sstream>
+#include <stdexcept>
 
 using namespace ml::basic;
 
@@ -153,4 +160,283 @@ TEST_F(ErrorTest, BoundaryConditions) {
   Error err3(ErrorLevel::Error, "Test error", "Test help", start_loc3, end_loc3,
              "test.txt", source);
   EXPECT_EQ(err3.snippet(), "test");
-}
\ No newline at end of file
+}
+
+// SmallVector Tests
+TEST(SmallVectorTest, StaysInlineUntilFull) {
+  SmallVector<int, 4> values;
+  for (int i = 0; i < 4; i++) {
+    values.push_back(i);
+  }
+  EXPECT_TRUE(values.isInline());
+  EXPECT_EQ(values.size(), 4);
+  EXPECT_EQ(values.back(), 3);
+}
+
+TEST(SmallVectorTest, GrowsOntoTheHeap) {
+  SmallVector<int, 2> values;
+  for (int i = 0; i < 100; i++) {
+    values.push_back(i);
+  }
+  EXPECT_FALSE(values.isInline());
+  ASSERT_EQ(values.size(), 100);
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(values[i], i);
+  }
+
+  SmallVector<int, 2> copy(values);
+  values.pop_back();
+  EXPECT_EQ(copy.size(), 100);
+  EXPECT_EQ(copy.back(), 99);
+  EXPECT_EQ(values.back(), 98);
+}
+
+// Thread Pool Tests
+TEST(ThreadPoolTest, DequePopsNewestAndStealsOldest) {
+  WorkStealingDeque<int> deque(2);
+  for (int i = 0; i < 10; i++) {
+    deque.push(i);
+  }
+  EXPECT_EQ(deque.size(), 10);
+  int value = -1;
+  ASSERT_TRUE(deque.pop(value));
+  EXPECT_EQ(value, 9);
+  ASSERT_TRUE(deque.steal(value));
+  EXPECT_EQ(value, 0);
+  while (deque.pop(value)) {
+  }
+  EXPECT_TRUE(deque.empty());
+  EXPECT_FALSE(deque.steal(value));
+}
+
+TEST(ThreadPoolTest, DequeHandsOutEveryElementOnce) {
+  WorkStealingDeque<int> deque;
+  constexpr int count = 20000;
+  std::atomic<bool> done{false};
+  std::atomic<int> stolen_sum{0};
+  std::vector<std::thread> thieves;
+  for (int t = 0; t < 3; t++) {
+    thieves.emplace_back([&]() {
+      int value;
+      while (!done || !deque.empty()) {
+        if (deque.steal(value)) {
+          stolen_sum += value;
+        }
+      }
+    });
+  }
+  long popped_sum = 0;
+  int value;
+  for (int i = 1; i <= count; i++) {
+    deque.push(i);
+    if (i % 3 == 0 && deque.pop(value)) {
+      popped_sum += value;
+    }
+  }
+  while (deque.pop(value)) {
+    popped_sum += value;
+  }
+  done = true;
+  for (auto &thief : thieves) {
+    thief.join();
+  }
+  EXPECT_EQ(popped_sum + stolen_sum, long(count) * (count + 1) / 2);
+}
+
+long fib(int n) {
+  if (n < 2) {
+    return n;
+  }
+  long left = 0;
+  TaskGroup group;
+  group.run([&]() { left = fib(n - 1); });
+  long right = fib(n - 2);
+  group.wait();
+  return left + right;
+}
+
+TEST(ThreadPoolTest, NestedForkJoin) {
+  EXPECT_EQ(fib(20), 6765);
+  ThreadPool pool(3);
+  TaskGroup group(pool);
+  std::atomic<int> sum{0};
+  for (int i = 0; i < 100; i++) {
+    group.run([&, i]() {
+      for (int j = 0; j < 10; j++) {
+        group.run([&, j]() { sum += j; });
+      }
+      sum += i;
+    });
+  }
+  group.wait();
+  EXPECT_EQ(sum, 100 * 45 + 99 * 100 / 2);
+  EXPECT_GE(pool.stats().executed, 1100u);
+}
+
+TEST(ThreadPoolTest, CancelSkipsPendingTasks) {
+  ThreadPool pool(1);
+  TaskGroup group(pool);
+  std::atomic<bool> release{false};
+  std::atomic<int> ran{0};
+  group.run([&]() {
+    while (!release) {
+      std::this_thread::yield();
+    }
+  });
+  group.cancel();
+  for (int i = 0; i < 50; i++) {
+    group.run([&]() { ran++; });
+  }
+  release = true;
+  group.wait();
+  EXPECT_TRUE(group.cancelled());
+  EXPECT_EQ(ran, 0);
+}
+
+TEST(ThreadPoolTest, WaitRethrowsTaskExceptions) {
+  TaskGroup group;
+  group.run([]() { throw std::runtime_error("task failed"); });
+  EXPECT_THROW(group.wait(), std::runtime_error);
+  EXPECT_TRUE(group.cancelled());
+
+  EXPECT_THROW(parallelFor(64, 4,
+                           [](size_t i) {
+                             if (i == 10) {
+                               throw std::runtime_error("item failed");
+                             }
+                           }),
+               std::runtime_error);
+}
+
+TEST(ThreadPoolTest, JoinSleepsWhileTasksRunElsewhere) {
+#ifdef _WIN32
+  GTEST_SKIP() << "std::clock measures wall time on Windows";
+#endif
+  ThreadPool pool(2);
+  TaskGroup group(pool);
+  group.run([]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  });
+  // Give a worker time to take the task, so the join has nothing to run.
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  std::clock_t start = std::clock();
+  group.wait();
+  double cpu = double(std::clock() - start) / CLOCKS_PER_SEC;
+  // A spinning join would burn about as much CPU as the task sleeps.
+  EXPECT_LT(cpu, 0.1);
+}
+
+TEST(ThreadPoolTest, ParallelForVisitsEveryIndex) {
+  std::vector<std::atomic<int>> hits(1000);
+  parallelFor(hits.size(), 8, [&hits](size_t i) { hits[i]++; });
+  for (auto &hit : hits) {
+    EXPECT_EQ(hit, 1);
+  }
+}
+
+// Unicode Tests
+TEST(UnicodeTest, ValidatesUtf8) {
+  EXPECT_TRUE(validateUtf8(""));
+  EXPECT_TRUE(validateUtf8("plain ascii text that spans several words"));
+  EXPECT_TRUE(validateUtf8("caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80"));
+
+  size_t offset = 0;
+  EXPECT_FALSE(validateUtf8("0123456789\xC0\xAF", &offset)); // Overlong
+  EXPECT_EQ(offset, 10);
+  EXPECT_FALSE(validateUtf8("\xED\xA0\x80", &offset)); // Surrogate
+  EXPECT_EQ(offset, 0);
+  EXPECT_FALSE(validateUtf8("ab\xF4\x90\x80\x80", &offset)); // > U+10FFFF
+  EXPECT_EQ(offset, 2);
+  EXPECT_FALSE(validateUtf8("abc\xE2\x82", &offset)); // Truncated
+  EXPECT_EQ(offset, 3);
+  EXPECT_FALSE(validateUtf8("\x80")); // Stray continuation byte
+}
+
+TEST(UnicodeTest, DecodesCodePoints) {
+  char32_t code_point = 0;
+  EXPECT_EQ(decodeUtf8("A", 0, code_point), 1);
+  EXPECT_EQ(code_point, U'A');
+  EXPECT_EQ(decodeUtf8("\xC3\xA9", 0, code_point), 2);
+  EXPECT_EQ(code_point, U'é');
+  EXPECT_EQ(decodeUtf8("x\xE2\x82\xAC", 1, code_point), 3);
+  EXPECT_EQ(code_point, U'€');
+  EXPECT_EQ(decodeUtf8("\xF0\x9F\x98\x80", 0, code_point), 4);
+  EXPECT_EQ(code_point, U'\U0001F600');
+}
+
+TEST(UnicodeTest, IdentifierProperties) {
+  EXPECT_TRUE(isXidStart(U'_'));
+  EXPECT_TRUE(isXidStart(U'é'));  // e with acute
+  EXPECT_TRUE(isXidStart(U'π'));  // Greek pi
+  EXPECT_TRUE(isXidStart(U'中'));  // CJK ideograph
+  EXPECT_FALSE(isXidStart(U'1'));
+  EXPECT_FALSE(isXidStart(U'١')); // Arabic-Indic digit one
+  EXPECT_TRUE(isXidContinue(U'١'));
+  EXPECT_TRUE(isXidContinue(U'́')); // Combining acute accent
+  EXPECT_FALSE(isXidContinue(U'€')); // Euro sign
+  EXPECT_FALSE(isXidContinue(U'\U0001F600'));
+
+  std::string_view text = "\xCF\x80r\xC2\xB2 = 1";
+  EXPECT_EQ(scanIdentifier(text, 0), 3); // Stops at the superscript two
+  EXPECT_EQ(scanIdentifier("9lives", 0), 0);
+  EXPECT_EQ(scanIdentifier("x_1 ", 0), 3);
+}
+
+// Number Tests
+TEST(NumberTest, ScansLiteralForms) {
+  EXPECT_EQ(scanNumber("123 ", 0), 3);
+  EXPECT_EQ(scanNumber("0x1F_FFu8;", 0), 9);
+  EXPECT_EQ(scanNumber("0b1010_0101", 0), 11);
+  EXPECT_EQ(scanNumber("1_000_000)", 0), 9);
+  EXPECT_EQ(scanNumber("6.02e+23f64 ", 0), 11);
+  EXPECT_EQ(scanNumber("0..10", 0), 1);   // A range, not a fraction
+  EXPECT_EQ(scanNumber("1.size", 0), 1);  // A member access
+  EXPECT_EQ(scanNumber("2e", 0), 1);      // No exponent digits
+  EXPECT_EQ(scanNumber("42i32x", 0), 2);  // Not a suffix
+  EXPECT_EQ(scanNumber("0xg", 0), 1);     // No hex digits
+  EXPECT_EQ(scanNumber("x1", 0), 0);
+}
+
+TEST(NumberTest, ConvertsValues) {
+  Number number;
+  ASSERT_TRUE(parseNumber("0x1F_FFu16", number));
+  EXPECT_EQ(number.kind, NumberKind::Integer);
+  EXPECT_EQ(number.suffix, NumberSuffix::U16);
+  EXPECT_EQ(number.integer, 0x1FFF);
+
+  ASSERT_TRUE(parseNumber("0b1010_0101", number));
+  EXPECT_EQ(number.integer, 0xA5);
+
+  ASSERT_TRUE(parseNumber("0x10f32", number)); // Hex digits, not a suffix
+  EXPECT_EQ(number.kind, NumberKind::Integer);
+  EXPECT_EQ(number.integer, 0x10F32);
+
+  ASSERT_TRUE(parseNumber("18446744073709551615", number));
+  EXPECT_EQ(number.integer, UINT64_MAX);
+
+  ASSERT_TRUE(parseNumber("1_000.25e2", number));
+  EXPECT_EQ(number.kind, NumberKind::Float);
+  EXPECT_DOUBLE_EQ(number.real, 100025.0);
+
+  ASSERT_TRUE(parseNumber("3f32", number));
+  EXPECT_EQ(number.kind, NumberKind::Float);
+  EXPECT_EQ(number.suffix, NumberSuffix::F32);
+  EXPECT_EQ(number.real, double(3.0f));
+
+  ASSERT_TRUE(parseNumber("0.1f32", number));
+  EXPECT_EQ(number.real, double(0.1f)); // Rounded to single precision
+
+  ASSERT_TRUE(parseNumber("128i8", number)); // Negatable to -128
+  EXPECT_FALSE(parseNumber("129i8", number));
+  EXPECT_EQ(number.kind, NumberKind::Integer);
+}
+
+TEST(NumberTest, RejectsMalformedLiterals) {
+  Number number;
+  EXPECT_FALSE(parseNumber("18446744073709551616", number)); // > 64 bits
+  EXPECT_FALSE(parseNumber("256u8", number));
+  EXPECT_FALSE(parseNumber("1.5i32", number)); // Integer suffix on a float
+  EXPECT_FALSE(parseNumber("1e999", number));
+  EXPECT_FALSE(parseNumber("12abc", number));
+  EXPECT_FALSE(parseNumber("", number));
+}
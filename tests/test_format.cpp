@@ -0,0 +1,319 @@
+#include "ml/ast/structural.h"
+#include "ml/format/doc.h"
+#include "ml/format/formatter.h"
+#include "ml/parser/parser.h"
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+
+using namespace ml::format;
+
+namespace {
+
+// Programs that exercise every statement and expression form
+const char *const CORPUS[] = {
+    "let x = 1;",
+    "let pub static y?: str;\nlet z: i32[] = [1, 2, 3];\nlet w: i32[4];",
+    "fn add(x i32, y: i32) i32 { return x + y; }\nfn init() {}",
+    "fn f?(a: i32 = 1) { if (a) { return; } elif (b) { break; } "
+    "else { continue; } }",
+    "rec Point { let x: f64; let y: f64; }",
+    "cls Counter { fn pub next() i32 { return this.count++; } "
+    "let count: i32 = 0; }",
+    "switch (x) { case 1 { a(); } case 2 { b(); } default { c(); } }",
+    "for (let i = 0; i < 10; i++) { outputln(i); }\n"
+    "for (x in xs) { outputln(x); }\nfor (x: i32 in xs) {}\n"
+    "for (0..10) {}\nfor (0.=10) {}",
+    "while (i < 10 && !done || i == 3) { i = i + 1; }",
+    "x = y = z;\n(x + y) * z;\nx - (y - z);\nx - y - z;\n- -x;\n-(-x + y);",
+    "(a.b) + c;\na.b + c;\na.b(c).d;\n(a.b)(c);\nitems[i + 1].name;",
+    "let t = spawn work(1, 2);\nlet r = await t;\nlet s = await spawn f();",
+    "{ nested(); { deeper(); } }",
+    "let s = \"tab\\there\";\nlet c = 'x';\nlet n = 0x1F_u32 + 1.5e3;",
+    "call(aVeryLongArgumentNumberOne, aVeryLongArgumentNumberTwo, "
+    "aVeryLongArgumentNumberThree, [1, 2, 3]);",
+    "let total = firstQuantityWithALongName + secondQuantityWithALongName + "
+    "thirdQuantityWithALongName;",
+};
+
+std::unique_ptr<ml::ast::Program> parse(const std::string &source) {
+  ml::parser::Parser parser;
+  auto program = parser.parse(source);
+  EXPECT_EQ(parser.errors(), 0u) << source;
+  return program;
+}
+
+std::string format(const std::string &source,
+                   const FormatOptions &options = FormatOptions()) {
+  std::string out;
+  EXPECT_TRUE(formatSource(source, out, options)) << source;
+  return out;
+}
+
+bool hasTrailingWhitespace(const std::string &text) {
+  std::istringstream lines(text);
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (!line.empty() && (line.back() == ' ' || line.back() == '\t')) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string minify(const std::string &source,
+                   const MinifyOptions &options = MinifyOptions()) {
+  std::string out;
+  EXPECT_TRUE(minifySource(source, out, options)) << source;
+  return out;
+}
+
+} // namespace
+
+TEST(DocTest, GroupsStayFlatWhenTheyFit) {
+  Doc doc;
+  doc.text("f(").begin().indent().softLine().text("a").text(",").line();
+  doc.text("b").dedent().softLine().end().text(");");
+
+  std::string wide;
+  doc.render(wide, 80, 4);
+  EXPECT_EQ(wide, "f(a, b);");
+
+  // The text after the group counts: "f(a, b)" fits in 7 columns, but not
+  // with the semicolon.
+  std::string narrow;
+  doc.render(narrow, 7, 4);
+  EXPECT_EQ(narrow, "f(\n    a,\n    b\n);");
+}
+
+TEST(DocTest, HardLinesBreakEnclosingGroups) {
+  Doc doc;
+  doc.begin().text("a").line().text("b").hardLine().text("c").end();
+  std::string out;
+  doc.render(out, 80, 4);
+  EXPECT_EQ(out, "a\nb\nc");
+}
+
+TEST(DocTest, BlankLinesHaveNoIndentation) {
+  Doc doc;
+  doc.text("{").indent().hardLine().text("a").hardLine().hardLine();
+  doc.text("b").dedent().hardLine().text("}");
+  std::string out;
+  doc.render(out, 80, 2);
+  EXPECT_EQ(out, "{\n  a\n\n  b\n}");
+}
+
+TEST(DocTest, MeasuresCodePoints) {
+  EXPECT_EQ(displayWidth("abc"), 3u);
+  EXPECT_EQ(displayWidth("\xC3\xA9t\xC3\xA9"), 3u);
+}
+
+TEST(FormatterTest, PreservesTheAst) {
+  for (const char *source : CORPUS) {
+    std::string formatted = format(source);
+    auto before = parse(source);
+    auto after = parse(formatted);
+    ASSERT_NE(before, nullptr);
+    ASSERT_NE(after, nullptr);
+    EXPECT_TRUE(ml::ast::structurallyEqual(*before, *after))
+        << source << "\n---\n"
+        << formatted;
+  }
+}
+
+TEST(FormatterTest, IsIdempotent) {
+  for (unsigned width : {20u, 40u, 80u, 120u}) {
+    FormatOptions options;
+    options.width = width;
+    for (const char *source : CORPUS) {
+      std::string once = format(source, options);
+      EXPECT_EQ(format(once, options), once) << "width " << width;
+      EXPECT_FALSE(hasTrailingWhitespace(once)) << once;
+    }
+  }
+}
+
+TEST(FormatterTest, PrintsCanonicalLayout) {
+  EXPECT_EQ(format("fn add(x i32,y i32)i32{return x+y;}"),
+            "fn add(x: i32, y: i32) i32 {\n    return x + y;\n}\n");
+  EXPECT_EQ(format("if (a) {} else { b(); }"),
+            "if (a) {} else {\n    b();\n}\n");
+  EXPECT_EQ(format(""), "");
+}
+
+TEST(FormatterTest, BreaksLongLines) {
+  FormatOptions options;
+  options.width = 30;
+  EXPECT_EQ(format("call(first, second, third, fourth);", options),
+            "call(\n    first,\n    second,\n    third,\n    fourth\n);\n");
+  EXPECT_EQ(format("let total = alpha + beta + gamma + delta;", options),
+            "let total = alpha +\n    beta +\n    gamma +\n    delta;\n");
+}
+
+TEST(FormatterTest, KeepsCommentsAndBlankLines) {
+  std::string source = "// header\n"
+                       "/* block\n   comment */\n"
+                       "\n\n\n"
+                       "let a = 1;   // trailing\n"
+                       "fn f() {\n"
+                       "  // inside\n"
+                       "  g();\n"
+                       "\n"
+                       "  h(); /* after /* nested */ */\n"
+                       "  // last\n"
+                       "}\n"
+                       "// end\n";
+  std::string expected = "// header\n"
+                         "/* block\n   comment */\n"
+                         "\n"
+                         "let a = 1; // trailing\n"
+                         "fn f() {\n"
+                         "    // inside\n"
+                         "    g();\n"
+                         "\n"
+                         "    h(); /* after /* nested */ */\n"
+                         "    // last\n"
+                         "}\n"
+                         "// end\n";
+  std::string formatted = format(source);
+  EXPECT_EQ(formatted, expected);
+  EXPECT_EQ(format(formatted), formatted);
+}
+
+TEST(FormatterTest, MovesCommentsOutOfExpressions) {
+  std::string formatted = format("f(a, // first\n  b);\ng();");
+  EXPECT_EQ(formatted, "f(a, b); // first\ng();\n");
+  EXPECT_EQ(format(formatted), formatted);
+}
+
+TEST(FormatterTest, RejectsInvalidSources) {
+  std::string out = "unchanged";
+  EXPECT_FALSE(formatSource("let = ;", out));
+  EXPECT_EQ(out, "unchanged");
+}
+
+TEST(FormatterTest, FormatsFilesInParallel) {
+  auto root = std::filesystem::temp_directory_path() / "ml_format_test";
+  std::filesystem::remove_all(root);
+  std::filesystem::create_directories(root);
+  std::vector<std::string> sources;
+  for (int i = 0; i < 8; i++) {
+    auto path = root / ("file" + std::to_string(i) + ".ml");
+    std::ofstream(path) << (i % 2 == 0 ? "let x=1;" : "let x = 1;\n");
+    sources.push_back(path.string());
+  }
+  auto invalid = root / "invalid.ml";
+  std::ofstream(invalid) << "let = ;";
+  sources.push_back(invalid.string());
+
+  FormatOptions options;
+  auto check = formatFiles(sources, options, false, 4);
+  EXPECT_EQ(check.files, 9u);
+  EXPECT_EQ(check.changed, 4u);
+  EXPECT_EQ(check.failed, 1u);
+  ASSERT_EQ(check.changes.size(), 4u);
+  EXPECT_EQ(check.changes[0], sources[0]);
+
+  auto written = formatFiles(sources, options, true, 4);
+  EXPECT_EQ(written.changed, 4u);
+  auto again = formatFiles(sources, options, false, 4);
+  EXPECT_EQ(again.changed, 0u);
+  for (const auto &entry : std::filesystem::directory_iterator(root)) {
+    EXPECT_NE(entry.path().extension(), ".tmp");
+  }
+
+  std::ifstream stream(sources[0]);
+  std::string content((std::istreambuf_iterator<char>(stream)),
+                      std::istreambuf_iterator<char>());
+  EXPECT_EQ(content, "let x = 1;\n");
+  std::filesystem::remove_all(root);
+}
+
+TEST(MinifierTest, PreservesTheAst) {
+  for (const char *source : CORPUS) {
+    std::string minified = minify(source);
+    auto before = parse(source);
+    auto after = parse(minified);
+    ASSERT_NE(before, nullptr);
+    ASSERT_NE(after, nullptr);
+    EXPECT_TRUE(ml::ast::structurallyEqual(*before, *after))
+        << source << "\n---\n"
+        << minified;
+    EXPECT_LT(minified.size(), std::string(source).size()) << minified;
+  }
+}
+
+TEST(MinifierTest, IsIdempotent) {
+  for (bool rename : {false, true}) {
+    MinifyOptions options;
+    options.rename = rename;
+    for (const char *source : CORPUS) {
+      std::string once = minify(source, options);
+      EXPECT_EQ(minify(once, options), once) << "rename " << rename;
+      EXPECT_NE(parse(once), nullptr);
+    }
+  }
+}
+
+TEST(MinifierTest, KeepsTokensApart) {
+  EXPECT_EQ(minify("- -x;\nx = -1;\ny = a - -b;"),
+            "- -x;x= -1;y=a- -b;");
+  EXPECT_EQ(minify("let s = \"two  spaces \";\nreturn s;"),
+            "let s=\"two  spaces \";return s;");
+  EXPECT_EQ(minify("// comment\nfor (x in xs) { /* gone */ f(x); }"),
+            "for(x in xs){f(x);}");
+}
+
+TEST(MinifierTest, RenamesOnlyLocals) {
+  MinifyOptions options;
+  options.rename = true;
+  // The global keeps its name, and no local is renamed to it.
+  EXPECT_EQ(minify("let a = 1;\nfn f(count: i32) i32 { let total = count + "
+                   "a; return total; }",
+                   options),
+            "let a=1;fn f(b:i32)i32{let c=b+a;return c;}");
+  // An initializer does not see the variable it declares.
+  EXPECT_EQ(minify("fn g() { let x = x; }", options), "fn g(){let a=x;}");
+  // Fields are reached through members and keep their names.
+  EXPECT_EQ(minify("cls C { let n: i32; fn m(n: i32) { this.n = n; } }",
+                   options),
+            "cls C{let n:i32;fn m(a:i32){this.n=a;}}");
+  // The most used local gets the shortest name.
+  EXPECT_EQ(minify("fn h(p: i32) { let q = 1; q = q + q; }", options),
+            "fn h(b:i32){let a=1;a=a+a;}");
+}
+
+TEST(MinifierTest, MinifiesFilesIntoADirectory) {
+  auto root = std::filesystem::temp_directory_path() / "ml_minify_test";
+  std::filesystem::remove_all(root);
+  std::filesystem::create_directories(root / "src");
+  std::vector<std::string> sources;
+  for (int i = 0; i < 4; i++) {
+    auto path = root / "src" / ("file" + std::to_string(i) + ".ml");
+    std::ofstream(path) << "fn f(value: i32) {\n    return value;\n}\n";
+    sources.push_back(path.string());
+  }
+  auto invalid = root / "src" / "invalid.ml";
+  std::ofstream(invalid) << "let = ;";
+  sources.push_back(invalid.string());
+
+  MinifyOptions options;
+  options.rename = true;
+  auto out = root / "out";
+  auto summary = minifyFiles(sources, options, out.string(), 2);
+  EXPECT_EQ(summary.files, 5u);
+  EXPECT_EQ(summary.failed, 1u);
+  ASSERT_EQ(summary.errors.size(), 1u);
+  EXPECT_EQ(summary.errors[0], invalid.string());
+  std::string expected = "fn f(a:i32){return a;}";
+  EXPECT_EQ(summary.output_bytes, 4 * expected.size());
+  EXPECT_LT(summary.output_bytes, summary.input_bytes);
+
+  auto target = out / std::filesystem::path(sources[0]).relative_path();
+  std::ifstream stream(target);
+  std::string content((std::istreambuf_iterator<char>(stream)),
+                      std::istreambuf_iterator<char>());
+  EXPECT_EQ(content, expected);
+  std::filesystem::remove_all(root);
+}
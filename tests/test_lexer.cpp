@@ -1,4 +1,5 @@
 #include "ml/lexer/lexer.h"
+#include "ml/lexer/literal.h"
 #include "ml/lexer/token.h"
 #include <gtest/gtest.h>
 #include <memory>
@@ -103,6 +104,43 @@ TEST_F(LexerTest, SingleFloat) {
   EXPECT_EQ(tokens.back()->kind, TokenKind::Eof);
 }
 
+TEST_F(LexerTest, ExtendedNumericLiterals) {
+  std::string source = "0xFF 0b101 1_000_000 2.5e-3 42i64 3.0f32 0..10";
+  Lexer lexer(source);
+  auto tokens = lexer.lex(source);
+
+  ASSERT_EQ(tokens.size(), 10);
+  expectToken(tokens[0], TokenKind::Integer, "0xFF");
+  EXPECT_EQ(tokens[0]->number.integer, 255);
+  expectToken(tokens[1], TokenKind::Integer, "0b101");
+  EXPECT_EQ(tokens[1]->number.integer, 5);
+  expectToken(tokens[2], TokenKind::Integer, "1_000_000");
+  EXPECT_EQ(tokens[2]->number.integer, 1000000);
+  expectToken(tokens[3], TokenKind::Float, "2.5e-3");
+  EXPECT_DOUBLE_EQ(tokens[3]->number.real, 0.0025);
+  expectToken(tokens[4], TokenKind::Integer, "42i64");
+  EXPECT_EQ(tokens[4]->number.suffix, ml::basic::NumberSuffix::I64);
+  expectToken(tokens[5], TokenKind::Float, "3.0f32");
+  EXPECT_EQ(tokens[5]->number.suffix, ml::basic::NumberSuffix::F32);
+  expectToken(tokens[6], TokenKind::Integer, "0");
+  expectToken(tokens[7], TokenKind::Operator, "..");
+  expectToken(tokens[8], TokenKind::Integer, "10");
+  EXPECT_EQ(lexer.errors(), 0);
+}
+
+TEST_F(LexerTest, NumericLiteralOutOfRange) {
+  testing::internal::CaptureStderr();
+  std::string source = "300u8 99999999999999999999";
+  Lexer lexer(source);
+  auto tokens = lexer.lex(source);
+  std::string stderr_output = testing::internal::GetCapturedStderr();
+
+  ASSERT_EQ(tokens.size(), 3);
+  expectToken(tokens[0], TokenKind::Integer, "300u8");
+  EXPECT_EQ(lexer.errors(), 2);
+  EXPECT_NE(stderr_output.find("Invalid numeric literal"), std::string::npos);
+}
+
 TEST_F(LexerTest, SingleIdentifier) {
   Lexer lexer("identifier");
   auto tokens = lexer.lex("identifier");
@@ -203,6 +241,139 @@ TEST_F(LexerTest, MixedTokenTypes) {
   expectToken(tokens[4], TokenKind::Delimiter, ";");
 }
 
+TEST_F(LexerTest, TaskKeywords) {
+  Lexer lexer("spawn await spawned");
+  auto tokens = lexer.lex("spawn await spawned");
+
+  ASSERT_GE(tokens.size(), 4);
+  expectToken(tokens[0], TokenKind::Keyword, "spawn");
+  expectToken(tokens[1], TokenKind::Keyword, "await");
+  expectToken(tokens[2], TokenKind::Identifier, "spawned");
+}
+
+TEST_F(LexerTest, CommentsAreSkipped) {
+  std::string source = "let x = 1; // one\n"
+                       "/* block\n   comment */ let y = 2 / x;\n"
+                       "//\n"
+                       "z // at end";
+  Lexer lexer(source);
+  auto tokens = lexer.lex(source);
+
+  ASSERT_EQ(tokens.size(), 14);
+  expectToken(tokens[5], TokenKind::Keyword, "let");
+  EXPECT_EQ(tokens[5]->start.line, 3);
+  EXPECT_EQ(tokens[5]->start.column, 15);
+  expectToken(tokens[9], TokenKind::Operator, "/");
+  expectToken(tokens[12], TokenKind::Identifier, "z");
+  EXPECT_EQ(tokens[12]->start.line, 5);
+  EXPECT_EQ(tokens[12]->start.column, 1);
+  EXPECT_EQ(tokens[13]->kind, TokenKind::Eof);
+  EXPECT_EQ(lexer.errors(), 0);
+}
+
+TEST_F(LexerTest, BlockCommentsNest) {
+  std::string source = "a /* outer /* inner */ still outer */ b /*/ x */ c";
+  Lexer lexer(source);
+  auto tokens = lexer.lex(source);
+
+  ASSERT_EQ(tokens.size(), 4);
+  expectToken(tokens[0], TokenKind::Identifier, "a");
+  expectToken(tokens[1], TokenKind::Identifier, "b");
+  expectToken(tokens[2], TokenKind::Identifier, "c");
+}
+
+TEST_F(LexerTest, UnterminatedBlockComment) {
+  testing::internal::CaptureStderr();
+  std::string source = "a /* open /* nested */";
+  Lexer lexer(source);
+  auto tokens = lexer.lex(source);
+  std::string stderr_output = testing::internal::GetCapturedStderr();
+
+  ASSERT_EQ(tokens.size(), 2);
+  EXPECT_EQ(tokens[1]->kind, TokenKind::Eof);
+  EXPECT_EQ(lexer.errors(), 1);
+  EXPECT_NE(stderr_output.find("Unterminated block comment"),
+            std::string::npos);
+}
+
+TEST_F(LexerTest, CommentEndMatchesTheLexer) {
+  std::string_view source = "/* a /* b */ c */ x // line\ny /*/ open";
+  EXPECT_EQ(blockCommentEnd(source, 0), 17);
+  EXPECT_EQ(commentEnd(source, 0), 17);
+  EXPECT_EQ(commentEnd(source, 20), 27);
+  EXPECT_EQ(blockCommentEnd(source, 30), std::string::npos);
+  EXPECT_EQ(commentEnd(source, 30), source.size());
+}
+
+TEST_F(LexerTest, DocCommentsAreOptIn) {
+  std::string source = "/// Adds.\n//// rule\nfn add() {}\n"
+                       "/** Point. */ /*** banner */ rec Point {}";
+  Lexer plain(source);
+  plain.lex(source);
+  EXPECT_TRUE(plain.docComments().empty());
+
+  Lexer lexer(source);
+  lexer.keepDocComments(true);
+  auto tokens = lexer.lex(source);
+  const auto &docs = lexer.docComments();
+  ASSERT_EQ(docs.size(), 2);
+  EXPECT_EQ(docs[0].text, "/// Adds.");
+  EXPECT_EQ(docs[0].token, 0);
+  EXPECT_EQ(docs[0].start.line, 1);
+  EXPECT_EQ(docs[1].text, "/** Point. */");
+  EXPECT_EQ(docs[1].start.line, 4);
+  ASSERT_LT(docs[1].token, tokens.size());
+  expectToken(tokens[docs[1].token], TokenKind::Keyword, "rec");
+}
+
+TEST_F(LexerTest, UnicodeIdentifiers) {
+  std::string source =
+      "let \xCF\x80 = 3; let na\xC3\xAFve_2 = \"\xE2\x82\xAC\";";
+  Lexer lexer(source);
+  auto tokens = lexer.lex(source);
+
+  ASSERT_EQ(tokens.size(), 11);
+  expectToken(tokens[1], TokenKind::Identifier, "\xCF\x80");
+  expectToken(tokens[6], TokenKind::Identifier, "na\xC3\xAFve_2");
+  expectToken(tokens[8], TokenKind::String, "\"\xE2\x82\xAC\"");
+  EXPECT_EQ(lexer.errors(), 0);
+}
+
+TEST_F(LexerTest, InvalidUtf8) {
+  testing::internal::CaptureStderr();
+  std::string source = "let a = 1;\nlet b\xFF = 2;";
+  Lexer lexer(source);
+  lexer.lex(source);
+  std::string stderr_output = testing::internal::GetCapturedStderr();
+
+  EXPECT_GE(lexer.errors(), 1);
+  EXPECT_NE(stderr_output.find("Invalid UTF-8"), std::string::npos);
+  EXPECT_NE(stderr_output.find("<input>:2:"), std::string::npos);
+}
+
+TEST_F(LexerTest, TriviaReproducesSource) {
+  std::string source = "  // header\nfn f(a: i32) {\r\n\treturn a+1; /* c */\n}"
+                       "\n\n/// trailing\n";
+  Lexer plain(source);
+  plain.lex(source);
+  EXPECT_TRUE(plain.trivia().empty());
+
+  Lexer lexer(source);
+  lexer.keepTrivia(true);
+  auto tokens = lexer.lex(source);
+  ASSERT_EQ(lexer.trivia().size(), tokens.size());
+  EXPECT_EQ(lexer.leadingTrivia(0), "  // header\n");
+  EXPECT_EQ(lexer.leadingTrivia(1), " ");
+  EXPECT_EQ(lexer.leadingTrivia(tokens.size() - 1), "\n\n/// trailing\n");
+
+  std::string rebuilt;
+  for (size_t i = 0; i < tokens.size(); i++) {
+    rebuilt += lexer.leadingTrivia(i);
+    rebuilt += tokens[i]->value;
+  }
+  EXPECT_EQ(rebuilt, source);
+}
+
 TEST_F(LexerTest, BooleanLiterals) {
   Lexer lexer("true false");
   auto tokens = lexer.lex("true false");
@@ -249,6 +420,82 @@ TEST_F(LexerTest, EscapedCharacterLiteral) {
   expectToken(tokens[0], TokenKind::Character, "'\\n'");
 }
 
+TEST_F(LexerTest, EscapedQuotesStayInsideStrings) {
+  std::string source = "\"say \\\"hi\\\"\" \"back\\\\\" x";
+  Lexer lexer(source);
+  auto tokens = lexer.lex(source);
+
+  ASSERT_EQ(tokens.size(), 4);
+  expectToken(tokens[0], TokenKind::String, "\"say \\\"hi\\\"\"");
+  expectToken(tokens[1], TokenKind::String, "\"back\\\\\"");
+  expectToken(tokens[2], TokenKind::Identifier, "x");
+  EXPECT_EQ(lexer.errors(), 0);
+}
+
+TEST_F(LexerTest, LongStringLiteral) {
+  std::string body(100000, 'a');
+  body[500] = '\n';
+  body[70001] = '\\';
+  body[70002] = 'n';
+  std::string source = "\"" + body + "\" z";
+  Lexer lexer(source);
+  auto tokens = lexer.lex(source);
+
+  ASSERT_EQ(tokens.size(), 3);
+  EXPECT_EQ(tokens[0]->value.size(), body.size() + 2);
+  expectToken(tokens[1], TokenKind::Identifier, "z");
+  EXPECT_EQ(tokens[1]->start.line, 2);
+  EXPECT_EQ(lexer.errors(), 0);
+}
+
+TEST_F(LexerTest, InvalidEscapeSequence) {
+  testing::internal::CaptureStderr();
+  std::string source = "\"a\\qb\" '\\u{110000}'";
+  Lexer lexer(source);
+  auto tokens = lexer.lex(source);
+  std::string stderr_output = testing::internal::GetCapturedStderr();
+
+  ASSERT_GE(tokens.size(), 2);
+  expectToken(tokens[0], TokenKind::String, "\"a\\qb\"");
+  EXPECT_EQ(lexer.errors(), 2);
+  EXPECT_NE(stderr_output.find("Invalid escape sequence"), std::string::npos);
+}
+
+TEST_F(LexerTest, UnicodeCharacterLiterals) {
+  std::string source = "'\xC3\xA9' '\\u{1F600}' '\\x41'";
+  Lexer lexer(source);
+  auto tokens = lexer.lex(source);
+
+  ASSERT_EQ(tokens.size(), 4);
+  expectToken(tokens[0], TokenKind::Character, "'\xC3\xA9'");
+  expectToken(tokens[1], TokenKind::Character, "'\\u{1F600}'");
+  expectToken(tokens[2], TokenKind::Character, "'\\x41'");
+  EXPECT_EQ(lexer.errors(), 0);
+}
+
+TEST_F(LexerTest, DecodeLiteral) {
+  std::string storage;
+  std::string_view payload;
+  std::string plain = "\"no escapes\"";
+  ASSERT_TRUE(decodeLiteral(plain, storage, payload));
+  EXPECT_EQ(payload, "no escapes");
+  EXPECT_EQ(payload.data(), plain.data() + 1); // Points into the source
+  EXPECT_TRUE(storage.empty());
+
+  ASSERT_TRUE(decodeLiteral("\"a\\nb\\\\\\\"\\x41\\u{E9}\\0\"", storage,
+                            payload));
+  EXPECT_EQ(payload, std::string_view("a\nb\\\"A\xC3\xA9\0", 9));
+  ASSERT_TRUE(decodeLiteral("'\\''", storage, payload));
+  EXPECT_EQ(payload, "'");
+
+  size_t offset = 0;
+  EXPECT_FALSE(decodeLiteral("\"ab\\q\"", storage, payload, &offset));
+  EXPECT_EQ(offset, 3);
+  EXPECT_FALSE(decodeLiteral("\"\\u{D800}\"", storage, payload));
+  EXPECT_FALSE(decodeLiteral("\"\\x80\"", storage, payload));
+  EXPECT_FALSE(decodeLiteral("\"open", storage, payload));
+}
+
 // Error Handling Tests
 TEST_F(LexerTest, UnterminatedStringLiteral) {
   // Capture stderr to check if error is reported
@@ -324,9 +571,27 @@ TEST_F(LexerTest, UnterminatedCharacterLiteralEmpty) {
 
   ASSERT_GE(tokens.size(), 2);
   expectToken(tokens[0], TokenKind::Character, "'");
+  EXPECT_EQ(tokens[0]->end.index, 1);
 
   EXPECT_NE(stderr_output.find("Unterminated character literal"),
             std::string::npos);
+  EXPECT_EQ(stderr_output.find("Empty character literal"), std::string::npos);
+}
+
+TEST_F(LexerTest, UnterminatedCharacterLiteralKeepsTriviaInSource) {
+  testing::internal::CaptureStderr();
+  std::string source = "a = '";
+  Lexer lexer(source);
+  lexer.keepTrivia(true);
+  auto tokens = lexer.lex(source);
+  testing::internal::GetCapturedStderr();
+
+  ASSERT_EQ(tokens.size(), lexer.trivia().size());
+  for (size_t i = 0; i < tokens.size(); i++) {
+    EXPECT_LE(tokens[i]->end.index, source.size());
+    EXPECT_LE(lexer.trivia()[i].offset + lexer.trivia()[i].length,
+              source.size());
+  }
 }
 
 TEST_F(LexerTest, UnterminatedEscapedCharacterLiteral) {
@@ -0,0 +1,456 @@
+#include "ml/analysis/purity.h"
+#include "ml/opt/optimizer.h"
+#include "ml/opt/rewrite.h"
+#include "ml/parser/parser.h"
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+using namespace ml::ast;
+using namespace ml::opt;
+
+class OptimizerTest : public ::testing::Test {
+protected:
+  // Helper function to parse a well-formed program
+  std::unique_ptr<Program> parseSource(const std::string &source) {
+    ml::parser::Parser parser;
+    auto program = parser.parse(source);
+    EXPECT_NE(program, nullptr);
+    EXPECT_EQ(parser.errors(), 0);
+    return program;
+  }
+
+  // Helper function to get the statements of the first function's body
+  std::vector<std::unique_ptr<Statement>> &body(Program &program,
+                                                size_t index = 0) {
+    auto *function =
+        dynamic_cast<FunctionDeclaration *>(program.statements[index].get());
+    EXPECT_NE(function, nullptr);
+    return function->body->statements;
+  }
+
+  // Helper function to run common subexpression elimination alone, so the
+  // unused functions of a test program are kept
+  OptimizerStatistics optimizeCse(Program &program) {
+    OptimizerOptions options;
+    options.dce = false;
+    return optimize(program, options);
+  }
+
+  // Helper function to count the nodes of a tag below a node
+  size_t count(const Node &root, NodeTag tag) {
+    size_t total = 0;
+    for (const Node &node : preOrder(root)) {
+      total += node.tag() == tag;
+    }
+    return total;
+  }
+};
+
+TEST_F(OptimizerTest, PurityFindsPureFunctions) {
+  auto program = parseSource(R"(
+    fn square(x: int) int { let y: int = x * x; return y; }
+    fn twice(x: int) int { return square(x) + square(x); }
+    fn shout(x: int) { outputln(x); }
+    fn store(a: int[], x: int) { a[0] = x; }
+    fn even(n: int) bool { if n == 0 { return true; } return odd(n - 1); }
+    fn odd(n: int) bool { if n == 0 { return false; } return even(n - 1); }
+  )");
+  ml::analysis::PurityAnalysis purity(*program);
+  EXPECT_TRUE(purity.isPureFunction("square"));
+  EXPECT_TRUE(purity.isPureFunction("twice"));
+  EXPECT_FALSE(purity.isPureFunction("shout"));
+  EXPECT_FALSE(purity.isPureFunction("store"));
+  EXPECT_TRUE(purity.isPureFunction("even"));
+  EXPECT_TRUE(purity.isPureFunction("odd"));
+  EXPECT_FALSE(purity.isPureFunction("outputln"));
+}
+
+TEST_F(OptimizerTest, CseSharesRepeatedIndexing) {
+  auto program = parseSource("fn f(a: int[], i: int) int { "
+                             "let x: int = a[i] * a[i] + a[i]; return x; }");
+  auto statistics = optimizeCse(*program);
+  EXPECT_EQ(statistics.cse.temporaries, 1);
+  EXPECT_EQ(statistics.cse.eliminated, 2);
+
+  auto &statements = body(*program);
+  ASSERT_EQ(statements.size(), 3);
+  auto *temporary = dynamic_cast<VariableDeclaration *>(statements[0].get());
+  ASSERT_NE(temporary, nullptr);
+  EXPECT_EQ(temporary->identifier->name, "__cse0");
+  EXPECT_EQ(temporary->initializer->tag(), NodeTag::IndexExpression);
+  EXPECT_EQ(count(*statements[1], NodeTag::IndexExpression), 0);
+}
+
+TEST_F(OptimizerTest, CsePrefersLargestSubexpression) {
+  auto program = parseSource("fn f(a: int, b: int) int { "
+                             "return (a + b) * 2 - (a + b) * 2; }");
+  auto statistics = optimizeCse(*program);
+  EXPECT_EQ(statistics.cse.temporaries, 1);
+  EXPECT_EQ(statistics.cse.eliminated, 1);
+
+  auto &statements = body(*program);
+  auto *temporary = dynamic_cast<VariableDeclaration *>(statements[0].get());
+  ASSERT_NE(temporary, nullptr);
+  auto *product =
+      dynamic_cast<BinaryExpression *>(temporary->initializer.get());
+  ASSERT_NE(product, nullptr);
+  EXPECT_EQ(product->op, "*");
+}
+
+TEST_F(OptimizerTest, CseSharesPureCallsOnly) {
+  auto program = parseSource(R"(
+    fn sq(x: int) int { return x * x; }
+    fn f(x: int) int { return sq(x) + sq(x); }
+    fn g(x: int) { outputln(x); outputln(x); }
+    fn h(x: int) int { let y: int = next(x) + next(x); return y; }
+  )");
+  auto statistics = optimizeCse(*program);
+  EXPECT_EQ(statistics.cse.temporaries, 1);
+  EXPECT_EQ(body(*program, 1).size(), 2);
+  EXPECT_EQ(body(*program, 2).size(), 2);
+  EXPECT_EQ(body(*program, 3).size(), 2);
+}
+
+TEST_F(OptimizerTest, CseKeepsSideEffectsAndShortCircuits) {
+  auto program = parseSource(R"(
+    fn f(a: int[], i: int) bool {
+      a[i] = a[i] + a[i]++;
+      let b: bool = i < 10 && a[i] > 0 && a[i] < 5;
+      return b;
+    }
+  )");
+  auto statistics = optimizeCse(*program);
+  EXPECT_EQ(statistics.cse.eliminated, 0);
+  EXPECT_EQ(body(*program).size(), 3);
+}
+
+TEST_F(OptimizerTest, CseAvoidsExistingNames) {
+  auto program = parseSource("fn f(__cse0: int) int { "
+                             "return (__cse0 + 1) * (__cse0 + 1); }");
+  optimizeCse(*program);
+  auto *temporary =
+      dynamic_cast<VariableDeclaration *>(body(*program)[0].get());
+  ASSERT_NE(temporary, nullptr);
+  EXPECT_EQ(temporary->identifier->name, "__cse1");
+}
+
+TEST_F(OptimizerTest, DceRemovesStatementsAfterJumps) {
+  auto program = parseSource(R"(
+    fn pub f(x: int) int {
+      while x > 0 {
+        if x == 5 { break; x = 1; } else { continue; }
+        x = x - 1;
+      }
+      return x;
+      outputln(x);
+      x = 2;
+    }
+  )");
+  OptimizerOptions options;
+  options.loops = false;
+  auto statistics = optimize(*program, options);
+  EXPECT_EQ(statistics.dce.unreachable, 4);
+  EXPECT_EQ(statistics.diagnostics.size(), 3);
+
+  auto &statements = body(*program);
+  ASSERT_EQ(statements.size(), 2);
+  EXPECT_EQ(statements[1]->tag(), NodeTag::ReturnStatement);
+  auto *loop = dynamic_cast<WhileConditional *>(statements[0].get());
+  ASSERT_NE(loop, nullptr);
+  EXPECT_EQ(loop->then_branch->statements.size(), 1);
+  auto *branch =
+      dynamic_cast<IfConditional *>(loop->then_branch->statements[0].get());
+  ASSERT_NE(branch, nullptr);
+  EXPECT_EQ(branch->then_branch->statements.size(), 1);
+}
+
+TEST_F(OptimizerTest, DceRemovesStatementsAfterEndlessLoopsAndSwitches) {
+  auto program = parseSource(R"(
+    fn pub f(x: int) int {
+      switch (x) { case 1 { return 1; } default { return 2; } }
+      x = 1;
+    }
+    fn pub g(x: int) int {
+      while (true) { x = x + 1; }
+      return x;
+    }
+    fn pub h(x: int) int {
+      while (true) { if x > 5 { break; } }
+      return x;
+    }
+  )");
+  OptimizerOptions options;
+  options.loops = false;
+  auto statistics = optimize(*program, options);
+  EXPECT_EQ(statistics.dce.unreachable, 2);
+  EXPECT_EQ(body(*program, 0).size(), 1);
+  EXPECT_EQ(body(*program, 1).size(), 1);
+  EXPECT_EQ(body(*program, 2).size(), 2);
+}
+
+TEST_F(OptimizerTest, DceResolvesConstantConditions) {
+  auto program = parseSource(R"(
+    fn pub f(x: int) {
+      if false { outputln(1); }
+      if false { outputln(2); } elif x > 0 { outputln(3); } else { x = 0; }
+      if x < 0 { outputln(4); } elif true { outputln(5); } else { x = 1; }
+      if true { outputln(6); } else { outputln(7); }
+      while false { x = x + 1; }
+    }
+  )");
+  auto statistics = optimize(*program);
+  EXPECT_EQ(statistics.dce.branches, 5);
+
+  auto &statements = body(*program);
+  ASSERT_EQ(statements.size(), 3);
+  auto *promoted = dynamic_cast<IfConditional *>(statements[0].get());
+  ASSERT_NE(promoted, nullptr);
+  EXPECT_EQ(promoted->condition->tag(), NodeTag::BinaryExpression);
+  EXPECT_NE(promoted->else_branch, nullptr);
+  auto *folded = dynamic_cast<IfConditional *>(statements[1].get());
+  ASSERT_NE(folded, nullptr);
+  EXPECT_TRUE(folded->elif_branches.empty());
+  ASSERT_NE(folded->else_branch, nullptr);
+  EXPECT_EQ(count(*folded->else_branch, NodeTag::CallExpression), 1);
+  EXPECT_EQ(statements[2]->tag(), NodeTag::BlockStatement);
+}
+
+TEST_F(OptimizerTest, DceRemovesUnusedPrivateDeclarations) {
+  auto program = parseSource(R"(
+    fn helper(x: int) int { return helper(x - 1); }
+    fn used() int { return 1; }
+    fn caller() int { return leaf(); }
+    fn leaf() int { return 2; }
+    fn pub api() int { return used(); }
+    fn main() { outputln(api()); }
+    cls Counter {
+      let count: int = 0;
+      let spare: int = 1;
+      let logged: int = log(1);
+      fn pub get() int { return count; }
+      fn reset() { count = 0; }
+    }
+  )");
+  auto statistics = optimize(*program);
+  EXPECT_EQ(statistics.dce.functions, 3);
+  EXPECT_EQ(statistics.dce.members, 2);
+
+  std::vector<std::string> names;
+  for (const auto &statement : program->statements) {
+    names.push_back(
+        static_cast<Declaration &>(*statement).identifier->name);
+  }
+  EXPECT_EQ(names, (std::vector<std::string>{"used", "api", "main",
+                                             "Counter"}));
+  auto &counter = static_cast<ClassDeclaration &>(*program->statements[3]);
+  ASSERT_EQ(counter.fields.size(), 2);
+  EXPECT_EQ(counter.fields[0]->identifier->name, "count");
+  EXPECT_EQ(counter.fields[1]->identifier->name, "logged");
+  ASSERT_EQ(counter.methods.size(), 1);
+  EXPECT_EQ(counter.methods[0]->identifier->name, "get");
+}
+
+TEST_F(OptimizerTest, LicmHoistsInvariantArithmetic) {
+  auto program = parseSource(R"(
+    fn pub f(a: i32[], n: i32, m: i32) {
+      let i: i32 = 0;
+      while i < n * m {
+        a[i] = (n + m) * 2 + i + a[n + 1] / m + (n + m) * 2;
+        i = i + 1;
+      }
+    }
+  )");
+  auto statistics = optimize(*program);
+  EXPECT_EQ(statistics.loops.loops, 1);
+  EXPECT_EQ(statistics.loops.hoisted, 4);
+
+  auto &statements = body(*program);
+  ASSERT_EQ(statements.size(), 5);
+  std::vector<std::string> hoisted;
+  for (size_t i = 1; i < 4; i++) {
+    auto *temporary = dynamic_cast<VariableDeclaration *>(statements[i].get());
+    ASSERT_NE(temporary, nullptr);
+    hoisted.push_back(temporary->identifier->name);
+  }
+  EXPECT_EQ(hoisted,
+            (std::vector<std::string>{"__licm0", "__licm1", "__licm2"}));
+  auto &loop = static_cast<WhileConditional &>(*statements[4]);
+  EXPECT_EQ(loop.condition->tag(), NodeTag::BinaryExpression);
+  // The division stays in the loop, but its index was hoisted.
+  EXPECT_EQ(count(*loop.then_branch, NodeTag::IndexExpression), 2);
+  EXPECT_EQ(count(*loop.then_branch, NodeTag::BinaryExpression), 7);
+}
+
+TEST_F(OptimizerTest, LicmKeepsNamesChangedByTheLoop) {
+  auto program = parseSource(R"(
+    let total: i32 = 0;
+    fn bump() { total = total + 1; }
+    fn pub f(n: i32) {
+      let i: i32 = 0;
+      while i < n {
+        let k: i32 = i + 2;
+        outputln(k + 1, total + n, n + 1);
+        bump();
+        i++;
+      }
+    }
+  )");
+  auto statistics = optimize(*program);
+  EXPECT_EQ(statistics.loops.hoisted, 1);
+  auto &statements = body(*program, 2);
+  ASSERT_EQ(statements.size(), 3);
+  auto *temporary = dynamic_cast<VariableDeclaration *>(statements[1].get());
+  ASSERT_NE(temporary, nullptr);
+  auto *sum = dynamic_cast<BinaryExpression *>(temporary->initializer.get());
+  ASSERT_NE(sum, nullptr);
+  EXPECT_EQ(static_cast<IdentifierExpression &>(*sum->left).name, "n");
+}
+
+TEST_F(OptimizerTest, StrengthReducesWhileInduction) {
+  auto program = parseSource(R"(
+    fn pub f(a: i32[], n: i32, s: i32) {
+      let i: i32 = 0;
+      while i < n {
+        if i > 3 { continue; }
+        a[i * s] = s * i;
+        i = i + 2;
+      }
+    }
+  )");
+  OptimizerOptions options;
+  options.cse = false;
+  auto statistics = optimize(*program, options);
+  EXPECT_EQ(statistics.loops.reduced, 2);
+
+  auto &statements = body(*program);
+  ASSERT_EQ(statements.size(), 4);
+  auto *reduced = dynamic_cast<VariableDeclaration *>(statements[1].get());
+  ASSERT_NE(reduced, nullptr);
+  EXPECT_EQ(reduced->identifier->name, "__sr0");
+  auto &loop = static_cast<WhileConditional &>(*statements[3]);
+  auto &inner = loop.then_branch->statements;
+  ASSERT_EQ(inner.size(), 4);
+  EXPECT_EQ(count(*loop.then_branch, NodeTag::IdentifierExpression) -
+                count(*inner[3], NodeTag::IdentifierExpression),
+            6);
+  // The step 2 * s is invariant, so it was hoisted next to __sr0.
+  auto &advance = static_cast<ExpressionStatement &>(*inner[3]);
+  auto &assignment = static_cast<BinaryExpression &>(*advance.expression);
+  EXPECT_EQ(static_cast<IdentifierExpression &>(*assignment.left).name,
+            "__sr0");
+  EXPECT_EQ(count(*inner[3], NodeTag::BinaryExpression), 2);
+}
+
+TEST_F(OptimizerTest, StrengthReducesForCounter) {
+  auto program = parseSource(R"(
+    fn pub f(a: i32[], n: i32) {
+      for (let j: i32 = 1; j < n; j++) {
+        if j == 2 { continue; }
+        a[j * 4] = j * 4;
+      }
+      for (let k = 0; k < n; k++) { k = k + 1; a[k * 2] = 0; }
+    }
+  )");
+  auto statistics = optimize(*program);
+  EXPECT_EQ(statistics.loops.reduced, 2);
+
+  auto &statements = body(*program);
+  ASSERT_EQ(statements.size(), 3);
+  auto *reduced = dynamic_cast<VariableDeclaration *>(statements[0].get());
+  ASSERT_NE(reduced, nullptr);
+  auto *start = dynamic_cast<LiteralExpression *>(reduced->initializer.get());
+  ASSERT_NE(start, nullptr);
+  EXPECT_EQ(start->value, "0");
+  auto &loop = static_cast<ForConditional &>(*statements[1]);
+  auto &advance =
+      static_cast<ExpressionStatement &>(*loop.then_branch->statements[0]);
+  auto &assignment = static_cast<BinaryExpression &>(*advance.expression);
+  auto &step = static_cast<BinaryExpression &>(*assignment.right);
+  EXPECT_EQ(step.op, "+");
+  EXPECT_EQ(static_cast<LiteralExpression &>(*step.right).value, "4");
+}
+
+TEST_F(OptimizerTest, TailCallsBecomeLoops) {
+  auto program = parseSource(R"(
+    fn pub fact(n: i32, acc: i32) i32 {
+      if n <= 1 { return acc; }
+      return fact(n - 1, acc * n);
+    }
+    fn pub count(n: i32, step: i32) {
+      if n > 0 { outputln(n); return count(n - step, step); }
+    }
+  )");
+  OptimizerOptions options;
+  options.loops = false;
+  options.cse = false;
+  auto statistics = optimize(*program, options);
+  EXPECT_EQ(statistics.tail_calls.functions, 2);
+  EXPECT_EQ(statistics.tail_calls.calls, 2);
+
+  auto &fact = body(*program, 0);
+  ASSERT_EQ(fact.size(), 1);
+  auto *loop = dynamic_cast<WhileConditional *>(fact[0].get());
+  ASSERT_NE(loop, nullptr);
+  EXPECT_EQ(count(*loop, NodeTag::CallExpression), 0);
+  EXPECT_EQ(count(*loop, NodeTag::ContinueStatement), 1);
+  // Both parameters change, so the arguments go through temporaries.
+  auto &jump = static_cast<BlockStatement &>(*loop->then_branch->statements[1]);
+  ASSERT_EQ(jump.statements.size(), 5);
+  EXPECT_EQ(jump.statements[0]->tag(), NodeTag::VariableDeclaration);
+
+  // Only n changes; the body can fall off its end, so it gets a break.
+  auto &counter = static_cast<WhileConditional &>(*body(*program, 1)[0]);
+  auto &statements = counter.then_branch->statements;
+  ASSERT_EQ(statements.size(), 2);
+  EXPECT_EQ(statements[1]->tag(), NodeTag::BreakStatement);
+  EXPECT_EQ(count(*statements[0], NodeTag::VariableDeclaration), 0);
+  EXPECT_EQ(count(*statements[0], NodeTag::CallExpression), 1);
+}
+
+TEST_F(OptimizerTest, TailCallsKeepOtherCalls) {
+  auto program = parseSource(R"(
+    fn pub fact(n: i32) i32 {
+      if n <= 1 { return 1; }
+      return n * fact(n - 1);
+    }
+    fn pub spin(n: i32) i32 {
+      while n > 0 { return spin(n - 1); }
+      return 0;
+    }
+    fn pub other(n: i32) i32 { return fact(n, 1); }
+  )");
+  auto statistics = optimize(*program);
+  EXPECT_EQ(statistics.tail_calls.calls, 0);
+  EXPECT_EQ(count(*program, NodeTag::CallExpression), 3);
+}
+
+TEST_F(OptimizerTest, SlotsIncludeArraySizes) {
+  ArrayIdentifierExpression array(
+      ml::basic::Locus(), ml::basic::Locus(), "a",
+      std::make_unique<LiteralExpression>(ml::basic::Locus(),
+                                          ml::basic::Locus(), "4"));
+  int slots = 0;
+  forEachSlot(array, [&slots](std::unique_ptr<Expression> &) { ++slots; });
+  EXPECT_EQ(slots, 1);
+
+  auto copy = cloneExpression(array);
+  auto *copied = dynamic_cast<ArrayIdentifierExpression *>(copy.get());
+  ASSERT_NE(copied, nullptr);
+  ASSERT_NE(copied->size, nullptr);
+  EXPECT_EQ(static_cast<LiteralExpression &>(*copied->size).value, "4");
+}
+
+TEST_F(OptimizerTest, CloneRejectsAbstractExpressions) {
+  Expression expression{ml::basic::Locus(), ml::basic::Locus()};
+  EXPECT_THROW(cloneExpression(expression), std::logic_error);
+}
+
+TEST_F(OptimizerTest, DeclarationTypesAreNotSlots) {
+  auto program = parseSource("fn pub f() int { let x: int = 1; return x; }");
+  auto &statements = body(*program);
+  ASSERT_EQ(statements.size(), 2);
+  int slots = 0;
+  forEachStatementSlot(*statements[0],
+                       [&slots](std::unique_ptr<Expression> &) { ++slots; });
+  EXPECT_EQ(slots, 1);
+}
@@ -1,6 +1,10 @@
 #include "ml/ast/ast.h"
 #include "ml/basic/error.h"
 #include "ml/parser/parser.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <gtest/gtest.h>
 #include <memory>
 #include <sstream>
@@ -141,6 +145,9 @@ TEST_F(ParserTest, FunctionDeclarationWithReturnType) {
   ASSERT_NE(funcDecl, nullptr);
   EXPECT_EQ(funcDecl->identifier->name, "getValue");
   EXPECT_EQ(funcDecl->parameters.size(), 0);
+  auto *type = dynamic_cast<IdentifierExpression *>(funcDecl->type.get());
+  ASSERT_NE(type, nullptr);
+  EXPECT_EQ(type->name, "int");
 }
 
 TEST_F(ParserTest, FunctionDeclarationNoParameters) {
@@ -603,4 +610,480 @@ TEST_F(ParserTest, EmptyArrayLiteral) {
   auto *arrayExpr = dynamic_cast<ArrayExpression *>(varDecl->initializer.get());
   ASSERT_NE(arrayExpr, nullptr);
   EXPECT_EQ(arrayExpr->elements.size(), 0);
-}
\ No newline at end of file
+}
+
+// Truncated input tests
+TEST_F(ParserTest, TruncatedInputDoesNotCrash) {
+  testing::internal::CaptureStderr();
+  for (const char *source :
+       {"let", "return", "while", "x = ", "switch x {}", "|| b;", "for (",
+        "fn f() {", "if {}", "a[;"}) {
+    Parser parser;
+    EXPECT_NE(parser.parse(source), nullptr) << source;
+  }
+  testing::internal::GetCapturedStderr();
+}
+
+TEST_F(ParserTest, CountsErrors) {
+  testing::internal::CaptureStderr();
+  Parser parser;
+  parser.parse("let x = ;");
+  EXPECT_GT(parser.errors(), 0);
+  parser.parse("let x = 1;");
+  EXPECT_EQ(parser.errors(), 0);
+  testing::internal::GetCapturedStderr();
+}
+
+// Traversal tests
+TEST_F(ParserTest, NodeTags) {
+  auto program = parseSource("fn f(a: int) { return a + 1; }");
+  ASSERT_NE(program, nullptr);
+  EXPECT_EQ(program->tag(), NodeTag::Program);
+  ASSERT_EQ(program->statements.size(), 1);
+  EXPECT_EQ(program->statements[0]->tag(), NodeTag::FunctionDeclaration);
+  EXPECT_EQ(nodeTagName(NodeTag::FunctionDeclaration), "FunctionDeclaration");
+}
+
+TEST_F(ParserTest, WalkVisitsChildrenInSourceOrder) {
+  auto program = parseSource("let x: int = a + b * c;");
+  ASSERT_NE(program, nullptr);
+
+  std::vector<std::string> names;
+  walk(static_cast<const Node &>(*program), [&names](const Node &node) {
+    if (auto *identifier = dynamic_cast<const IdentifierExpression *>(&node)) {
+      names.push_back(identifier->name);
+    }
+    return true;
+  });
+  EXPECT_EQ(names, (std::vector<std::string>{"x", "int", "a", "b", "c"}));
+}
+
+TEST_F(ParserTest, WalkSkipsChildren) {
+  auto program = parseSource("fn f() { let y: int = 1; } let z: int = 2;");
+  ASSERT_NE(program, nullptr);
+
+  size_t variables = 0;
+  walk(static_cast<Node &>(*program), [&variables](Node &node) {
+    if (node.tag() == NodeTag::VariableDeclaration) {
+      variables++;
+    }
+    return node.tag() != NodeTag::FunctionDeclaration;
+  });
+  EXPECT_EQ(variables, 1);
+}
+
+// Position query tests
+TEST_F(ParserTest, NodeIndexFindsInnermostNode) {
+  std::string source = "fn f(a: int) { let x: int = a + foo(1, 2); }";
+  auto program = parseSource(source);
+  ASSERT_NE(program, nullptr);
+  NodeIndex index(*program);
+  EXPECT_GT(index.size(), 0);
+
+  auto *callee = dynamic_cast<const IdentifierExpression *>(
+      index.at(source.find("foo") + 1));
+  ASSERT_NE(callee, nullptr);
+  EXPECT_EQ(callee->name, "foo");
+
+  auto *literal =
+      dynamic_cast<const LiteralExpression *>(index.at(source.find("2")));
+  ASSERT_NE(literal, nullptr);
+  EXPECT_EQ(literal->value, "2");
+
+  // Between arguments the call itself is the innermost node.
+  EXPECT_EQ(index.at(source.find(","))->tag(), NodeTag::CallExpression);
+  // Whitespace inside the body belongs to the block.
+  EXPECT_EQ(index.at(source.find("{") + 1)->tag(), NodeTag::BlockStatement);
+  EXPECT_EQ(index.at(source.size() + 10), nullptr);
+}
+
+TEST_F(ParserTest, NodeIndexPathEndsAtRoot) {
+  std::string source = "let x: int = (1 + 2) * 3;";
+  auto program = parseSource(source);
+  ASSERT_NE(program, nullptr);
+  NodeIndex index(*program);
+
+  auto path = index.path(source.find("2"));
+  ASSERT_GE(path.size(), 3);
+  EXPECT_EQ(path.front()->tag(), NodeTag::LiteralExpression);
+  EXPECT_EQ(path.back(), program.get());
+  for (size_t i = 1; i < path.size(); i++) {
+    EXPECT_LE(path[i]->start.index, path[i - 1]->start.index);
+  }
+}
+
+// Iterator tests
+TEST_F(ParserTest, PreOrderMatchesRecursiveOrder) {
+  auto program = parseSource("fn f(a: int) { if a { g(a, 1); } }");
+  ASSERT_NE(program, nullptr);
+
+  std::vector<const Node *> recursive;
+  std::function<void(const Node &)> collect = [&](const Node &node) {
+    recursive.push_back(&node);
+    forEachChild(node, collect);
+  };
+  collect(*program);
+
+  std::vector<const Node *> iterated;
+  for (const Node &node : preOrder(static_cast<const Node &>(*program))) {
+    iterated.push_back(&node);
+  }
+  EXPECT_EQ(iterated, recursive);
+}
+
+TEST_F(ParserTest, PostOrderVisitsChildrenFirst) {
+  auto program = parseSource("let x: int = 1 + 2;");
+  ASSERT_NE(program, nullptr);
+
+  std::vector<NodeTag> tags;
+  for (const Node &node : postOrder(static_cast<const Node &>(*program))) {
+    tags.push_back(node.tag());
+  }
+  ASSERT_GE(tags.size(), 4);
+  EXPECT_EQ(tags[tags.size() - 2], NodeTag::VariableDeclaration);
+  EXPECT_EQ(tags.back(), NodeTag::Program);
+  EXPECT_EQ(tags[tags.size() - 3], NodeTag::BinaryExpression);
+}
+
+TEST_F(ParserTest, IteratorsHandleDeepTrees) {
+  // A left-nested chain of binary expressions thousands of levels deep.
+  std::string source = "let x: int = 1";
+  for (int i = 0; i < 5000; i++) {
+    source += " + 1";
+  }
+  source += ";";
+  auto program = parseSource(source);
+  ASSERT_NE(program, nullptr);
+
+  size_t literals = 0;
+  for (const Node &node : postOrder(static_cast<const Node &>(*program))) {
+    literals += node.tag() == NodeTag::LiteralExpression;
+  }
+  EXPECT_EQ(literals, 5001);
+
+  // Early exit costs nothing beyond the nodes visited.
+  size_t visited = 0;
+  for (const Node &node : preOrder(static_cast<const Node &>(*program))) {
+    visited++;
+    if (node.tag() == NodeTag::BinaryExpression) {
+      break;
+    }
+  }
+  EXPECT_LE(visited, 8);
+}
+
+// Structural hashing tests
+TEST_F(ParserTest, StructuralHashIgnoresLocations) {
+  auto a = parseSource("let x: int = a[i] * a[i] + 1;");
+  auto b = parseSource("let   x :int=a[i]*a[i]\n+1;");
+  auto c = parseSource("let x: int = a[i] * a[j] + 1;");
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  ASSERT_NE(c, nullptr);
+
+  EXPECT_EQ(structuralHash(*a), structuralHash(*b));
+  EXPECT_TRUE(structurallyEqual(*a, *b));
+  EXPECT_NE(structuralHash(*a), structuralHash(*c));
+  EXPECT_FALSE(structurallyEqual(*a, *c));
+}
+
+TEST_F(ParserTest, StructuralEqualityChecksFilledSlots) {
+  auto typed = parseSource("let x: int;");
+  auto initialized = parseSource("let x = int;");
+  ASSERT_NE(typed, nullptr);
+  ASSERT_NE(initialized, nullptr);
+  EXPECT_FALSE(structurallyEqual(*typed, *initialized));
+}
+
+TEST_F(ParserTest, HashConsingMapsTwinsToOneNode) {
+  auto program = parseSource("let y: int = a[i] * a[i] + f(a[i]);");
+  ASSERT_NE(program, nullptr);
+
+  HashConsTable table;
+  table.add(*program);
+
+  std::vector<const IndexExpression *> indexes;
+  for (const Node &node : preOrder(static_cast<const Node &>(*program))) {
+    if (node.tag() == NodeTag::IndexExpression) {
+      indexes.push_back(static_cast<const IndexExpression *>(&node));
+    }
+  }
+  ASSERT_EQ(indexes.size(), 3);
+  EXPECT_NE(table.canonical(*indexes[0]), nullptr);
+  EXPECT_EQ(table.canonical(*indexes[0]), table.canonical(*indexes[1]));
+  EXPECT_EQ(table.canonical(*indexes[0]), table.canonical(*indexes[2]));
+  EXPECT_GT(table.duplicateCount(), 0);
+
+  // Calls have side effects, so they and their parents are not interned.
+  auto *declaration =
+      dynamic_cast<VariableDeclaration *>(program->statements[0].get());
+  ASSERT_NE(declaration, nullptr);
+  EXPECT_EQ(table.canonical(*declaration->initializer), nullptr);
+  EXPECT_FALSE(isSideEffectFree(*declaration->initializer));
+}
+
+TEST_F(ParserTest, HashConsingCanIncludeStatements) {
+  auto program = parseSource("fn f() { g(); } fn h() { g(); }");
+  ASSERT_NE(program, nullptr);
+
+  HashConsTable table(false);
+  table.add(*program);
+  auto *f = dynamic_cast<FunctionDeclaration *>(program->statements[0].get());
+  auto *h = dynamic_cast<FunctionDeclaration *>(program->statements[1].get());
+  ASSERT_NE(f, nullptr);
+  ASSERT_NE(h, nullptr);
+  EXPECT_EQ(table.canonical(*h->body), f->body.get());
+  EXPECT_NE(table.canonical(*h), table.canonical(*f));
+}
+
+// AST image tests
+TEST_F(ParserTest, ImageRoundTripsPrograms) {
+  std::string source = "rec P { let pub x: i32; }\n"
+                       "fn pub f(a: i32, b: i32): i32 {\n"
+                       "  let v: i32[3] = [1, 2, 3];\n"
+                       "  for (let i: i32 = 0; i < b; i++) { v[i] = a; }\n"
+                       "  if (a > b) { return -a; } elif (a == b) { return 0; }"
+                       " else { return g(a).y; }\n"
+                       "  while (true) { break; }\n"
+                       "}\n";
+  auto program = parseSource(source);
+  ASSERT_NE(program, nullptr);
+
+  auto path = std::filesystem::temp_directory_path() / "ml_image_round.mli";
+  ASSERT_TRUE(writeImage(path.string(), *program, 42));
+
+  AstImage image;
+  ASSERT_TRUE(image.open(path.string()));
+  EXPECT_EQ(image.sourceHash(), 42);
+  auto copy = image.materialize();
+  ASSERT_NE(copy, nullptr);
+  EXPECT_TRUE(structurallyEqual(*program, *copy));
+  EXPECT_EQ(structuralHash(*program), structuralHash(*copy));
+
+  // Locations come from the line table.
+  std::vector<const Node *> original, restored;
+  for (const Node &node : preOrder(static_cast<const Node &>(*program))) {
+    original.push_back(&node);
+  }
+  for (const Node &node : preOrder(static_cast<const Node &>(*copy))) {
+    restored.push_back(&node);
+  }
+  ASSERT_EQ(original.size(), restored.size());
+  for (size_t i = 0; i < original.size(); i++) {
+    EXPECT_EQ(original[i]->tag(), restored[i]->tag());
+    EXPECT_EQ(original[i]->start.line, restored[i]->start.line);
+    EXPECT_EQ(original[i]->start.column, restored[i]->start.column);
+    EXPECT_EQ(original[i]->end.index, restored[i]->end.index);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_F(ParserTest, ImageIsReadInPlace) {
+  auto program = parseSource("fn g(x: i32) { } fn f() { g(1); } "
+                             "fn g(x: f32) { }");
+  ASSERT_NE(program, nullptr);
+
+  auto path = std::filesystem::temp_directory_path() / "ml_image_place.mli";
+  ASSERT_TRUE(writeImage(path.string(), *program, 0));
+  AstImage image;
+  ASSERT_TRUE(image.open(path.string()));
+
+  size_t nodes = 0;
+  for (const Node &node : preOrder(static_cast<const Node &>(*program))) {
+    (void)node;
+    nodes++;
+  }
+  EXPECT_EQ(image.nodeCount(), nodes);
+  EXPECT_EQ(image.node(0).nodeTag(), NodeTag::Program);
+
+  auto overloads = image.functions("g");
+  ASSERT_EQ(overloads.size(), 2);
+  EXPECT_LT(overloads[0], overloads[1]);
+  EXPECT_EQ(image.node(overloads[0]).nodeTag(), NodeTag::FunctionDeclaration);
+  EXPECT_EQ(image.node(overloads[1]).start().line, 1);
+  EXPECT_EQ(image.functions("f").size(), 1);
+  EXPECT_TRUE(image.functions("h").empty());
+
+  // The children of f are its modifier, its name and its body.
+  std::vector<uint32_t> children;
+  image.forEachChild(image.functions("f")[0],
+                     [&children](uint32_t child) { children.push_back(child); });
+  ASSERT_FALSE(children.empty());
+  bool named = false;
+  for (uint32_t child : children) {
+    named = named || image.text(child) == "f";
+  }
+  EXPECT_TRUE(named);
+  std::filesystem::remove(path);
+}
+
+TEST_F(ParserTest, ImageRejectsDamagedFiles) {
+  auto program = parseSource("let x: i32 = 1 + 2;");
+  ASSERT_NE(program, nullptr);
+  std::string bytes = buildImage(*program, 7);
+
+  auto path = std::filesystem::temp_directory_path() / "ml_image_bad.mli";
+  auto save = [&path](const std::string &content) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << content;
+  };
+
+  AstImage image;
+  save(bytes.substr(0, bytes.size() / 2));
+  EXPECT_FALSE(image.open(path.string()));
+  EXPECT_EQ(image.nodeCount(), 0);
+
+  std::string version = bytes;
+  version[8] = static_cast<char>(IMAGE_VERSION + 1);
+  save(version);
+  EXPECT_FALSE(image.open(path.string()));
+
+  save(bytes);
+  EXPECT_TRUE(image.open(path.string()));
+  std::filesystem::remove(path);
+}
+
+TEST_F(ParserTest, ImageRoundTripsDeepTrees) {
+  // Deeper than a recursive writer or reader could follow on a small stack.
+  constexpr int DEPTH = 20000;
+  ml::basic::Locus at(1, 1);
+  std::unique_ptr<Expression> expression =
+      std::make_unique<IdentifierExpression>(at, at, "x");
+  for (int i = 0; i < DEPTH; i++) {
+    expression =
+        std::make_unique<UnaryExpression>(at, at, "-", std::move(expression));
+  }
+  std::vector<std::unique_ptr<Statement>> statements;
+  statements.push_back(
+      std::make_unique<ExpressionStatement>(at, at, std::move(expression)));
+  Program program(at, at, std::move(statements));
+
+  auto path = std::filesystem::temp_directory_path() / "ml_image_deep.mli";
+  ASSERT_TRUE(writeImage(path.string(), program, 0));
+  AstImage image;
+  ASSERT_TRUE(image.open(path.string()));
+  EXPECT_EQ(image.nodeCount(), DEPTH + 3u);
+  auto copy = image.materialize();
+  ASSERT_NE(copy, nullptr);
+
+  int depth = 0;
+  const Expression *node =
+      static_cast<ExpressionStatement &>(*copy->statements[0]).expression.get();
+  while (node->tag() == NodeTag::UnaryExpression) {
+    node = static_cast<const UnaryExpression *>(node)->operand.get();
+    depth++;
+  }
+  EXPECT_EQ(depth, DEPTH);
+  EXPECT_EQ(static_cast<const IdentifierExpression *>(node)->name, "x");
+  std::filesystem::remove(path);
+}
+
+TEST_F(ParserTest, ImageRejectsSharedChildren) {
+  auto program = parseSource("let x: i32 = 1 + 2;");
+  ASSERT_NE(program, nullptr);
+  std::string bytes = buildImage(*program, 0);
+
+  auto path = std::filesystem::temp_directory_path() / "ml_image_shared.mli";
+  auto save = [&path](const std::string &content) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << content;
+  };
+  save(bytes);
+  AstImage image;
+  ASSERT_TRUE(image.open(path.string()));
+  uint32_t first_slot = IMAGE_NONE;
+  for (uint32_t id = 0; id < image.nodeCount(); id++) {
+    if (image.node(id).nodeTag() == NodeTag::BinaryExpression) {
+      first_slot = image.node(id).first_slot;
+    }
+  }
+  ASSERT_NE(first_slot, IMAGE_NONE);
+
+  // Point the right operand at the left one. The slots section offset
+  // follows the magic, the counts, the hash and the nodes offset.
+  uint64_t slots_offset;
+  std::memcpy(&slots_offset, bytes.data() + 48, sizeof(slots_offset));
+  std::memcpy(&bytes[slots_offset + 4 * (first_slot + 1)],
+              bytes.data() + slots_offset + 4 * first_slot, sizeof(uint32_t));
+  save(bytes);
+  EXPECT_FALSE(image.open(path.string()));
+  std::filesystem::remove(path);
+}
+
+// Task tests
+TEST_F(ParserTest, CommentedProgram) {
+  auto program = parseSource("// Integers and floats\n"
+                             "let x: i32 = 42; /* the answer */\n"
+                             "let pi: f64 = 3.14159;\n"
+                             "/* a /* nested */ block */\n"
+                             "let half: f64 = pi / 2; // slash stays\n");
+  ASSERT_NE(program, nullptr);
+  ASSERT_EQ(program->statements.size(), 3);
+  auto *half =
+      dynamic_cast<VariableDeclaration *>(program->statements[2].get());
+  ASSERT_NE(half, nullptr);
+  EXPECT_EQ(half->start.line, 5);
+  EXPECT_NE(dynamic_cast<BinaryExpression *>(half->initializer.get()),
+            nullptr);
+}
+
+TEST_F(ParserTest, ParserKeepsTriviaOnRequest) {
+  Parser parser;
+  parser.keepTrivia(true);
+  auto program = parser.parse("let x = 1; // one\n");
+  ASSERT_NE(program, nullptr);
+  const auto &tokens = parser.tokens();
+  ASSERT_EQ(parser.lexer().trivia().size(), tokens.size());
+  EXPECT_EQ(parser.lexer().leadingTrivia(tokens.size() - 1), " // one\n");
+
+  parser.keepTrivia(false);
+  parser.parse("let y = 2;");
+  EXPECT_TRUE(parser.lexer().trivia().empty());
+}
+
+TEST_F(ParserTest, SpawnAndAwait) {
+  auto program = parseSource("let t = spawn fetch(path, 2);\n"
+                             "let n: i32 = await t + 1;");
+  ASSERT_NE(program, nullptr);
+  ASSERT_EQ(program->statements.size(), 2);
+
+  auto *first =
+      dynamic_cast<VariableDeclaration *>(program->statements[0].get());
+  ASSERT_NE(first, nullptr);
+  auto *spawn = dynamic_cast<SpawnExpression *>(first->initializer.get());
+  ASSERT_NE(spawn, nullptr);
+  auto *call = dynamic_cast<CallExpression *>(spawn->call.get());
+  ASSERT_NE(call, nullptr);
+  EXPECT_EQ(call->arguments.size(), 2);
+  EXPECT_EQ(spawn->start.column, 9);
+
+  // await binds tighter than binary operators.
+  auto *second =
+      dynamic_cast<VariableDeclaration *>(program->statements[1].get());
+  ASSERT_NE(second, nullptr);
+  auto *sum = dynamic_cast<BinaryExpression *>(second->initializer.get());
+  ASSERT_NE(sum, nullptr);
+  auto *await = dynamic_cast<AwaitExpression *>(sum->left.get());
+  ASSERT_NE(await, nullptr);
+  EXPECT_EQ(await->task->tag(), NodeTag::IdentifierExpression);
+  EXPECT_FALSE(isSideEffectFree(*await));
+}
+
+TEST_F(ParserTest, SpawnRequiresCall) {
+  Parser parser;
+  parser.parse("let t = spawn worker;");
+  EXPECT_GT(parser.errors(), 0);
+}
+
+TEST_F(ParserTest, TasksRoundTripThroughImages) {
+  auto program = parseSource("fn f() { let a = await spawn g(1); }");
+  ASSERT_NE(program, nullptr);
+  auto path = std::filesystem::temp_directory_path() / "ml_image_tasks.mli";
+  ASSERT_TRUE(writeImage(path.string(), *program, 0));
+  AstImage image;
+  ASSERT_TRUE(image.open(path.string()));
+  auto copy = image.materialize();
+  ASSERT_NE(copy, nullptr);
+  EXPECT_TRUE(structurallyEqual(*program, *copy));
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,174 @@
+/**
+ * @file image_bench.cpp
+ * @brief Benchmark of cold start from AST images in My Language.
+ * @details Generates a synthetic program, writes it as source and as an
+ * image, then compares the time to get a usable tree each way: reading and
+ * parsing the source, mapping the image and walking it in place, and mapping
+ * the image and rebuilding the pointer tree.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/ast/image.h"
+#include "ml/basic/hash.h"
+#include "ml/parser/parser.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace ml;
+
+namespace {
+
+/**
+ * @brief Generates a program with a number of functions.
+ */
+std::string generate(size_t functions) {
+  std::ostringstream source;
+  source << "rec Point { let pub x: i32; let pub y: i32; }\n";
+  for (size_t i = 0; i < functions; i++) {
+    source << "fn pub f" << i << "(a: i32, b: i32): i32 {\n"
+           << "  let s: i32 = 0;\n"
+           << "  for (let k: i32 = 0; k < a; k++) {\n"
+           << "    if (k > b) { s = s + k * " << i << "; }\n"
+           << "    elif (k == b) { s = s - 1; }\n"
+           << "    else { s = s + f" << (i == 0 ? 0 : i - 1) << "(k, b); }\n"
+           << "  }\n"
+           << "  while (s > 100) { s = s / 2; }\n"
+           << "  return s + \"value " << i << "\".size;\n"
+           << "}\n";
+  }
+  return source.str();
+}
+
+std::string readFile(const std::string &file_path) {
+  std::ifstream file_stream(file_path, std::ios::binary);
+  std::stringstream buffer;
+  buffer << file_stream.rdbuf();
+  return buffer.str();
+}
+
+/**
+ * @brief Measures the mean time of a cold start in milliseconds.
+ * @param start Gets the tree ready and returns its node count.
+ */
+template <typename F> double measure(F &&start, int repeats, size_t &nodes) {
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeats; i++) {
+    nodes = start();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - begin;
+  return std::chrono::duration<double, std::milli>(elapsed).count() / repeats;
+}
+
+size_t countNodes(const ast::Node &root) {
+  size_t count = 0;
+  for (const ast::Node &node : ast::preOrder(root)) {
+    (void)node;
+    count++;
+  }
+  return count;
+}
+
+void printRow(const std::string &name, double millis, size_t nodes,
+              double baseline) {
+  std::cout << std::left << std::setw(22) << name << std::right
+            << std::setw(10) << nodes << std::setw(12) << std::fixed
+            << std::setprecision(3) << millis << std::setw(10)
+            << std::setprecision(1) << baseline / millis << "x" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  size_t functions = 2000;
+  int repeats = 10;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--functions" && i + 1 < argc) {
+      functions = std::stoul(argv[++i]);
+    } else if (arg == "--repeats" && i + 1 < argc) {
+      repeats = std::stoi(argv[++i]);
+    } else {
+      std::cerr << "Usage: image_bench [--functions N] [--repeats R]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  auto directory = std::filesystem::temp_directory_path() / "ml_image_bench";
+  std::filesystem::create_directories(directory);
+  std::string source_path = (directory / "program.ml").string();
+  std::string image_path = (directory / "program.mli").string();
+
+  std::string source = generate(functions);
+  std::ofstream(source_path, std::ios::binary) << source;
+  {
+    parser::Parser parser;
+    auto program = parser.parse(source);
+    if (!program ||
+        !ast::writeImage(image_path, *program, basic::fnv1a(source))) {
+      std::cerr << "failed to build the image" << std::endl;
+      return 1;
+    }
+  }
+
+  std::cout << functions << " functions, source "
+            << std::filesystem::file_size(source_path) << " bytes, image "
+            << std::filesystem::file_size(image_path) << " bytes"
+            << std::endl;
+  std::cout << std::left << std::setw(22) << "start" << std::right
+            << std::setw(10) << "nodes" << std::setw(12) << "time (ms)"
+            << std::setw(11) << "speedup" << std::endl;
+
+  size_t nodes = 0;
+  double parse = measure(
+      [&source_path]() {
+        parser::Parser parser;
+        auto program = parser.parse(readFile(source_path));
+        return program ? countNodes(*program) : 0;
+      },
+      repeats, nodes);
+  printRow("parse source", parse, nodes, parse);
+
+  double walk = measure(
+      [&image_path]() -> size_t {
+        ast::AstImage image;
+        if (!image.open(image_path)) {
+          return 0;
+        }
+        // Visit every node reachable from the root, in place.
+        size_t count = 0;
+        std::vector<uint32_t> stack = {0};
+        while (!stack.empty()) {
+          uint32_t id = stack.back();
+          stack.pop_back();
+          count++;
+          image.forEachChild(id, [&stack](uint32_t child) {
+            stack.push_back(child);
+          });
+        }
+        return count;
+      },
+      repeats, nodes);
+  printRow("map image + walk", walk, nodes, parse);
+
+  double materialize = measure(
+      [&image_path]() -> size_t {
+        ast::AstImage image;
+        if (!image.open(image_path)) {
+          return 0;
+        }
+        auto program = image.materialize();
+        return program ? countNodes(*program) : 0;
+      },
+      repeats, nodes);
+  printRow("map image + rebuild", materialize, nodes, parse);
+
+  std::filesystem::remove_all(directory);
+  return 0;
+}
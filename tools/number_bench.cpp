@@ -0,0 +1,165 @@
+/**
+ * @file number_bench.cpp
+ * @brief Benchmark of numeric literal lexing in My Language.
+ * @details Generates a number-heavy data file (large arrays of integer,
+ * hexadecimal, separated and floating-point literals), then measures
+ * lexing it with values converted once in the lexer, and compares that
+ * conversion against converting the same lexemes later with strtoull and
+ * strtod, as consumers did when literals were kept only as strings.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/basic/number.h"
+#include "ml/lexer/lexer.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ml;
+
+namespace {
+
+/**
+ * @brief Generates a data file with a number of literals.
+ */
+std::string generate(size_t count, uint32_t seed) {
+  std::mt19937_64 random(seed);
+  std::uniform_real_distribution<double> reals(-1e6, 1e6);
+  std::ostringstream source;
+  source.precision(17);
+  source << "let data: f64[] = [\n";
+  for (size_t i = 0; i < count; i++) {
+    switch (i % 4) {
+    case 0:
+      source << random() % 1000000;
+      break;
+    case 1:
+      source << "0x" << std::hex << random() << std::dec;
+      break;
+    case 2:
+      source << std::abs(reals(random));
+      break;
+    default:
+      source << std::abs(reals(random)) << "e-3";
+      break;
+    }
+    source << (i % 8 == 7 ? ",\n" : ", ");
+  }
+  source << "];\n";
+  return source.str();
+}
+
+/**
+ * @brief Measures the mean time of a run in milliseconds.
+ */
+template <typename F> double measure(F &&run, int repeats, double &result) {
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeats; i++) {
+    result = run();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - begin;
+  return std::chrono::duration<double, std::milli>(elapsed).count() / repeats;
+}
+
+void printRow(const std::string &name, double millis, double result,
+              size_t bytes) {
+  std::cout << std::left << std::setw(26) << name << std::right
+            << std::setw(22) << std::setprecision(6) << result
+            << std::setw(12) << std::fixed << std::setprecision(3) << millis
+            << std::setw(10) << std::setprecision(1)
+            << bytes / (millis * 1000.0) << std::endl;
+  std::cout.unsetf(std::ios::fixed);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  size_t count = 1000000;
+  int repeats = 5;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--numbers" && i + 1 < argc) {
+      count = std::stoul(argv[++i]);
+    } else if (arg == "--repeats" && i + 1 < argc) {
+      repeats = std::stoi(argv[++i]);
+    } else {
+      std::cerr << "Usage: number_bench [--numbers N] [--repeats R]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  std::string source = generate(count, 1);
+  std::vector<std::string> lexemes;
+  {
+    lexer::Lexer lexer(source);
+    for (const auto &token : lexer.lex(source)) {
+      if (token->kind == lexer::TokenKind::Integer ||
+          token->kind == lexer::TokenKind::Float) {
+        lexemes.push_back(token->value);
+      }
+    }
+  }
+  size_t literal_bytes = 0;
+  for (const auto &lexeme : lexemes) {
+    literal_bytes += lexeme.size();
+  }
+
+  std::cout << lexemes.size() << " literals, " << source.size()
+            << " bytes of source" << std::endl;
+  std::cout << std::left << std::setw(26) << "run" << std::right
+            << std::setw(22) << "checksum" << std::setw(12) << "time (ms)"
+            << std::setw(10) << "MB/s" << std::endl;
+
+  double result = 0;
+  double time = measure(
+      [&source]() {
+        lexer::Lexer lexer(source);
+        double sum = 0;
+        for (const auto &token : lexer.lex(source)) {
+          sum += token->number.kind == basic::NumberKind::Float
+                     ? token->number.real
+                     : static_cast<double>(token->number.integer);
+        }
+        return sum;
+      },
+      repeats, result);
+  printRow("lex with values", time, result, source.size());
+
+  time = measure(
+      [&lexemes]() {
+        double sum = 0;
+        basic::Number number;
+        for (const auto &lexeme : lexemes) {
+          basic::parseNumber(lexeme, number);
+          sum += number.kind == basic::NumberKind::Float
+                     ? number.real
+                     : static_cast<double>(number.integer);
+        }
+        return sum;
+      },
+      repeats, result);
+  printRow("convert with from_chars", time, result, literal_bytes);
+
+  time = measure(
+      [&lexemes]() {
+        double sum = 0;
+        for (const auto &lexeme : lexemes) {
+          bool is_float = lexeme.find_first_of(".e") != std::string::npos &&
+                          lexeme.compare(0, 2, "0x") != 0;
+          sum += is_float ? std::strtod(lexeme.c_str(), nullptr)
+                          : static_cast<double>(
+                                std::strtoull(lexeme.c_str(), nullptr, 0));
+        }
+        return sum;
+      },
+      repeats, result);
+  printRow("convert with strtod", time, result, literal_bytes);
+  return 0;
+}
@@ -0,0 +1,230 @@
+/**
+ * @file pool_bench.cpp
+ * @brief Benchmark of the work-stealing thread pool in My Language.
+ * @details Runs fork-join workloads three ways: sequentially, with a thread
+ * started per forked task and on the shared work-stealing pool. The
+ * workloads are a recursive Fibonacci, a divide-and-conquer sum and many
+ * short parallel loops, the shape of a build over small files.
+ * @copyright Copyright (c) 2025 Karson P. Califf
+ */
+
+#include "ml/basic/parallel.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ml;
+
+namespace {
+
+/**
+ * @brief Subproblems below this size run sequentially.
+ */
+constexpr int FIB_CUTOFF = 16;
+constexpr size_t SUM_CUTOFF = 4096;
+
+long fibSequential(int n) {
+  return n < 2 ? n : fibSequential(n - 1) + fibSequential(n - 2);
+}
+
+long fibThreads(int n, int depth) {
+  if (n < FIB_CUTOFF || depth == 0) {
+    return fibSequential(n);
+  }
+  long left = 0;
+  std::thread thread(
+      [&left, n, depth]() { left = fibThreads(n - 1, depth - 1); });
+  long right = fibThreads(n - 2, depth - 1);
+  thread.join();
+  return left + right;
+}
+
+long fibPool(int n) {
+  if (n < FIB_CUTOFF) {
+    return fibSequential(n);
+  }
+  long left = 0;
+  basic::TaskGroup group;
+  group.run([&left, n]() { left = fibPool(n - 1); });
+  long right = fibPool(n - 2);
+  group.wait();
+  return left + right;
+}
+
+uint64_t sumSequential(const uint64_t *begin, const uint64_t *end) {
+  return std::accumulate(begin, end, uint64_t(0));
+}
+
+uint64_t sumThreads(const uint64_t *begin, const uint64_t *end, int depth) {
+  size_t size = end - begin;
+  if (size < SUM_CUTOFF || depth == 0) {
+    return sumSequential(begin, end);
+  }
+  const uint64_t *middle = begin + size / 2;
+  uint64_t left = 0;
+  std::thread thread([&left, begin, middle, depth]() {
+    left = sumThreads(begin, middle, depth - 1);
+  });
+  uint64_t right = sumThreads(middle, end, depth - 1);
+  thread.join();
+  return left + right;
+}
+
+uint64_t sumPool(const uint64_t *begin, const uint64_t *end) {
+  size_t size = end - begin;
+  if (size < SUM_CUTOFF) {
+    return sumSequential(begin, end);
+  }
+  const uint64_t *middle = begin + size / 2;
+  uint64_t left = 0;
+  basic::TaskGroup group;
+  group.run([&left, begin, middle]() { left = sumPool(begin, middle); });
+  uint64_t right = sumPool(middle, end);
+  group.wait();
+  return left + right;
+}
+
+using Loop = void (*)(size_t, unsigned, const std::function<void(size_t)> &);
+
+void loopSequential(size_t count, unsigned,
+                    const std::function<void(size_t)> &body) {
+  for (size_t i = 0; i < count; i++) {
+    body(i);
+  }
+}
+
+/**
+ * @brief The parallel loop as it was before the pool: fresh threads per
+ * call claiming items from a shared counter.
+ */
+void loopThreads(size_t count, unsigned jobs,
+                 const std::function<void(size_t)> &body) {
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    for (size_t i = next++; i < count; i = next++) {
+      body(i);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < jobs; i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+/**
+ * @brief Measures the mean time of a workload in milliseconds.
+ */
+template <typename F> double measure(F &&run, int repeats, uint64_t &result) {
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeats; i++) {
+    result = run();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - begin;
+  return std::chrono::duration<double, std::milli>(elapsed).count() / repeats;
+}
+
+void printRow(const std::string &name, double millis, uint64_t result,
+              double baseline) {
+  std::cout << std::left << std::setw(22) << name << std::right
+            << std::setw(16) << result << std::setw(12) << std::fixed
+            << std::setprecision(3) << millis << std::setw(10)
+            << std::setprecision(2) << baseline / millis << "x" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int n = 30;
+  size_t elements = 1 << 24;
+  size_t loops = 2000;
+  int repeats = 5;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--fib" && i + 1 < argc) {
+      n = std::stoi(argv[++i]);
+    } else if (arg == "--elements" && i + 1 < argc) {
+      elements = std::stoul(argv[++i]);
+    } else if (arg == "--loops" && i + 1 < argc) {
+      loops = std::stoul(argv[++i]);
+    } else if (arg == "--repeats" && i + 1 < argc) {
+      repeats = std::stoi(argv[++i]);
+    } else {
+      std::cerr << "Usage: pool_bench [--fib N] [--elements N] [--loops N] "
+                   "[--repeats R]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  unsigned jobs = basic::defaultJobs();
+  // Deep enough that every hardware thread gets a share of the tree.
+  int depth = 1;
+  while ((1u << depth) < jobs * 4) {
+    depth++;
+  }
+  basic::ThreadPool &pool = basic::ThreadPool::global();
+  std::cout << pool.size() << " workers" << std::endl;
+  std::cout << std::left << std::setw(22) << "workload" << std::right
+            << std::setw(16) << "result" << std::setw(12) << "time (ms)"
+            << std::setw(11) << "speedup" << std::endl;
+
+  uint64_t result = 0;
+  double base = measure([n]() { return fibSequential(n); }, repeats, result);
+  printRow("fib sequential", base, result, base);
+  double time = measure([n, depth]() { return fibThreads(n, depth); },
+                        repeats, result);
+  printRow("fib thread per task", time, result, base);
+  time = measure([n]() { return fibPool(n); }, repeats, result);
+  printRow("fib pool", time, result, base);
+
+  std::vector<uint64_t> values(elements);
+  std::iota(values.begin(), values.end(), uint64_t(1));
+  const uint64_t *begin = values.data();
+  const uint64_t *end = begin + values.size();
+  base = measure([=]() { return sumSequential(begin, end); }, repeats,
+                 result);
+  printRow("sum sequential", base, result, base);
+  time = measure([=]() { return sumThreads(begin, end, depth); }, repeats,
+                 result);
+  printRow("sum thread per task", time, result, base);
+  time = measure([=]() { return sumPool(begin, end); }, repeats, result);
+  printRow("sum pool", time, result, base);
+
+  // Many small loops, each over a handful of uneven items.
+  std::function<void(size_t)> item = [](size_t i) {
+    volatile uint64_t x = 0;
+    for (size_t k = 0; k < 2000 * (i % 7 + 1); k++) {
+      x = x + k;
+    }
+  };
+  auto loopsWith = [loops, jobs, &item](Loop loop) {
+    return [loops, jobs, &item, loop]() -> uint64_t {
+      for (size_t i = 0; i < loops; i++) {
+        loop(16, jobs, item);
+      }
+      return loops;
+    };
+  };
+  base = measure(loopsWith(loopSequential), repeats, result);
+  printRow("loops sequential", base, result, base);
+  time = measure(loopsWith(loopThreads), repeats, result);
+  printRow("loops thread per call", time, result, base);
+  time = measure(loopsWith(basic::parallelFor), repeats, result);
+  printRow("loops pool", time, result, base);
+
+  basic::PoolStats stats = pool.stats();
+  std::cout << stats.executed << " tasks run, " << stats.stolen
+            << " stolen, " << stats.injected << " injected" << std::endl;
+  return 0;
+}